@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////
+#ifdef VERTEX_SHADER
+
+// constants
+uniform mat4 view_projection_matrix;
+
+// attributes
+in vec3 in_pos_frame0;
+in vec3 in_pos_frame1;
+in vec2 in_texcoord;
+
+// per instance attributes
+in vec4 in_instance_transform0;
+in vec4 in_instance_transform1;
+in vec4 in_instance_transform2;
+in vec4 in_instance_transform3;
+in float in_instance_mix_frames;
+
+// pass to fragment shader
+out vec2 Texcoord;
+
+// entry point
+void main() 
+{
+	Texcoord = in_texcoord;
+
+    mat4 model_matrix = mat4(in_instance_transform0, in_instance_transform1, in_instance_transform2, in_instance_transform3);
+
+    vec4 v0 = view_projection_matrix * model_matrix * vec4(in_pos_frame0, 1.0);
+    vec4 v1 = view_projection_matrix * model_matrix * vec4(in_pos_frame1, 1.0);
+
+    gl_Position = mix(v0, v1, in_instance_mix_frames);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef FRAGMENT_SHADER
+
+uniform sampler2D tex_0;
+
+// passed from vertex shader
+in vec2 Texcoord;
+
+// result
+out vec4 FinalColor;
+
+// entry point
+void main() 
+{
+	vec4 texelColor = texture(tex_0, Texcoord);
+    FinalColor = texelColor;
+}
+
+#endif
@@ -14,9 +14,11 @@ in vec3 in_pos;
 //in vec3 in_normal;
 in vec2 in_texcoord;
 in ivec2 in_tile_coord;
+in uint in_texture_layer;
 
 // pass to fragment shader
 out vec2 Texcoord;
+flat out uint TextureLayer;
 out vec3 FragIllumination;
 out vec4 FragColor;
 out vec3 InPos;
@@ -25,11 +27,14 @@ out vec3 InPos;
 void main() 
 {
 	Texcoord = in_texcoord;
-    InPos = in_pos;
+    TextureLayer = in_texture_layer;
+    // compact vertices are restored to world space by model matrix
+    vec4 worldPosition = model_matrix * vec4(in_pos, 1.0);
+    InPos = worldPosition.xyz;
 
 	FragColor = texelFetch(colorsTex, in_tile_coord, 0);
 
-    vec4 vertexPosition = view_projection_matrix * model_matrix * vec4(in_pos, 1.0);
+    vec4 vertexPosition = view_projection_matrix * worldPosition;
     gl_Position = vertexPosition;
 }
 
@@ -39,11 +44,17 @@ void main()
 #ifdef FRAGMENT_SHADER
 
 #define diffuseTex tex_0
+#define diffuseArrayTex tex_2
+
+// vertex uses regular diffuse texture instead of textures array
+#define NO_TEXTURE_LAYER 65535u
 
 uniform sampler2D diffuseTex;
+uniform sampler2DArray diffuseArrayTex;
 
 // passed from vertex shader
 in vec2 Texcoord;
+flat in uint TextureLayer;
 in vec4 FragColor;
 in vec3 FragIllumination;
 in vec3 InPos;
@@ -54,7 +65,9 @@ out vec4 FinalColor;
 // entry point
 void main() 
 {
-	vec4 texelColor = texture(diffuseTex, Texcoord);
+	vec4 texelColor = (TextureLayer == NO_TEXTURE_LAYER) ? 
+        texture(diffuseTex, Texcoord) : 
+        texture(diffuseArrayTex, vec3(Texcoord, float(TextureLayer)));
     if (texelColor.a < 0.185f)
         discard; // translucency
 
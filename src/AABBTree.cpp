@@ -3,11 +3,99 @@
 #include "DebugRenderer.h"
 #include "SceneObject.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define AABBTREE_SSE2
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 // AABBTree implementation borrowed from here
 // https://github.com/JamesRandall/SimpleVoxelEngine/blob/master/voxelEngine/src/AABBTree.h
 //////////////////////////////////////////////////////////////////////////
 
+// leaf bounds enlargement, allows small movements without reinserting leaf
+const float AABBTreeFatMargin = 0.1f;
+// how far ahead object movement is predicted in leaf bounds
+const float AABBTreeDisplacementMultiplier = 4.0f;
+
+const int CullingBatchSize = 4;
+const unsigned int CullingAllPlanes = (1U << cxx::NUM_FRUSTUM_PLANES) - 1;
+const unsigned int CullingRejected = ~0U;
+
+// values for each node in batch
+struct CullingLanes
+{
+public:
+    alignas(16) float mX[CullingBatchSize];
+    alignas(16) float mY[CullingBatchSize];
+    alignas(16) float mZ[CullingBatchSize];
+    alignas(16) float mW[CullingBatchSize];
+};
+
+// frustum planes replicated for each node in batch
+struct AABBTree::CullingPlanes
+{
+public:
+    const cxx::frustum_t* mFrustum = nullptr;
+    CullingLanes mPlanes[cxx::NUM_FRUSTUM_PLANES];
+    CullingLanes mAbsNormals[cxx::NUM_FRUSTUM_PLANES];
+};
+
+// test batch of boxes against planes, one plane per box
+// @param planes, absNormals: Planes and absolute values of their normals
+// @param centers, extents: Boxes
+// @param outsideBits, insideBits: Receives bits of boxes which are completely behind and in front of plane
+inline void classify_boxes(const CullingLanes& planes, const CullingLanes& absNormals, const CullingLanes& centers, const CullingLanes& extents,
+    unsigned int& outsideBits, unsigned int& insideBits)
+{
+#ifdef AABBTREE_SSE2
+    // distance from box center to plane and projected box radius
+    const __m128 distance = _mm_add_ps(_mm_add_ps(
+        _mm_mul_ps(_mm_load_ps(planes.mX), _mm_load_ps(centers.mX)), 
+        _mm_mul_ps(_mm_load_ps(planes.mY), _mm_load_ps(centers.mY))), _mm_add_ps(
+        _mm_mul_ps(_mm_load_ps(planes.mZ), _mm_load_ps(centers.mZ)), _mm_load_ps(planes.mW)));
+    const __m128 radius = _mm_add_ps(_mm_add_ps(
+        _mm_mul_ps(_mm_load_ps(absNormals.mX), _mm_load_ps(extents.mX)),
+        _mm_mul_ps(_mm_load_ps(absNormals.mY), _mm_load_ps(extents.mY))),
+        _mm_mul_ps(_mm_load_ps(absNormals.mZ), _mm_load_ps(extents.mZ)));
+    const __m128 zeroValue = _mm_setzero_ps();
+    outsideBits = (unsigned int) _mm_movemask_ps(_mm_cmple_ps(_mm_add_ps(distance, radius), zeroValue));
+    insideBits = (unsigned int) _mm_movemask_ps(_mm_cmpgt_ps(_mm_sub_ps(distance, radius), zeroValue));
+#else
+    outsideBits = 0;
+    insideBits = 0;
+    for (int ilane = 0; ilane < CullingBatchSize; ++ilane)
+    {
+        const float distance = planes.mX[ilane] * centers.mX[ilane] + planes.mY[ilane] * centers.mY[ilane] + 
+            planes.mZ[ilane] * centers.mZ[ilane] + planes.mW[ilane];
+        const float radius = absNormals.mX[ilane] * extents.mX[ilane] + absNormals.mY[ilane] * extents.mY[ilane] + 
+            absNormals.mZ[ilane] * extents.mZ[ilane];
+        if (distance + radius <= 0.0f)
+        {
+            outsideBits |= (1U << ilane);
+        }
+        if (distance - radius > 0.0f)
+        {
+            insideBits |= (1U << ilane);
+        }
+    }
+#endif // AABBTREE_SSE2
+}
+
+// copy plane to single lane
+inline void set_plane_lane(CullingLanes& planes, CullingLanes& absNormals, int ilane, const cxx::plane3d& plane)
+{
+    planes.mX[ilane] = plane.mNormal.x;
+    planes.mY[ilane] = plane.mNormal.y;
+    planes.mZ[ilane] = plane.mNormal.z;
+    planes.mW[ilane] = plane.mDistance;
+    absNormals.mX[ilane] = fabs(plane.mNormal.x);
+    absNormals.mY[ilane] = fabs(plane.mNormal.y);
+    absNormals.mZ[ilane] = fabs(plane.mNormal.z);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 AABBTree::AABBTree(unsigned int initialSize)
     : mRootNodeIndex(NULL_TREE_NODE)
     , mAllocatedCount()
@@ -53,6 +141,9 @@ void AABBTree::AllocateTreeNode(TreeNodeIndex* treeNodeIndex)
     treeNode.mParentNodeIndex = NULL_TREE_NODE;
     treeNode.mLeftNodeIndex = NULL_TREE_NODE;
     treeNode.mRightNodeIndex = NULL_TREE_NODE;
+    treeNode.mObject = nullptr;
+    treeNode.mHeight = 0;
+    treeNode.mCullPlane = 0;
     mNextFreeNodeIndex = treeNode.mNextNodeIndex;
     mAllocatedCount++;
 }
@@ -86,7 +177,7 @@ void AABBTree::InsertLeaf(TreeNodeIndex leafNodeIndex)
 	// search for the best place to put the new leaf in the tree
 	// we use surface area and depth as search heuristics
 	TreeNodeIndex treeNodeIndex = mRootNodeIndex;
-	TreeNode& leafNode = mTreeNodes[leafNodeIndex];
+	const cxx::aabbox leafBounds = mTreeNodes[leafNodeIndex].mBoundingBox;
 	while (!mTreeNodes[treeNodeIndex].IsLeafNode())
 	{
 		// because of the test in the while loop above we know we are never a leaf inside it
@@ -96,7 +187,7 @@ void AABBTree::InsertLeaf(TreeNodeIndex leafNodeIndex)
 		const TreeNode& leftNode = mTreeNodes[leftNodeIndex];
 		const TreeNode& rightNode = mTreeNodes[rightNodeIndex];
 
-        float combinedAabbSurfaceArea = treeNode.mBoundingBox.union_with(leafNode.mBoundingBox).get_surface_area();
+        float combinedAabbSurfaceArea = treeNode.mBoundingBox.union_with(leafBounds).get_surface_area();
 		float newParentNodeCost = 2.0f * combinedAabbSurfaceArea;
 		float minimumPushDownCost = 2.0f * (combinedAabbSurfaceArea - treeNode.mBoundingBox.get_surface_area());
 		// use the costs to figure out whether to create a new parent here or descend
@@ -104,20 +195,20 @@ void AABBTree::InsertLeaf(TreeNodeIndex leafNodeIndex)
 		float costRight;
 		if (leftNode.IsLeafNode())
 		{
-			costLeft = leafNode.mBoundingBox.union_with(leftNode.mBoundingBox).get_surface_area() + minimumPushDownCost;
+			costLeft = leafBounds.union_with(leftNode.mBoundingBox).get_surface_area() + minimumPushDownCost;
 		}
 		else
 		{
-			cxx::aabbox newLeftAabb = leafNode.mBoundingBox.union_with(leftNode.mBoundingBox);
+			cxx::aabbox newLeftAabb = leafBounds.union_with(leftNode.mBoundingBox);
 			costLeft = (newLeftAabb.get_surface_area() - leftNode.mBoundingBox.get_surface_area()) + minimumPushDownCost;			
 		}
 		if (rightNode.IsLeafNode())
 		{
-			costRight = leafNode.mBoundingBox.union_with(rightNode.mBoundingBox).get_surface_area() + minimumPushDownCost;
+			costRight = leafBounds.union_with(rightNode.mBoundingBox).get_surface_area() + minimumPushDownCost;
 		}
 		else
 		{
-			cxx::aabbox newRightAabb = leafNode.mBoundingBox.union_with(rightNode.mBoundingBox);
+			cxx::aabbox newRightAabb = leafBounds.union_with(rightNode.mBoundingBox);
 			costRight = (newRightAabb.get_surface_area() - rightNode.mBoundingBox.get_surface_area()) + minimumPushDownCost;
 		}
 
@@ -140,14 +231,17 @@ void AABBTree::InsertLeaf(TreeNodeIndex leafNodeIndex)
 	// the leafs sibling is going to be the node we found above and we are going to create a new
 	// parent node and attach the leaf and this item
 	TreeNodeIndex leafSiblingIndex = treeNodeIndex;
-	TreeNode& leafSibling = mTreeNodes[leafSiblingIndex];
-	TreeNodeIndex oldParentIndex = leafSibling.mParentNodeIndex;
+	TreeNodeIndex oldParentIndex = mTreeNodes[leafSiblingIndex].mParentNodeIndex;
 	TreeNodeIndex newParentIndex = NULL_TREE_NODE;
     AllocateTreeNode(&newParentIndex);
 
+    // nodes storage might be reallocated, so references are taken after allocation
+    TreeNode& leafNode = mTreeNodes[leafNodeIndex];
+	TreeNode& leafSibling = mTreeNodes[leafSiblingIndex];
 	TreeNode& newParent = mTreeNodes[newParentIndex];
 	newParent.mParentNodeIndex = oldParentIndex;
 	newParent.mBoundingBox = leafNode.mBoundingBox.union_with(leafSibling.mBoundingBox); // the new parents aabb is the leaf aabb combined with it's siblings aabb
+	newParent.mHeight = leafSibling.mHeight + 1;
 	newParent.mLeftNodeIndex = leafSiblingIndex;
 	newParent.mRightNodeIndex = leafNodeIndex;
 	leafNode.mParentNodeIndex = newParentIndex;
@@ -174,8 +268,7 @@ void AABBTree::InsertLeaf(TreeNodeIndex leafNodeIndex)
 	}
 
 	// finally we need to walk back up the tree fixing heights and areas
-	treeNodeIndex = leafNode.mParentNodeIndex;
-	FixUpwardsTree(treeNodeIndex);
+	FixUpwardsTree(newParentIndex);
 }
 
 void AABBTree::RemoveLeaf(TreeNodeIndex leafNodeIndex)
@@ -196,6 +289,7 @@ void AABBTree::RemoveLeaf(TreeNodeIndex leafNodeIndex)
 	debug_assert(siblingNodeIndex != NULL_TREE_NODE); // we must have a sibling
 
 	TreeNode& siblingNode = mTreeNodes[siblingNodeIndex];
+	leafNode.mParentNodeIndex = NULL_TREE_NODE;
 	if (grandParentNodeIndex != NULL_TREE_NODE)
 	{
 		// if we have a grand parent (i.e. the parent is not the root) then destroy the parent and connect the sibling to the grandparent in its
@@ -220,31 +314,58 @@ void AABBTree::RemoveLeaf(TreeNodeIndex leafNodeIndex)
 		siblingNode.mParentNodeIndex = NULL_TREE_NODE;
 		DeallocateTreeNode(parentNodeIndex);
 	}
-
-	leafNode.mParentNodeIndex = NULL_TREE_NODE;
 }
 
 void AABBTree::UpdateLeaf(TreeNodeIndex leafNodeIndex, const cxx::aabbox& boundingBox)
 {
     debug_assert(leafNodeIndex != NULL_TREE_NODE);
-	TreeNode& node = mTreeNodes[leafNodeIndex];
-	
-	// if the node contains the new aabb then we just leave things
-	// TODO: when we add velocity this check should kick in as often an update will lie within the velocity fattened initial aabb
-	// to support this we might need to differentiate between velocity fattened aabb and actual aabb
-	if (node.mBoundingBox.contains(boundingBox)) 
+    // object bounds was not changed since last update
+    const cxx::aabbox& objectBounds = mTreeNodes[leafNodeIndex].mObjectBounds;
+    if (objectBounds.mMin == boundingBox.mMin && objectBounds.mMax == boundingBox.mMax)
         return;
 
+    ++mStats.mObjectsUpdated;
+
+    const glm::vec3 displacement = boundingBox.get_center() - mTreeNodes[leafNodeIndex].mObjectBounds.get_center();
+    const cxx::aabbox fatBounds = ComputeFatBounds(boundingBox, displacement);
+    mTreeNodes[leafNodeIndex].mObjectBounds = boundingBox;
+
+    // if fat bounds still contains object and is not too large for it then we just leave things
+    const cxx::aabbox& currentBounds = mTreeNodes[leafNodeIndex].mBoundingBox;
+    if (currentBounds.contains(boundingBox))
+    {
+        const glm::vec3 hugeMargin (AABBTreeFatMargin * 4.0f);
+        const cxx::aabbox hugeBounds (fatBounds.mMin - hugeMargin, fatBounds.mMax + hugeMargin);
+        if (hugeBounds.contains(currentBounds))
+            return;
+    }
+
+    ++mStats.mLeavesReinserted;
+
 	RemoveLeaf(leafNodeIndex);
-	node.mBoundingBox = boundingBox;
+	mTreeNodes[leafNodeIndex].mBoundingBox = fatBounds;
 	InsertLeaf(leafNodeIndex);
 }
 
+cxx::aabbox AABBTree::ComputeFatBounds(const cxx::aabbox& boundingBox, const glm::vec3& displacement) const
+{
+    const glm::vec3 margin (AABBTreeFatMargin);
+    cxx::aabbox fatBounds (boundingBox.mMin - margin, boundingBox.mMax + margin);
+
+    // extend bounds in direction of movement
+    const glm::vec3 predicted = displacement * AABBTreeDisplacementMultiplier;
+    fatBounds.mMin += glm::min(predicted, glm::vec3(0.0f));
+    fatBounds.mMax += glm::max(predicted, glm::vec3(0.0f));
+    return fatBounds;
+}
+
 void AABBTree::FixUpwardsTree(TreeNodeIndex treeNodeIndex)
 {
     debug_assert(treeNodeIndex != NULL_TREE_NODE);
 	while (treeNodeIndex != NULL_TREE_NODE)
 	{
+		treeNodeIndex = BalanceNode(treeNodeIndex);
+
 		TreeNode& treeNode = mTreeNodes[treeNodeIndex];
 
 		// every node should be a parent
@@ -253,12 +374,84 @@ void AABBTree::FixUpwardsTree(TreeNodeIndex treeNodeIndex)
 		// fix height and area
 		const TreeNode& leftNode = mTreeNodes[treeNode.mLeftNodeIndex];
 		const TreeNode& rightNode = mTreeNodes[treeNode.mRightNodeIndex];
+		treeNode.mHeight = 1 + std::max(leftNode.mHeight, rightNode.mHeight);
 		treeNode.mBoundingBox = leftNode.mBoundingBox.union_with(rightNode.mBoundingBox);
 
 		treeNodeIndex = treeNode.mParentNodeIndex;
 	}
 }
 
+AABBTree::TreeNodeIndex AABBTree::BalanceNode(TreeNodeIndex nodeIndexA)
+{
+    debug_assert(nodeIndexA != NULL_TREE_NODE);
+
+    TreeNode& nodeA = mTreeNodes[nodeIndexA];
+    if (nodeA.IsLeafNode() || nodeA.mHeight < 2)
+        return nodeIndexA;
+
+    const TreeNodeIndex nodeIndexB = nodeA.mLeftNodeIndex;
+    const TreeNodeIndex nodeIndexC = nodeA.mRightNodeIndex;
+    const int balance = mTreeNodes[nodeIndexC].mHeight - mTreeNodes[nodeIndexB].mHeight;
+    if (balance > -2 && balance < 2)
+        return nodeIndexA;
+
+    // promote taller child of A, its taller child stays with it and shorter one is moved to A
+    const bool rotateLeft = (balance > 1);
+    const TreeNodeIndex nodeIndexUp = rotateLeft ? nodeIndexC : nodeIndexB;
+    const TreeNodeIndex nodeIndexSibling = rotateLeft ? nodeIndexB : nodeIndexC;
+    TreeNode& nodeUp = mTreeNodes[nodeIndexUp];
+    TreeNode& nodeSibling = mTreeNodes[nodeIndexSibling];
+
+    // promoted node takes place of A in its parent
+    nodeUp.mParentNodeIndex = nodeA.mParentNodeIndex;
+    nodeA.mParentNodeIndex = nodeIndexUp;
+    if (nodeUp.mParentNodeIndex == NULL_TREE_NODE)
+    {
+        mRootNodeIndex = nodeIndexUp;
+    }
+    else
+    {
+        TreeNode& parentNode = mTreeNodes[nodeUp.mParentNodeIndex];
+        if (parentNode.mLeftNodeIndex == nodeIndexA)
+        {
+            parentNode.mLeftNodeIndex = nodeIndexUp;
+        }
+        else
+        {
+            parentNode.mRightNodeIndex = nodeIndexUp;
+        }
+    }
+
+    const TreeNode& nodeF = mTreeNodes[nodeUp.mLeftNodeIndex];
+    const TreeNode& nodeG = mTreeNodes[nodeUp.mRightNodeIndex];
+    const bool keepLeft = (nodeF.mHeight > nodeG.mHeight);
+    const TreeNodeIndex nodeIndexKeep = keepLeft ? nodeUp.mLeftNodeIndex : nodeUp.mRightNodeIndex;
+    const TreeNodeIndex nodeIndexMove = keepLeft ? nodeUp.mRightNodeIndex : nodeUp.mLeftNodeIndex;
+    TreeNode& nodeKeep = mTreeNodes[nodeIndexKeep];
+    TreeNode& nodeMove = mTreeNodes[nodeIndexMove];
+
+    // A becomes child of promoted node, moved node takes place of promoted node in A
+    nodeUp.mLeftNodeIndex = nodeIndexA;
+    nodeUp.mRightNodeIndex = nodeIndexKeep;
+    if (rotateLeft)
+    {
+        nodeA.mRightNodeIndex = nodeIndexMove;
+    }
+    else
+    {
+        nodeA.mLeftNodeIndex = nodeIndexMove;
+    }
+    nodeMove.mParentNodeIndex = nodeIndexA;
+
+    nodeA.mBoundingBox = nodeSibling.mBoundingBox.union_with(nodeMove.mBoundingBox);
+    nodeA.mHeight = 1 + std::max(nodeSibling.mHeight, nodeMove.mHeight);
+    nodeUp.mBoundingBox = nodeA.mBoundingBox.union_with(nodeKeep.mBoundingBox);
+    nodeUp.mHeight = 1 + std::max(nodeA.mHeight, nodeKeep.mHeight);
+
+    ++mStats.mRotations;
+    return nodeIndexUp;
+}
+
 void AABBTree::DebugRender(DebugRenderer& renderer)
 {
     if (mRootNodeIndex != NULL_TREE_NODE)
@@ -267,6 +460,258 @@ void AABBTree::DebugRender(DebugRenderer& renderer)
     }
 }
 
+void AABBTree::CullObjects(const cxx::frustum_t& cameraFrustum, std::vector<SceneObject*>& outputObjects, CullingStats* stats)
+{
+    if (mRootNodeIndex == NULL_TREE_NODE)
+        return;
+
+    CullSubtree(mRootNodeIndex, cameraFrustum, outputObjects, mCullingStack, stats);
+}
+
+void AABBTree::CullSubtree(TreeNodeIndex subtreeNodeIndex, const cxx::frustum_t& cameraFrustum, std::vector<SceneObject*>& outputObjects,
+    CullingStack& cullingStack, CullingStats* stats)
+{
+    debug_assert(subtreeNodeIndex != NULL_TREE_NODE);
+
+    CullingPlanes planes;
+    planes.mFrustum = &cameraFrustum;
+    for (int iplane = 0; iplane < cxx::NUM_FRUSTUM_PLANES; ++iplane)
+    {
+        for (int ilane = 0; ilane < CullingBatchSize; ++ilane)
+        {
+            set_plane_lane(planes.mPlanes[iplane], planes.mAbsNormals[iplane], ilane, cameraFrustum.mPlanes[iplane]);
+        }
+    }
+
+    CullingStats cullingStats;
+    CullingEntry batchEntries[CullingBatchSize];
+    unsigned int batchMasks[CullingBatchSize];
+
+    cullingStack.clear();
+    cullingStack.push_back({subtreeNodeIndex, CullingAllPlanes});
+    while (!cullingStack.empty())
+    {
+        int batchSize = 0;
+        for (; batchSize < CullingBatchSize && !cullingStack.empty(); ++batchSize)
+        {
+            batchEntries[batchSize] = cullingStack.back();
+            cullingStack.pop_back();
+        }
+
+        ClassifyNodes(planes, batchEntries, batchSize, batchMasks, cullingStats);
+
+        for (int ientry = 0; ientry < batchSize; ++ientry)
+        {
+            if (batchMasks[ientry] == CullingRejected)
+                continue;
+
+            const TreeNodeIndex treeNodeIndex = batchEntries[ientry].mNodeIndex;
+            const TreeNode& treeNode = mTreeNodes[treeNodeIndex];
+            if (treeNode.IsLeafNode())
+            {
+                if (treeNode.mObject)
+                {
+                    outputObjects.push_back(treeNode.mObject);
+                }
+                continue;
+            }
+
+            // subtree is completely inside of frustum
+            if (batchMasks[ientry] == 0)
+            {
+                ++cullingStats.mNodesAccepted;
+                GatherSubtreeObjects(treeNodeIndex, outputObjects);
+                continue;
+            }
+
+            cullingStack.push_back({treeNode.mRightNodeIndex, batchMasks[ientry]});
+            cullingStack.push_back({treeNode.mLeftNodeIndex, batchMasks[ientry]});
+        }
+    }
+
+    if (stats)
+    {
+        *stats = cullingStats;
+    }
+}
+
+void AABBTree::GetSubtrees(int maxSubtrees, std::vector<TreeNodeIndex>& outputSubtrees) const
+{
+    outputSubtrees.clear();
+    if (mRootNodeIndex == NULL_TREE_NODE || maxSubtrees < 1)
+        return;
+
+    // split highest subtree until limit is reached
+    outputSubtrees.push_back(mRootNodeIndex);
+    while ((int) outputSubtrees.size() < maxSubtrees)
+    {
+        int highestSubtree = 0;
+        for (int isubtree = 1; isubtree < (int) outputSubtrees.size(); ++isubtree)
+        {
+            if (mTreeNodes[outputSubtrees[isubtree]].mHeight > mTreeNodes[outputSubtrees[highestSubtree]].mHeight)
+            {
+                highestSubtree = isubtree;
+            }
+        }
+
+        const TreeNode& treeNode = mTreeNodes[outputSubtrees[highestSubtree]];
+        if (treeNode.IsLeafNode())
+            break;
+
+        outputSubtrees[highestSubtree] = treeNode.mLeftNodeIndex;
+        outputSubtrees.push_back(treeNode.mRightNodeIndex);
+    }
+}
+
+void AABBTree::ClassifyNodes(const CullingPlanes& planes, const CullingEntry* entries, int entriesCount, unsigned int* outputMasks, CullingStats& stats)
+{
+    debug_assert(entriesCount > 0 && entriesCount <= CullingBatchSize);
+
+    // gather boxes, unused lanes are duplicates of first one
+    CullingLanes centers;
+    CullingLanes extents;
+    CullingLanes coherentPlanes;
+    CullingLanes coherentAbsNormals;
+    for (int ilane = 0; ilane < CullingBatchSize; ++ilane)
+    {
+        const TreeNode& treeNode = mTreeNodes[entries[ilane < entriesCount ? ilane : 0].mNodeIndex];
+        // leaf is tested with actual object bounds
+        const cxx::aabbox& bounds = treeNode.IsLeafNode() ? treeNode.mObjectBounds : treeNode.mBoundingBox;
+        const glm::vec3 center = (bounds.mMin + bounds.mMax) * 0.5f;
+        const glm::vec3 extent = (bounds.mMax - bounds.mMin) * 0.5f;
+        centers.mX[ilane] = center.x;
+        centers.mY[ilane] = center.y;
+        centers.mZ[ilane] = center.z;
+        extents.mX[ilane] = extent.x;
+        extents.mY[ilane] = extent.y;
+        extents.mZ[ilane] = extent.z;
+        set_plane_lane(coherentPlanes, coherentAbsNormals, ilane, planes.mFrustum->mPlanes[treeNode.mCullPlane]);
+    }
+
+    const unsigned int activeLanes = (1U << entriesCount) - 1;
+    unsigned int rejectedLanes = 0;
+    unsigned int outsideBits = 0;
+    unsigned int insideBits = 0;
+
+    // test plane that rejected node last time first, most nodes stay rejected by same plane between frames
+    classify_boxes(coherentPlanes, coherentAbsNormals, centers, extents, outsideBits, insideBits);
+    rejectedLanes = outsideBits & activeLanes;
+
+    for (int ilane = 0; ilane < entriesCount; ++ilane)
+    {
+        outputMasks[ilane] = entries[ilane].mPlanesMask;
+        if (rejectedLanes & (1U << ilane))
+        {
+            ++stats.mCoherentRejects;
+        }
+    }
+
+    for (int iplane = 0; iplane < cxx::NUM_FRUSTUM_PLANES && rejectedLanes != activeLanes; ++iplane)
+    {
+        // skip plane if all remaining nodes are known to be inside of it
+        const unsigned int planeBit = (1U << iplane);
+        unsigned int testLanes = 0;
+        for (int ilane = 0; ilane < entriesCount; ++ilane)
+        {
+            if (outputMasks[ilane] & planeBit)
+            {
+                testLanes |= (1U << ilane);
+            }
+        }
+        testLanes &= ~rejectedLanes;
+        if (testLanes == 0)
+            continue;
+
+        classify_boxes(planes.mPlanes[iplane], planes.mAbsNormals[iplane], centers, extents, outsideBits, insideBits);
+        outsideBits &= testLanes;
+        insideBits &= testLanes;
+
+        for (int ilane = 0; ilane < entriesCount; ++ilane)
+        {
+            const unsigned int laneBit = (1U << ilane);
+            if (outsideBits & laneBit)
+            {
+                mTreeNodes[entries[ilane].mNodeIndex].mCullPlane = iplane;
+            }
+            if (insideBits & laneBit)
+            {
+                outputMasks[ilane] &= ~planeBit;
+            }
+        }
+        rejectedLanes |= outsideBits;
+    }
+
+    for (int ilane = 0; ilane < entriesCount; ++ilane)
+    {
+        if (rejectedLanes & (1U << ilane))
+        {
+            outputMasks[ilane] = CullingRejected;
+        }
+    }
+    stats.mNodesVisited += entriesCount;
+}
+
+void AABBTree::GatherSubtreeObjects(TreeNodeIndex treeNodeIndex, std::vector<SceneObject*>& outputObjects) const
+{
+    TreeNodeIndex nodesStack[MaxTraversalStack];
+    int stackSize = 0;
+    nodesStack[stackSize++] = treeNodeIndex;
+
+    while (stackSize > 0)
+    {
+        const TreeNode& treeNode = mTreeNodes[nodesStack[--stackSize]];
+        if (treeNode.IsLeafNode())
+        {
+            if (treeNode.mObject)
+            {
+                outputObjects.push_back(treeNode.mObject);
+            }
+            continue;
+        }
+
+        if (stackSize + 2 > MaxTraversalStack)
+        {
+            debug_assert(false);
+            continue;
+        }
+        nodesStack[stackSize++] = treeNode.mRightNodeIndex;
+        nodesStack[stackSize++] = treeNode.mLeftNodeIndex;
+    }
+}
+
+int AABBTree::GetTreeHeight() const
+{
+    if (mRootNodeIndex == NULL_TREE_NODE)
+        return 0;
+
+    return mTreeNodes[mRootNodeIndex].mHeight;
+}
+
+float AABBTree::ComputeSAHCost() const
+{
+    if (mRootNodeIndex == NULL_TREE_NODE)
+        return 0.0f;
+
+    const float rootArea = mTreeNodes[mRootNodeIndex].mBoundingBox.get_surface_area();
+    if (rootArea <= 0.0f)
+        return 0.0f;
+
+    float totalArea = 0.0f;
+    for (const auto& iterator: mObjectsMap)
+    {
+        // walk up from each leaf, internal node is counted once by its left child
+        TreeNodeIndex childIndex = iterator.second;
+        TreeNodeIndex nodeIndex = mTreeNodes[childIndex].mParentNodeIndex;
+        while (nodeIndex != NULL_TREE_NODE && mTreeNodes[nodeIndex].mLeftNodeIndex == childIndex)
+        {
+            totalArea += mTreeNodes[nodeIndex].mBoundingBox.get_surface_area();
+            childIndex = nodeIndex;
+            nodeIndex = mTreeNodes[nodeIndex].mParentNodeIndex;
+        }
+    }
+    return totalArea / rootArea;
+}
+
 void AABBTree::DebugRenderNode(DebugRenderer& renderer, TreeNode& treeNode)
 {
     if (treeNode.IsLeafNode())
@@ -287,7 +732,38 @@ void AABBTree::DebugRenderNode(DebugRenderer& renderer, TreeNode& treeNode)
 
 void AABBTree::UpdateTree()
 {
-    // todo
+    if (mObjectsMap.empty())
+        return;
+
+    std::vector<TreeNodeIndex> leafNodes;
+    leafNodes.reserve(mObjectsMap.size());
+    for (const auto& iterator: mObjectsMap)
+    {
+        leafNodes.push_back(iterator.second);
+    }
+
+    // drop all internal nodes, internal node is deallocated once by its left child
+    for (TreeNodeIndex leafNodeIndex: leafNodes)
+    {
+        TreeNodeIndex childIndex = leafNodeIndex;
+        TreeNodeIndex nodeIndex = mTreeNodes[childIndex].mParentNodeIndex;
+        while (nodeIndex != NULL_TREE_NODE && mTreeNodes[nodeIndex].mLeftNodeIndex == childIndex)
+        {
+            childIndex = nodeIndex;
+            nodeIndex = mTreeNodes[nodeIndex].mParentNodeIndex;
+            DeallocateTreeNode(childIndex);
+        }
+    }
+    mRootNodeIndex = NULL_TREE_NODE;
+
+    // reinsert leaves with bounds tightened to last known object bounds
+    for (TreeNodeIndex leafNodeIndex: leafNodes)
+    {
+        TreeNode& treeNode = mTreeNodes[leafNodeIndex];
+        treeNode.mParentNodeIndex = NULL_TREE_NODE;
+        treeNode.mBoundingBox = ComputeFatBounds(treeNode.mObjectBounds, glm::vec3(0.0f));
+        InsertLeaf(leafNodeIndex);
+    }
 }
 
 void AABBTree::Cleanup()
@@ -297,6 +773,8 @@ void AABBTree::Cleanup()
 
     mRootNodeIndex = NULL_TREE_NODE;
     mNextFreeNodeIndex = 0;
+    mAllocatedCount = 0;
+    mStats = UpdateStats();
     // setup initial nodes
     for (unsigned int inode = 0; inode < mCapacity; ++inode)
     {
@@ -315,7 +793,8 @@ void AABBTree::InsertObject(SceneObject* object)
     AllocateTreeNode(&nodeIndex);
     
     TreeNode& treeNode = mTreeNodes[nodeIndex];
-    treeNode.mBoundingBox = object->mBoundsTransformed;
+    treeNode.mBoundingBox = ComputeFatBounds(object->mBoundsTransformed, glm::vec3(0.0f));
+    treeNode.mObjectBounds = object->mBoundsTransformed;
     treeNode.mObject = object;
 
     InsertLeaf(nodeIndex);
@@ -325,8 +804,14 @@ void AABBTree::InsertObject(SceneObject* object)
 void AABBTree::RemoveObject(SceneObject* object)
 {
     debug_assert(object);
-    TreeNodeIndex nodeIndex = mObjectsMap[object];
-    mObjectsMap.erase(object);
+    auto find_iterator = mObjectsMap.find(object);
+    if (find_iterator == mObjectsMap.end())
+    {
+        debug_assert(false);
+        return;
+    }
+    TreeNodeIndex nodeIndex = find_iterator->second;
+    mObjectsMap.erase(find_iterator);
 
     RemoveLeaf(nodeIndex);
     DeallocateTreeNode(nodeIndex);
@@ -337,6 +822,11 @@ void AABBTree::UpdateObject(SceneObject* object)
     debug_assert(object);
     object->ComputeTransformation();
 
-    TreeNodeIndex nodeIndex = mObjectsMap[object];
-    UpdateLeaf(nodeIndex, object->mBoundsTransformed);
+    auto find_iterator = mObjectsMap.find(object);
+    if (find_iterator == mObjectsMap.end())
+    {
+        debug_assert(false);
+        return;
+    }
+    UpdateLeaf(find_iterator->second, object->mBoundsTransformed);
 }
\ No newline at end of file
@@ -16,6 +16,39 @@ class AABBTree
 {
 public:
     static const int MaxQueryObjects = 16384;
+    static const int MaxTraversalStack = 128; // enough for balanced tree of any practical size
+
+    // tree maintenance statistics, accumulated since cleanup
+    struct UpdateStats
+    {
+    public:
+        int mObjectsUpdated = 0;
+        int mLeavesReinserted = 0; // object moved out of its fat bounds
+        int mRotations = 0;
+    };
+
+    // frustum culling statistics
+    struct CullingStats
+    {
+    public:
+        int mNodesVisited = 0; // nodes tested against frustum planes
+        int mNodesAccepted = 0; // fully visible subtrees, gathered without tests
+        int mCoherentRejects = 0; // nodes rejected by plane that rejected them last time
+    };
+
+    using TreeNodeIndex = unsigned int;
+
+    // pending culling node and frustum planes it is still intersects
+    struct CullingEntry
+    {
+    public:
+        TreeNodeIndex mNodeIndex;
+        unsigned int mPlanesMask;
+    };
+    using CullingStack = std::vector<CullingEntry>;
+
+    // readonly
+    UpdateStats mStats;
 
 public:
     AABBTree(unsigned int initialSize = 1024);
@@ -60,16 +93,45 @@ public:
     template<typename TCallback>
     void QueryObjects(const cxx::frustum_t& cameraFrustum, const TCallback& callback, int maxObjects = MaxQueryObjects) const;
 
-    // Rebuild whole tree
+    // Get all objects that currently visible, planes that node is fully inside are not tested for its subtree,
+    // nodes are tested in batches and remember rejecting plane to test it first next time
+    // @param cameraFrustum: Camera frustum
+    // @param outputObjects: Visible objects will be appended
+    // @param stats: Optional culling statistics
+    void CullObjects(const cxx::frustum_t& cameraFrustum, std::vector<SceneObject*>& outputObjects, CullingStats* stats = nullptr);
+
+    // Same as CullObjects but processes only specified subtree,
+    // could be called concurrently for different subtrees with separate culling stacks
+    // @param subtreeNodeIndex: Root node of subtree
+    // @param cullingStack: Temporary storage
+    void CullSubtree(TreeNodeIndex subtreeNodeIndex, const cxx::frustum_t& cameraFrustum, std::vector<SceneObject*>& outputObjects, 
+        CullingStack& cullingStack, CullingStats* stats = nullptr);
+
+    // Split tree into disjoint subtrees of similar height for parallel processing
+    // @param maxSubtrees: Max number of subtrees
+    // @param outputSubtrees: Root nodes of subtrees
+    void GetSubtrees(int maxSubtrees, std::vector<TreeNodeIndex>& outputSubtrees) const;
+
+    // Rebuild whole tree from current objects bounds
     void UpdateTree();
 
     // Destroy all internal nodes and reset state
     void Cleanup();
 
+    // Get number of objects in tree
+    inline int GetObjectsCount() const { return (int) mObjectsMap.size(); }
+
+    // Get longest path from root to leaf, 0 if tree is empty or has single leaf
+    int GetTreeHeight() const;
+
+    // Compute surface area heuristic cost of tree - sum of internal nodes areas relative to root area,
+    // lower is better
+    float ComputeSAHCost() const;
+
 private:
 
-    using TreeNodeIndex = unsigned int;
     struct TreeNode;
+    struct CullingPlanes;
 
     // internals
     void AllocateTreeNode(TreeNodeIndex* treeNodeIndex);
@@ -79,8 +141,24 @@ private:
     void UpdateLeaf(TreeNodeIndex treeNodeIndex, const cxx::aabbox& boundingBox);
     void FixUpwardsTree(TreeNodeIndex treeNodeIndex);
 
-    template<typename TCallback>
-    void QueryObjectsRecursive(const TreeNode* exploreNode, const cxx::frustum_t& cameraFrustum, const TCallback& callback, int& maxObjects) const;
+    // rotate subtree if its children heights differ by more than one
+    // @returns index of new subtree root
+    TreeNodeIndex BalanceNode(TreeNodeIndex treeNodeIndex);
+
+    // compute leaf bounds enlarged by margin and predicted movement
+    // @param boundingBox: Object bounds
+    // @param displacement: Object movement since last update
+    cxx::aabbox ComputeFatBounds(const cxx::aabbox& boundingBox, const glm::vec3& displacement) const;
+
+    // iterative depth-first traversal of tree nodes
+    // @param nodeTest: Returns true if bounding box passes query
+    template<typename TNodeTest, typename TCallback>
+    void QueryObjectsImpl(const TNodeTest& nodeTest, const TCallback& callback, int maxObjects) const;
+
+    // test batch of nodes against frustum planes
+    // @param outputMasks: Receives planes that node is still intersects or CullingRejected
+    void ClassifyNodes(const CullingPlanes& planes, const CullingEntry* entries, int entriesCount, unsigned int* outputMasks, CullingStats& stats);
+    void GatherSubtreeObjects(TreeNodeIndex treeNodeIndex, std::vector<SceneObject*>& outputObjects) const;
 
     void DebugRenderNode(DebugRenderer& renderer, TreeNode& treeNode);
 
@@ -100,23 +178,29 @@ private:
             , mLeftNodeIndex(NULL_TREE_NODE)
             , mRightNodeIndex(NULL_TREE_NODE)
             , mNextNodeIndex(NULL_TREE_NODE)
+            , mHeight()
+            , mCullPlane()
         {}
 
         // test is tree node is leaf
         inline bool IsLeafNode() const { return mLeftNodeIndex == NULL_TREE_NODE; }
 
     public:
-        cxx::aabbox mBoundingBox; // world space aabb
+        cxx::aabbox mBoundingBox; // world space aabb, fattened for leaf nodes
+        cxx::aabbox mObjectBounds; // leaf only, object bounds at last update
         SceneObject* mObject;
         TreeNodeIndex mParentNodeIndex;
         TreeNodeIndex mLeftNodeIndex;
         TreeNodeIndex mRightNodeIndex;
         TreeNodeIndex mNextNodeIndex;
+        int mHeight; // leaf is 0
+        int mCullPlane; // frustum plane that rejected node last time
     };
     //////////////////////////////////////////////////////////////////////////
 
     std::unordered_map<SceneObject*, TreeNodeIndex> mObjectsMap;
     std::vector<TreeNode> mTreeNodes;
+    CullingStack mCullingStack;
     TreeNodeIndex mRootNodeIndex;
     TreeNodeIndex mNextFreeNodeIndex;
     unsigned int mAllocatedCount;
@@ -1,33 +1,41 @@
 #pragma once
 
-template<typename TCallback>
-inline void AABBTree::QueryObjectsRecursive(const TreeNode* node, const cxx::frustum_t& cameraFrustum, const TCallback& callback, int& maxObjects) const
+template<typename TNodeTest, typename TCallback>
+inline void AABBTree::QueryObjectsImpl(const TNodeTest& nodeTest, const TCallback& callback, int maxObjects) const
 {
-    // see limits
-    if (maxObjects < 1 || !cameraFrustum.contains(node->mBoundingBox))
+    if (mRootNodeIndex == NULL_TREE_NODE || maxObjects < 1)
         return;
 
-    // found leaf node
-    if (node->IsLeafNode())
+    TreeNodeIndex nodesStack[MaxTraversalStack];
+    int stackSize = 0;
+    nodesStack[stackSize++] = mRootNodeIndex;
+
+    while (stackSize > 0)
     {
-        if (node->mObject)
+        const TreeNode& node = mTreeNodes[nodesStack[--stackSize]];
+
+        // found leaf node, test actual object bounds instead of fattened
+        if (node.IsLeafNode())
         {
-            callback(node->mObject);
-            maxObjects--;
+            if (node.mObject && nodeTest(node.mObjectBounds))
+            {
+                callback(node.mObject);
+                if (--maxObjects < 1)
+                    return;
+            }
+            continue;
         }
-        return;
-    }
 
-    if (node->mLeftNodeIndex != NULL_TREE_NODE)
-    {
-        const TreeNode* leftNode = &mTreeNodes[node->mLeftNodeIndex];
-        QueryObjectsRecursive(leftNode, cameraFrustum, callback, maxObjects);
-    }
+        if (!nodeTest(node.mBoundingBox))
+            continue;
 
-    if (node->mRightNodeIndex != NULL_TREE_NODE)
-    {
-        const TreeNode* rightNode = &mTreeNodes[node->mRightNodeIndex];
-        QueryObjectsRecursive(rightNode, cameraFrustum, callback, maxObjects);
+        if (stackSize + 2 > MaxTraversalStack)
+        {
+            debug_assert(false);
+            continue;
+        }
+        nodesStack[stackSize++] = node.mRightNodeIndex;
+        nodesStack[stackSize++] = node.mLeftNodeIndex;
     }
 }
 
@@ -36,28 +44,41 @@ inline void AABBTree::QueryObjectsRecursive(const TreeNode* node, const cxx::fru
 template<typename TCallback>
 inline void AABBTree::QueryObjects(const cxx::aabbox& aabbox, const TCallback& callback, int maxObjects) const
 {
-    // todo
+    QueryObjectsImpl([&aabbox](const cxx::aabbox& nodeBounds)
+        {
+            return cxx::intersects(nodeBounds, aabbox);
+        },
+        callback, maxObjects);
 }
 
 template<typename TCallback>
 inline void AABBTree::QueryObjects(const cxx::bounding_sphere& sphere, const TCallback& callback, int maxObjects) const
 {
-    // todo
+    QueryObjectsImpl([&sphere](const cxx::aabbox& nodeBounds)
+        {
+            return cxx::intersects(nodeBounds, sphere);
+        },
+        callback, maxObjects);
 }
 
 template<typename TCallback>
 inline void AABBTree::QueryObjects(const cxx::ray3d& ray, const TCallback& callback, int maxObjects) const
 {
-    // todo
+    QueryObjectsImpl([&ray](const cxx::aabbox& nodeBounds)
+        {
+            float distanceNear;
+            float distanceFar;
+            return cxx::intersects(nodeBounds, ray, distanceNear, distanceFar);
+        },
+        callback, maxObjects);
 }
 
 template<typename TCallback>
 inline void AABBTree::QueryObjects(const cxx::frustum_t& cameraFrustum, const TCallback& callback, int maxObjects) const
 {
-    if (mRootNodeIndex == NULL_TREE_NODE || maxObjects < 1)
-        return;
-
-    // process tree nodes recursive
-    const TreeNode* rootNode = &mTreeNodes[mRootNodeIndex];
-    QueryObjectsRecursive(rootNode, cameraFrustum, callback, maxObjects);
+    QueryObjectsImpl([&cameraFrustum](const cxx::aabbox& nodeBounds)
+        {
+            return cameraFrustum.contains(nodeBounds);
+        },
+        callback, maxObjects);
 }
\ No newline at end of file
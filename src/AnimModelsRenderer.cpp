@@ -9,6 +9,8 @@
 #include "ConsoleVariable.h"
 #include "cvars.h"
 #include "SceneObject.h"
+#include "MeshMaterial.h"
+#include "Console.h"
 
 bool AnimModelsRenderer::Initialize()
 {
@@ -17,12 +19,34 @@ bool AnimModelsRenderer::Initialize()
         debug_assert(false);
     }
 
+    if (gGraphicsDevice.mCaps.mFeatures[eGraphicsDeviceFeature_Instancing])
+    {
+        if (!mMorphAnimInstancedRenderProgram.LoadProgram())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot load instanced animating models program");
+        }
+
+        mInstancesBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices);
+        debug_assert(mInstancesBuffer);
+    }
+
     return true;
 }
 
 void AnimModelsRenderer::Deinit()
 {
     mMorphAnimRenderProgram.FreeProgram();
+    mMorphAnimInstancedRenderProgram.FreeProgram();
+
+    if (mInstancesBuffer)
+    {
+        gGraphicsDevice.DestroyBuffer(mInstancesBuffer);
+        mInstancesBuffer = nullptr;
+    }
+
+    mInstancedDrawQueue.clear();
+    mInstancesData.clear();
+
     for (auto& curr_iterator : mModelsCache)
     {
         ReleaseRenderdata(&curr_iterator.second);
@@ -45,27 +69,82 @@ void AnimModelsRenderer::Render(SceneRenderContext& renderContext, RenderableMod
         return;
     }
 
+    // vertex format was switched, component refers to destroyed buffers
+    if (mCompactVertices != gCvarRender_CompactVertices.mValue)
+    {
+        RebuildModelsCache();
+    }
+
+    if (component->mRenderdataGeneration != mModelsCacheGeneration)
+    {
+        PrepareRenderdata(component);
+    }
+
     if (component->mVertexBuffer == nullptr || component->mIndexBuffer == nullptr)
     {
         debug_assert(false);
         return;
     }
 
-    mMorphAnimRenderProgram.SetViewProjectionMatrix(gRenderScene.mCamera.mViewProjectionMatrix);
-    mMorphAnimRenderProgram.SetModelMatrix(component->mTransformation);
-
+    // level of details is selected once per frame on first pass model drawn in
+    if (renderContext.mCurrentPass == eRenderPass_Opaque || !component->HasOpaqueMeshParts())
+    {
+        int lod = SelectLOD(component);
+        if (lod != component->mCurrentLOD)
+        {
+            SetupDrawPartsLOD(component, lod);
+        }
+
+        if (component->mCurrentLOD < MaxStatsLODs)
+        {
+            ++mFrameStats.mModelsCount[component->mCurrentLOD];
+            for (const RenderableModel::DrawPart& currMeshPart: component->mDrawParts)
+            {
+                mFrameStats.mTrianglesCount[component->mCurrentLOD] += currMeshPart.mTriangleCount;
+            }
+        }
+    }
+
     float mixFrames = component->mAnimState.mMixFrames;
     if (!gCvarRender_EnableAnimBlendFrames.mValue)
     {
         mixFrames = 0.0f;
     }
+
+    // opaque parts are collected and drawn later in batches
+    if (renderContext.mCurrentPass == eRenderPass_Opaque && IsInstancingEnabled())
+    {
+        for (size_t icurrSubset = 0, Count = modelAsset->mMeshArray.size(); 
+            icurrSubset < Count; ++icurrSubset)
+        {
+            const ModelAsset::SubMesh& currentSubMesh = modelAsset->mMeshArray[icurrSubset];
+
+            MeshMaterial* meshMaterial = component->GetMeshMaterial(currentSubMesh.mMaterialIndex);
+            if (meshMaterial->IsTransparent() || component->mDrawParts[icurrSubset].mTriangleCount == 0)
+                continue;
+
+            InstancedDrawEntry drawEntry;
+            drawEntry.mComponent = component;
+            drawEntry.mMaterial = meshMaterial;
+            drawEntry.mSubsetIndex = (int) icurrSubset;
+            drawEntry.mLOD = component->mCurrentLOD;
+            drawEntry.mFrame0 = component->mAnimState.mFrame0;
+            drawEntry.mFrame1 = component->mAnimState.mFrame1;
+            drawEntry.mMixFrames = mixFrames;
+            mInstancedDrawQueue.push_back(drawEntry);
+        }
+        return;
+    }
+
+    mMorphAnimRenderProgram.SetViewProjectionMatrix(gRenderScene.mCamera.mViewProjectionMatrix);
+    mMorphAnimRenderProgram.SetModelMatrix(component->mCompactVertices ? 
+        (component->mTransformation * component->mDequantizeMatrix) : component->mTransformation);
     mMorphAnimRenderProgram.SetMixFrames(mixFrames);
     mMorphAnimRenderProgram.ActivateProgram();
 
     // bind indices
     gGraphicsDevice.BindIndexBuffer(component->mIndexBuffer);
 
-    Vertex3D_Anim_Format vertexDefs;
     for (size_t icurrSubset = 0, Count = modelAsset->mMeshArray.size(); 
         icurrSubset < Count; ++icurrSubset)
     {
@@ -79,21 +158,236 @@ void AnimModelsRenderer::Render(SceneRenderContext& renderContext, RenderableMod
         if (renderContext.mCurrentPass == eRenderPass_Opaque && meshMaterial->IsTransparent())
             continue;
 
+        RenderableModel::DrawPart& currMeshPart = component->mDrawParts[icurrSubset];
+        if (currMeshPart.mTriangleCount == 0)
+            continue;
+
         meshMaterial->ActivateMaterial();
 
         int frame0 = component->mAnimState.mFrame0;
         int frame1 = component->mAnimState.mFrame1;
 
-        RenderableModel::DrawPart& currMeshPart = component->mDrawParts[icurrSubset];
-
         // prepare vertex streams definition
-        vertexDefs.Setup(currMeshPart.mVertexDataOffset, currentSubMesh.mFrameVerticesCount, modelAsset->mFramesCount, frame0, frame1);
-        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, vertexDefs);
-        gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32,
+        BindFramesVertexBuffer(component, (int) icurrSubset, frame0, frame1);
+        gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, component->mIndicesType,
             currMeshPart.mIndexDataOffset, currMeshPart.mTriangleCount * 3);
     }
 }
 
+void AnimModelsRenderer::RenderFrameBegin()
+{
+    mPrevFrameStats = mFrameStats;
+    mFrameStats = FrameStats();
+}
+
+void AnimModelsRenderer::RenderInstancedBatches(SceneRenderContext& renderContext)
+{
+    if (mInstancedDrawQueue.empty())
+        return;
+
+    // group submeshes sharing geometry, material and animation frames
+    std::sort(mInstancedDrawQueue.begin(), mInstancedDrawQueue.end(), CompareBatches);
+
+    // upload per instance data of all batches at once
+    const int NumInstances = (int) mInstancedDrawQueue.size();
+    mInstancesData.resize(NumInstances);
+    for (int iinstance = 0; iinstance < NumInstances; ++iinstance)
+    {
+        const InstancedDrawEntry& drawEntry = mInstancedDrawQueue[iinstance];
+        const RenderableModel* component = drawEntry.mComponent;
+        mInstancesData[iinstance].mTransformation = component->mCompactVertices ? 
+            (component->mTransformation * component->mDequantizeMatrix) : component->mTransformation;
+        mInstancesData[iinstance].mMixFrames = drawEntry.mMixFrames;
+    }
+
+    // buffer storage is reallocated only when instances count exceeds largest seen so far
+    const unsigned int InstancesDataLength = NumInstances * Sizeof_Vertex3D_AnimInstance;
+    if (InstancesDataLength > mInstancesBuffer->mBufferCapacity)
+    {
+        const unsigned int NewBufferLength = std::max(InstancesDataLength, mInstancesBuffer->mBufferCapacity * 2);
+        if (!mInstancesBuffer->Setup(eBufferUsage_Stream, NewBufferLength, nullptr))
+        {
+            debug_assert(false);
+            mInstancedDrawQueue.clear();
+            return;
+        }
+    }
+
+    bool isInstancesUploaded = false;
+    if (void* bufferData = mInstancesBuffer->Lock(BufferAccess_Write | BufferAccess_InvalidateBuffer, 0, InstancesDataLength))
+    {
+        ::memcpy(bufferData, mInstancesData.data(), InstancesDataLength);
+        isInstancesUploaded = mInstancesBuffer->Unlock();
+    }
+
+    if (!isInstancesUploaded)
+    {
+        debug_assert(false);
+        mInstancedDrawQueue.clear();
+        return;
+    }
+
+    mMorphAnimInstancedRenderProgram.SetViewProjectionMatrix(gRenderScene.mCamera.mViewProjectionMatrix);
+    mMorphAnimInstancedRenderProgram.ActivateProgram();
+
+    Vertex3D_AnimInstance_Format instanceDefs;
+    for (int ibatchStart = 0; ibatchStart < NumInstances; )
+    {
+        const InstancedDrawEntry& drawEntry = mInstancedDrawQueue[ibatchStart];
+
+        int ibatchEnd = ibatchStart + 1;
+        for (; ibatchEnd < NumInstances; ++ibatchEnd)
+        {
+            if (!IsSameBatch(drawEntry, mInstancedDrawQueue[ibatchEnd]))
+                break;
+        }
+
+        RenderableModel* component = drawEntry.mComponent;
+        RenderableModel::DrawPart& currMeshPart = component->mDrawParts[drawEntry.mSubsetIndex];
+
+        drawEntry.mMaterial->ActivateMaterial();
+
+        gGraphicsDevice.BindIndexBuffer(component->mIndexBuffer);
+
+        // per vertex stream
+        BindFramesVertexBuffer(component, drawEntry.mSubsetIndex, drawEntry.mFrame0, drawEntry.mFrame1);
+
+        // per instance stream
+        instanceDefs.mBaseOffset = ibatchStart * Sizeof_Vertex3D_AnimInstance;
+        gGraphicsDevice.BindVertexBuffer(mInstancesBuffer, instanceDefs);
+
+        gGraphicsDevice.RenderIndexedPrimitivesInstanced(ePrimitiveType_Triangles, component->mIndicesType,
+            currMeshPart.mIndexDataOffset, currMeshPart.mTriangleCount * 3, ibatchEnd - ibatchStart);
+
+        ibatchStart = ibatchEnd;
+    }
+
+    mInstancedDrawQueue.clear();
+}
+
+bool AnimModelsRenderer::IsInstancingEnabled() const
+{
+    return gCvarRender_InstancedModels.mValue && mInstancesBuffer && mMorphAnimInstancedRenderProgram.IsProgramLoaded();
+}
+
+bool AnimModelsRenderer::IsSameBatch(const InstancedDrawEntry& lhs, const InstancedDrawEntry& rhs)
+{
+    return lhs.mComponent->mModelAsset == rhs.mComponent->mModelAsset && 
+        lhs.mSubsetIndex == rhs.mSubsetIndex && 
+        lhs.mLOD == rhs.mLOD && 
+        lhs.mFrame0 == rhs.mFrame0 && 
+        lhs.mFrame1 == rhs.mFrame1 && 
+        *lhs.mMaterial == *rhs.mMaterial;
+}
+
+bool AnimModelsRenderer::CompareBatches(const InstancedDrawEntry& lhs, const InstancedDrawEntry& rhs)
+{
+    if (lhs.mComponent->mModelAsset != rhs.mComponent->mModelAsset)
+        return lhs.mComponent->mModelAsset < rhs.mComponent->mModelAsset;
+
+    if (lhs.mSubsetIndex != rhs.mSubsetIndex)
+        return lhs.mSubsetIndex < rhs.mSubsetIndex;
+
+    if (lhs.mLOD != rhs.mLOD)
+        return lhs.mLOD < rhs.mLOD;
+
+    if (lhs.mFrame0 != rhs.mFrame0)
+        return lhs.mFrame0 < rhs.mFrame0;
+
+    if (lhs.mFrame1 != rhs.mFrame1)
+        return lhs.mFrame1 < rhs.mFrame1;
+
+    return *lhs.mMaterial < *rhs.mMaterial;
+}
+
+int AnimModelsRenderer::SelectLOD(RenderableModel* component) const
+{
+    ModelAsset* modelAsset = component->mModelAsset;
+    debug_assert(modelAsset);
+
+    // all submeshes share same number of lods
+    const int NumLODs = modelAsset->mMeshArray.empty() ? 0 : (int) modelAsset->mMeshArray[0].mLODsArray.size();
+    if (NumLODs < 2)
+        return 0;
+
+    const int PreferredLOD = glm::clamp(component->mPreferredLOD, 0, NumLODs - 1);
+    if (!gCvarRender_ModelsAutoLOD.mValue || gRenderScene.mCamera.mCurrentMode != eSceneCameraMode_Perspective)
+        return PreferredLOD;
+
+    const cxx::aabbox& bounds = component->mBoundsTransformed;
+    float boundsRadius = glm::length(bounds.mMax - bounds.mMin) * 0.5f;
+    float distanceToCamera = std::sqrt(component->mDistanceToCameraSquared);
+    if (distanceToCamera <= boundsRadius)
+        return PreferredLOD;
+
+    // bounding sphere height relative to screen height
+    float screenSize = (boundsRadius * gRenderScene.mCamera.mProjectionMatrix[1][1]) / distanceToCamera;
+    float hysteresis = glm::clamp(gCvarRender_ModelsLODHysteresis.mValue, 0.0f, 0.9f);
+    float threshold = gCvarRender_ModelsLODScreenSize.mValue;
+
+    int lod = 0;
+    for (; lod < NumLODs - 1; ++lod, threshold *= 0.5f)
+    {
+        // moving back to finer level requires model to grow a bit above threshold and vice versa
+        float switchSize = (component->mCurrentLOD > lod) ? 
+            (threshold * (1.0f + hysteresis)) : 
+            (threshold * (1.0f - hysteresis));
+
+        if (screenSize >= switchSize)
+            break;
+    }
+    return std::max(lod, PreferredLOD);
+}
+
+void AnimModelsRenderer::SetupDrawPartsLOD(RenderableModel* component, int lod)
+{
+    ModelAssetRenderdata* renderdata = GetRenderdata(component->mModelAsset);
+    if (renderdata == nullptr)
+    {
+        debug_assert(false);
+        return;
+    }
+
+    debug_assert(renderdata->mSubsets.size() == component->mDrawParts.size());
+    for (size_t icurrSubset = 0; icurrSubset < renderdata->mSubsets.size(); ++icurrSubset)
+    {
+        const ModelAssetRenderdata::Subset& currSubset = renderdata->mSubsets[icurrSubset];
+        if (currSubset.mSubsetLODs.empty())
+            continue;
+
+        // some lods of submesh might be missing, fallback to finer one
+        int subsetLOD = std::min(lod, (int) currSubset.mSubsetLODs.size() - 1);
+        while (subsetLOD > 0 && currSubset.mSubsetLODs[subsetLOD].mTriangleCount == 0)
+        {
+            --subsetLOD;
+        }
+
+        RenderableModel::DrawPart& currMeshPart = component->mDrawParts[icurrSubset];
+        currMeshPart.mIndexDataOffset = currSubset.mSubsetLODs[subsetLOD].mIndexDataOffset;
+        currMeshPart.mTriangleCount = currSubset.mSubsetLODs[subsetLOD].mTriangleCount;
+    }
+    component->mCurrentLOD = lod;
+}
+
+void AnimModelsRenderer::BindFramesVertexBuffer(RenderableModel* component, int subsetIndex, int frame0, int frame1)
+{
+    const ModelAsset* modelAsset = component->mModelAsset;
+    const ModelAsset::SubMesh& currentSubMesh = modelAsset->mMeshArray[subsetIndex];
+    const RenderableModel::DrawPart& currMeshPart = component->mDrawParts[subsetIndex];
+    if (component->mCompactVertices)
+    {
+        Vertex3D_AnimCompact_Format vertexDefs;
+        vertexDefs.Setup(currMeshPart.mVertexDataOffset, currentSubMesh.mFrameVerticesCount, modelAsset->mFramesCount, frame0, frame1);
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, vertexDefs);
+    }
+    else
+    {
+        Vertex3D_Anim_Format vertexDefs;
+        vertexDefs.Setup(currMeshPart.mVertexDataOffset, currentSubMesh.mFrameVerticesCount, modelAsset->mFramesCount, frame0, frame1);
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, vertexDefs);
+    }
+}
+
 ModelAssetRenderdata* AnimModelsRenderer::GetRenderdata(ModelAsset* modelAsset)
 {
     if (modelAsset == nullptr || !modelAsset->IsModelLoaded())
@@ -113,6 +407,18 @@ ModelAssetRenderdata* AnimModelsRenderer::GetRenderdata(ModelAsset* modelAsset)
     return renderdata;
 }
 
+void AnimModelsRenderer::RebuildModelsCache()
+{
+    mCompactVertices = gCvarRender_CompactVertices.mValue;
+    ++mModelsCacheGeneration;
+
+    for (auto& curr_iterator: mModelsCache)
+    {
+        ReleaseRenderdata(&curr_iterator.second);
+        PrepareRenderdata(&curr_iterator.second, curr_iterator.first);
+    }
+}
+
 void AnimModelsRenderer::InvalidateRenderData(ModelAsset* modelAsset)
 {
     if (modelAsset == nullptr || !modelAsset->IsModelLoaded())
@@ -134,10 +440,13 @@ void AnimModelsRenderer::ReleaseRenderdata(ModelAssetRenderdata* renderdata)
     debug_assert(renderdata);
     if (renderdata->mVertexBuffer)
     {
+        mGeometryStats.mVertexBytes -= renderdata->mVertexBuffer->mBufferCapacity;
+        --mGeometryStats.mMeshesCount;
         gGraphicsDevice.DestroyBuffer(renderdata->mVertexBuffer);
     }
     if (renderdata->mIndexBuffer)
     {
+        mGeometryStats.mIndexBytes -= renderdata->mIndexBuffer->mBufferCapacity;
         gGraphicsDevice.DestroyBuffer(renderdata->mIndexBuffer);
     }
     renderdata->Clear();
@@ -168,13 +477,57 @@ void AnimModelsRenderer::PrepareRenderdata(ModelAssetRenderdata* renderdata, Mod
         }
     }
 
-    int vbufferLengthBytes = (numVerticesPerFrame * modelAsset->mFramesCount * (sizeof(glm::vec3) + sizeof(glm::vec3))) +
-        (numVerticesPerFrame * sizeof(glm::vec2));
+    // choose vertex format, positions of all frames are quantized within common bounds
+    renderdata->mCompactVertices = mCompactVertices;
+    renderdata->mIndicesType = eIndicesType_i32;
+
+    cxx::aabbox quantizeBounds;
+    if (renderdata->mCompactVertices)
+    {
+        glm::vec3 minPosition (std::numeric_limits<float>::max());
+        glm::vec3 maxPosition (-std::numeric_limits<float>::max());
+        bool shortIndices = true;
+        for (const ModelAsset::SubMesh& currentSubMesh: modelAsset->mMeshArray)
+        {
+            for (const glm::vec3& currPosition: currentSubMesh.mVertexPositionArray)
+            {
+                minPosition = glm::min(minPosition, currPosition);
+                maxPosition = glm::max(maxPosition, currPosition);
+            }
+            // indices are relative to submesh
+            shortIndices = shortIndices && (currentSubMesh.mFrameVerticesCount <= 0xFFFF);
+        }
+        quantizeBounds = cxx::aabbox(minPosition, maxPosition);
+        renderdata->mDequantizeMatrix = GetDequantizeMatrix(quantizeBounds);
+        if (shortIndices)
+        {
+            renderdata->mIndicesType = eIndicesType_i16;
+        }
+    }
+
+    int vbufferLengthBytes = 0;
+    if (renderdata->mCompactVertices)
+    {
+        vbufferLengthBytes = (numVerticesPerFrame * modelAsset->mFramesCount * 
+            (Vertex3D_AnimCompact_Format::Sizeof_Position + Vertex3D_AnimCompact_Format::Sizeof_Normal)) +
+            (numVerticesPerFrame * Vertex3D_AnimCompact_Format::Sizeof_Texcoord);
+    }
+    else
+    {
+        vbufferLengthBytes = (numVerticesPerFrame * modelAsset->mFramesCount * (sizeof(glm::vec3) + sizeof(glm::vec3))) +
+            (numVerticesPerFrame * sizeof(glm::vec2));
+    }
 
     debug_assert(vbufferLengthBytes > 0);
 
     renderdata->mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Static, vbufferLengthBytes, nullptr);
     debug_assert(renderdata->mVertexBuffer);
+    if (renderdata->mVertexBuffer)
+    {
+        mGeometryStats.mVertexBytes += renderdata->mVertexBuffer->mBufferCapacity;
+        mGeometryStats.mUploadedBytes += vbufferLengthBytes;
+        ++mGeometryStats.mMeshesCount;
+    }
 
     // upload vertex attributes
     unsigned char* vbufferptr = (unsigned char*)renderdata->mVertexBuffer->Lock(BufferAccess_UnsynchronizedWrite);
@@ -196,6 +549,25 @@ void AnimModelsRenderer::PrepareRenderdata(ModelAssetRenderdata* renderdata, Mod
             ::memcpy(vbufferptr + currentBufferOffset, currentSubMesh.mVertexTexCoordArray.data(), texcoordsDataLength);
             currentBufferOffset += texcoordsDataLength;
 
+            if (renderdata->mCompactVertices)
+            {
+                for (const glm::vec3& currPosition: currentSubMesh.mVertexPositionArray)
+                {
+                    short* position = reinterpret_cast<short*>(vbufferptr + currentBufferOffset);
+                    PackPositionSnorm16(currPosition, quantizeBounds, position);
+                    position[3] = PackSnorm16(1.0f);
+                    currentBufferOffset += Vertex3D_AnimCompact_Format::Sizeof_Position;
+                }
+
+                for (const glm::vec3& currNormal: currentSubMesh.mVertexNormalArray)
+                {
+                    short* normal = reinterpret_cast<short*>(vbufferptr + currentBufferOffset);
+                    PackOctahedralNormal(currNormal, normal);
+                    currentBufferOffset += Vertex3D_AnimCompact_Format::Sizeof_Normal;
+                }
+                continue;
+            }
+
             int positionsDataLength = currentSubMesh.mVertexPositionArray.size() * sizeof(glm::vec3);
             ::memcpy(vbufferptr + currentBufferOffset, currentSubMesh.mVertexPositionArray.data(), positionsDataLength);
             currentBufferOffset += positionsDataLength;
@@ -211,11 +583,17 @@ void AnimModelsRenderer::PrepareRenderdata(ModelAssetRenderdata* renderdata, Mod
         }
     } // if
 
-    int ibufferLengthByets = numTriangles * sizeof(glm::ivec3);
+    const int triangleSize = GetIndexSizeBytes(renderdata->mIndicesType) * 3;
+    int ibufferLengthByets = numTriangles * triangleSize;
     debug_assert(ibufferLengthByets > 0);
 
     renderdata->mIndexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Indices, eBufferUsage_Static, ibufferLengthByets, nullptr);
     debug_assert(renderdata->mIndexBuffer);
+    if (renderdata->mIndexBuffer)
+    {
+        mGeometryStats.mIndexBytes += renderdata->mIndexBuffer->mBufferCapacity;
+        mGeometryStats.mUploadedBytes += ibufferLengthByets;
+    }
 
     // upload index data
     unsigned char* ibufferptr = (unsigned char*)renderdata->mIndexBuffer->Lock(BufferAccess_UnsynchronizedWrite);
@@ -231,11 +609,25 @@ void AnimModelsRenderer::PrepareRenderdata(ModelAssetRenderdata* renderdata, Mod
             {
                 ModelAsset::SubMeshLOD& currentLOD = currentSubMesh.mLODsArray[icurrLOD];
                 renderdata->mSubsets[icurrSubset].mSubsetLODs[icurrLOD].mIndexDataOffset = currentBufferOffset;
-                int currentLODDataLength = currentLOD.mTriangleArray.size() * sizeof(glm::ivec3);
+                renderdata->mSubsets[icurrSubset].mSubsetLODs[icurrLOD].mTriangleCount = (int) currentLOD.mTriangleArray.size();
+                int currentLODDataLength = currentLOD.mTriangleArray.size() * triangleSize;
                 if (currentLODDataLength < 1)
                     continue;
 
-                ::memcpy(ibufferptr + currentBufferOffset, currentLOD.mTriangleArray.data(), currentLODDataLength);
+                if (renderdata->mIndicesType == eIndicesType_i16)
+                {
+                    unsigned short* indices = reinterpret_cast<unsigned short*>(ibufferptr + currentBufferOffset);
+                    for (const glm::ivec3& currTriangle: currentLOD.mTriangleArray)
+                    {
+                        *indices++ = (unsigned short) currTriangle.x;
+                        *indices++ = (unsigned short) currTriangle.y;
+                        *indices++ = (unsigned short) currTriangle.z;
+                    }
+                }
+                else
+                {
+                    ::memcpy(ibufferptr + currentBufferOffset, currentLOD.mTriangleArray.data(), currentLODDataLength);
+                }
                 currentBufferOffset += currentLODDataLength;
             }
         }
@@ -280,7 +672,12 @@ void AnimModelsRenderer::PrepareRenderdata(RenderableModel* component)
 
     component->mIndexBuffer = renderdata->mIndexBuffer;
     component->mVertexBuffer = renderdata->mVertexBuffer;
+    component->mDequantizeMatrix = renderdata->mDequantizeMatrix;
+    component->mIndicesType = renderdata->mIndicesType;
+    component->mCompactVertices = renderdata->mCompactVertices;
+    component->mRenderdataGeneration = mModelsCacheGeneration;
     component->mRenderProgram = &mMorphAnimRenderProgram;
+    component->mCurrentLOD = 0;
 }
 
 void AnimModelsRenderer::ReleaseRenderdata(RenderableModel* component)
@@ -7,6 +7,21 @@ class AnimModelsRenderer: public cxx::noncopyable
 {
     friend class RenderableModel;
 
+public:
+    static const int MaxStatsLODs = 4;
+
+    // per frame rendering statistics
+    struct FrameStats
+    {
+    public:
+        int mModelsCount[MaxStatsLODs] = {}; // rendered models per level of details
+        int mTrianglesCount[MaxStatsLODs] = {}; // rendered triangles per level of details
+    };
+
+    // readonly
+    FrameStats mPrevFrameStats;
+    RenderGeometryStats mGeometryStats;
+
 public:
     // setup renderer internal resources
     bool Initialize();
@@ -17,6 +32,13 @@ public:
     // @param component: Renderable component
     void Render(SceneRenderContext& renderContext, RenderableModel* component);
 
+    // reset per frame statistics, should be called before scene rendering
+    void RenderFrameBegin();
+
+    // draw all models queued for instanced rendering during current render pass
+    // @param renderContext: Current render context
+    void RenderInstancedBatches(SceneRenderContext& renderContext);
+
     // recreate renderdata for specific model asset
     // @param modelAsset: Model data
     void InvalidateRenderData(ModelAsset* modelAsset);
@@ -33,7 +55,50 @@ private:
     void PrepareRenderdata(ModelAssetRenderdata* renderdata, ModelAsset* modelAsset);
     void ReleaseRenderdata(ModelAssetRenderdata* renderdata);
 
+    // test whether models could be drawn with hardware instancing
+    bool IsInstancingEnabled() const;
+
+    // choose level of details depending on projected size of model bounds
+    // @param component: Renderable component, must have model asset
+    int SelectLOD(RenderableModel* component) const;
+
+    // switch component draw parts to specific level of details geometry
+    void SetupDrawPartsLOD(RenderableModel* component, int lod);
+
+    // bind vertex attributes of submesh animation frames
+    void BindFramesVertexBuffer(RenderableModel* component, int subsetIndex, int frame0, int frame1);
+
+    // recreate all cached renderdata with current vertex format
+    void RebuildModelsCache();
+
+private:
+    // submesh of model queued for instanced rendering
+    struct InstancedDrawEntry
+    {
+    public:
+        RenderableModel* mComponent = nullptr;
+        MeshMaterial* mMaterial = nullptr;
+        int mSubsetIndex = 0;
+        int mLOD = 0;
+        int mFrame0 = 0;
+        int mFrame1 = 0;
+        float mMixFrames = 0.0f;
+    };
+
+    // test whether two entries could be drawn within single instanced batch
+    static bool IsSameBatch(const InstancedDrawEntry& lhs, const InstancedDrawEntry& rhs);
+    static bool CompareBatches(const InstancedDrawEntry& lhs, const InstancedDrawEntry& rhs);
+
 private:
     MorphAnimRenderProgram mMorphAnimRenderProgram;
+    MorphAnimInstancedRenderProgram mMorphAnimInstancedRenderProgram;
     std::map<ModelAsset*, ModelAssetRenderdata> mModelsCache;
+    unsigned int mModelsCacheGeneration = 0; // incremented when all cached renderdata is recreated
+    bool mCompactVertices = false; // vertex format of cached renderdata
+
+    std::vector<InstancedDrawEntry> mInstancedDrawQueue;
+    std::vector<Vertex3D_AnimInstance> mInstancesData;
+    GpuBuffer* mInstancesBuffer = nullptr;
+
+    FrameStats mFrameStats;
 };
\ No newline at end of file
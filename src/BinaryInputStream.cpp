@@ -1,6 +1,9 @@
 #include "pch.h"
 #include "BinaryInputStream.h"
 
+// size of file stream read ahead buffer
+const long FileReadAheadBufferSize = 64 * 1024;
+
 FileInputStream::~FileInputStream()
 {
     CloseFileStream();
@@ -14,6 +17,9 @@ bool FileInputStream::OpenFileStream(const std::string& filePath)
     if (mFileStream == nullptr)
         return false;
 
+    // stream does own buffering
+    ::setvbuf(mFileStream, nullptr, _IONBF, 0);
+
     mFileLength = cxx::get_filesize(mFileStream);
     return true;
 }
@@ -27,6 +33,9 @@ void FileInputStream::CloseFileStream()
     }
     mFileLength = 0;
     mFileCursor = 0;
+    mBuffer.clear();
+    mBufferStart = 0;
+    mBufferLength = 0;
 }
 
 long FileInputStream::GetCursorPosition() const
@@ -34,7 +43,7 @@ long FileInputStream::GetCursorPosition() const
     debug_assert(mFileStream);
     if (mFileStream)
     {
-        return cxx::get_filepos(mFileStream);
+        return mFileCursor;
     }
     return 0;
 }
@@ -42,9 +51,10 @@ long FileInputStream::GetCursorPosition() const
 bool FileInputStream::SetCursorPosition(long cursorPosition)
 {
     debug_assert(mFileStream);
-    if (mFileStream)
+    if (mFileStream && cursorPosition >= 0)
     {
-        return cxx::set_filepos(mFileStream, cursorPosition);
+        mFileCursor = cursorPosition;
+        return true;
     }
     return false;
 }
@@ -54,7 +64,7 @@ bool FileInputStream::AdvanceCursorPosition(long advancePosition)
     debug_assert(mFileStream);
     if (mFileStream)
     {
-        return cxx::advance_cursor(mFileStream, advancePosition);
+        return SetCursorPosition(mFileCursor + advancePosition);
     }
     return false;
 }
@@ -63,11 +73,44 @@ long FileInputStream::ReadData(void* dataBuffer, long dataLength)
 {
     debug_assert(mFileStream);
     debug_assert(dataBuffer);
-    if (mFileStream && dataBuffer)
+    if (mFileStream == nullptr || dataBuffer == nullptr)
+        return 0;
+
+    unsigned char* outputCursor = static_cast<unsigned char*>(dataBuffer);
+    long bytesRead = 0;
+    while (bytesRead < dataLength)
     {
-        return ::fread(dataBuffer, 1, dataLength, mFileStream);
+        // copy buffered data
+        const long bufferOffset = mFileCursor - mBufferStart;
+        if (bufferOffset >= 0 && bufferOffset < mBufferLength)
+        {
+            const long copyLength = std::min(dataLength - bytesRead, mBufferLength - bufferOffset);
+            ::memcpy(outputCursor + bytesRead, mBuffer.data() + bufferOffset, copyLength);
+            bytesRead += copyLength;
+            mFileCursor += copyLength;
+            continue;
+        }
+
+        if (mFileCursor >= mFileLength)
+            break;
+
+        // large blocks are read directly
+        const long remainingLength = dataLength - bytesRead;
+        if (remainingLength >= FileReadAheadBufferSize)
+        {
+            if (!cxx::set_filepos(mFileStream, mFileCursor))
+                break;
+
+            const long directLength = (long) ::fread(outputCursor + bytesRead, 1, remainingLength, mFileStream);
+            bytesRead += directLength;
+            mFileCursor += directLength;
+            break;
+        }
+
+        if (!RefillBuffer())
+            break;
     }
-    return 0;
+    return bytesRead;
 }
 
 bool FileInputStream::IsEos() const
@@ -75,7 +118,7 @@ bool FileInputStream::IsEos() const
     debug_assert(mFileStream);
     if (mFileStream)
     {
-        return ::feof(mFileStream) != 0;
+        return mFileCursor >= mFileLength;
     }
     return false;
 }
@@ -85,6 +128,19 @@ long FileInputStream::GetLength() const
     return mFileLength;
 }
 
+bool FileInputStream::RefillBuffer()
+{
+    mBuffer.resize(FileReadAheadBufferSize);
+    mBufferStart = mFileCursor;
+    mBufferLength = 0;
+
+    if (!cxx::set_filepos(mFileStream, mFileCursor))
+        return false;
+
+    mBufferLength = (long) ::fread(mBuffer.data(), 1, FileReadAheadBufferSize, mFileStream);
+    return mBufferLength > 0;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 MemoryInputStream::~MemoryInputStream()
@@ -97,13 +153,26 @@ void MemoryInputStream::OpenMemoryStreamFromBuffer(ByteArray& sourceBuffer)
     CloseMemoryStream();
 
     mStreamData.swap(sourceBuffer);
+    mStreamDataPointer = mStreamData.data();
     mStreamCursor = 0;
     mStreamLength = mStreamData.size();
 }
 
+void MemoryInputStream::OpenMemoryStreamFromView(const unsigned char* sourceData, long sourceLength)
+{
+    debug_assert(sourceData || sourceLength == 0);
+
+    CloseMemoryStream();
+
+    mStreamDataPointer = sourceData;
+    mStreamCursor = 0;
+    mStreamLength = sourceLength;
+}
+
 void MemoryInputStream::CloseMemoryStream()
 {
     mStreamData.clear();
+    mStreamDataPointer = nullptr;
     mStreamCursor = 0;
     mStreamLength = 0;
 }
@@ -134,7 +203,7 @@ long MemoryInputStream::ReadData(void* dataBuffer, long dataLength)
     dataLength = (cursorPos - mStreamCursor);
     if (dataLength > 0)
     {
-        memcpy(dataBuffer, mStreamData.data() + mStreamCursor, dataLength);
+        memcpy(dataBuffer, mStreamDataPointer + mStreamCursor, dataLength);
         mStreamCursor = cursorPos;
     }
     return dataLength;
@@ -25,11 +25,44 @@ public:
 
     // get binary stream size in bytes
     virtual long GetLength() const = 0;
+
+    // read array of plain data elements and advance cursor position
+    // @param elements: Destination elements
+    // @param elementsCount: Number of elements to read
+    // @returns false if not all elements were read
+    template<typename TElement>
+    inline bool ReadElements(TElement* elements, long elementsCount)
+    {
+        static_assert(std::is_trivially_copyable<TElement>::value, "Element type must be trivially copyable");
+        debug_assert(elements || elementsCount == 0);
+
+        const long dataLength = elementsCount * static_cast<long>(sizeof(TElement));
+        return ReadData(elements, dataLength) == dataLength;
+    }
+
+    // read array of plain data elements, previous content of destination container is discarded
+    // @param elements: Destination container
+    // @param elementsCount: Number of elements to read
+    // @returns false if not all elements were read
+    template<typename TElement>
+    inline bool ReadElements(std::vector<TElement>& elements, long elementsCount)
+    {
+        elements.resize(elementsCount);
+        return ReadElements(elements.data(), elementsCount);
+    }
+
+    // read single plain data element and advance cursor position
+    // @param element: Destination element
+    template<typename TElement>
+    inline bool ReadElement(TElement& element)
+    {
+        return ReadElements(&element, 1);
+    }
 };
 
 //////////////////////////////////////////////////////////////////////////
 
-// file stream implementation
+// file stream implementation, data is read ahead into internal buffer
 class FileInputStream: public BinaryInputStream
 {
 public:
@@ -58,10 +91,17 @@ public:
     // get binary stream size in bytes
     long GetLength() const override;
 
+private:
+    // fill read ahead buffer with data starting at current cursor position
+    bool RefillBuffer();
+
 private:
     FILE* mFileStream = nullptr;
     long mFileLength = 0;
-    long mFileCursor = 0;
+    long mFileCursor = 0; // logical cursor position
+    ByteArray mBuffer;
+    long mBufferStart = 0; // file position of first buffered byte
+    long mBufferLength = 0;
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -74,6 +114,11 @@ public:
 
     // setup stream, moves source buffer data into internal buffer (takes ownership)
     void OpenMemoryStreamFromBuffer(ByteArray& sourceBuffer);
+
+    // setup stream over external memory without copying, data must stay valid until stream is closed
+    // @param sourceData: Source data
+    // @param sourceLength: Source data length in bytes
+    void OpenMemoryStreamFromView(const unsigned char* sourceData, long sourceLength);
     void CloseMemoryStream();
 
     // get or set current cursor position within stream
@@ -96,6 +141,7 @@ public:
 
 private:
     ByteArray mStreamData;
+    const unsigned char* mStreamDataPointer = nullptr; // points to own buffer or external memory
     long mStreamLength = 0;
     long mStreamCursor = 0;
 };
\ No newline at end of file
@@ -7,18 +7,57 @@
 
 #define SEND_LOG_TO_STDOUT
 
+//////////////////////////////////////////////////////////////////////////
+
+const int DefaultLogLinesLimit = 4096;
+const int WriterIdleIntervalMs = 5;
+
+//////////////////////////////////////////////////////////////////////////
+
 Console gConsole;
 
+Console::Console()
+    : mMaxLogLines(DefaultLogLinesLimit)
+    , mEnqueuePosition(0)
+    , mDequeuePosition(0)
+    , mDroppedMessagesCount(0)
+    , mWriterRunning(false)
+{
+    for (int irecord = 0; irecord < LogRecordsCount; ++irecord)
+    {
+        mLogRecords[irecord].mSequence.store(irecord, std::memory_order_relaxed);
+    }
+}
+
 bool Console::Initialize()
 {
     RegisterStandardFunctions();
 
     gToolsUIManager.AttachWindow(&gConsoleWindow);
+
+    // start writer thread
+    mWriterShutdownRequested = false;
+    mWriterRunning = true;
+    mWriterThread = std::thread(&Console::WriterThreadProc, this);
     return true;
 }
 
 void Console::Deinit()
 {
+    // stop writer thread, it will process all queued messages before exit
+    if (mWriterThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mWriterMutex);
+            mWriterShutdownRequested = true;
+        }
+        mWriterCondition.notify_one();
+        mWriterThread.join();
+    }
+    mWriterRunning = false;
+    Flush();
+    SetLogFile("");
+
     gToolsUIManager.DetachWindow(&gConsoleWindow);
 
     Clear();
@@ -29,23 +68,161 @@ void Console::Deinit()
 
 void Console::LogMessage(eLogMessage cat, const char* format, ...)
 {
-    static char consoleMessageBuffer[2048];
+    // reserve record in queue
+    unsigned int position = mEnqueuePosition.load(std::memory_order_relaxed);
+    LogRecord* record = nullptr;
+    for (;;)
+    {
+        record = &mLogRecords[position & (LogRecordsCount - 1)];
+        const int sequenceDiff = (int) (record->mSequence.load(std::memory_order_acquire) - position);
+        if (sequenceDiff == 0)
+        {
+            if (mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (sequenceDiff < 0) // queue is full, writer is behind
+        {
+            ++mDroppedMessagesCount;
+            return;
+        }
+        else // other producer took this record
+        {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
 
     {
         va_list vaList { };
         va_start(vaList, format);
-            vsnprintf(consoleMessageBuffer, sizeof(consoleMessageBuffer), format, vaList);
+            vsnprintf(record->mMessageString, sizeof(record->mMessageString), format, vaList);
         va_end(vaList);
     }
+    record->mMessageCategory = cat;
+    record->mSequence.store(position + 1, std::memory_order_release);
+
+    // process immediately if writer thread is not started yet or already stopped
+    if (!mWriterRunning.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(mWriterMutex);
+        ProcessLogRecords();
+    }
+}
+
+void Console::Flush()
+{
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    if (!mWriterRunning)
+    {
+        ProcessLogRecords();
+        return;
+    }
+
+    const unsigned int targetPosition = mEnqueuePosition.load();
+    mWriterFlushRequested = true;
+    mWriterCondition.notify_one();
+    mWriterFlushedCondition.wait(lock, [this, targetPosition]()
+        {
+            return (int) (mDequeuePosition.load() - targetPosition) >= 0;
+        });
+}
+
+bool Console::SetLogFile(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(mWriterMutex);
+    if (mLogFile)
+    {
+        fclose(mLogFile);
+        mLogFile = nullptr;
+    }
+
+    if (filePath.empty())
+        return true;
+
+    mLogFile = fopen(filePath.c_str(), "w");
+    return mLogFile != nullptr;
+}
+
+void Console::WriterThreadProc()
+{
+    std::unique_lock<std::mutex> lock(mWriterMutex);
+    for (bool isIdle = true;;)
+    {
+        // sleep only when there was nothing to write
+        if (isIdle)
+        {
+            mWriterCondition.wait_for(lock, std::chrono::milliseconds(WriterIdleIntervalMs), [this]()
+                {
+                    return mWriterShutdownRequested || mWriterFlushRequested;
+                });
+        }
+
+        isIdle = (ProcessLogRecords() == 0);
+
+        mWriterFlushRequested = false;
+        mWriterFlushedCondition.notify_all();
+        if (mWriterShutdownRequested)
+            break;
+    }
+}
+
+int Console::ProcessLogRecords()
+{
+    int processedCount = 0;
+    for (;;)
+    {
+        const unsigned int position = mDequeuePosition.load(std::memory_order_relaxed);
+        LogRecord& record = mLogRecords[position & (LogRecordsCount - 1)];
+        // queue is empty or message is being formatted
+        if (record.mSequence.load(std::memory_order_acquire) != position + 1)
+            break;
+
+        WriteLogLine(record.mMessageCategory, record.mMessageString);
+
+        // release record for producers
+        record.mSequence.store(position + LogRecordsCount, std::memory_order_release);
+        mDequeuePosition.store(position + 1, std::memory_order_release);
+        ++processedCount;
+    }
+
+    // report lost messages
+    const unsigned int droppedCount = mDroppedMessagesCount.load(std::memory_order_relaxed);
+    if (droppedCount != mReportedDroppedMessagesCount)
+    {
+        char messageBuffer[128];
+        snprintf(messageBuffer, sizeof(messageBuffer), "Log queue overflow, %u messages dropped", droppedCount - mReportedDroppedMessagesCount);
+        WriteLogLine(eLogMessage_Warning, messageBuffer);
+        mReportedDroppedMessagesCount = droppedCount;
+    }
+
+    if (processedCount > 0 && mLogFile)
+    {
+        fflush(mLogFile);
+    }
+    return processedCount;
+}
 
+void Console::WriteLogLine(eLogMessage cat, const char* message)
+{
 #ifdef SEND_LOG_TO_STDOUT 
-    printf("%s\n", consoleMessageBuffer);
+    printf("%s\n", message);
 #endif
 
+    if (mLogFile)
+    {
+        fprintf(mLogFile, "%s\n", message);
+    }
+    ++mWrittenMessagesCount;
+
     LineStruct consoleLine;
         consoleLine.mMessageCategory = cat;
-        consoleLine.mMessageString = consoleMessageBuffer;
+        consoleLine.mMessageString = message;
+
+    std::lock_guard<std::mutex> lock(mLogLinesMutex);
     mLogLines.push_back(std::move(consoleLine));
+    if (mMaxLogLines > 0 && (int) mLogLines.size() > mMaxLogLines)
+    {
+        mLogLines.pop_front();
+    }
 }
 
 void Console::ExecuteCommands(const char* commands)
@@ -176,15 +353,36 @@ void Console::RegisterStandardFunctions()
                 return;
             }
         });
+
+    // log_file
+    RegisterFunction("log_file", "Write log messages to file, empty path closes current file, args: filePath", [](const ConsoleFuncArgs& args)
+        {
+            std::string filePath;
+            args.ParseArgument(0, filePath);
+            if (!gConsole.SetLogFile(filePath))
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot open log file '%s'", filePath.c_str());
+            }
+        });
+
+    // stat_console
+    RegisterFunction("stat_console", "Print log queue counters", [](const ConsoleFuncArgs& args)
+        {
+            gConsole.Flush();
+            gConsole.LogMessage(eLogMessage_Info, "Log queue: %d records, %u messages written, %u dropped", LogRecordsCount, 
+                gConsole.mWrittenMessagesCount, gConsole.GetDroppedMessagesCount());
+        });
 }
 
 void Console::Clear()
 {
+    std::lock_guard<std::mutex> lock(mLogLinesMutex);
     mLogLines.clear();
 }
 
 void Console::SetLogMessagesLimit(int messagesCount)
 {
+    std::lock_guard<std::mutex> lock(mLogLinesMutex);
     if (messagesCount > 0 && messagesCount != mMaxLogLines)
     {
         int currentLinesCount = (int) mLogLines.size();
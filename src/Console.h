@@ -7,6 +7,12 @@ class Console: public cxx::noncopyable
     friend class ToolsUIConsoleWindow;
 
 public:
+    static const int LogRecordsCount = 2048; // must be power of two
+    static const int LogRecordLength = 1024; // longer messages are truncated
+
+public:
+    Console();
+
     // setup console internal resources, returns false on error
     bool Initialize();
     void Deinit();
@@ -15,11 +21,23 @@ public:
     // @param messagesCount: Max messages in log, 0 disables current limit
     void SetLogMessagesLimit(int messagesCount);
 
-    // send formatted log messages to system console
+    // send formatted log messages to system console, log file and console window
+    // message is processed on writer thread, safe to call from any thread
     // @param cat: Message category
     // @param format: String format
     void LogMessage(eLogMessage cat, const char* format, ...);
 
+    // wait until all queued log messages are written
+    void Flush();
+
+    // start or stop writing log messages to file
+    // @param filePath: Output file path, empty to close current file
+    // @returns false on error
+    bool SetLogFile(const std::string& filePath);
+
+    // get number of log messages lost because log queue was full
+    inline unsigned int GetDroppedMessagesCount() const { return mDroppedMessagesCount; }
+
     // clear all console log messages
     void Clear();
 
@@ -46,6 +64,12 @@ private:
 
     void RegisterStandardFunctions();
 
+    // write queued log messages to outputs, called on writer thread
+    // @returns number of processed messages
+    int ProcessLogRecords();
+    void WriterThreadProc();
+    void WriteLogLine(eLogMessage cat, const char* message);
+
 private:
     struct LineStruct
     {
@@ -53,8 +77,38 @@ private:
         std::string mMessageString;
     };
 
+    // preformatted message, sequence is used to synchronize producers with writer
+    struct LogRecord
+    {
+        std::atomic<unsigned int> mSequence;
+        eLogMessage mMessageCategory;
+        char mMessageString[LogRecordLength];
+    };
+
+    // lines shown in console window, guarded by mutex
     std::deque<LineStruct> mLogLines;
-    int mMaxLogLines = 0; // no limits default
+    std::mutex mLogLinesMutex;
+    int mMaxLogLines;
+
+    // bounded multiple producers queue
+    LogRecord mLogRecords[LogRecordsCount];
+    std::atomic<unsigned int> mEnqueuePosition;
+    std::atomic<unsigned int> mDequeuePosition;
+    std::atomic<unsigned int> mDroppedMessagesCount;
+    unsigned int mReportedDroppedMessagesCount = 0;
+    unsigned int mWrittenMessagesCount = 0;
+
+    // writer thread
+    std::thread mWriterThread;
+    std::mutex mWriterMutex;
+    std::condition_variable mWriterCondition;
+    std::condition_variable mWriterFlushedCondition;
+    std::atomic<bool> mWriterRunning;
+    bool mWriterShutdownRequested = false;
+    bool mWriterFlushRequested = false;
+
+    // file sink, accessed on writer thread under writer mutex
+    FILE* mLogFile = nullptr;
 
     // registered console variables
     std::vector<CVarBase*> mConsoleVariables;
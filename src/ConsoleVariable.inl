@@ -43,6 +43,29 @@ template<>
 class ConsoleValueHandler<float>
 {
 public:
+    static bool ValidateValue(float value)
+    {
+        return std::isfinite(value);
+    }
+    static void SerializeValue(float value, std::string& outputData)
+    {
+        char buffer[32];
+        int length = ::snprintf(buffer, sizeof(buffer), "%g", value);
+        outputData.assign(buffer, length > 0 ? length : 0);
+    }
+    static bool TryLoadValue(float& outputValue, const std::string& inputData)
+    {
+        if (inputData.empty())
+            return false;
+
+        char* parseEnd = nullptr;
+        float value = ::strtof(inputData.c_str(), &parseEnd);
+        if (parseEnd != inputData.c_str() + inputData.length())
+            return false;
+
+        outputValue = value;
+        return true;
+    }
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -51,6 +74,30 @@ template<>
 class ConsoleValueHandler<int>
 {
 public:
+    static bool ValidateValue(int value)
+    {
+        return true;
+    }
+    static void SerializeValue(int value, std::string& outputData)
+    {
+        outputData.assign(std::to_string(value));
+    }
+    static bool TryLoadValue(int& outputValue, const std::string& inputData)
+    {
+        if (inputData.empty())
+            return false;
+
+        char* parseEnd = nullptr;
+        long long value = ::strtoll(inputData.c_str(), &parseEnd, 10);
+        if (parseEnd != inputData.c_str() + inputData.length())
+            return false;
+
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+            return false;
+
+        outputValue = (int) value;
+        return true;
+    }
 };
 
 //////////////////////////////////////////////////////////////////////////
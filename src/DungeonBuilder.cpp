@@ -7,13 +7,22 @@
 #include "GameWorld.h"
 
 void DungeonBuilder::ExtendTileMesh(TerrainTile* terrainTile, eTileFace faceid, ModelAsset* asset, const glm::mat3* rot, const glm::vec3* trans)
+{
+    debug_assert(terrainTile);
+    debug_assert(faceid < eTileFace_COUNT);
+
+    ExtendTileMesh(terrainTile, terrainTile->mFaces[faceid].mMeshArray, faceid, asset, rot, trans);
+}
+
+void DungeonBuilder::ExtendTileMesh(TerrainTile* terrainTile, std::vector<TileMesh>& meshArray, eTileFace faceid, 
+    ModelAsset* asset, const glm::mat3* rot, const glm::vec3* trans)
 {
     debug_assert(terrainTile);
     debug_assert(asset);
     debug_assert(faceid < eTileFace_COUNT);
 
-    // destination geometry
-    TileFaceData& tileFace = terrainTile->mFaces[faceid];
+    // source tile face
+    const TileFaceData& tileFace = terrainTile->mFaces[faceid];
     const glm::vec3 tileTranslation = 
     {
         terrainTile->mTileLocation.x + (trans ? trans->x : 0.0f), trans ? trans->y : 0.0f,
@@ -77,13 +86,13 @@ void DungeonBuilder::ExtendTileMesh(TerrainTile* terrainTile, eTileFace faceid,
         }
 
         // add terrain mesh piece
-        tileFace.mMeshArray.emplace_back();
+        meshArray.emplace_back();
 
-        TileMesh& destMeshGroup = tileFace.mMeshArray.back();
-        destMeshGroup.mMaterial.mDiffuseTexture = gTexturesManager.GetTexture2D(sourceMaterial.mTextures[textureIndex]);
+        TileMesh& destMeshGroup = meshArray.back();
+        destMeshGroup.mMaterial.mDiffuseTexture = GetTexture2D(sourceMaterial.mTextures[textureIndex]);
         if (sourceMaterial.mEnvMappingTexture.length())
         {
-            destMeshGroup.mMaterial.mEnvMappingTexture = gTexturesManager.GetTexture2D(sourceMaterial.mEnvMappingTexture);
+            destMeshGroup.mMaterial.mEnvMappingTexture = GetTexture2D(sourceMaterial.mEnvMappingTexture);
         }
         // force default render states for terrain mesh with disabled alphablending
         destMeshGroup.mMaterial.mRenderStates = RenderStates();     
@@ -139,26 +148,19 @@ void DungeonBuilder::ExtendTileMesh(TerrainTile* terrainTile, eTileFace faceid,
 void DungeonBuilder::BuildTerrainMesh(TerrainTile* terrainTile)
 {
     debug_assert(terrainTile);
-    terrainTile->ClearTileMesh();
-
-    ConstructTerrainFloor(terrainTile);
-
-    TerrainDefinition* terrainDef = terrainTile->GetTerrain();
-    if (terrainDef->mIsSolid)
-    {
-        ConstructTerrainWalls(terrainTile);
-    }
 
-    // todo: ceiling
+    TileMeshStaging staging;
+    BuildTerrainMesh(terrainTile, staging);
+    CommitTerrainMesh(terrainTile, staging);
 }
 
 void DungeonBuilder::BuildTerrainMesh(TerrainTile* terrainTile, eTileFace faceid)
 {
-    terrainTile->ClearTileMesh(faceid);
+    TileMeshStaging staging;
 
     if (faceid == eTileFace_Floor)
     {
-        ConstructTerrainFloor(terrainTile);
+        ConstructTerrainFloor(terrainTile, staging);
     }
 
     // construct wall
@@ -167,22 +169,49 @@ void DungeonBuilder::BuildTerrainMesh(TerrainTile* terrainTile, eTileFace faceid
         TerrainDefinition* terrainDef = terrainTile->GetTerrain();
         if (terrainDef->mIsSolid)
         {
-            ConstructTerrainWall(terrainTile, faceid);
+            ConstructTerrainWall(terrainTile, staging, faceid);
         }
     }
 
     // todo: ceiling
+
+    terrainTile->mFaces[faceid].mMeshArray.swap(staging.mFaces[faceid]);
 }
 
-void DungeonBuilder::ConstructTerrainWalls(TerrainTile* terrainTile)
+void DungeonBuilder::BuildTerrainMesh(TerrainTile* terrainTile, TileMeshStaging& staging)
+{
+    debug_assert(terrainTile);
+    staging.Clear();
+
+    ConstructTerrainFloor(terrainTile, staging);
+
+    TerrainDefinition* terrainDef = terrainTile->GetTerrain();
+    if (terrainDef->mIsSolid)
+    {
+        ConstructTerrainWalls(terrainTile, staging);
+    }
+
+    // todo: ceiling
+}
+
+void DungeonBuilder::CommitTerrainMesh(TerrainTile* terrainTile, TileMeshStaging& staging)
+{
+    debug_assert(terrainTile);
+    for (int iface = 0; iface < eTileFace_COUNT; ++iface)
+    {
+        terrainTile->mFaces[iface].mMeshArray.swap(staging.mFaces[iface]);
+    }
+}
+
+void DungeonBuilder::ConstructTerrainWalls(TerrainTile* terrainTile, TileMeshStaging& staging)
 {
     for (eTileFace faceid: {eTileFace_SideN, eTileFace_SideE, eTileFace_SideS, eTileFace_SideW})
     {
-        ConstructTerrainWall(terrainTile, faceid);
+        ConstructTerrainWall(terrainTile, staging, faceid);
     }
 }
 
-void DungeonBuilder::ConstructTerrainWall(TerrainTile* terrainTile, eTileFace faceid)
+void DungeonBuilder::ConstructTerrainWall(TerrainTile* terrainTile, TileMeshStaging& staging, eTileFace faceid)
 {
     const glm::mat3* rotation = nullptr;
     switch (faceid)
@@ -209,13 +238,13 @@ void DungeonBuilder::ConstructTerrainWall(TerrainTile* terrainTile, eTileFace fa
     // test side wall is required
     if (ShouldBuildSideWall(terrainTile, faceid))
     {
-        ModelAsset* asset = gModelsManager.LoadModelAsset(terrain->mResourceSide.mResourceName);
+        ModelAsset* asset = LoadModelAsset(terrain->mResourceSide.mResourceName);
         debug_assert(asset);
-        ExtendTileMesh(terrainTile, faceid, asset, rotation);
+        ExtendTileMesh(terrainTile, staging.mFaces[faceid], faceid, asset, rotation, nullptr);
     }
 }
 
-void DungeonBuilder::ConstructTerrainFloor(TerrainTile* terrainTile)
+void DungeonBuilder::ConstructTerrainFloor(TerrainTile* terrainTile, TileMeshStaging& staging)
 {
     TerrainDefinition* terrainDef = terrainTile->GetTerrain();
 
@@ -225,7 +254,7 @@ void DungeonBuilder::ConstructTerrainFloor(TerrainTile* terrainTile)
         TerrainDefinition* baseTerrainDef = terrainTile->GetBaseTerrain();
         if (baseTerrainDef->mIsWater || baseTerrainDef->mIsLava)
         {
-            ConstructTerrainWaterBed(terrainTile, terrainTile->GetBaseTerrain()->GetCellResource());
+            ConstructTerrainWaterBed(terrainTile, staging, terrainTile->GetBaseTerrain()->GetCellResource());
         }
         // dont build room floor geometry here
         return;
@@ -238,23 +267,23 @@ void DungeonBuilder::ConstructTerrainFloor(TerrainTile* terrainTile)
     // water bed
     if (terrainDef->mConstructionTypeWater)
     {
-        ConstructTerrainWaterBed(terrainTile, cellResource);
+        ConstructTerrainWaterBed(terrainTile, staging, cellResource);
     }
     // construct terrain quad
     else if (terrainDef->mConstructionTypeQuad)
     {
-        ConstructTerrainQuad(terrainTile, cellResource);
+        ConstructTerrainQuad(terrainTile, staging, cellResource);
     }
     // construct terrain normal
     else
     {
-        ModelAsset* asset = gModelsManager.LoadModelAsset(cellResource->mResourceName);
+        ModelAsset* asset = LoadModelAsset(cellResource->mResourceName);
         debug_assert(asset);
-        ExtendTileMesh(terrainTile, eTileFace_Floor, asset);
+        ExtendTileMesh(terrainTile, staging.mFaces[eTileFace_Floor], eTileFace_Floor, asset, nullptr, nullptr);
     }
 }
 
-void DungeonBuilder::ConstructTerrainQuad(TerrainTile* terrainTile, ArtResource* artResource)
+void DungeonBuilder::ConstructTerrainQuad(TerrainTile* terrainTile, TileMeshStaging& staging, ArtResource* artResource)
 {
     std::string meshName = artResource->mResourceName;
 
@@ -262,8 +291,10 @@ void DungeonBuilder::ConstructTerrainQuad(TerrainTile* terrainTile, ArtResource*
     TerrainDefinition* tileTerrainDef = terrainTile->GetTerrain();
     if (tileTerrainDef->mPlayerColouredPath || tileTerrainDef->mPlayerColouredWall) 
     {
-        const char* suffix = cxx::va("%d_", (terrainTile->mOwnerID == ePlayerID_Null) ? 0 : terrainTile->mOwnerID - 1);
-        meshName.append(suffix);
+        // cxx::va is not thread safe
+        int colourIndex = (terrainTile->mOwnerID == ePlayerID_Null) ? 0 : terrainTile->mOwnerID - 1;
+        meshName.append(std::to_string(colourIndex));
+        meshName.push_back('_');
     }
 
     int subTiles[4];
@@ -323,11 +354,11 @@ void DungeonBuilder::ConstructTerrainQuad(TerrainTile* terrainTile, ArtResource*
     };
 
     // pieces
-    ModelAsset* piece0 = gModelsManager.LoadModelAsset(meshName + "0");
-    ModelAsset* piece1 = gModelsManager.LoadModelAsset(meshName + "1");
-    ModelAsset* piece2 = gModelsManager.LoadModelAsset(meshName + "2");
-    ModelAsset* piece3 = gModelsManager.LoadModelAsset(meshName + "3");
-    ModelAsset* piece4 = gModelsManager.LoadModelAsset(meshName + "4");
+    ModelAsset* piece0 = LoadModelAsset(meshName + "0");
+    ModelAsset* piece1 = LoadModelAsset(meshName + "1");
+    ModelAsset* piece2 = LoadModelAsset(meshName + "2");
+    ModelAsset* piece3 = LoadModelAsset(meshName + "3");
+    ModelAsset* piece4 = LoadModelAsset(meshName + "4");
     ModelAsset* pieces[8] = 
     {
         piece1, piece4, piece1, piece4, // 1, 4, 0, 4
@@ -336,12 +367,14 @@ void DungeonBuilder::ConstructTerrainQuad(TerrainTile* terrainTile, ArtResource*
     
     for (int isubtile = 0; isubtile < 4; ++isubtile)
     {
-        ExtendTileMesh(terrainTile, eTileFace_Floor, pieces[subTiles[isubtile]], rotations[isubtile], &g_SubTileTranslations[isubtile]);
+        ExtendTileMesh(terrainTile, staging.mFaces[eTileFace_Floor], eTileFace_Floor, pieces[subTiles[isubtile]], rotations[isubtile], &g_SubTileTranslations[isubtile]);
     }
 }
 
-void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResource* artResource)
+void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, TileMeshStaging& staging, ArtResource* artResource)
 {
+    std::vector<TileMesh>& floorMeshArray = staging.mFaces[eTileFace_Floor];
+
     const glm::mat3* rotations[] =
     {
         &g_TileRotations[0],
@@ -376,15 +409,15 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
     const unsigned char cornersBits = bits & 0xF0U;
     const unsigned char sidesBits = bits & 0x0FU;
 
-    ModelAsset* piece0 = gModelsManager.LoadModelAsset(artResource->mResourceName + "0");
-    ModelAsset* piece1 = gModelsManager.LoadModelAsset(artResource->mResourceName + "1");
-    ModelAsset* piece2 = gModelsManager.LoadModelAsset(artResource->mResourceName + "2");
-    ModelAsset* piece3 = gModelsManager.LoadModelAsset(artResource->mResourceName + "3");
+    ModelAsset* piece0 = LoadModelAsset(artResource->mResourceName + "0");
+    ModelAsset* piece1 = LoadModelAsset(artResource->mResourceName + "1");
+    ModelAsset* piece2 = LoadModelAsset(artResource->mResourceName + "2");
+    ModelAsset* piece3 = LoadModelAsset(artResource->mResourceName + "3");
 
     // simplest one
     if (bits == 0)
     {
-        ExtendTileMesh(terrainTile, eTileFace_Floor, piece3);
+        ExtendTileMesh(terrainTile, floorMeshArray, eTileFace_Floor, piece3, nullptr, nullptr);
         return;
     }
 
@@ -404,7 +437,7 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
         {
             if (bits == pentry.first)
             {
-                ExtendTileMesh(terrainTile, eTileFace_Floor, piece2, pentry.second);
+                ExtendTileMesh(terrainTile, floorMeshArray, eTileFace_Floor, piece2, pentry.second, nullptr);
                 break;
             }
         }
@@ -434,7 +467,7 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
         {
             if (sidesBits == pentry.first)
             {
-                ExtendTileMesh(terrainTile, eTileFace_Floor, piece0, pentry.second);
+                ExtendTileMesh(terrainTile, floorMeshArray, eTileFace_Floor, piece0, pentry.second, nullptr);
                 break;
             }
         }
@@ -464,7 +497,7 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
         {
             if (sidesBits == pentry.first)
             {
-                ExtendTileMesh(terrainTile, eTileFace_Floor, piece1, pentry.second);
+                ExtendTileMesh(terrainTile, floorMeshArray, eTileFace_Floor, piece1, pentry.second, nullptr);
                 break;
             }
         }
@@ -490,10 +523,10 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
         (NeighbourHasSameBaseTerrain(terrainTile, eDirection_W) ? 0x01 : 0)
     };
 
-    ModelAsset* piece4 = gModelsManager.LoadModelAsset(artResource->mResourceName + "4");
-    ModelAsset* piece5 = gModelsManager.LoadModelAsset(artResource->mResourceName + "5");
-    ModelAsset* piece6 = gModelsManager.LoadModelAsset(artResource->mResourceName + "6");
-    ModelAsset* piece7 = gModelsManager.LoadModelAsset(artResource->mResourceName + "7");
+    ModelAsset* piece4 = LoadModelAsset(artResource->mResourceName + "4");
+    ModelAsset* piece5 = LoadModelAsset(artResource->mResourceName + "5");
+    ModelAsset* piece6 = LoadModelAsset(artResource->mResourceName + "6");
+    ModelAsset* piece7 = LoadModelAsset(artResource->mResourceName + "7");
     ModelAsset* geoIndices[8] = {
         piece5, piece4, piece5, piece4, 
         piece4, piece6, piece4, piece7
@@ -509,11 +542,23 @@ void DungeonBuilder::ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResou
     
     for (int isubtile = 0; isubtile < 4; ++isubtile)
     {
-        ExtendTileMesh(terrainTile, eTileFace_Floor, geoIndices[subTiles[isubtile]], 
+        ExtendTileMesh(terrainTile, floorMeshArray, eTileFace_Floor, geoIndices[subTiles[isubtile]], 
             subtileRotations[isubtile][subTiles[isubtile]], &g_SubTileTranslations[isubtile]);
     }
 }
 
+ModelAsset* DungeonBuilder::LoadModelAsset(const std::string& resourceName)
+{
+    std::lock_guard<std::mutex> lock(mResourcesMutex);
+    return gModelsManager.LoadModelAsset(resourceName);
+}
+
+Texture2D* DungeonBuilder::GetTexture2D(const std::string& textureName)
+{
+    std::lock_guard<std::mutex> lock(mResourcesMutex);
+    return gTexturesManager.GetTexture2D(textureName);
+}
+
 bool DungeonBuilder::ShouldBuildSideWall(TerrainTile* terrainTile, eTileFace faceid) const
 {
     eDirection direction = FaceIdToDirection(faceid);
@@ -8,6 +8,17 @@ public:
     void BuildTerrainMesh(TerrainTile* terrainTile);
     void BuildTerrainMesh(TerrainTile* terrainTile, eTileFace faceid);
 
+    // construct terrain mesh for specific tile into staging geometry, tile itself is not modified
+    // it is safe to invoke from worker threads as long as map terrain does not change meanwhile
+    // @param terrainTile: Map tile
+    // @param staging: Output geometry
+    void BuildTerrainMesh(TerrainTile* terrainTile, TileMeshStaging& staging);
+
+    // replace tile mesh with previously constructed staging geometry, main thread only
+    // @param terrainTile: Map tile
+    // @param staging: Source geometry, receives previous tile mesh
+    void CommitTerrainMesh(TerrainTile* terrainTile, TileMeshStaging& staging);
+
     // append geometry to specific tile face mesh
     // @param terrainTile: Map tile
     // @param faceid: Tile face identifier
@@ -33,14 +44,25 @@ public:
 
 private:
     // construction
-    void ConstructTerrainWalls(TerrainTile* terrainTile);
-    void ConstructTerrainWall(TerrainTile* terrainTile, eTileFace faceid);
-    void ConstructTerrainFloor(TerrainTile* terrainTile);
-    void ConstructTerrainQuad(TerrainTile* terrainTile, ArtResource* artResource);
-    void ConstructTerrainWaterBed(TerrainTile* terrainTile, ArtResource* artResource);
+    void ConstructTerrainWalls(TerrainTile* terrainTile, TileMeshStaging& staging);
+    void ConstructTerrainWall(TerrainTile* terrainTile, TileMeshStaging& staging, eTileFace faceid);
+    void ConstructTerrainFloor(TerrainTile* terrainTile, TileMeshStaging& staging);
+    void ConstructTerrainQuad(TerrainTile* terrainTile, TileMeshStaging& staging, ArtResource* artResource);
+    void ConstructTerrainWaterBed(TerrainTile* terrainTile, TileMeshStaging& staging, ArtResource* artResource);
+
+    // append geometry to destination mesh array
+    void ExtendTileMesh(TerrainTile* terrainTile, std::vector<TileMesh>& meshArray, eTileFace faceid, 
+        ModelAsset* asset, const glm::mat3* rot, const glm::vec3* trans);
+
+    // access shared resources, serialized between worker threads
+    ModelAsset* LoadModelAsset(const std::string& resourceName);
+    Texture2D* GetTexture2D(const std::string& textureName);
 
     // test whether side wall should be constructed
     // @param dungeonMapTile: Target map tile
     // @param direction: Wall side
     bool ShouldBuildSideWall(TerrainTile* terrainTile, eTileFace faceid) const;
+
+private:
+    std::mutex mResourcesMutex;
 };
\ No newline at end of file
@@ -3,6 +3,13 @@
 #include "Texture2D_Image.h"
 #include "Console.h"
 #include "FileSystem.h"
+#include "TasksManager.h"
+#include "ConsoleVariable.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarRender_EngineTexturesCache ("r_engineTexturesCache", true, "Store decoded engine textures on disk to skip decompression on next launches", ConsoleVar_Renderer);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -36,6 +43,26 @@ public:
     int mVersion = 0;
     int mEntriesCount = 0;
 };
+
+const unsigned int DTXC_SIGNATURE = MAKEDWORD('D','T','X','C');
+
+const int DecodedTextureCacheVersion = 1;
+
+// header of decoded texture entry stored within disk cache
+struct DecodedTextureCacheHeader
+{
+public:
+    unsigned int mSignature = 0; // DTXC
+    int mVersion = 0;
+    unsigned int mDatFileLength = 0;
+    int mDataStartLocation = 0;
+    int mDataLength = 0;
+    int mSizeX = 0;
+    int mSizeY = 0;
+};
+
+// number of textures decoded at once while dumping
+const int DumpTexturesBatchSize = 64;
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -176,69 +203,52 @@ static const float float_7af044 = 3.8268343e-1f;
 
 //////////////////////////////////////////////////////////////////////////
 
+// reads uint32 words of texture data from mapped dat file, words beyond end of file are zero
 class stream_uint32
 {
 public:
-    stream_uint32(FILE* fileStream, int theOrigin, int theLength)
-        : mStream(fileStream)
+    stream_uint32(const unsigned char* fileData, size_t fileSize, int theOrigin)
+        : mFileData(fileData)
+        , mFileSize(fileSize)
         , mOrigin(theOrigin)
-        , mLength(theLength)
-        , mPageIndex()
-        , mCacheSize()
     {
-        refill_cache();
     }
 
     // read uint from specific location
-    inline unsigned int get(unsigned int theOffset)
+    inline unsigned int get(unsigned int theOffset) const
     {
-        const int requestBufferPage = theOffset / NUM_CACHE_ELEMENTS;
-        if (requestBufferPage != mPageIndex)
-        {
-            mPageIndex = requestBufferPage;
-            refill_cache();
-        }
-        const int ielement = theOffset % NUM_CACHE_ELEMENTS;
-        return (ielement < mCacheSize) ? mCache[ielement] : 0;
-    }
-
-private:
-    enum { NUM_CACHE_ELEMENTS = 256 };
+        const size_t position = mOrigin + static_cast<size_t>(theOffset) * sizeof(unsigned int);
+        if (position + sizeof(unsigned int) > mFileSize)
+            return 0;
 
-    enum { Sizeof_CacheElement = sizeof(unsigned int) };
-    enum { Sizeof_Cache = NUM_CACHE_ELEMENTS * Sizeof_CacheElement };
-    // cache data from file stream
-    inline void refill_cache()
-    {
-        if (!cxx::set_filepos(mStream, mOrigin + mPageIndex * Sizeof_Cache))
-        {
-            debug_assert(false);
-            return;
-        }
-        mCacheSize = ::fread(mCache, Sizeof_CacheElement, NUM_CACHE_ELEMENTS, mStream);
+        unsigned int theValue;
+        ::memcpy(&theValue, mFileData + position, sizeof(unsigned int)); // data might be unaligned
+        return theValue;
     }
 
 private:
-    FILE* mStream = nullptr;
-    int mOrigin;
-    int mLength;
-    int mPageIndex;
-    int mCache[512];
-    int mCacheSize; // in uints
+    const unsigned char* mFileData;
+    size_t mFileSize;
+    size_t mOrigin;
 };
 
-static stream_uint32* bs;
-static unsigned int bs_index;
-static unsigned int bs_red = 0;
-static unsigned int bs_green = 0;
-static unsigned int bs_blue = 0;
-static unsigned int bs_alpha = 0;
-
-static int decompress2_chunk[256]; /* buffers */
-static int decompress3_chunk[288];
-static int decompress4_chunk[512];
-
-inline unsigned int bs_read(unsigned int pos, int bits)
+// decompressor state, each decoding thread uses its own instance
+struct dd_context
+{
+public:
+    const stream_uint32* bs = nullptr;
+    unsigned int bs_index = 0;
+    unsigned int bs_red = 0;
+    unsigned int bs_green = 0;
+    unsigned int bs_blue = 0;
+    unsigned int bs_alpha = 0;
+
+    int decompress2_chunk[256]; /* buffers */
+    int decompress3_chunk[288];
+    int decompress4_chunk[512];
+};
+
+inline unsigned int bs_read(const dd_context& dd, unsigned int pos, int bits)
 {
     unsigned int w1, w2;
     unsigned int word_index;
@@ -246,26 +256,26 @@ inline unsigned int bs_read(unsigned int pos, int bits)
 
     word_index = pos >> 5;
     shamt = pos & 0x1f;
-    w1 = bs->get(word_index) << shamt;
-    w2 = shamt ? bs->get(word_index + 1) >> (32 - shamt) : 0;
+    w1 = dd.bs->get(word_index) << shamt;
+    w2 = shamt ? dd.bs->get(word_index + 1) >> (32 - shamt) : 0;
     w1 |= w2;
     w1 >>= (32 - bits);
 
     return w1;
 }
 
-static unsigned int prepare_decompress(unsigned int value, unsigned int pos)
+static unsigned int prepare_decompress(dd_context& dd, unsigned int value, unsigned int pos)
 {
     int xindex, index, control_word = 0;
     unsigned char magic_index = 0x3f;
 
-    decompress2_chunk[0] = value * magic_output_table[0];
-    memset(&decompress2_chunk[1], 0,
-        sizeof(decompress2_chunk) - sizeof(unsigned int));
+    dd.decompress2_chunk[0] = value * magic_output_table[0];
+    memset(&dd.decompress2_chunk[1], 0,
+        sizeof(dd.decompress2_chunk) - sizeof(unsigned int));
 
     for (;;)
     {
-        xindex = index = bs_read(pos, 17);
+        xindex = index = bs_read(dd, pos, 17);
         if (index >= 0x8000) 
         {
             index >>= 13;
@@ -317,7 +327,7 @@ static unsigned int prepare_decompress(unsigned int value, unsigned int pos)
             unsigned short unk14;
             // read next control 
             pos += control_word >> 16;
-            unk14 = bs_read(pos, 14);
+            unk14 = bs_read(dd, pos, 14);
             pos += 14;
             magic_index -= (unk14 & 0xff00) >> 8;
             unk14 &= 0xff;
@@ -331,14 +341,14 @@ static unsigned int prepare_decompress(unsigned int value, unsigned int pos)
                 } 
                 else 
                 {
-                    unk14 = bs_read(pos, 8);
+                    unk14 = bs_read(dd, pos, 8);
                     pos += 8;
                     unk14 -= 0x100;
                 }
             } 
             else 
             {
-                unk14 = bs_read(pos, 8);
+                unk14 = bs_read(dd, pos, 8);
                 pos += 8;
             }
             control_word = unk14;
@@ -360,7 +370,7 @@ static unsigned int prepare_decompress(unsigned int value, unsigned int pos)
         }
 
         unsigned int out_index = dc_control_table_7af0e0[magic_index + 1];
-        decompress2_chunk[out_index] = ((short) control_word) * magic_output_table[out_index];
+        dd.decompress2_chunk[out_index] = ((short) control_word) * magic_output_table[out_index];
     }
     return pos + (control_word >> 16);
 }
@@ -529,163 +539,163 @@ static void decompress_func2(int *in, int *out)
     out[7] = d;
 }
 
-static void decompress(bool hasAlpha)
+static void decompress(dd_context& dd, bool hasAlpha)
 {
     unsigned char jt_index, jt_value;
-    unsigned int bs_pos = bs_index;
+    unsigned int bs_pos = dd.bs_index;
     int value;
     unsigned char blanket_fill;
 
     /* red */
     value = 0;
-    jt_index = bs_read(bs_pos, 8);
+    jt_index = bs_read(dd, bs_pos, 8);
 
     jt_value = jump_table_7af4e0[jt_index];
     bs_pos += jt_value & 0xf;
     jt_value >>= 4;
     if( jt_value ) {
         /* value is signed */
-        value = bs_read(bs_pos, jt_value);
+        value = bs_read(dd, bs_pos, jt_value);
         if( (value & (1 << (jt_value - 1))) == 0 )
             value -= (1 << jt_value) - 1;
 
         bs_pos += jt_value;
     }
 
-    bs_red += value;
-    blanket_fill = bs_read(bs_pos, 2);
+    dd.bs_red += value;
+    blanket_fill = bs_read(dd, bs_pos, 2);
     if( blanket_fill == 2 ) {
         int i, j;
         bs_pos += 2;
         for( j = 0; j < 8; j++ )
             for( i = 0; i < 8; i++ )
-                decompress4_chunk[j * 64 + i] = bs_red << 16;
-        bs_index = bs_pos;
+                dd.decompress4_chunk[j * 64 + i] = dd.bs_red << 16;
+        dd.bs_index = bs_pos;
     } else {
         int i;
-        bs_index = prepare_decompress(bs_red, bs_pos);
+        dd.bs_index = prepare_decompress(dd, dd.bs_red, bs_pos);
         for( i = 0; i < 8; i++ )
-            decompress_func1(&decompress2_chunk[i * 8], &decompress3_chunk[i]);
+            decompress_func1(&dd.decompress2_chunk[i * 8], &dd.decompress3_chunk[i]);
         for( i = 0; i < 8; i++ )
-            decompress_func2(&decompress3_chunk[i * 9], &decompress4_chunk[i * 64]);
+            decompress_func2(&dd.decompress3_chunk[i * 9], &dd.decompress4_chunk[i * 64]);
     }
 
-    bs_pos = bs_index;
+    bs_pos = dd.bs_index;
 
     /* green */
     value = 0;
-    jt_index = bs_read(bs_pos, 8);
+    jt_index = bs_read(dd, bs_pos, 8);
 
     jt_value = jump_table_7af4e0[jt_index];
     bs_pos += jt_value & 0xf;
     jt_value >>= 4;
     if( jt_value ) {
         /* value is signed */
-        value = bs_read(bs_pos, jt_value);
+        value = bs_read(dd, bs_pos, jt_value);
         if( (value & (1 << (jt_value - 1))) == 0 )
             value -= (1 << jt_value) - 1;
 
         bs_pos += jt_value;
     }
 
-    bs_green += value;
-    blanket_fill = bs_read(bs_pos, 2);
+    dd.bs_green += value;
+    blanket_fill = bs_read(dd, bs_pos, 2);
     if( blanket_fill == 2 ) {
         int i, j;
         bs_pos += 2;
         for( j = 0; j < 8; j++ )
             for( i = 0; i < 8; i++ )
-                decompress4_chunk[j * 64 + i + 9] = bs_green << 16;
-        bs_index = bs_pos;
+                dd.decompress4_chunk[j * 64 + i + 9] = dd.bs_green << 16;
+        dd.bs_index = bs_pos;
     } else {
         int i;
-        bs_index = prepare_decompress(bs_green, bs_pos);
+        dd.bs_index = prepare_decompress(dd, dd.bs_green, bs_pos);
         for( i = 0; i < 8; i++ )
-            decompress_func1(&decompress2_chunk[i * 8], &decompress3_chunk[i]);
+            decompress_func1(&dd.decompress2_chunk[i * 8], &dd.decompress3_chunk[i]);
         for( i = 0; i < 8; i++ )
-            decompress_func2(&decompress3_chunk[i * 9], &decompress4_chunk[i * 64 + 9]);
+            decompress_func2(&dd.decompress3_chunk[i * 9], &dd.decompress4_chunk[i * 64 + 9]);
     }
 
-    bs_pos = bs_index;
+    bs_pos = dd.bs_index;
 
     /* blue */
     value = 0;
-    jt_index = bs_read(bs_pos, 8);
+    jt_index = bs_read(dd, bs_pos, 8);
 
     jt_value = jump_table_7af4e0[jt_index];
     bs_pos += jt_value & 0xf;
     jt_value >>= 4;
     if( jt_value ) {
         /* value is signed */
-        value = bs_read(bs_pos, jt_value);
+        value = bs_read(dd, bs_pos, jt_value);
         if( (value & (1 << (jt_value - 1))) == 0 )
             value -= (1 << jt_value) - 1;
 
         bs_pos += jt_value;
     }
 
-    bs_blue += value;
-    blanket_fill = bs_read(bs_pos, 2);
+    dd.bs_blue += value;
+    blanket_fill = bs_read(dd, bs_pos, 2);
     if( blanket_fill == 2 ) {
         int i, j;
         bs_pos += 2;
         for( j = 0; j < 8; j++ )
             for( i = 0; i < 8; i++ )
-                decompress4_chunk[j * 64 + i + 18] = bs_blue << 16;
-        bs_index = bs_pos;
+                dd.decompress4_chunk[j * 64 + i + 18] = dd.bs_blue << 16;
+        dd.bs_index = bs_pos;
     } else {
         int i;
-        bs_index = prepare_decompress(bs_blue, bs_pos);
+        dd.bs_index = prepare_decompress(dd, dd.bs_blue, bs_pos);
         for( i = 0; i < 8; i++ )
-            decompress_func1(&decompress2_chunk[i * 8], &decompress3_chunk[i]);
+            decompress_func1(&dd.decompress2_chunk[i * 8], &dd.decompress3_chunk[i]);
         for( i = 0; i < 8; i++ )
-            decompress_func2(&decompress3_chunk[i * 9], &decompress4_chunk[i * 64 + 18]);
+            decompress_func2(&dd.decompress3_chunk[i * 9], &dd.decompress4_chunk[i * 64 + 18]);
     }
 
-    bs_pos = bs_index;
+    bs_pos = dd.bs_index;
 
     /* alpha */
     if(!hasAlpha) return;
 
     value = 0;
-    jt_index = bs_read(bs_pos, 8);
+    jt_index = bs_read(dd, bs_pos, 8);
 
     jt_value = jump_table_7af4e0[jt_index];
     bs_pos += jt_value & 0xf;
     jt_value >>= 4;
     if( jt_value ) {
         /* value is signed */
-        value = bs_read(bs_pos, jt_value);
+        value = bs_read(dd, bs_pos, jt_value);
         if( (value & (1 << (jt_value - 1))) == 0 )
             value -= (1 << jt_value) - 1;
 
         bs_pos += jt_value;
     }
 
-    bs_alpha += value;
-    blanket_fill = bs_read(bs_pos, 2);
+    dd.bs_alpha += value;
+    blanket_fill = bs_read(dd, bs_pos, 2);
     if( blanket_fill == 2 ) {
         int i, j;
         bs_pos += 2;
         for( j = 0; j < 8; j++ )
             for( i = 0; i < 8; i++ )
-                decompress4_chunk[j * 64 + i + 27] = bs_alpha << 16;
-        bs_index = bs_pos;
+                dd.decompress4_chunk[j * 64 + i + 27] = dd.bs_alpha << 16;
+        dd.bs_index = bs_pos;
     } else {
         int i;
-        bs_index = prepare_decompress(bs_alpha, bs_pos);
+        dd.bs_index = prepare_decompress(dd, dd.bs_alpha, bs_pos);
         for( i = 0; i < 8; i++ )
-            decompress_func1(&decompress2_chunk[i * 8], &decompress3_chunk[i]);
+            decompress_func1(&dd.decompress2_chunk[i * 8], &dd.decompress3_chunk[i]);
         for( i = 0; i < 8; i++ )
-            decompress_func2(&decompress3_chunk[i * 9], &decompress4_chunk[i * 64 + 27]);
+            decompress_func2(&dd.decompress3_chunk[i * 9], &dd.decompress4_chunk[i * 64 + 27]);
     }
 }
 
-static void decompress_block(unsigned char *out, unsigned short stride, bool hasAlpha)
+static void decompress_block(dd_context& dd, unsigned char *out, unsigned short stride, bool hasAlpha)
 {
-    decompress(hasAlpha);
+    decompress(dd, hasAlpha);
 
-    const int* inp = decompress4_chunk;
+    const int* inp = dd.decompress4_chunk;
     for (int j = 0; j < 8; ++j) 
     {
         for(int i = 0; i < 8; ++i) 
@@ -707,24 +717,24 @@ static void decompress_block(unsigned char *out, unsigned short stride, bool has
     }
 }
 
-inline void initialize_dd(stream_uint32 *buf)
+inline void initialize_dd(dd_context& dd, const stream_uint32 *buf)
 {
-    bs = buf;
-    bs_index = 0;
-    bs_red = 0;
-    bs_blue = 0;
-    bs_green = 0;
-    bs_alpha = 0;
+    dd.bs = buf;
+    dd.bs_index = 0;
+    dd.bs_red = 0;
+    dd.bs_blue = 0;
+    dd.bs_green = 0;
+    dd.bs_alpha = 0;
 }
 
-static void dd_texture(stream_uint32 *buf, unsigned char *outp, unsigned int stride, unsigned short width, unsigned short height, bool hasAlpha)
+static void dd_texture(dd_context& dd, const stream_uint32 *buf, unsigned char *outp, unsigned int stride, unsigned short width, unsigned short height, bool hasAlpha)
 {
-    initialize_dd(buf);
+    initialize_dd(dd, buf);
 
     for(unsigned short y = 0; y < height; y += 8)
         for(unsigned short x = 0; x < width; x += 8) 
         {
-            decompress_block(&outp[y * stride + x * 4], stride, hasAlpha);
+            decompress_block(dd, &outp[y * stride + x * 4], stride, hasAlpha);
         }
 }
 
@@ -765,7 +775,18 @@ EngineTexturesProvider::~EngineTexturesProvider()
 
 bool EngineTexturesProvider::Initialize()
 {
-    debug_assert(mFileStream == nullptr);
+    debug_assert(!mDatFile.is_open());
+
+    gConsole.RegisterVariable(&gCvarRender_EngineTexturesCache);
+    gConsole.RegisterFunction("dump_engineTextures", "Extract all engine textures to directory, args: outputDirectory", [](const ConsoleFuncArgs& args)
+        {
+            std::string outputDirectory;
+            if (!args.ParseArgument(0, outputDirectory))
+            {
+                outputDirectory = "engine_textures";
+            }
+            gEngineTexturesProvider.DumpTextures(outputDirectory);
+        });
 
     if (gFileSystem.mDungeonKeeperGameTextureCacheDirPath.empty())
     {
@@ -795,18 +816,31 @@ bool EngineTexturesProvider::Initialize()
         return false;
     }
 
+    // setup decoded textures cache location
+    fs::path decodedCacheDir = fs::path(gFileSystem.mDataPath) / "cache" / "engine_textures";
+    std::error_code errorCode;
+    fs::create_directories(decodedCacheDir, errorCode);
+    if (fs::is_directory(decodedCacheDir, errorCode))
+    {
+        mDecodedCacheDirPath = decodedCacheDir.generic_string();
+    }
+    else
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot create decoded engine textures cache directory");
+    }
+
     return true;
 }
 
 void EngineTexturesProvider::Deinit()
 {
-    if (mFileStream)
-    {
-        ::fclose(mFileStream);
-        mFileStream = nullptr;
-    }
+    gConsole.UnregisterVariable(&gCvarRender_EngineTexturesCache);
+    gConsole.UnregisterFunction("dump_engineTextures");
+
+    mDatFile.close();
     mEntiesArray.clear();
     mIndicesMap.clear();
+    mDecodedCacheDirPath.clear();
 }
 
 bool EngineTexturesProvider::ContainsTexture(const std::string& textureName) const
@@ -818,6 +852,16 @@ bool EngineTexturesProvider::ContainsTexture(const std::string& textureName) con
     return true;
 }
 
+void EngineTexturesProvider::GetTexturesNames(std::vector<std::string>& texturesNames) const
+{
+    texturesNames.clear();
+    texturesNames.reserve(mIndicesMap.size());
+    for (const auto& currEntry: mIndicesMap)
+    {
+        texturesNames.push_back(currEntry.first);
+    }
+}
+
 bool EngineTexturesProvider::ExtractTexture(const std::string& textureName, Texture2D_Image& imageData) const
 {
     auto find_iterator = mIndicesMap.find(textureName);
@@ -827,44 +871,60 @@ bool EngineTexturesProvider::ExtractTexture(const std::string& textureName, Text
         return false;
     }
 
-    const TextureEntryIndex& entryIndex = find_iterator->second;
+    if (!ExtractTextureData(find_iterator->second, imageData))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot extract texture data '%s'", textureName.c_str());
+        return false;
+    }
+    return true;
+}
 
-    const int linearIndex = entryIndex.mMipIndices[0];
-    debug_assert(linearIndex != -1);
-    const TextureEntryStruct& entryStruct = mEntiesArray[linearIndex];
+int EngineTexturesProvider::ExtractTextures(const std::vector<std::string>& texturesNames, std::vector<Texture2D_Image>& texturesData) const
+{
+    const int texturesCount = (int) texturesNames.size();
 
-    // extract texture with all mipmaps
-    Point textureDimensions { entryStruct.mSizeX, entryStruct.mSizeY };
-    imageData.CreateImage(eTextureFormat_RGBA8, textureDimensions, entryIndex.mNumImages - 1, entryStruct.mHasAlpha);
-    for (int icurr = 0; icurr < entryIndex.mNumImages; ++icurr)
+    texturesData.resize(texturesCount);
+
+    // lookup entries on calling thread
+    std::vector<const TextureEntryIndex*> entries(texturesCount);
+    for (int itexture = 0; itexture < texturesCount; ++itexture)
     {
-        unsigned char* dataBuffer = imageData.GetImageDataBuffer(icurr);
-        if (icurr == 0)
+        texturesData[itexture].Clear();
+
+        auto find_iterator = mIndicesMap.find(texturesNames[itexture]);
+        if (find_iterator == mIndicesMap.end())
         {
-            if (!ExtractTexturePixels(linearIndex, dataBuffer))
+            gConsole.LogMessage(eLogMessage_Debug, "Engine texture does not exists '%s'", texturesNames[itexture].c_str());
+            continue;
+        }
+        entries[itexture] = &find_iterator->second;
+    }
+
+    std::vector<char> extractResults(texturesCount, 0);
+    gTasksManager.ParallelFor(texturesCount, 0, false, [&](int taskIndex, int threadIndex)
+        {
+            if (entries[taskIndex] && ExtractTextureData(*entries[taskIndex], texturesData[taskIndex]))
             {
-                debug_assert(false);
-                gConsole.LogMessage(eLogMessage_Warning, "Cannot extract texture data '%s'", textureName.c_str());
-                return false;
+                extractResults[taskIndex] = 1;
             }
+        });
+
+    // report errors on calling thread
+    int successCount = 0;
+    for (int itexture = 0; itexture < texturesCount; ++itexture)
+    {
+        if (extractResults[itexture])
+        {
+            ++successCount;
+            continue;
         }
-        else
+
+        if (entries[itexture])
         {
-            const int mipLinearIndex = entryIndex.mMipIndices[icurr];
-            debug_assert(mipLinearIndex != -1);
-
-            const TextureEntryStruct& mipmapStruct = mEntiesArray[mipLinearIndex];
-            debug_assert(mipmapStruct.mSizeX == GetTextureMipmapDims(textureDimensions.x, icurr));
-            debug_assert(mipmapStruct.mSizeY == GetTextureMipmapDims(textureDimensions.y, icurr));
-
-            if (!ExtractTexturePixels(mipLinearIndex, dataBuffer))
-            {
-                debug_assert(false);
-                gConsole.LogMessage(eLogMessage_Warning, "Cannot extract texture mipmap data '%s'", textureName.c_str());
-            }
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot extract texture data '%s'", texturesNames[itexture].c_str());
         }
     }
-    return true;
+    return successCount;
 }
 
 void EngineTexturesProvider::DumpTextures(const std::string& outputDirectory) const
@@ -879,41 +939,74 @@ void EngineTexturesProvider::DumpTextures(const std::string& outputDirectory) co
         }
     }
 
-    Texture2D_Image imageData;
+    std::vector<std::string> texturesNames;
+    texturesNames.reserve(mIndicesMap.size());
     for (const auto& indices_iterator: mIndicesMap)
     {
-        imageData.Clear();
+        texturesNames.push_back(indices_iterator.first);
+    }
 
-        const TextureEntryIndex& entryIndex = indices_iterator.second;
-        debug_assert(entryIndex.mNumImages > 0);
+    std::vector<std::string> batchNames;
+    std::vector<Texture2D_Image> batchImages;
+    std::vector<char> dumpResults;
 
-        const int primaryIndex = entryIndex.mMipIndices[0];
-        debug_assert(primaryIndex != -1);
-        const TextureEntryStruct& primaryEntry = mEntiesArray[primaryIndex];
+    double decodeSeconds = 0.0;
+    long long decodedBytes = 0;
+    int texturesCount = (int) texturesNames.size();
+    for (int batchStart = 0; batchStart < texturesCount; batchStart += DumpTexturesBatchSize)
+    {
+        const int batchEnd = std::min(batchStart + DumpTexturesBatchSize, texturesCount);
+        batchNames.assign(texturesNames.begin() + batchStart, texturesNames.begin() + batchEnd);
 
-        Point textureDimensions { primaryEntry.mSizeX, primaryEntry.mSizeY };
-        imageData.CreateImage(eTextureFormat_RGBA8, textureDimensions, 0, primaryEntry.mHasAlpha);
+        auto timeStart = std::chrono::steady_clock::now();
+        ExtractTextures(batchNames, batchImages);
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+        decodeSeconds += timeElapsed.count();
 
-        unsigned char* dataBuffer = imageData.GetImageDataBuffer();
-        if (!ExtractTexturePixels(primaryIndex, dataBuffer))
+        for (const Texture2D_Image& currImage: batchImages)
         {
-            debug_assert(false);
-            gConsole.LogMessage(eLogMessage_Warning, "Cannot extract texture data '%s'", indices_iterator.first.c_str());
-            continue;
+            if (currImage.IsNull())
+                continue;
+
+            for (int imipmap = 0; imipmap < currImage.mTextureDesc.mMipmapsCount + 1; ++imipmap)
+            {
+                decodedBytes += currImage.GetImageDataSize(imipmap);
+            }
         }
 
-        std::string tempName = indices_iterator.first;
-        tempName.append(".png");
-        cxx::path_remove_forbidden_chars(tempName); // make sure path is good
+        // save base images
+        const int batchCount = (int) batchNames.size();
+        dumpResults.assign(batchCount, 0);
+        gTasksManager.ParallelFor(batchCount, 0, false, [&](int taskIndex, int threadIndex)
+            {
+                const Texture2D_Image& imageData = batchImages[taskIndex];
+                if (imageData.IsNull())
+                    return;
 
-        fs::path filePath = outDirectoryPath / fs::path { tempName };
-        if (!imageData.DumpToFile(filePath.generic_string()))
+                std::string tempName = batchNames[taskIndex];
+                tempName.append(".png");
+                cxx::path_remove_forbidden_chars(tempName); // make sure path is good
+
+                fs::path filePath = outDirectoryPath / fs::path { tempName };
+                if (imageData.DumpToFile(filePath.generic_string()))
+                {
+                    dumpResults[taskIndex] = 1;
+                }
+            });
+
+        for (int itexture = 0; itexture < batchCount; ++itexture)
         {
-            debug_assert(false);
-            gConsole.LogMessage(eLogMessage_Warning, "Cannot save texture '%s'", indices_iterator.first.c_str());
-            continue;
+            if (!batchImages[itexture].IsNull() && !dumpResults[itexture])
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot save texture '%s'", batchNames[itexture].c_str());
+            }
         }
     }
+
+    const double decodedMegabytes = decodedBytes / (1024.0 * 1024.0);
+    gConsole.LogMessage(eLogMessage_Info, "Extracted %d engine textures: %.1f MB in %.3f sec (%.1f MB/s, %d threads)",
+        texturesCount, decodedMegabytes, decodeSeconds, decodeSeconds > 0.0 ? decodedMegabytes / decodeSeconds : 0.0,
+        gTasksManager.GetMaxThreadsCount());
 }
 
 bool EngineTexturesProvider::ParseDirContent(const std::string& dirFilepath, const std::string& datFilepath)
@@ -948,8 +1041,7 @@ bool EngineTexturesProvider::ParseDirContent(const std::string& dirFilepath, con
     }
 
     // scan dir entities
-    mFileStream = ::fopen(datFilepath.c_str(), "rb");
-    if (mFileStream == nullptr)
+    if (!mDatFile.open(datFilepath))
     {
         debug_assert(false);
         return false;
@@ -988,7 +1080,7 @@ bool EngineTexturesProvider::ParseDirContent(const std::string& dirFilepath, con
 
         TextureEntryStruct& entryStruct = mEntiesArray[i];
         // read data offset ot dat file
-        int offset = cursorPos[0] | 
+        int offset = cursorPos[0] |
             (cursorPos[1] << 8) |
             (cursorPos[2] << 16) |
             (cursorPos[3] << 24);
@@ -996,34 +1088,164 @@ bool EngineTexturesProvider::ParseDirContent(const std::string& dirFilepath, con
         cursorPos += 4;
 
         // read dat header
-        cxx::set_filepos(mFileStream, offset);
+        const int DatEntryHeaderLength = 20;
+        if (offset < 0 || offset + DatEntryHeaderLength > (long long) mDatFile.size())
+        {
+            debug_assert(false);
+            return false;
+        }
 
-        cxx::read_int32(mFileStream, entryStruct.mSizeX);
-        cxx::read_int32(mFileStream, entryStruct.mSizeY);
-        cxx::read_int32(mFileStream, entryStruct.mDataLength);
+        const unsigned char* entryHeader = mDatFile.data() + offset;
+        ::memcpy(&entryStruct.mSizeX, entryHeader + 0, sizeof(int));
+        ::memcpy(&entryStruct.mSizeY, entryHeader + 4, sizeof(int));
+        ::memcpy(&entryStruct.mDataLength, entryHeader + 8, sizeof(int));
         entryStruct.mDataLength = entryStruct.mDataLength - 8; // correct
 
-        cxx::read_int16(mFileStream, entryStruct.mSizeX2);
-        cxx::read_int16(mFileStream, entryStruct.mSizeY2);
+        ::memcpy(&entryStruct.mSizeX2, entryHeader + 12, sizeof(short));
+        ::memcpy(&entryStruct.mSizeY2, entryHeader + 14, sizeof(short));
 
         unsigned int textureFlags = 0;
-        cxx::read_uint32(mFileStream, textureFlags);
+        ::memcpy(&textureFlags, entryHeader + 16, sizeof(unsigned int));
 
         entryStruct.mHasAlpha = (textureFlags >> 7) > 0;
-        entryStruct.mDataStartLocation = offset + 20;
+        entryStruct.mDataStartLocation = offset + DatEntryHeaderLength;
     }
     gConsole.LogMessage(eLogMessage_Info, "Found %d unique entries in engine textures cache", mIndicesMap.size());
     return true;
+}
+
+bool EngineTexturesProvider::ExtractTextureData(const TextureEntryIndex& entryIndex, Texture2D_Image& imageData) const
+{
+    const int linearIndex = entryIndex.mMipIndices[0];
+    debug_assert(linearIndex != -1);
+    if (linearIndex == -1)
+        return false;
+
+    const TextureEntryStruct& entryStruct = mEntiesArray[linearIndex];
+
+    // extract texture with all mipmaps
+    Point textureDimensions { entryStruct.mSizeX, entryStruct.mSizeY };
+    if (!imageData.CreateImage(eTextureFormat_RGBA8, textureDimensions, entryIndex.mNumImages - 1, entryStruct.mHasAlpha))
+        return false;
+
+    for (int icurr = 0; icurr < entryIndex.mNumImages; ++icurr)
+    {
+        const int mipLinearIndex = entryIndex.mMipIndices[icurr];
+        debug_assert(mipLinearIndex != -1);
+        if (mipLinearIndex == -1)
+            return false;
+
+        debug_assert(mEntiesArray[mipLinearIndex].mSizeX == GetTextureMipmapDims(textureDimensions.x, icurr));
+        debug_assert(mEntiesArray[mipLinearIndex].mSizeY == GetTextureMipmapDims(textureDimensions.y, icurr));
+
+        unsigned char* dataBuffer = imageData.GetImageDataBuffer(icurr);
+        if (!ExtractTexturePixels(mipLinearIndex, dataBuffer))
+        {
+            debug_assert(false);
+            // base image is required, broken mipmaps are tolerated
+            if (icurr == 0)
+                return false;
+        }
+    }
+    return true;
 }
 
 bool EngineTexturesProvider::ExtractTexturePixels(int entryIndex, unsigned char* outputBuffer) const
 {
     const TextureEntryStruct& entryStruct = mEntiesArray[entryIndex];
 
-    stream_uint32 uint32stream (mFileStream, entryStruct.mDataStartLocation, entryStruct.mDataLength);
-    dd_texture(&uint32stream, outputBuffer, 
+    const bool useDecodedCache = gCvarRender_EngineTexturesCache.mValue && !mDecodedCacheDirPath.empty();
+    if (useDecodedCache && ReadDecodedPixels(entryIndex, outputBuffer))
+        return true;
+
+    dd_context decoderContext;
+    stream_uint32 uint32stream (mDatFile.data(), mDatFile.size(), entryStruct.mDataStartLocation);
+    dd_texture(decoderContext, &uint32stream, outputBuffer,
         entryStruct.mSizeX * 4,
         entryStruct.mSizeX,
         entryStruct.mSizeY, entryStruct.mHasAlpha);
+
+    if (useDecodedCache)
+    {
+        WriteDecodedPixels(entryIndex, outputBuffer);
+    }
     return true;
 }
+
+std::string EngineTexturesProvider::GetDecodedCacheFilePath(int entryIndex) const
+{
+    const TextureEntryStruct& entryStruct = mEntiesArray[entryIndex];
+
+    // cxx::va is not reentrant
+    char fileName[64];
+    ::snprintf(fileName, sizeof(fileName), "%08x_%08x.bin", entryStruct.mDataStartLocation, entryStruct.mDataLength);
+    return mDecodedCacheDirPath + "/" + fileName;
+}
+
+bool EngineTexturesProvider::ReadDecodedPixels(int entryIndex, unsigned char* outputBuffer) const
+{
+    const TextureEntryStruct& entryStruct = mEntiesArray[entryIndex];
+    const std::string filePath = GetDecodedCacheFilePath(entryIndex);
+
+    cxx::file_unique_ptr scope_file { filePath.c_str(), "rb" };
+    if (scope_file.mFileStream == nullptr)
+        return false;
+
+    DecodedTextureCacheHeader cacheHeader;
+    if (!cxx::read_data(scope_file.mFileStream, &cacheHeader, sizeof(cacheHeader)))
+        return false;
+
+    // make sure cached data belongs to same entry of same dat file
+    if (cacheHeader.mSignature != DTXC_SIGNATURE ||
+        cacheHeader.mVersion != DecodedTextureCacheVersion ||
+        cacheHeader.mDatFileLength != (unsigned int) mDatFile.size() ||
+        cacheHeader.mDataStartLocation != entryStruct.mDataStartLocation ||
+        cacheHeader.mDataLength != entryStruct.mDataLength ||
+        cacheHeader.mSizeX != entryStruct.mSizeX ||
+        cacheHeader.mSizeY != entryStruct.mSizeY)
+    {
+        return false;
+    }
+
+    return cxx::read_data(scope_file.mFileStream, outputBuffer, entryStruct.mSizeX * entryStruct.mSizeY * 4);
+}
+
+void EngineTexturesProvider::WriteDecodedPixels(int entryIndex, const unsigned char* pixelsBuffer) const
+{
+    const TextureEntryStruct& entryStruct = mEntiesArray[entryIndex];
+    const std::string filePath = GetDecodedCacheFilePath(entryIndex);
+
+    // write to temporary file first so that incomplete entries never get read
+    std::string tempFilePath = filePath;
+    tempFilePath.append(".");
+    tempFilePath.append(std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())));
+
+    DecodedTextureCacheHeader cacheHeader;
+    cacheHeader.mSignature = DTXC_SIGNATURE;
+    cacheHeader.mVersion = DecodedTextureCacheVersion;
+    cacheHeader.mDatFileLength = (unsigned int) mDatFile.size();
+    cacheHeader.mDataStartLocation = entryStruct.mDataStartLocation;
+    cacheHeader.mDataLength = entryStruct.mDataLength;
+    cacheHeader.mSizeX = entryStruct.mSizeX;
+    cacheHeader.mSizeY = entryStruct.mSizeY;
+
+    bool isSuccess = false;
+    {
+        cxx::file_unique_ptr scope_file { tempFilePath.c_str(), "wb" };
+        if (scope_file.mFileStream == nullptr)
+            return;
+
+        const size_t pixelsLength = entryStruct.mSizeX * entryStruct.mSizeY * 4;
+        isSuccess = (::fwrite(&cacheHeader, sizeof(cacheHeader), 1, scope_file.mFileStream) == 1) &&
+            (::fwrite(pixelsBuffer, pixelsLength, 1, scope_file.mFileStream) == 1);
+    }
+
+    std::error_code errorCode;
+    if (isSuccess)
+    {
+        fs::rename(tempFilePath, filePath, errorCode);
+        if (!errorCode)
+            return;
+    }
+    fs::remove(tempFilePath, errorCode);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mapped_file.h"
+
 // dungeon keeper engine textures provider
 class EngineTexturesProvider: public cxx::noncopyable
 {
@@ -21,16 +23,23 @@ public:
     // @param textureData: Output texture data
     bool ExtractTexture(const std::string& textureName, Texture2D_Image& textureData) const;
 
-    // extract all textures to specified directory
+    // extract multiple textures with all mipmaps in parallel on worker threads
+    // @param texturesNames: Entry names
+    // @param texturesData: Output textures data in same order as names, missing or broken textures are null
+    // @returns number of successfully extracted textures
+    int ExtractTextures(const std::vector<std::string>& texturesNames, std::vector<Texture2D_Image>& texturesData) const;
+
+    // get names of all textures within engine textures cache
+    // @param texturesNames: Output list
+    void GetTexturesNames(std::vector<std::string>& texturesNames) const;
+
+    // extract all textures to specified directory and print decode throughput
     // @param outputDirectory: Output directory path
     void DumpTextures(const std::string& outputDirectory) const;
 
 private:
     bool ParseDirContent(const std::string& dirFilepath, const std::string& datFilepath);
 
-    // decompress texture data
-    bool ExtractTexturePixels(int entryIndex, unsigned char* outputBuffer) const;
-
 private:
 
     enum 
@@ -67,7 +76,21 @@ private:
 
     std::vector<TextureEntryStruct> mEntiesArray; // all textures and mipmaps entries
 
-    FILE* mFileStream = nullptr;
+    cxx::mapped_file mDatFile;
+
+    std::string mDecodedCacheDirPath; // empty if decoded textures cache is unavailable
+
+private:
+    // extract texture with all mipmaps, does not write log so it is safe to call from worker threads
+    bool ExtractTextureData(const TextureEntryIndex& entryIndex, Texture2D_Image& imageData) const;
+
+    // decompress texture data or read it from decoded textures cache
+    bool ExtractTexturePixels(int entryIndex, unsigned char* outputBuffer) const;
+
+    // decoded textures cache entry is keyed by entry location and length within dat file
+    std::string GetDecodedCacheFilePath(int entryIndex) const;
+    bool ReadDecodedPixels(int entryIndex, unsigned char* outputBuffer) const;
+    void WriteDecodedPixels(int entryIndex, const unsigned char* pixelsBuffer) const;
 };
 
 extern EngineTexturesProvider gEngineTexturesProvider;
\ No newline at end of file
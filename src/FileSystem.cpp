@@ -5,6 +5,8 @@
 #include "FileSystemArchive.h"
 #include "BinaryInputStream.h"
 #include "BinaryOutputStream.h"
+#include "ConsoleVariable.h"
+#include "TasksManager.h"
 
 #if OS_NAME == OS_WINDOWS
     #define WIN32_LEAN_AND_MEAN
@@ -12,10 +14,25 @@
     #include <windows.h>
 #endif
 
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarSys_MapResourceArchives ("sys_mapResourceArchives", true, "Map game resource archives to memory instead of reading through file stream", ConsoleVar_System);
+
+//////////////////////////////////////////////////////////////////////////
+
 FileSystem gFileSystem;
 
 bool FileSystem::Initialize()
 {
+    gConsole.RegisterVariable(&gCvarSys_MapResourceArchives);
+    gConsole.RegisterFunction("bench_wadExtract", "Extract all entries of mounted resource archives, args: maxThreads", [](const ConsoleFuncArgs& args)
+        {
+            int maxThreads = 0;
+            args.ParseArgument(0, maxThreads);
+            gFileSystem.RunArchivesBenchmark(maxThreads);
+        });
+
     if (!SetupExecutablePath())
     {
         Deinit();
@@ -33,6 +50,9 @@ bool FileSystem::Initialize()
 
 void FileSystem::Deinit()
 {
+    gConsole.UnregisterVariable(&gCvarSys_MapResourceArchives);
+    gConsole.UnregisterFunction("bench_wadExtract");
+
     UnmountDungeonKeeperGameArchives();
 }
 
@@ -163,7 +183,7 @@ bool FileSystem::MountDungeonKeeperGameArchives()
         bool isSuccess = false;
 
         FileSystemArchive* fsArchive = new FileSystemArchive(currpath.filename().generic_string(), currpath.generic_string());
-        if (fsArchive->OpenArchive())
+        if (fsArchive->OpenArchive(gCvarSys_MapResourceArchives.mValue))
         {
             isSuccess = true;
         }
@@ -224,15 +244,12 @@ BinaryInputStream* FileSystem::OpenDataFile(const std::string& fileName)
         if (!currArchive->ContainsResource(fileName))
             continue;
 
-        ByteArray streamData;
-        if (!currArchive->ExtractResource(fileName, streamData))
+        BinaryInputStream* inputStream = currArchive->OpenResourceStream(fileName);
+        if (inputStream == nullptr)
         {
             gConsole.LogMessage(eLogMessage_Warning, "Cannot extract file from wad archive '%s'", fileName.c_str());
             return nullptr;
         }
-
-        MemoryInputStream* inputStream = new MemoryInputStream;
-        inputStream->OpenMemoryStreamFromBuffer(streamData);
         return inputStream;
     }
 
@@ -270,6 +287,81 @@ FileSystemArchive* FileSystem::FindResourceArchive(const std::string& fileName)
     return nullptr;
 }
 
+void FileSystem::RunArchivesBenchmark(int maxThreads)
+{
+    if (mResourceArchives.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Archives benchmark requires mounted resource archives");
+        return;
+    }
+
+    if (maxThreads < 1 || maxThreads > gTasksManager.GetMaxThreadsCount())
+    {
+        maxThreads = gTasksManager.GetMaxThreadsCount();
+    }
+
+    struct BenchmarkPass
+    {
+    public:
+        const char* mName;
+        bool mMemoryMapped;
+        int mThreadsCount;
+    };
+    const BenchmarkPass benchmarkPasses[] =
+    {
+        {"file stream", false, 1},
+        {"memory mapped", true, 1},
+        {"memory mapped", true, maxThreads},
+    };
+
+    for (const BenchmarkPass& currPass: benchmarkPasses)
+    {
+        // mounted archives are left intact, separate instances are opened for each pass
+        std::vector<std::unique_ptr<FileSystemArchive>> archives;
+        std::vector<std::pair<const FileSystemArchive*, const std::string*>> entries;
+        for (FileSystemArchive* currArchive: mResourceArchives)
+        {
+            archives.emplace_back(new FileSystemArchive(currArchive->mName, currArchive->mPath));
+
+            FileSystemArchive* benchArchive = archives.back().get();
+            if (!benchArchive->OpenArchive(currPass.mMemoryMapped))
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot open archive '%s'", currArchive->mName.c_str());
+                continue;
+            }
+
+            for (const auto& currEntry: benchArchive->mEtriesMap)
+            {
+                entries.emplace_back(benchArchive, &currEntry.first);
+            }
+        }
+
+        std::atomic<long long> extractedBytes (0);
+        std::atomic<int> failedEntries (0);
+
+        auto timeStart = std::chrono::steady_clock::now();
+        gTasksManager.ParallelFor((int) entries.size(), currPass.mThreadsCount, false, [&](int taskIndex, int threadIndex)
+            {
+                const auto& currEntry = entries[taskIndex];
+
+                BinaryInputStream* inputStream = currEntry.first->OpenResourceStream(*currEntry.second);
+                if (inputStream == nullptr)
+                {
+                    ++failedEntries;
+                    return;
+                }
+                extractedBytes += inputStream->GetLength();
+                delete inputStream;
+            });
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+
+        const double seconds = std::max(timeElapsed.count(), 0.000001);
+        gConsole.LogMessage(eLogMessage_Info, "Archives %s, threads: %d, entries: %d (%d failed), entries/sec: %.0f, MB/s: %.1f",
+            currPass.mName, currPass.mThreadsCount, (int) entries.size(), failedEntries.load(), entries.size() / seconds,
+            (extractedBytes / (1024.0 * 1024.0)) / seconds);
+    }
+}
+
 void FileSystem::CloseFileStream(BinaryInputStream* fileStream)
 {
     debug_assert(fileStream);
@@ -289,16 +381,19 @@ bool FileSystem::ReadTextFile(const std::string& fileName, std::string& stringBu
         return false;
 
     stringBuffer.clear();
-    stringBuffer.reserve(inputStream->GetLength());
 
-    while (!inputStream->IsEos())
+    // read whole file at once
+    ByteArray fileContent (inputStream->GetLength());
+    long bytesRead = 0;
+    if (!fileContent.empty())
     {
-        unsigned char inputChar = 0;
-        if (inputStream->ReadData(&inputChar, 1) == 0)
-        {
-            break;
-        }
-        
+        bytesRead = inputStream->ReadData(fileContent.data(), (long) fileContent.size());
+    }
+
+    stringBuffer.reserve(bytesRead);
+    for (long icursor = 0; icursor < bytesRead; ++icursor)
+    {
+        const unsigned char inputChar = fileContent[icursor];
         if (inputChar == '\r' || inputChar == 0)
             continue;
 
@@ -57,6 +57,11 @@ public:
     // @param fileName: Archive identifier
     FileSystemArchive* FindResourceArchive(const std::string& fileName);
 
+    // extract every entry of mounted resource archives through file stream and memory mapping,
+    // print entries/sec and bytes/sec stats
+    // @param maxThreads: Max threads count for memory mapped pass, 0 means all available
+    void RunArchivesBenchmark(int maxThreads);
+
     // free file stream
     // @param fileStream: File stream
     void CloseFileStream(BinaryInputStream* fileStream);
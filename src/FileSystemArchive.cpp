@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "FileSystemArchive.h"
 #include "Console.h"
+#include "BinaryInputStream.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -44,11 +45,34 @@ private:
     int mLength;
 };
 
+// reads bytes directly from mapped archive data
+class memory_range
+{
+public:
+    memory_range(const unsigned char* data, int dataLength)
+        : mCursor(data)
+        , mEnd(data + dataLength)
+    {
+    }
+
+    inline unsigned char get_byte()
+    {
+        return (mCursor < mEnd) ? *mCursor++ : 0;
+    }
+
+    inline bool is_eof() const { return mCursor == mEnd; }
+
+private:
+    const unsigned char* mCursor;
+    const unsigned char* mEnd;
+};
+
 //////////////////////////////////////////////////////////////////////////
 
 // Thanks to Trass3r for his decompression algorithm.
 
-static bool dk2_wad_decompress_data(file_stream_range& input, int compressedLength, unsigned char* theBuffer)
+template<typename TInputRange>
+static bool dk2_wad_decompress_data(TInputRange& input, int compressedLength, unsigned char* theBuffer)
 {
     bool isFinished = false;
     if (input.get_byte() & 1) 
@@ -173,7 +197,7 @@ FileSystemArchive::~FileSystemArchive()
     CloseArchive();
 }
 
-bool FileSystemArchive::OpenArchive()
+bool FileSystemArchive::OpenArchive(bool memoryMapped)
 {
     CloseArchive();
 
@@ -272,6 +296,20 @@ bool FileSystemArchive::OpenArchive()
         archiveEntry.mCompressed = (fileCompression == 4);
         inameoffset += fileNameLength;
     }
+
+    if (memoryMapped)
+    {
+        if (mMappedFile.open(mPath))
+        {
+            // file stream is not needed anymore
+            fclose(mFileStream);
+            mFileStream = nullptr;
+        }
+        else
+        {
+            gConsole.LogMessage(eLogMessage_Debug, "Cannot map archive '%s' to memory, using file stream", mName.c_str());
+        }
+    }
     return true;
 }
 
@@ -282,12 +320,13 @@ void FileSystemArchive::CloseArchive()
         fclose(mFileStream);
         mFileStream = nullptr;
     }
+    mMappedFile.close();
     mEtriesMap.clear();
 }
 
 bool FileSystemArchive::ContainsResource(const std::string& resourceName) const
 {
-    debug_assert(mFileStream);
+    debug_assert(mFileStream || IsMemoryMapped());
 
     auto resource_iterator = mEtriesMap.find(resourceName);
     if (resource_iterator == mEtriesMap.end())
@@ -298,9 +337,7 @@ bool FileSystemArchive::ContainsResource(const std::string& resourceName) const
 
 bool FileSystemArchive::ExtractResource(const std::string& resourceName, ByteArray& theExtractData) const
 {
-    debug_assert(mFileStream);
-    if (mFileStream == nullptr)
-        return false;
+    debug_assert(mFileStream || IsMemoryMapped());
 
     auto resource_iterator = mEtriesMap.find(resourceName);
     if (resource_iterator == mEtriesMap.end())
@@ -308,9 +345,37 @@ bool FileSystemArchive::ExtractResource(const std::string& resourceName, ByteArr
 
     const ArchiveEntryStruct& archiveEntry = resource_iterator->second;
 
-    theExtractData.clear();
     theExtractData.resize((archiveEntry.mCompressed) ? archiveEntry.mCompressedLength : archiveEntry.mDataLength);
 
+    // read from mapped memory
+    if (IsMemoryMapped())
+    {
+        if (archiveEntry.mDataOffset < 0 || archiveEntry.mDataLength < 0 ||
+            (size_t) archiveEntry.mDataOffset + archiveEntry.mDataLength > mMappedFile.size())
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        const unsigned char* entryData = mMappedFile.data() + archiveEntry.mDataOffset;
+        if (!archiveEntry.mCompressed)
+        {
+            if (archiveEntry.mDataLength > 0)
+            {
+                ::memcpy(theExtractData.data(), entryData, archiveEntry.mDataLength);
+            }
+            return true;
+        }
+
+        memory_range input{entryData, archiveEntry.mDataLength};
+        return dk2_wad_decompress_data(input, archiveEntry.mCompressedLength, theExtractData.data());
+    }
+
+    if (mFileStream == nullptr)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mFileStreamMutex);
+
     if (!cxx::set_filepos(mFileStream, archiveEntry.mDataOffset))
     {
         debug_assert(false);
@@ -334,6 +399,38 @@ bool FileSystemArchive::ExtractResource(const std::string& resourceName, ByteArr
     return dk2_wad_decompress_data(input, archiveEntry.mCompressedLength, theExtractData.data());
 }
 
+BinaryInputStream* FileSystemArchive::OpenResourceStream(const std::string& resourceName) const
+{
+    auto resource_iterator = mEtriesMap.find(resourceName);
+    if (resource_iterator == mEtriesMap.end())
+        return nullptr;
+
+    const ArchiveEntryStruct& archiveEntry = resource_iterator->second;
+
+    // expose mapped data directly
+    if (IsMemoryMapped() && !archiveEntry.mCompressed)
+    {
+        if (archiveEntry.mDataOffset < 0 || archiveEntry.mDataLength < 0 ||
+            (size_t) archiveEntry.mDataOffset + archiveEntry.mDataLength > mMappedFile.size())
+        {
+            debug_assert(false);
+            return nullptr;
+        }
+
+        MemoryInputStream* inputStream = new MemoryInputStream;
+        inputStream->OpenMemoryStreamFromView(mMappedFile.data() + archiveEntry.mDataOffset, archiveEntry.mDataLength);
+        return inputStream;
+    }
+
+    ByteArray streamData;
+    if (!ExtractResource(resourceName, streamData))
+        return nullptr;
+
+    MemoryInputStream* inputStream = new MemoryInputStream;
+    inputStream->OpenMemoryStreamFromBuffer(streamData);
+    return inputStream;
+}
+
 void FileSystemArchive::CloseWithFail(const char* errorMessage)
 {
     debug_assert(false);
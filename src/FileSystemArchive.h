@@ -1,6 +1,12 @@
 #pragma once
 
+#include "mapped_file.h"
+
+// forwards
+class BinaryInputStream;
+
 // game wad archive
+// resources could be extracted from multiple threads simultaneously
 class FileSystemArchive: public cxx::noncopyable
 {
 public:
@@ -26,7 +32,8 @@ public:
     ~FileSystemArchive();
 
     // parse and load wad archive data
-    bool OpenArchive();
+    // @param memoryMapped: Map archive file to memory instead of reading through file stream
+    bool OpenArchive(bool memoryMapped = true);
 
     // unload archive data
     void CloseArchive();
@@ -35,14 +42,24 @@ public:
     // @param resourceName: Entry name
     bool ContainsResource(const std::string& resourceName) const;
 
+    // test whether wad archive file is mapped to memory
+    inline bool IsMemoryMapped() const { return mMappedFile.is_open(); }
+
     // extract resource data from wad archive
     // @param resourceName: Entry name
-    // @param outputData: Destination buffer
+    // @param outputData: Destination buffer, existing allocation is reused
     bool ExtractResource(const std::string& resourceName, ByteArray& outputData) const;
 
+    // open resource for reading, uncompressed resources of memory mapped archive are not copied
+    // @param resourceName: Entry name
+    // @returns null on error
+    BinaryInputStream* OpenResourceStream(const std::string& resourceName) const;
+
 private:
     void CloseWithFail(const char* errorMessage);
 
 private:
     FILE* mFileStream = nullptr;
+    mutable std::mutex mFileStreamMutex; // file stream cursor is shared
+    cxx::mapped_file mMappedFile;
 };
\ No newline at end of file
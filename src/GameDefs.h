@@ -10,6 +10,8 @@ class GameMap;
 class Entity;
 class TerrainTile;
 class GameObject;
+struct TileMesh;
+struct TileMeshStaging;
 
 // terrain type identifier
 enum TerrainTypeID: unsigned int
@@ -2,6 +2,7 @@
 #include "GameMain.h"
 #include "RenderScene.h"
 #include "Console.h"
+#include "ConsoleVariable.h"
 #include "GenericGamestate.h"
 #include "ToolsUIConsoleWindow.h"
 #include "System.h"
@@ -23,6 +24,28 @@ bool GameMain::Initialize()
     gToolsUIManager.AttachWindow(&mFpsWindow);
     mFpsWindow.SetWindowShown(false);
 
+    gToolsUIManager.AttachWindow(&mTexturesWindow);
+    mTexturesWindow.SetWindowShown(false);
+
+    gConsole.RegisterFunction("ui_textures", "Toggle resident textures window", [this](const ConsoleFuncArgs& args)
+    {
+        mTexturesWindow.ToggleWindowShown();
+    });
+
+    gConsole.RegisterFunction("stress_animModels", "Show grid of animating models in mesh view, args: modelsCount modelName", [this](const ConsoleFuncArgs& args)
+    {
+        int modelsCount = 4096;
+        args.ParseArgument(0, modelsCount);
+        std::string modelName = "vampire-pray";
+        args.ParseArgument(1, modelName);
+
+        if (!IsMeshViewGamestate())
+        {
+            SwitchToGameState(&mMeshViewGamestate);
+        }
+        mMeshViewGamestate.SetupStressScene(modelsCount, modelName);
+    });
+
     if (!gGameWorld.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize game world");
@@ -52,11 +75,15 @@ bool GameMain::Initialize()
 
 void GameMain::Deinit()
 {
+    gConsole.UnregisterFunction("stress_animModels");
+    gConsole.UnregisterFunction("ui_textures");
+
     gGameWorld.Deinit();
 
     SwitchToGameState(nullptr);
 
     gToolsUIManager.DetachWindow(&mFpsWindow);
+    gToolsUIManager.DetachWindow(&mTexturesWindow);
     gRenderScene.Deinit();
 }
 
@@ -4,6 +4,7 @@
 #include "GameplayGamestate.h"
 #include "GuiTestGamestate.h"
 #include "ToolsUISceneStatisticsWindow.h"
+#include "ToolsUITexturesWindow.h"
 
 // game core
 class GameMain: public cxx::noncopyable
@@ -49,6 +50,7 @@ private:
 private:
     GenericGamestate* mCurrentGamestate = nullptr;
     ToolsUISceneStatisticsWindow mFpsWindow;
+    ToolsUITexturesWindow mTexturesWindow;
 };
 
 extern GameMain gGameMain;
\ No newline at end of file
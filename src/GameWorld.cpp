@@ -6,11 +6,18 @@
 #include "RoomsManager.h"
 #include "GenericRoom.h"
 #include "GameObjectsManager.h"
+#include "FileSystem.h"
+#include "PathfindingManager.h"
 
 GameWorld gGameWorld;
 
 bool GameWorld::Initialize()
 {
+    gConsole.RegisterFunction("bench_scenarios", "Load all shipped scenarios and print data files parse time", [](const ConsoleFuncArgs& args)
+        {
+            gGameWorld.RunScenariosBenchmark();
+        });
+
     if (!gTerrainManager.Initialize())
     {
         Deinit();
@@ -35,11 +42,22 @@ bool GameWorld::Initialize()
         return false;
     }
 
+    if (!gPathfindingManager.Initialize())
+    {
+        Deinit();
+
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize pathfinding manager");
+        return false;
+    }
+
     return true;
 }
 
 void GameWorld::Deinit()
 {
+    gConsole.UnregisterFunction("bench_scenarios");
+
+    gPathfindingManager.Deinit();
     gRoomsManager.Deinit();
     gGameObjectsManager.Deinit();
     gTerrainManager.Deinit();
@@ -54,6 +72,53 @@ bool GameWorld::LoadScenario(const std::string& scenarioName)
         return false;
     }
     return true;
+}
+
+void GameWorld::RunScenariosBenchmark()
+{
+    std::vector<std::string> scenarios;
+
+    std::error_code errorCode;
+    fs::directory_iterator iter_directory_end;
+    for (fs::directory_iterator iter_directory(gFileSystem.mDungeonKeeperGameMapsPath, errorCode);
+        iter_directory != iter_directory_end; ++iter_directory)
+    {
+        const fs::path& currentFile = iter_directory->path();
+        if (fs::is_regular_file(currentFile) && cxx::iequals(currentFile.extension().generic_string(), ".kwd"))
+        {
+            scenarios.push_back(currentFile.stem().generic_string());
+        }
+    }
+
+    if (scenarios.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot locate scenario files");
+        return;
+    }
+
+    std::sort(scenarios.begin(), scenarios.end());
+
+    double totalSeconds = 0.0;
+    for (const std::string& currScenario: scenarios)
+    {
+        ScenarioData scenarioData;
+        ScenarioLoader scenarioLoader (scenarioData);
+
+        auto timeStart = std::chrono::steady_clock::now();
+        bool isSuccess = scenarioLoader.LoadScenarioData(currScenario);
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+        totalSeconds += timeElapsed.count();
+
+        gConsole.LogMessage(eLogMessage_Info, "Scenario '%s': %.3f ms%s", currScenario.c_str(), timeElapsed.count() * 1000.0,
+            isSuccess ? "" : " (FAIL)");
+        for (const ScenarioLoader::DataFileStats& currStats: scenarioLoader.mDataFilesStats)
+        {
+            gConsole.LogMessage(eLogMessage_Info, " - %s: %.3f ms, %d KB", currStats.mFilePath.c_str(), 
+                currStats.mParseSeconds * 1000.0, (int) (currStats.mFileLength / 1024));
+        }
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Loaded %d scenarios in %.3f ms", (int) scenarios.size(), totalSeconds * 1000.0);
 }
 
 void GameWorld::EnterWorld()
@@ -68,12 +133,14 @@ void GameWorld::EnterWorld()
     gGameObjectsManager.EnterWorld();
 
     gTerrainManager.BuildFullTerrainMesh();
+    gPathfindingManager.EnterWorld();
     mTerrainCursor.EnterWorld();
 }
 
 void GameWorld::ClearWorld()
 {
     mTerrainCursor.ClearWorld();
+    gPathfindingManager.ClearWorld();
     gTerrainManager.ClearWorld();
     gGameObjectsManager.ClearWorld();
     gRoomsManager.ClearWorld();
@@ -86,6 +153,7 @@ void GameWorld::UpdateFrame()
     gGameObjectsManager.UpdateFrame();
     gRoomsManager.UpdateFrame();
     gTerrainManager.UpdateTerrainMesh();
+    gPathfindingManager.UpdateFrame();
     mTerrainCursor.UpdateFrame();
 }
 
@@ -22,6 +22,9 @@ public:
     // load world data, level map, setup players, build rooms etc
     // @param scenarioName: Scenario name
     bool LoadScenario(const std::string& scenarioName);
+
+    // load all shipped scenarios and print per data file parse time
+    void RunScenariosBenchmark();
     void EnterWorld();
     void ClearWorld();
 
@@ -5,6 +5,7 @@
 #include "DungeonBuilder.h"
 #include "GameWorld.h"
 #include "WallSection.h"
+#include "cvars.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -67,12 +68,7 @@ void GenericRoom::AbsorbRoom(GenericRoom* sourceRoom, const TilesList& targetTil
 void GenericRoom::ReleaseTiles(const TilesList& terrainTiles)
 {
     DetachTiles(terrainTiles);
-
-    ReevaluateOccupationArea();
-    ReevaluateInnerSquares();
-    ReevaluateWallSections();
-
-    Reconfigure();
+    ReevaluateTiles(terrainTiles);
 }
 
 void GenericRoom::ReleaseTiles()
@@ -85,10 +81,23 @@ void GenericRoom::ReleaseTiles()
 void GenericRoom::EnlargeRoom(const TilesList& terrainTiles)
 {
     AttachTiles(terrainTiles);
+    ReevaluateTiles(terrainTiles);
+}
 
+void GenericRoom::ReevaluateTiles(const TilesList& changedTiles)
+{
     ReevaluateOccupationArea();
-    ReevaluateInnerSquares();
-    ReevaluateWallSections();
+
+    if (gCvarGame_RoomsIncrementalUpdate.mValue)
+    {
+        ReevaluateInnerSquares(changedTiles);
+        ReevaluateWallSections(changedTiles);
+    }
+    else
+    {
+        ReevaluateInnerSquares();
+        ReevaluateWallSections();
+    }
 
     Reconfigure();
 }
@@ -136,8 +145,15 @@ void GenericRoom::NeighbourTileChange(TerrainTile* targetTile)
     debug_assert(isNeighbour);
     if (isNeighbour)
     {
-        // todo: optimize
-        ReevaluateWallSections();
+        if (gCvarGame_RoomsIncrementalUpdate.mValue)
+        {
+            TilesList changedTiles { targetTile };
+            ReevaluateWallSections(changedTiles);
+        }
+        else
+        {
+            ReevaluateWallSections();
+        }
     }
 }
 
@@ -254,12 +270,172 @@ void GenericRoom::ReevaluateInnerSquares()
     }
 }
 
+void GenericRoom::ReevaluateInnerSquares(const TilesList& changedTiles)
+{
+    bool hasRemovedInnerTiles = false;
+
+    auto UpdateInnerTile = [this, &hasRemovedInnerTiles](TerrainTile* currTile)
+    {
+        if (currTile == nullptr)
+            return;
+
+        // released tiles were reset on detach
+        if (currTile->mBuiltRoom != this)
+        {
+            hasRemovedInnerTiles = true;
+            return;
+        }
+
+        bool isInnerTile = true;
+        for (eDirection direction: gDirectionsCW)
+        {
+            if (!gGameWorld.mDungeonBuilder.NeighbourHasSameRoom(currTile, direction))
+            {
+                isInnerTile = false;
+                break;
+            }
+        }
+
+        if (isInnerTile == currTile->mIsRoomInnerTile)
+            return;
+
+        // invalidate tiles
+        currTile->InvalidateTileMesh();
+        currTile->InvalidateNeighbourTilesMesh();
+
+        currTile->mIsRoomInnerTile = isInnerTile;
+        if (isInnerTile)
+        {
+            mInnerTiles.push_back(currTile);
+        }
+        else
+        {
+            hasRemovedInnerTiles = true;
+        }
+    };
+
+    // inner state depends on all 8 neighbours
+    for (TerrainTile* currTile: changedTiles)
+    {
+        UpdateInnerTile(currTile);
+        for (TerrainTile* neighbourTile: currTile->mNeighbours)
+        {
+            UpdateInnerTile(neighbourTile);
+        }
+    }
+
+    if (hasRemovedInnerTiles)
+    {
+        cxx::erase_elements_if(mInnerTiles, [this](const TerrainTile* terrainTile)
+            {
+                return terrainTile->mBuiltRoom != this || !terrainTile->mIsRoomInnerTile;
+            });
+    }
+}
+
+void GenericRoom::ReevaluateWallSections(const TilesList& changedTiles)
+{
+    if (!mDefinition->mHasWalls) // room does not handle walls
+    {
+        mInvalidatedWallSections.clear();
+        return;
+    }
+
+    mWallFacesToScan.clear();
+
+    // collect solid faces adjacent to changed tiles
+    for (TerrainTile* changedTile: changedTiles)
+    {
+        for (eDirection direction: gStraightDirections)
+        {
+            TerrainTile* neighbourTile = changedTile->mNeighbours[direction];
+            if (neighbourTile == nullptr)
+                continue;
+
+            if (changedTile->mBuiltRoom == this && CanHaveRoomWall(neighbourTile))
+            {
+                mWallFacesToScan.push_back({neighbourTile, DirectionToFaceId(GetOppositeDirection(direction))});
+            }
+            else if (neighbourTile->mBuiltRoom == this && CanHaveRoomWall(changedTile))
+            {
+                mWallFacesToScan.push_back({changedTile, DirectionToFaceId(direction)});
+            }
+
+            // changed tile might be wall itself
+            WallSection* wallSection = changedTile->mFaces[DirectionToFaceId(direction)].mWallSection;
+            if (wallSection && wallSection->mOwnerRoom == this)
+            {
+                InvalidateWallSection(wallSection);
+            }
+        }
+    }
+
+    // new faces might join or extend wall sections on same line
+    for (const WallFace& wallFace: mWallFacesToScan)
+    {
+        const eDirection faceDirection = FaceIdToDirection(wallFace.mFaceId);
+        const eDirection lineDirectionA = (faceDirection == eDirection_N || faceDirection == eDirection_S) ? eDirection_W : eDirection_N;
+        const eDirection lineDirectionB = GetOppositeDirection(lineDirectionA);
+
+        for (TerrainTile* lineTile: {wallFace.mTile, wallFace.mTile->mNeighbours[lineDirectionA], wallFace.mTile->mNeighbours[lineDirectionB]})
+        {
+            if (lineTile == nullptr)
+                continue;
+
+            WallSection* wallSection = lineTile->mFaces[wallFace.mFaceId].mWallSection;
+            if (wallSection && wallSection->mOwnerRoom == this)
+            {
+                InvalidateWallSection(wallSection);
+            }
+        }
+    }
+
+    // release affected sections, their remaining tiles must be scanned again
+    for (WallSection* currentSection: mInvalidatedWallSections)
+    {
+        for (TerrainTile* currentTile: currentSection->mMapTiles)
+        {
+            TileFaceData& face = currentTile->mFaces[currentSection->mFaceId];
+            if (face.mWallSection != currentSection)
+                continue;
+
+            face.mWallSection = nullptr;
+            currentTile->InvalidateTileMesh();
+            mWallFacesToScan.push_back({currentTile, currentSection->mFaceId});
+        }
+        cxx::erase_elements(mWallSections, currentSection);
+        gWallSectionsPool.destroy(currentSection);
+    }
+    mInvalidatedWallSections.clear();
+
+    // scan wall sections
+    for (const WallFace& wallFace: mWallFacesToScan)
+    {
+        TileFaceData& face = wallFace.mTile->mFaces[wallFace.mFaceId];
+        if (face.mWallSection) // already processed
+        {
+            debug_assert(face.mWallSection->mOwnerRoom == this);
+            continue;
+        }
+
+        TerrainTile* roomTile = wallFace.mTile->mNeighbours[FaceIdToDirection(wallFace.mFaceId)];
+        if (roomTile == nullptr || roomTile->mBuiltRoom != this || !CanHaveRoomWall(wallFace.mTile))
+            continue;
+
+        // create wall section
+        WallSection* wallSection = gWallSectionsPool.create(this);
+
+        ScanWallSection(wallFace.mTile, wallFace.mFaceId, wallSection);
+        FinalizeWallSection(wallSection);
+    }
+    mWallFacesToScan.clear();
+}
+
 void GenericRoom::ReevaluateWallSections()
 {
     if (!mDefinition->mHasWalls) // room does not handle walls
         return;
 
-    // todo: optimize walls reevaluation
     ReleaseWallSections();
 
     // scan wall sections
@@ -277,8 +453,7 @@ void GenericRoom::ReevaluateWallSections()
                 continue;
             }
 
-            TerrainDefinition* neighbourTerrain = neighbourTile->GetTerrain();
-            if (!neighbourTerrain->mIsSolid || !neighbourTerrain->mAllowRoomWalls)
+            if (!CanHaveRoomWall(neighbourTile))
                 continue;
 
             eDirection inwardsDirection = GetOppositeDirection(outOfRoomDirection);
@@ -410,6 +585,22 @@ void GenericRoom::ReleaseWallSections()
         gWallSectionsPool.destroy(currentSection);
     }
     mWallSections.clear();
+    mInvalidatedWallSections.clear();
+}
+
+void GenericRoom::InvalidateWallSection(WallSection* section)
+{
+    debug_assert(section && section->mOwnerRoom == this);
+    if (!cxx::contains(mInvalidatedWallSections, section))
+    {
+        mInvalidatedWallSections.push_back(section);
+    }
+}
+
+bool GenericRoom::CanHaveRoomWall(TerrainTile* terrainTile)
+{
+    TerrainDefinition* terrainDefinition = terrainTile->GetTerrain();
+    return terrainDefinition->mIsSolid && terrainDefinition->mAllowRoomWalls;
 }
 
 void GenericRoom::DetachFromWall(TerrainTile* roomTile)
@@ -432,6 +623,8 @@ void GenericRoom::DetachFromWall(TerrainTile* roomTile)
             wallSection->RemoveTile(currNeighbour);
 
             facedata.mWallSection = nullptr; // clear wall section reference
+            // section might be split or become empty
+            InvalidateWallSection(wallSection);
         }
     }
 }
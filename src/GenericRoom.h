@@ -54,13 +54,26 @@ protected:
     void AttachTiles(const TilesList& terrainTiles);
     void DetachTiles(const TilesList& terrainTiles);
 
+    // update inner squares and walls after tiles were attached or detached
+    // @param changedTiles: Attached, detached or neighbour tiles which terrain was changed
+    void ReevaluateTiles(const TilesList& changedTiles);
+
     void ReevaluateOccupationArea();
     void ReevaluateInnerSquares();
     void ReevaluateWallSections();
+
+    // incremental versions, only changed tiles and their neighbours are processed
+    void ReevaluateInnerSquares(const TilesList& changedTiles);
+    void ReevaluateWallSections(const TilesList& changedTiles);
     
     void ReleaseWallSections();
     void DetachFromWall(TerrainTile* roomTile);
 
+    // wall section will be released and its tiles will be rescanned on next walls reevaluation
+    void InvalidateWallSection(WallSection* section);
+
+    static bool CanHaveRoomWall(TerrainTile* terrainTile);
+
     static void ScanWallSection(TerrainTile* terrainTile, eTileFace faceId, WallSection* section);
     static void ScanWallSection(TerrainTile* terrainTile, eDirection faceDirection, WallSection* section);
     static void ScanWallSectionImpl(TerrainTile* terrainTile, WallSection* section);
@@ -90,6 +103,16 @@ protected:
     void ConstructTiles_HeroGate3x1     (DungeonBuilder& builder, const TilesList& terrainTiles);
 
 protected:
+    // solid tile face which can be part of room wall
+    struct WallFace
+    {
+    public:
+        TerrainTile* mTile = nullptr;
+        eTileFace mFaceId = eTileFace_SideN;
+    };
+
     std::vector<WallSection*> mWallSections;
+    std::vector<WallSection*> mInvalidatedWallSections;
+    std::vector<WallFace> mWallFacesToScan;
     TilesList mInnerTiles;
 };
\ No newline at end of file
@@ -46,6 +46,11 @@ GpuBuffer::GpuBuffer(GraphicsDeviceContext& graphicsContext, eBufferContent buff
     , mBufferLength()
     , mBufferCapacity()
 {
+    if (mGraphicsContext.mNullBackend)
+    {
+        mResourceHandle = mGraphicsContext.AllocateNullHandle();
+        return;
+    }
     ::glGenBuffers(1, &mResourceHandle);
     glCheckError();
 }
@@ -54,6 +59,9 @@ GpuBuffer::~GpuBuffer()
 {
     SetUnbound();
 
+    if (mGraphicsContext.mNullBackend)
+        return;
+
     ::glDeleteBuffers(1, &mResourceHandle);
     glCheckError();
 }
@@ -64,6 +72,15 @@ void GpuBuffer::SetUnbound()
     {
         mGraphicsContext.mCurrentBuffers[mContent] = nullptr;
     }
+
+    // buffer object name might be reused, drop cached attributes setup
+    for (GraphicsDeviceContext::VertexStreamState& currStream: mGraphicsContext.mVertexStreams)
+    {
+        if (currStream.mSourceBuffer == this)
+        {
+            currStream.mSourceBuffer = nullptr;
+        }
+    }
 }
 
 bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const void* dataBuffer)
@@ -74,6 +91,17 @@ bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const
     mBufferCapacity = paddedContentLength;
     mUsageHint = bufferUsage;
     debug_assert(mUsageHint < eBufferUsage_COUNT);
+
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadBuffer, this, 0, dataBuffer ? bufferLength : 0);
+    if (mGraphicsContext.mNullBackend)
+    {
+        mNullStorage.assign(mBufferCapacity, 0);
+        if (dataBuffer)
+        {
+            ::memcpy(mNullStorage.data(), dataBuffer, bufferLength);
+        }
+        return true;
+    }
 
     ScopeBinder scopedBind {this};
     GLenum bufferTargetGL = EnumToGL(mContent);
@@ -117,6 +145,14 @@ bool GpuBuffer::Resize(unsigned int newLength)
 
     unsigned int newBufferCapacity = (newLength + 15U) & (~15U); // padded
 
+    if (mGraphicsContext.mNullBackend)
+    {
+        mNullStorage.resize(newBufferCapacity, 0);
+        mBufferCapacity = newBufferCapacity;
+        mBufferLength = newLength;
+        return true;
+    }
+
                                                                  // allocate new buffer and transfer data
     bool wasBound = IsBufferBound();
 
@@ -172,6 +208,13 @@ bool GpuBuffer::SubData(unsigned int dataOffset, unsigned int dataLength, const
     debug_assert(dataLength && dataSource);
     debug_assert(dataOffset + dataLength < mBufferCapacity);
 
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadBuffer, this, 0, dataLength);
+    if (mGraphicsContext.mNullBackend)
+    {
+        ::memcpy(mNullStorage.data() + dataOffset, dataSource, dataLength);
+        return true;
+    }
+
     ScopeBinder scopedBind {this};
     GLenum bufferTargetGL = EnumToGL(mContent);
     ::glBufferSubData(bufferTargetGL, dataOffset, dataLength, dataSource);
@@ -209,6 +252,14 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits, unsigned int bufferOffset, un
         return nullptr;
     }
 
+    if ((accessBits & BufferAccess_Write) > 0)
+    {
+        mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadBuffer, this, 0, dataLength);
+    }
+
+    if (mGraphicsContext.mNullBackend)
+        return mNullStorage.data() + bufferOffset;
+
     ScopeBinder scopedBind {this};
     GLenum bufferTargetGL = EnumToGL(mContent);
     void* pMappedData = ::glMapBufferRange(bufferTargetGL, bufferOffset, dataLength, accessBitsGL);
@@ -224,6 +275,9 @@ bool GpuBuffer::Unlock()
         return false;
     }
 
+    if (mGraphicsContext.mNullBackend)
+        return true;
+
     ScopeBinder scopedBind {this};
     GLenum bufferTargetGL = EnumToGL(mContent);
     GLboolean unmapResult = ::glUnmapBuffer(bufferTargetGL);
@@ -238,6 +292,9 @@ void GpuBuffer::Invalidate()
         debug_assert(false);
         return;
     }
+
+    if (mGraphicsContext.mNullBackend)
+        return;
 
     ScopeBinder scopedBind {this};
     GLenum bufferTargetGL = EnumToGL(mContent);
@@ -75,4 +75,5 @@ private:
 private:
     GpuBufferHandle mResourceHandle;
     GraphicsDeviceContext& mGraphicsContext;
+    std::vector<unsigned char> mNullStorage; // buffer content for null backend
 };
\ No newline at end of file
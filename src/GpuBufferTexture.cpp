@@ -42,6 +42,13 @@ GpuBufferTexture::GpuBufferTexture(GraphicsDeviceContext& graphicsContext)
     , mFormat()
     , mBufferLength()
 {
+    if (mGraphicsContext.mNullBackend)
+    {
+        mBufferHandle = mGraphicsContext.AllocateNullHandle();
+        mResourceHandle = mGraphicsContext.AllocateNullHandle();
+        return;
+    }
+
     ::glGenBuffers(1, &mBufferHandle);
     glCheckError();
 
@@ -53,6 +60,9 @@ GpuBufferTexture::~GpuBufferTexture()
 {
     SetUnbound();
 
+    if (mGraphicsContext.mNullBackend)
+        return;
+
     ::glDeleteTextures(1, &mResourceHandle);
     glCheckError();
 
@@ -78,13 +88,17 @@ bool GpuBufferTexture::Setup(eTextureFormat textureFormat, int dataLength, const
     {
         gConsole.LogMessage(eLogMessage_Warning, "Exceeded max texture buffer size (%d, max is %d)", dataLength, maxTextureBufferSize);
     }
+
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, sourceData ? dataLength : 0);
+    if (mGraphicsContext.mNullBackend)
+        return true;
     
     ScopeBinder scopedBind {this};
 
-	::glBindBuffer(GL_TEXTURE_BUFFER, mBufferHandle);
+    ::glBindBuffer(GL_TEXTURE_BUFFER, mBufferHandle);
     glCheckError();
 
-	::glBufferData(GL_TEXTURE_BUFFER, dataLength, sourceData, GL_DYNAMIC_DRAW);
+    ::glBufferData(GL_TEXTURE_BUFFER, dataLength, sourceData, GL_DYNAMIC_DRAW);
     glCheckError();
 
     ::glBindBuffer(GL_TEXTURE_BUFFER, 0);
@@ -128,10 +142,14 @@ bool GpuBufferTexture::Upload(int dataOffset, int dataLength, const void* source
     debug_assert(sourceData);
     debug_assert(dataOffset + dataLength <= mBufferLength);
 
-	::glBindBuffer(GL_TEXTURE_BUFFER, mBufferHandle);
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, dataLength);
+    if (mGraphicsContext.mNullBackend)
+        return true;
+
+    ::glBindBuffer(GL_TEXTURE_BUFFER, mBufferHandle);
     glCheckError();
 
-	::glBufferSubData(GL_TEXTURE_BUFFER, dataOffset, dataLength, sourceData);
+    ::glBufferSubData(GL_TEXTURE_BUFFER, dataOffset, dataLength, sourceData);
     glCheckError();
 
     ::glBindBuffer(GL_TEXTURE_BUFFER, 0);
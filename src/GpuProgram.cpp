@@ -94,7 +94,8 @@ bool GpuProgram::IsProgramConfigured() const
 bool GpuProgram::BindAttribute(eVertexAttribute attributeIdentifier, const char* attributeName)
 {
     mInputLayout.IncludeAttribute(attributeIdentifier);
-    mAttributes[attributeIdentifier] = QueryAttributeLocation(attributeName);
+    // null backend uses attribute identifiers as locations
+    mAttributes[attributeIdentifier] = mGraphicsContext.mNullBackend ? attributeIdentifier : QueryAttributeLocation(attributeName);
     if (mAttributes[attributeIdentifier] == GpuVariable_NULL)
     {
         debug_assert(false);
@@ -103,65 +104,90 @@ bool GpuProgram::BindAttribute(eVertexAttribute attributeIdentifier, const char*
     return true;
 }
 
-void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, float param0)
+bool GpuProgram::RecordUniformParam(GpuVariableLocation constantLocation)
 {
     debug_assert(constantLocation != GpuVariable_NULL);
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_SetUniform, this, constantLocation);
+    return !mGraphicsContext.mNullBackend;
+}
+
+void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, float param0)
+{
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform1f(mResourceHandle, constantLocation, param0);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, float param0, float param1)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform2f(mResourceHandle, constantLocation, param0, param1);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, float param0, float param1, float param2)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform3f(mResourceHandle, constantLocation, param0, param1, param2);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, int param0)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform1i(mResourceHandle, constantLocation, param0);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, const glm::vec2& floatVector2)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform2fv(mResourceHandle, constantLocation, 1, &floatVector2.x);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, const glm::vec3& floatVector3)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform3fv(mResourceHandle, constantLocation, 1, &floatVector3.x);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, const glm::vec4& floatVector4)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniform4fv(mResourceHandle, constantLocation, 1, &floatVector4.x);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, const glm::mat3& floatMatrix3)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniformMatrix3fv(mResourceHandle, constantLocation, 1, GL_FALSE, &floatMatrix3[0][0]);
     glCheckError();
 }
 
 void GpuProgram::SetUniformParam(GpuVariableLocation constantLocation, const glm::mat4& floatMatrix4)
 {
-    debug_assert(constantLocation != GpuVariable_NULL);
+    if (!RecordUniformParam(constantLocation))
+        return;
+
     ::glProgramUniformMatrix4fv(mResourceHandle, constantLocation, 1, GL_FALSE, &floatMatrix4[0][0]);
     glCheckError();
 }
@@ -174,6 +200,21 @@ bool GpuProgram::CompileSourceCode(const char* shaderSource)
         mGraphicsContext.mCurrentProgram = nullptr;
     }
 
+    if (mGraphicsContext.mNullBackend)
+    {
+        // shader source is not validated
+        FreeProgram();
+        mResourceHandle = mGraphicsContext.AllocateNullHandle();
+        mInputLayout.mEnabledAttributes = 0;
+
+        for (GpuVariableLocation& location: mAttributes) { location = GpuVariable_NULL; }
+        for (int isampler = 0; isampler < eTextureUnit_COUNT; ++isampler) 
+        { 
+            mSamplers[isampler] = isampler; 
+        }
+        return true;
+    }
+
     bool isSuccessed = false;
     {
         // create temporary program
@@ -281,14 +322,20 @@ void GpuProgram::FreeProgram()
     if (mResourceHandle == GpuProgramHandle_NULL)
         return;
 
-    ::glDeleteProgram(mResourceHandle);
-    glCheckError();
+    if (!mGraphicsContext.mNullBackend)
+    {
+        ::glDeleteProgram(mResourceHandle);
+        glCheckError();
+    }
 
     mResourceHandle = GpuProgramHandle_NULL;
 }
 
 GpuVariableLocation GpuProgram::QueryUniformLocation(const char* constantName) const
 {
+    if (mGraphicsContext.mNullBackend)
+        return (GpuVariableLocation) mGraphicsContext.AllocateNullHandle();
+
     GpuVariableLocation outLocation = ::glGetUniformLocation(mResourceHandle, constantName);
     glCheckError();
 
@@ -297,6 +344,9 @@ GpuVariableLocation GpuProgram::QueryUniformLocation(const char* constantName) c
 
 GpuVariableLocation GpuProgram::QueryAttributeLocation(const char* attributeName) const
 {
+    if (mGraphicsContext.mNullBackend)
+        return GpuVariable_NULL;
+
     GpuVariableLocation outLocation = ::glGetAttribLocation(mResourceHandle, attributeName);
     glCheckError();
 
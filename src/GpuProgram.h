@@ -51,6 +51,9 @@ private:
     bool CompileSourceCode(GpuProgramHandle targetHandle, const char* programSrc);
     void SetUnbound();
 
+    // record uniform update, returns false if it must not be issued to opengl
+    bool RecordUniformParam(GpuVariableLocation constantLocation);
+
 private:
     GpuProgramHandle mResourceHandle;
     GpuVariableLocation mAttributes[eVertexAttribute_MAX];
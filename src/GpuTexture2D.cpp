@@ -83,6 +83,15 @@ bool GpuTexture2D::InitTextureObject(const Texture2D_Desc& textureDesc, const vo
         return false;
     }
 
+    if (mGraphicsContext.mNullBackend)
+    {
+        mResourceHandle = mGraphicsContext.AllocateNullHandle();
+        mDesc = textureDesc;
+        mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, 
+            sourceData ? GetTextureDataSize(mDesc.mTextureFormat, mDesc.mDimensions, 0) : 0);
+        return true;
+    }
+
     ::glGenTextures(1, &mResourceHandle);
     glCheckError();
 
@@ -94,6 +103,8 @@ bool GpuTexture2D::InitTextureObject(const Texture2D_Desc& textureDesc, const vo
 
     // init texture data
     mDesc = textureDesc;
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, 
+        sourceData ? GetTextureDataSize(mDesc.mTextureFormat, mDesc.mDimensions, 0) : 0);
 
     ScopeBinder scopedBind {this};
 
@@ -135,8 +146,12 @@ void GpuTexture2D::FreeTextureObject()
         SetUnbound();
 
         // destroy opengl object
-        ::glDeleteTextures(1, &mResourceHandle);
-        glCheckError();
+        if (!mGraphicsContext.mNullBackend)
+        {
+            ::glDeleteTextures(1, &mResourceHandle);
+            glCheckError();
+        }
+        mResourceHandle = GpuTextureHandle_NULL;
     }
     // clear desc
     mDesc = Texture2D_Desc();
@@ -154,6 +169,8 @@ bool GpuTexture2D::SetSamplerState(const TextureSamplerState& samplerState)
         return true;
 
     mSamplerState = samplerState;
+    if (mGraphicsContext.mNullBackend)
+        return true;
 
     ScopeBinder scopedBind {this};
     SetSamplerStateImpl();
@@ -210,6 +227,11 @@ bool GpuTexture2D::TexSubImage(int mipmapLevel, const Rectangle& rc, const void*
         debug_assert(false);
         return false;
     }
+
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, mipmapLevel, 
+        GetTextureDataSize(mDesc.mTextureFormat, Point(rc.w, rc.h), 0));
+    if (mGraphicsContext.mNullBackend)
+        return true;
 
     ScopeBinder scopedBind {this};
     ::glTexSubImage2D(GL_TEXTURE_2D, mipmapLevel, rc.x, rc.y, rc.w, rc.h, gl_format, gl_data_type, sourceData);
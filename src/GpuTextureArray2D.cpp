@@ -44,6 +44,11 @@ GpuTextureArray2D::GpuTextureArray2D(GraphicsDeviceContext& graphicsContext)
     , mFormat()
     , mLayersCount()
 {
+    if (mGraphicsContext.mNullBackend)
+    {
+        mResourceHandle = mGraphicsContext.AllocateNullHandle();
+        return;
+    }
     ::glGenTextures(1, &mResourceHandle);
     glCheckError();
 }
@@ -52,6 +57,9 @@ GpuTextureArray2D::~GpuTextureArray2D()
 {
     SetUnbound();
 
+    if (mGraphicsContext.mNullBackend)
+        return;
+
     ::glDeleteTextures(1, &mResourceHandle);
     glCheckError();
 }
@@ -79,6 +87,15 @@ bool GpuTextureArray2D::Setup(eTextureFormat textureFormat, const Point& dimensi
         mLayersCount = MaxLayers;
     }
 
+    const int layerDataLength = GetTextureDataSize(mFormat, mSize, 0);
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, sourceData ? layerDataLength * layersCount : 0);
+    if (mGraphicsContext.mNullBackend)
+    {
+        mFiltering = eTextureFilterMode_Nearest;
+        mRepeating = eTextureRepeatMode_ClampToEdge;
+        return true;
+    }
+
     ScopeBinder scopedBind {this};
 
     ::glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, internalFormatGL, mSize.x, mSize.y, layersCount);
@@ -112,6 +129,11 @@ bool GpuTextureArray2D::Upload(int startLayerIndex, int layersCount, const void*
         return false;
     }
 
+    const int layerDataLength = GetTextureDataSize(mFormat, mSize, 0);
+    mGraphicsContext.mCommandStream.Record(eGraphicsCommand_UploadTexture, this, 0, layerDataLength * layersCount);
+    if (mGraphicsContext.mNullBackend)
+        return true;
+
     ScopeBinder scopedBind {this};
 
     glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, startLayerIndex, mSize.x, mSize.y, layersCount, formatGL, dataType, sourceData);
@@ -131,6 +153,13 @@ void GpuTextureArray2D::SetSamplerState(eTextureFilterMode filtering, eTextureRe
     if (mFiltering == filtering && mRepeating == repeating)
         return;
 
+    if (mGraphicsContext.mNullBackend)
+    {
+        mFiltering = filtering;
+        mRepeating = repeating;
+        return;
+    }
+
     ScopeBinder scopedBind {this};
 
     SetSamplerStateImpl(filtering, repeating);
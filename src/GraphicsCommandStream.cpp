@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "GraphicsCommandStream.h"
+#include "Console.h"
+
+GraphicsCommandStream::GraphicsCommandStream()
+{
+    Clear();
+}
+
+void GraphicsCommandStream::SetRecording(bool isEnabled, bool recordDetails)
+{
+    mRecordingEnabled = isEnabled;
+    mRecordDetails = isEnabled && recordDetails;
+    if (!mRecordDetails)
+    {
+        mCommands.shrink_to_fit();
+    }
+    Clear();
+}
+
+void GraphicsCommandStream::Clear()
+{
+    mCommands.clear();
+    for (int& currCount: mCommandsCount)
+    {
+        currCount = 0;
+    }
+    mBytesTransferred = 0;
+}
+
+void GraphicsCommandStream::DumpCommands(bool printCommands) const
+{
+    if (printCommands)
+    {
+        for (const GraphicsCommand& currCommand: mCommands)
+        {
+            gConsole.LogMessage(eLogMessage_Debug, " %s (%p, %u, %u bytes)", cxx::enum_to_string(currCommand.mCommand),
+                currCommand.mResource, currCommand.mParam, currCommand.mDataLength);
+        }
+    }
+
+    for (int icommand = 0; icommand < eGraphicsCommand_COUNT; ++icommand)
+    {
+        if (mCommandsCount[icommand] == 0)
+            continue;
+
+        gConsole.LogMessage(eLogMessage_Info, " - %s: %d", cxx::enum_to_string((eGraphicsCommand) icommand), mCommandsCount[icommand]);
+    }
+    gConsole.LogMessage(eLogMessage_Info, " - bytes transferred: %u", mBytesTransferred);
+}
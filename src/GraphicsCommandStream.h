@@ -0,0 +1,53 @@
+#pragma once
+
+// records graphics device commands issued during frame,
+// used to inspect renderers cost without gpu when device is created with null backend
+class GraphicsCommandStream: public cxx::noncopyable
+{
+public:
+    // readonly
+    std::vector<GraphicsCommand> mCommands; // commands of current frame, only if details are recorded
+    int mCommandsCount[eGraphicsCommand_COUNT];
+    unsigned int mBytesTransferred; // buffers and textures uploads
+
+public:
+    GraphicsCommandStream();
+
+    // start or stop recording, all recorded commands are discarded
+    // @param isEnabled: Enable commands counting
+    // @param recordDetails: Keep each command in list in addition to counters
+    void SetRecording(bool isEnabled, bool recordDetails);
+
+    // discard recorded commands, usually called at frame start
+    void Clear();
+
+    // print counters and optionally commands list to console
+    // @param printCommands: Print each recorded command
+    void DumpCommands(bool printCommands) const;
+
+    // test whether recording is enabled
+    inline bool IsRecording() const { return mRecordingEnabled; }
+
+    // add command to stream
+    // @param command: Command kind
+    // @param resource: Source resource, optional
+    // @param param: Texture unit or elements count
+    // @param dataLength: Bytes transferred
+    inline void Record(eGraphicsCommand command, const void* resource = nullptr, unsigned int param = 0, unsigned int dataLength = 0)
+    {
+        if (!mRecordingEnabled)
+            return;
+
+        debug_assert(command < eGraphicsCommand_COUNT);
+        ++mCommandsCount[command];
+        mBytesTransferred += dataLength;
+        if (mRecordDetails)
+        {
+            mCommands.push_back({command, resource, param, dataLength});
+        }
+    }
+
+private:
+    bool mRecordingEnabled = false;
+    bool mRecordDetails = false;
+};
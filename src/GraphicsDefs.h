@@ -64,8 +64,12 @@ public:
     glm::vec2 mTexcoord; // 8 bytes
                          // terrain tile logical coordinate
     unsigned short mTileCoord[2]; // x/y tile coordinate
+    unsigned short mTextureLayer; // within terrain textures array
 };
 
+// terrain vertex uses regular diffuse texture instead of textures array
+const unsigned short TerrainNoTextureLayer = 0xFFFF;
+
 const unsigned int Sizeof_Vertex3D_Terrain = sizeof(Vertex3D_Terrain);
 
 // render vertex 3d water lava mesh
@@ -78,6 +82,40 @@ public:
 
 const unsigned int Sizeof_Vertex3D_WaterLava = sizeof(Vertex3D_WaterLava);
 
+// compact render vertex 3d terrain mesh, position is quantized within terrain mesh bounds
+struct Vertex3D_TerrainCompact
+{
+public:
+    short mPosition[4]; // 8 bytes, snorm16, w is unused
+    unsigned short mTexcoord[2]; // 4 bytes, half floats
+                                 // terrain tile logical coordinate
+    unsigned short mTileCoord[2]; // x/y tile coordinate
+    unsigned short mTextureLayer; // within terrain textures array
+    unsigned short mPadding;
+};
+
+const unsigned int Sizeof_Vertex3D_TerrainCompact = sizeof(Vertex3D_TerrainCompact);
+
+// compact render vertex 3d water lava mesh
+struct Vertex3D_WaterLavaCompact
+{
+public:
+    unsigned short mPosition[4]; // 8 bytes, half floats, w is unused
+    unsigned short mTexcoord[2]; // 4 bytes, half floats
+};
+
+const unsigned int Sizeof_Vertex3D_WaterLavaCompact = sizeof(Vertex3D_WaterLavaCompact);
+
+// per instance data of animating model
+struct Vertex3D_AnimInstance
+{
+public:
+    glm::mat4 mTransformation; // 64 bytes
+    float mMixFrames; // 4 bytes
+};
+
+const unsigned int Sizeof_Vertex3D_AnimInstance = sizeof(Vertex3D_AnimInstance);
+
 //////////////////////////////////////////////////////////////////////////
 
 enum eTextureFilterMode
@@ -267,6 +305,19 @@ enum eIndicesType
 
 decl_enum_strings(eIndicesType);
 
+// get size of single index in bytes
+// @param indicesType: Indices type
+inline unsigned int GetIndexSizeBytes(eIndicesType indicesType)
+{
+    switch (indicesType)
+    {
+        case eIndicesType_i16: return sizeof(unsigned short);
+        case eIndicesType_i32: return sizeof(unsigned int);
+    }
+    debug_assert(false);
+    return 0;
+}
+
 enum eTextureUnit
 {
     eTextureUnit_0,
@@ -295,11 +346,17 @@ decl_enum_strings(eTextureUnit);
 // standard vertex attributes
 enum eVertexAttributeFormat
 {
+    eVertexAttributeFormat_1F,      // 1 float
     eVertexAttributeFormat_2F,      // 2 floats
     eVertexAttributeFormat_3F,      // 3 floats
+    eVertexAttributeFormat_4F,      // 4 floats
     eVertexAttributeFormat_4UB,     // 4 unsigned bytes
     eVertexAttributeFormat_1US,     // 1 unsigned short
     eVertexAttributeFormat_2US,     // 2 unsigned shorts
+    eVertexAttributeFormat_2S,      // 2 signed shorts
+    eVertexAttributeFormat_4S,      // 4 signed shorts
+    eVertexAttributeFormat_2HF,     // 2 half floats
+    eVertexAttributeFormat_4HF,     // 4 half floats
     eVertexAttributeFormat_Unknown
 };
 
@@ -316,23 +373,43 @@ enum eVertexAttribute
     eVertexAttribute_Color0,
     eVertexAttribute_Color1,
     eVertexAttribute_TerrainTilePosition,
+    eVertexAttribute_TerrainTextureLayer,
+    // per instance attributes
+    eVertexAttribute_InstanceTransform0,
+    eVertexAttribute_InstanceTransform1,
+    eVertexAttribute_InstanceTransform2,
+    eVertexAttribute_InstanceTransform3,
+    eVertexAttribute_InstanceMixFrames,
     eVertexAttribute_COUNT,
     eVertexAttribute_MAX = 16,
 };
 
 decl_enum_strings(eVertexAttribute);
 
+// test whether vertex attribute is fetched once per instance rather than per vertex
+// @param attribute: Attribute identifier
+inline bool IsInstanceAttribute(eVertexAttribute attribute)
+{
+    return attribute >= eVertexAttribute_InstanceTransform0 && attribute <= eVertexAttribute_InstanceMixFrames;
+}
+
 // get number of component for vertex attribute
 // @param attributeSemantics: Attribute semantics
 inline unsigned int GetAttributeComponentCount(eVertexAttributeFormat attributeFormat)
 {
     switch (attributeFormat)
     {
+        case eVertexAttributeFormat_1F: return 1;
         case eVertexAttributeFormat_2F: return 2;
         case eVertexAttributeFormat_3F: return 3;
+        case eVertexAttributeFormat_4F: return 4;
         case eVertexAttributeFormat_4UB: return 4;
         case eVertexAttributeFormat_1US: return 1;
         case eVertexAttributeFormat_2US: return 2;
+        case eVertexAttributeFormat_2S: return 2;
+        case eVertexAttributeFormat_4S: return 4;
+        case eVertexAttributeFormat_2HF: return 2;
+        case eVertexAttributeFormat_4HF: return 4;
     }
     debug_assert(false);
     return 0;
@@ -344,16 +421,77 @@ inline unsigned int GetAttributeSizeBytes(eVertexAttributeFormat attributeFormat
 {
     switch (attributeFormat)
     {
+        case eVertexAttributeFormat_1F: return 1 * sizeof(float);
         case eVertexAttributeFormat_2F: return 2 * sizeof(float);
         case eVertexAttributeFormat_3F: return 3 * sizeof(float);
+        case eVertexAttributeFormat_4F: return 4 * sizeof(float);
         case eVertexAttributeFormat_4UB: return 4 * sizeof(unsigned char);
         case eVertexAttributeFormat_1US: return 1 * sizeof(unsigned short);
         case eVertexAttributeFormat_2US: return 2 * sizeof(unsigned short);
+        case eVertexAttributeFormat_2S: return 2 * sizeof(short);
+        case eVertexAttributeFormat_4S: return 4 * sizeof(short);
+        case eVertexAttributeFormat_2HF: return 2 * sizeof(unsigned short);
+        case eVertexAttributeFormat_4HF: return 4 * sizeof(unsigned short);
     }
     debug_assert(false);
     return 0;
 }
 
+// quantize value to half precision float
+inline unsigned short PackHalfFloat(float value)
+{
+    return glm::packHalf1x16(value);
+}
+
+// quantize value within [-1, 1] range to signed normalized short
+inline short PackSnorm16(float value)
+{
+    return (short) std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+// quantize position to signed normalized shorts relative to bounds, bounds center maps to zero
+// @param position: Source position, will be clamped to bounds
+// @param bounds: Quantization bounds
+// @param output: Three components
+inline void PackPositionSnorm16(const glm::vec3& position, const cxx::aabbox& bounds, short* output)
+{
+    const glm::vec3 center = (bounds.mMin + bounds.mMax) * 0.5f;
+    const glm::vec3 halfExtents = glm::max((bounds.mMax - bounds.mMin) * 0.5f, glm::vec3(0.0001f));
+    const glm::vec3 normalized = (position - center) / halfExtents;
+    output[0] = PackSnorm16(normalized.x);
+    output[1] = PackSnorm16(normalized.y);
+    output[2] = PackSnorm16(normalized.z);
+}
+
+// get transformation that restores positions quantized with PackPositionSnorm16
+// @param bounds: Quantization bounds
+inline glm::mat4 GetDequantizeMatrix(const cxx::aabbox& bounds)
+{
+    const glm::vec3 center = (bounds.mMin + bounds.mMax) * 0.5f;
+    const glm::vec3 halfExtents = glm::max((bounds.mMax - bounds.mMin) * 0.5f, glm::vec3(0.0001f));
+    return glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtents);
+}
+
+// encode unit vector with octahedral mapping to two signed normalized shorts
+// @param normal: Source unit vector
+// @param output: Two components
+inline void PackOctahedralNormal(const glm::vec3& normal, short* output)
+{
+    const float invLength = 1.0f / std::max(std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z), 0.0001f);
+    float octx = normal.x * invLength;
+    float octy = normal.y * invLength;
+    if (normal.z < 0.0f)
+    {
+        // fold lower hemisphere
+        const float foldx = (1.0f - std::fabs(octy)) * (octx >= 0.0f ? 1.0f : -1.0f);
+        const float foldy = (1.0f - std::fabs(octx)) * (octy >= 0.0f ? 1.0f : -1.0f);
+        octx = foldx;
+        octy = foldy;
+    }
+    output[0] = PackSnorm16(octx);
+    output[1] = PackSnorm16(octy);
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 enum eBufferContent
@@ -494,9 +632,47 @@ enum eGraphicsDeviceFeature
 {
     eGraphicsDeviceFeature_NPOT_Textures,
     eGraphicsDeviceFeature_ABGR,
+    eGraphicsDeviceFeature_Instancing, // per instance vertex attributes
     eGraphicsDeviceFeature_COUNT
 };
 
+// recorded graphics device command kind
+enum eGraphicsCommand
+{
+    eGraphicsCommand_BindProgram,
+    eGraphicsCommand_BindVertexBuffer,
+    eGraphicsCommand_BindIndexBuffer,
+    eGraphicsCommand_BindTexture,
+    eGraphicsCommand_SetRenderStates,
+    eGraphicsCommand_SetUniform,
+    eGraphicsCommand_UploadBuffer,
+    eGraphicsCommand_UploadTexture,
+    eGraphicsCommand_Draw,
+    eGraphicsCommand_ClearScreen,
+    eGraphicsCommand_COUNT
+};
+
+decl_enum_strings(eGraphicsCommand);
+
+struct GraphicsCommand
+{
+public:
+    eGraphicsCommand mCommand;
+    const void* mResource; // program, buffer, texture or null
+    unsigned int mParam; // texture unit or elements count for draws
+    unsigned int mDataLength; // bytes transferred for uploads
+};
+
+// per frame render statistics
+struct GraphicsDeviceStats
+{
+public:
+    int mDrawCalls = 0; // number of issued draw commands
+    int mInstancesDrawn = 0; // number of rendered geometry instances, including non instanced draws
+    int mStateChanges = 0; // number of program, buffer, texture and render states switches
+    int mStateChangesSkipped = 0; // number of redundant switches that were not issued
+};
+
 struct GraphicsDeviceCaps
 {
 public:
@@ -11,6 +11,10 @@
 #include "GpuTextureArray2D.h"
 
 GraphicsDevice gGraphicsDevice;
+
+// null backend reports generous limits so that resources setup is not clamped
+const int NullBackendMaxArrayTextureLayers = 2048;
+const int NullBackendMaxTextureBufferSize = 128 * 1024 * 1024;
 
 // globals
 static GLFWwindow* gGLFW_WindowHandle = nullptr;
@@ -106,6 +110,9 @@ bool GraphicsDevice::Initialize()
         mScreenResolution.x, mScreenResolution.y, 
         settings.mEnableVSync ? "enabled" : "disabled", settings.mEnableVSync ? "yes" : "no");
 
+    if (gSystem.mStartupParams.mHeadless)
+        return InitializeNullBackend();
+
     if (::glfwInit() == GL_FALSE)
     {
         gConsole.LogMessage(eLogMessage_Warning, "GLFW initialization failed");
@@ -286,8 +293,33 @@ bool GraphicsDevice::Initialize()
     return true;
 }
 
+bool GraphicsDevice::InitializeNullBackend()
+{
+    gConsole.LogMessage(eLogMessage_Info, "Graphics device null backend, commands are recorded but not issued");
+
+    mDeviceContext.mNullBackend = true;
+    mCaps.mMaxArrayTextureLayers = NullBackendMaxArrayTextureLayers;
+    mCaps.mMaxTextureBufferSize = NullBackendMaxTextureBufferSize;
+
+    mViewportRect.Set(0, 0, mScreenResolution.x, mScreenResolution.y);
+    mScissorBox = mViewportRect;
+    mCurrentStates = RenderStates();
+
+    mDeviceContext.mCommandStream.SetRecording(true, false);
+    return true;
+}
+
 void GraphicsDevice::Deinit()
 {
+    if (mDeviceContext.mNullBackend)
+    {
+        mDeviceContext.mCommandStream.SetRecording(false, false);
+        mDeviceContext.mNullBackend = false;
+        mScreenResolution.x = 0;
+        mScreenResolution.y = 0;
+        return;
+    }
+
     if (gGLFW_WindowHandle == nullptr)
         return;
 
@@ -309,13 +341,19 @@ void GraphicsDevice::Deinit()
 
 void GraphicsDevice::EnableVSync(bool vsyncEnabled)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    if (mDeviceContext.mNullBackend)
+        return;
+
     ::glfwSwapInterval(vsyncEnabled ? 1 : 0);
 }
 
 void GraphicsDevice::EnableFullscreen(bool fullscreenEnabled)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    if (mDeviceContext.mNullBackend)
+        return;
+
     if (gGLFW_MonitorHandle == nullptr && fullscreenEnabled)
     {
         gGLFW_MonitorHandle = ::glfwGetPrimaryMonitor();
@@ -376,6 +414,7 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
 {
     mCaps.mFeatures[eGraphicsDeviceFeature_NPOT_Textures] = (GLEW_ARB_texture_non_power_of_two == GL_TRUE);
     mCaps.mFeatures[eGraphicsDeviceFeature_ABGR] = (GLEW_EXT_abgr == GL_TRUE);
+    mCaps.mFeatures[eGraphicsDeviceFeature_Instancing] = (GLEW_VERSION_3_3 == GL_TRUE);
 
     ::glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &mCaps.mMaxTextureBufferSize);
     glCheckError();
@@ -391,7 +430,18 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
 void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, bool forceState)
 {
     if (mCurrentStates == renderStates && !forceState)
+    {
+        ++mFrameStats.mStateChangesSkipped;
+        return;
+    }
+
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_SetRenderStates);
+    if (mDeviceContext.mNullBackend)
+    {
+        mCurrentStates = renderStates;
+        ++mFrameStats.mStateChanges;
         return;
+    }
 
     // polygon mode
     if (forceState || (mCurrentStates.mPolygonFillMode != renderStates.mPolygonFillMode))
@@ -535,11 +585,15 @@ void GraphicsDevice::InternalSetRenderStates(const RenderStates& renderStates, b
     }
 
     mCurrentStates = renderStates;
+    ++mFrameStats.mStateChanges;
 }
 
 void GraphicsDevice::ProcessInputEvents()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    if (mDeviceContext.mNullBackend)
+        return;
+
     // process window messages
     ::glfwPollEvents();
     if (::glfwWindowShouldClose(gGLFW_WindowHandle) == GL_TRUE)
@@ -551,35 +605,49 @@ void GraphicsDevice::ProcessInputEvents()
 
 void GraphicsDevice::Present()
 {
-    debug_assert(gGLFW_WindowHandle);
-    ::glfwSwapBuffers(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glfwSwapBuffers(gGLFW_WindowHandle);
+    }
+
+    mPrevFrameStats = mFrameStats;
+    mFrameStats = GraphicsDeviceStats();
 }
 
 void GraphicsDevice::SetViewportRect(const Rectangle& sourceRectangle)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     if (mViewportRect == sourceRectangle)
         return;
 
     mViewportRect = sourceRectangle;
+    if (mDeviceContext.mNullBackend)
+        return;
+
     ::glViewport(mViewportRect.x, mViewportRect.y, mViewportRect.w, mViewportRect.h);
     glCheckError();
 }
 
 void GraphicsDevice::SetScissorRect(const Rectangle& sourceRectangle)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     if (mScissorBox == sourceRectangle)
         return;
 
     mScissorBox = sourceRectangle;
+    if (mDeviceContext.mNullBackend)
+        return;
+
     ::glScissor(mScissorBox.x, mScissorBox.y, mScissorBox.w, mScissorBox.h);
     glCheckError();
 }
 
 void GraphicsDevice::SetClearColor(Color32 clearColor)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    if (mDeviceContext.mNullBackend)
+        return;
 
     const float inv = 1.0f / 255.0f;
     ::glClearColor(clearColor.mR * inv, clearColor.mG * inv, clearColor.mB * inv, clearColor.mA * inv);
@@ -588,7 +656,11 @@ void GraphicsDevice::SetClearColor(Color32 clearColor)
 
 void GraphicsDevice::ClearScreen()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_ClearScreen);
+    if (mDeviceContext.mNullBackend)
+        return;
 
     ::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glCheckError();
@@ -596,7 +668,7 @@ void GraphicsDevice::ClearScreen()
 
 GpuBufferTexture* GraphicsDevice::CreateBufferTexture()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuBufferTexture* texture = new GpuBufferTexture(mDeviceContext);
     return texture;
@@ -604,7 +676,7 @@ GpuBufferTexture* GraphicsDevice::CreateBufferTexture()
 
 GpuBufferTexture* GraphicsDevice::CreateBufferTexture(eTextureFormat textureFormat, int dataLength, const void* sourceData)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuBufferTexture* texture = new GpuBufferTexture(mDeviceContext);
     if (!texture->Setup(textureFormat, dataLength, sourceData))
@@ -617,7 +689,7 @@ GpuBufferTexture* GraphicsDevice::CreateBufferTexture(eTextureFormat textureForm
 
 GpuTexture2D* GraphicsDevice::CreateTexture2D()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuTexture2D* texture = new GpuTexture2D(mDeviceContext);
     return texture;
@@ -625,7 +697,7 @@ GpuTexture2D* GraphicsDevice::CreateTexture2D()
 
 GpuTextureArray2D* GraphicsDevice::CreateTextureArray2D()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuTextureArray2D* texture = new GpuTextureArray2D(mDeviceContext);
     return texture;   
@@ -633,7 +705,7 @@ GpuTextureArray2D* GraphicsDevice::CreateTextureArray2D()
 
 GpuTextureArray2D* GraphicsDevice::CreateTextureArray2D(eTextureFormat textureFormat, const Point& dimensions, int layersCount, const void* sourceData)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuTextureArray2D* texture = new GpuTextureArray2D(mDeviceContext);
     if (!texture->Setup(textureFormat, dimensions, layersCount, sourceData))
@@ -646,7 +718,7 @@ GpuTextureArray2D* GraphicsDevice::CreateTextureArray2D(eTextureFormat textureFo
 
 GpuProgram* GraphicsDevice::CreateRenderProgram()
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuProgram* program = new GpuProgram(mDeviceContext);
     return program;
@@ -654,7 +726,7 @@ GpuProgram* GraphicsDevice::CreateRenderProgram()
 
 GpuProgram* GraphicsDevice::CreateRenderProgram(const char* shaderSource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuProgram* program = new GpuProgram(mDeviceContext);
     if (!program->CompileSourceCode(shaderSource))
@@ -667,7 +739,7 @@ GpuProgram* GraphicsDevice::CreateRenderProgram(const char* shaderSource)
 
 GpuBuffer* GraphicsDevice::CreateBuffer(eBufferContent bufferContent)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(bufferContent < eBufferContent_COUNT);
     GpuBuffer* bufferObject = new GpuBuffer(mDeviceContext, bufferContent);
     return bufferObject;
@@ -675,7 +747,7 @@ GpuBuffer* GraphicsDevice::CreateBuffer(eBufferContent bufferContent)
 
 GpuBuffer* GraphicsDevice::CreateBuffer(eBufferContent bufferContent, eBufferUsage bufferUsage, unsigned int bufferLength, const void* dataBuffer)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(bufferContent < eBufferContent_COUNT);
     GpuBuffer* bufferObject = new GpuBuffer(mDeviceContext, bufferContent);
     if (!bufferObject->Setup(bufferUsage, bufferLength, dataBuffer))
@@ -688,7 +760,7 @@ GpuBuffer* GraphicsDevice::CreateBuffer(eBufferContent bufferContent, eBufferUsa
 
 void GraphicsDevice::BindVertexBuffer(GpuBuffer* sourceBuffer, const VertexFormat& streamDefinition)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(mDeviceContext.mCurrentProgram);
     if (sourceBuffer)
     {
@@ -697,30 +769,56 @@ void GraphicsDevice::BindVertexBuffer(GpuBuffer* sourceBuffer, const VertexForma
 
     if (mDeviceContext.mCurrentBuffers[eBufferContent_Vertices] != sourceBuffer)
     {
-        GLenum bufferTargetGL = EnumToGL(eBufferContent_Vertices);
         mDeviceContext.mCurrentBuffers[eBufferContent_Vertices] = sourceBuffer;
-        ::glBindBuffer(bufferTargetGL, sourceBuffer ? sourceBuffer->mResourceHandle : 0);
-        glCheckError();
+        if (!mDeviceContext.mNullBackend)
+        {
+            GLenum bufferTargetGL = EnumToGL(eBufferContent_Vertices);
+            ::glBindBuffer(bufferTargetGL, sourceBuffer ? sourceBuffer->mResourceHandle : 0);
+            glCheckError();
+        }
     }
 
-    if (sourceBuffer)
+    if (sourceBuffer == nullptr)
+        return;
+
+    // attributes setup is kept until program changes
+    GraphicsDeviceContext::VertexStreamState& streamState = mDeviceContext.mVertexStreams[streamDefinition.mInstanceDivisor > 0 ? 1 : 0];
+    if (streamState.mSourceBuffer == sourceBuffer && streamState.mFormat == streamDefinition)
+    {
+        ++mFrameStats.mStateChangesSkipped;
+        return;
+    }
+
+    streamState.mSourceBuffer = sourceBuffer;
+    streamState.mFormat = streamDefinition;
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindVertexBuffer, sourceBuffer, streamDefinition.mInstanceDivisor);
+    if (!mDeviceContext.mNullBackend)
     {
         SetupVertexAttributes(streamDefinition);
     }
+    ++mFrameStats.mStateChanges;
 }
 
 void GraphicsDevice::BindIndexBuffer(GpuBuffer* sourceBuffer)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     if (sourceBuffer)
     {
         debug_assert(sourceBuffer->mContent == eBufferContent_Indices);
     }
 
     if (mDeviceContext.mCurrentBuffers[eBufferContent_Indices] == sourceBuffer)
+    {
+        ++mFrameStats.mStateChangesSkipped;
         return;
+    }
 
     mDeviceContext.mCurrentBuffers[eBufferContent_Indices] = sourceBuffer;
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindIndexBuffer, sourceBuffer);
+    ++mFrameStats.mStateChanges;
+    if (mDeviceContext.mNullBackend)
+        return;
+
     GLenum bufferTargetGL = EnumToGL(eBufferContent_Indices);
     ::glBindBuffer(bufferTargetGL, sourceBuffer ? sourceBuffer->mResourceHandle : 0);
     glCheckError();
@@ -728,62 +826,91 @@ void GraphicsDevice::BindIndexBuffer(GpuBuffer* sourceBuffer)
 
 void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuBufferTexture* texture)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureUnit < eTextureUnit_COUNT);
     if (mDeviceContext.mCurrentTextures[textureUnit].mBufferTexture == texture)
+    {
+        ++mFrameStats.mStateChangesSkipped;
         return;
-
-    ActivateTextureUnit(textureUnit);
+    }
 
     mDeviceContext.mCurrentTextures[textureUnit].mBufferTexture = texture;
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindTexture, texture, textureUnit);
+    ++mFrameStats.mStateChanges;
+    if (mDeviceContext.mNullBackend)
+        return;
+
+    ActivateTextureUnit(textureUnit);
     ::glBindTexture(GL_TEXTURE_BUFFER, texture ? texture->mResourceHandle : 0);
     glCheckError();
 }
 
 void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTexture2D* texture)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureUnit < eTextureUnit_COUNT);
     if (mDeviceContext.mCurrentTextures[textureUnit].mTexture2D == texture)
+    {
+        ++mFrameStats.mStateChangesSkipped;
         return;
-
-    ActivateTextureUnit(textureUnit);
+    }
 
     mDeviceContext.mCurrentTextures[textureUnit].mTexture2D = texture;
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindTexture, texture, textureUnit);
+    ++mFrameStats.mStateChanges;
+    if (mDeviceContext.mNullBackend)
+        return;
+
+    ActivateTextureUnit(textureUnit);
     ::glBindTexture(GL_TEXTURE_2D, texture ? texture->mResourceHandle : 0);
     glCheckError();
 }
 
 void GraphicsDevice::BindTexture(eTextureUnit textureUnit, GpuTextureArray2D* texture)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureUnit < eTextureUnit_COUNT);
     if (mDeviceContext.mCurrentTextures[textureUnit].mTextureArray2D == texture)
+    {
+        ++mFrameStats.mStateChangesSkipped;
         return;
-
-    ActivateTextureUnit(textureUnit);
+    }
 
     mDeviceContext.mCurrentTextures[textureUnit].mTextureArray2D = texture;
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindTexture, texture, textureUnit);
+    ++mFrameStats.mStateChanges;
+    if (mDeviceContext.mNullBackend)
+        return;
+
+    ActivateTextureUnit(textureUnit);
     ::glBindTexture(GL_TEXTURE_2D_ARRAY, texture ? texture->mResourceHandle : 0);
     glCheckError();
 }
 
 void GraphicsDevice::BindRenderProgram(GpuProgram* program)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     if (mDeviceContext.mCurrentProgram == program)
+    {
+        ++mFrameStats.mStateChangesSkipped;
         return;
+    }
 
     if (program)
     {
         debug_assert(program->IsProgramConfigured() && program->IsProgramConfigured());
     }
 
-    ::glUseProgram(program ? program->mResourceHandle : 0);
-    glCheckError();
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_BindProgram, program);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glUseProgram(program ? program->mResourceHandle : 0);
+        glCheckError();
+    }
+
+    bool programAttributes[eVertexAttribute_MAX] = {};
     if (program)
     {
-        bool programAttributes[eVertexAttribute_MAX] = {};
         for (int streamIndex = 0; streamIndex < eVertexAttribute_MAX; ++streamIndex)
         {
             if (program->mAttributes[streamIndex] == GpuVariable_NULL)
@@ -791,71 +918,77 @@ void GraphicsDevice::BindRenderProgram(GpuProgram* program)
 
             programAttributes[program->mAttributes[streamIndex]] = true;
         }
+    }
 
-        // setup attribute streams
-        for (int ivattribute = 0; ivattribute < eVertexAttribute_COUNT; ++ivattribute)
+    // setup attribute streams, toggle only locations that differ from previous program
+    for (int ivattribute = 0; ivattribute < eVertexAttribute_MAX; ++ivattribute)
+    {
+        if (mDeviceContext.mEnabledAttributes[ivattribute] == programAttributes[ivattribute])
+            continue;
+
+        mDeviceContext.mEnabledAttributes[ivattribute] = programAttributes[ivattribute];
+        if (mDeviceContext.mNullBackend)
+            continue;
+
+        if (programAttributes[ivattribute])
         {
-            if (programAttributes[ivattribute])
-            {
-                ::glEnableVertexAttribArray(ivattribute);
-                glCheckError();
-            }
-            else
-            {
-                ::glDisableVertexAttribArray(ivattribute);
-                glCheckError();
-            }
+            ::glEnableVertexAttribArray(ivattribute);
+            glCheckError();
         }
-    }
-    else
-    {
-        for (int ivattribute = 0; ivattribute < eVertexAttribute_MAX; ++ivattribute)
+        else
         {
             ::glDisableVertexAttribArray(ivattribute);
             glCheckError();
         }
     }
+
+    // attribute locations differ between programs
+    for (GraphicsDeviceContext::VertexStreamState& currStream: mDeviceContext.mVertexStreams)
+    {
+        currStream.mSourceBuffer = nullptr;
+    }
     mDeviceContext.mCurrentProgram = program;
+    ++mFrameStats.mStateChanges;
 }
 
 void GraphicsDevice::DestroyTexture(GpuBufferTexture* textureResource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureResource);
     delete textureResource;
 }
 
 void GraphicsDevice::DestroyTexture(GpuTexture2D* textureResource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureResource);
     delete textureResource;
 }
 
 void GraphicsDevice::DestroyTexture(GpuTextureArray2D* textureResource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(textureResource);
     delete textureResource;
 }
 
 void GraphicsDevice::DestroyProgram(GpuProgram* programResource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(programResource);
     delete programResource;
 }
 
 void GraphicsDevice::DestroyBuffer(GpuBuffer* bufferResource)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
     debug_assert(bufferResource);
     delete bufferResource;
 }
 
 void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indices, unsigned int offset, unsigned int numIndices)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuBuffer* indexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Indices];
     GpuBuffer* vertexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Vertices];
@@ -863,13 +996,20 @@ void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesT
 
     GLenum primitives = EnumToGL(primitive);
     GLenum indicesTypeGL = EnumToGL(indices);
-    ::glDrawElements(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset));
-    glCheckError();
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_Draw, mDeviceContext.mCurrentProgram, numIndices);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glDrawElements(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset));
+        glCheckError();
+    }
+
+    ++mFrameStats.mDrawCalls;
+    ++mFrameStats.mInstancesDrawn;
 }
 
 void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indices, unsigned int offset, unsigned int numIndices, unsigned int baseVertex)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuBuffer* indexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Indices];
     GpuBuffer* vertexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Vertices];
@@ -877,20 +1017,88 @@ void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesT
 
     GLenum primitives = EnumToGL(primitive);
     GLenum indicesTypeGL = EnumToGL(indices);
-    ::glDrawElementsBaseVertex(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset), baseVertex);
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_Draw, mDeviceContext.mCurrentProgram, numIndices);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glDrawElementsBaseVertex(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset), baseVertex);
+        glCheckError();
+    }
+
+    ++mFrameStats.mDrawCalls;
+    ++mFrameStats.mInstancesDrawn;
+}
+
+void GraphicsDevice::RenderIndexedPrimitivesInstanced(ePrimitiveType primitive, eIndicesType indices, unsigned int offset, unsigned int numIndices, unsigned int numInstances)
+{
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+
+    GpuBuffer* indexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Indices];
+    GpuBuffer* vertexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(indexBuffer && vertexBuffer && mDeviceContext.mCurrentProgram);
+
+    GLenum primitives = EnumToGL(primitive);
+    GLenum indicesTypeGL = EnumToGL(indices);
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_Draw, mDeviceContext.mCurrentProgram, numIndices * numInstances);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glDrawElementsInstanced(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset), numInstances);
+        glCheckError();
+    }
+
+    ++mFrameStats.mDrawCalls;
+    mFrameStats.mInstancesDrawn += numInstances;
+}
+
+void GraphicsDevice::RenderIndexedPrimitivesMulti(ePrimitiveType primitive, eIndicesType indices, const unsigned int* offsets, const int* numIndices, const int* baseVertices, int numRanges)
+{
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
+    debug_assert(offsets && numIndices && baseVertices);
+
+    GpuBuffer* indexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Indices];
+    GpuBuffer* vertexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(indexBuffer && vertexBuffer && mDeviceContext.mCurrentProgram);
+
+    if (numRanges < 1)
+        return;
+
+    ++mFrameStats.mDrawCalls;
+    ++mFrameStats.mInstancesDrawn;
+
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_Draw, mDeviceContext.mCurrentProgram, numRanges);
+    if (mDeviceContext.mNullBackend)
+        return;
+
+    mMultiDrawOffsets.resize(numRanges);
+    for (int irange = 0; irange < numRanges; ++irange)
+    {
+        mMultiDrawOffsets[irange] = BUFFER_OFFSET(offsets[irange]);
+    }
+
+    GLenum primitives = EnumToGL(primitive);
+    GLenum indicesTypeGL = EnumToGL(indices);
+    // bundled glew declares arrays as non-const, they are not modified by driver
+    ::glMultiDrawElementsBaseVertex(primitives, const_cast<GLsizei*>(numIndices), indicesTypeGL, mMultiDrawOffsets.data(), numRanges, 
+        const_cast<GLint*>(baseVertices));
     glCheckError();
 }
 
 void GraphicsDevice::RenderPrimitives(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements)
 {
-    debug_assert(gGLFW_WindowHandle);
+    debug_assert(gGLFW_WindowHandle || mDeviceContext.mNullBackend);
 
     GpuBuffer* vertexBuffer = mDeviceContext.mCurrentBuffers[eBufferContent_Vertices];
     debug_assert(vertexBuffer && mDeviceContext.mCurrentProgram);
 
     GLenum primitives = EnumToGL(primitiveType);
-    ::glDrawArrays(primitives, firstIndex, numElements);
-    glCheckError();
+    mDeviceContext.mCommandStream.Record(eGraphicsCommand_Draw, mDeviceContext.mCurrentProgram, numElements);
+    if (!mDeviceContext.mNullBackend)
+    {
+        ::glDrawArrays(primitives, firstIndex, numElements);
+        glCheckError();
+    }
+
+    ++mFrameStats.mDrawCalls;
+    ++mFrameStats.mInstancesDrawn;
 }
 
 void GraphicsDevice::ActivateTextureUnit(eTextureUnit textureUnit)
@@ -907,6 +1115,7 @@ void GraphicsDevice::ActivateTextureUnit(eTextureUnit textureUnit)
 void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
 {
     GpuProgram* currentProgram = mDeviceContext.mCurrentProgram;
+    const bool isInstanceStream = streamDefinition.mInstanceDivisor > 0;
     for (int iattribute = 0; iattribute < eVertexAttribute_COUNT; ++iattribute)
     {
         if (currentProgram->mAttributes[iattribute] == GpuVariable_NULL)
@@ -915,6 +1124,19 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
             continue;
         }
 
+        // per vertex and per instance attributes are fed from different streams
+        if (IsInstanceAttribute((eVertexAttribute) iattribute) != isInstanceStream)
+            continue;
+
+        // attribute locations are shared between programs so divisor must be reset for per vertex streams
+        GpuVariableLocation attributeLocation = currentProgram->mAttributes[iattribute];
+        if (mDeviceContext.mAttributeDivisors[attributeLocation] != streamDefinition.mInstanceDivisor)
+        {
+            mDeviceContext.mAttributeDivisors[attributeLocation] = streamDefinition.mInstanceDivisor;
+            ::glVertexAttribDivisor(attributeLocation, streamDefinition.mInstanceDivisor);
+            glCheckError();
+        }
+
         const auto& attribute = streamDefinition.mAttributes[iattribute];
         if (attribute.mFormat == eVertexAttributeFormat_Unknown)
         {
@@ -931,7 +1153,7 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
 
         GLenum dataType = GetAttributeDataTypeGL(attribute.mFormat);
 
-        if (dataType == GL_FLOAT || attribute.mNormalized)
+        if (dataType == GL_FLOAT || dataType == GL_HALF_FLOAT || attribute.mNormalized)
         {
             // set attribute location
             ::glVertexAttribPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
@@ -11,6 +11,8 @@ public:
     Rectangle mViewportRect;
     Rectangle mScissorBox;
     GraphicsDeviceCaps mCaps;
+    GraphicsDeviceStats mFrameStats; // accumulated during current frame
+    GraphicsDeviceStats mPrevFrameStats; // complete statistics of previous frame
 
     // current screen params
     Point mScreenResolution;
@@ -64,6 +66,7 @@ public:
     GpuBuffer* CreateBuffer(eBufferContent bufferContent, eBufferUsage bufferUsage, unsigned int bufferLength, const void* dataBuffer);
 
     // set source buffer for geometries vertex data and setup layout for bound shader
+    // per instance attributes stream could be bound after per vertex stream, both stay in use until next bind of same kind
     // @param sourceBuffer: Buffer reference or nullptr to unbind current
     // @param streamDefinition: Layout
     void BindVertexBuffer(GpuBuffer* sourceBuffer, const VertexFormat& streamDefinition);
@@ -113,6 +116,23 @@ public:
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices);
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices, unsigned int baseVertex);
 
+    // render multiple instances of indexed geometry, per instance attributes stream must be bound
+    // @param primitive: Type of primitives to render
+    // @param indicesType: Type of indices data
+    // @param offset: Offset within index buffer in bytes
+    // @param numIndices: Number of elements
+    // @param numInstances: Number of instances to render
+    void RenderIndexedPrimitivesInstanced(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices, unsigned int numInstances);
+
+    // render several ranges of indexed geometry with single call
+    // @param primitive: Type of primitives to render
+    // @param indicesType: Type of indices data
+    // @param offsets: Offsets within index buffer in bytes, per range
+    // @param numIndices: Number of elements, per range
+    // @param baseVertices: Constants added to indices, per range
+    // @param numRanges: Number of ranges to render
+    void RenderIndexedPrimitivesMulti(ePrimitiveType primitive, eIndicesType indicesType, const unsigned int* offsets, const int* numIndices, const int* baseVertices, int numRanges);
+
     // render geometry
     // @param primitiveType: Type of primitives to render
     // @param firstIndex: Start position in attribute buffers, index
@@ -140,6 +160,12 @@ public:
     // clear color and depth of current framebuffer
     void ClearScreen();
 
+    // test whether device was initialized without window and opengl context, see startup param -headless
+    inline bool IsNullBackend() const { return mDeviceContext.mNullBackend; }
+
+    // access recorded commands, null backend always records commands counters
+    inline GraphicsCommandStream& GetCommandStream() { return mDeviceContext.mCommandStream; }
+
     // get screen resolution aspect ratio
     float GetScreenResolutionAspect() const
     {
@@ -148,6 +174,7 @@ public:
 
 private:
     void InternalSetRenderStates(const RenderStates& renderStates, bool forceState);
+    bool InitializeNullBackend();
     bool InitOpenGLExtensions();
     void QueryGraphicsDeviceCaps();
     void ActivateTextureUnit(eTextureUnit textureUnit);
@@ -158,6 +185,8 @@ private:
 
 private:
     GraphicsDeviceContext mDeviceContext;
+
+    std::vector<void*> mMultiDrawOffsets; // scratch buffer
 };
 
 extern GraphicsDevice gGraphicsDevice;
\ No newline at end of file
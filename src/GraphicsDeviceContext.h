@@ -1,5 +1,8 @@
 #pragma once
 
+#include "VertexFormat.h"
+#include "GraphicsCommandStream.h"
+
 // represents current low level graphics device state which is does not intended for direct usage
 class GraphicsDeviceContext
 {
@@ -10,7 +13,17 @@ public:
         , mCurrentTextureUnit(eTextureUnit_0)
         , mCurrentTextures()
         , mCurrentProgram()
+        , mAttributeDivisors()
+        , mEnabledAttributes()
+        , mNullBackend()
+        , mNullHandlesCounter()
+    {
+    }
+
+    // get unique fake resource handle for null backend
+    inline unsigned int AllocateNullHandle()
     {
+        return ++mNullHandlesCounter;
     }
 public:
 
@@ -22,9 +35,24 @@ public:
         GpuTextureArray2D* mTextureArray2D = nullptr;
     };
 
+    // last attributes setup of vertex stream, valid until program changes
+    struct VertexStreamState
+    {
+        GpuBuffer* mSourceBuffer = nullptr; // null if attributes must be setup on next bind
+        VertexFormat mFormat;
+    };
+
     GpuVertexArrayHandle mMainVaoHandle;
     GpuBuffer* mCurrentBuffers[eBufferContent_COUNT];
     GpuProgram* mCurrentProgram;
     eTextureUnit mCurrentTextureUnit;
     TextureUnitState mCurrentTextures[eTextureUnit_COUNT];
+    unsigned int mAttributeDivisors[eVertexAttribute_MAX]; // per attribute location
+    bool mEnabledAttributes[eVertexAttribute_MAX]; // per attribute location
+    VertexStreamState mVertexStreams[2]; // per vertex and per instance attributes
+
+    // no window and opengl context is created, resources only keep their data and commands are recorded
+    bool mNullBackend;
+    unsigned int mNullHandlesCounter;
+    GraphicsCommandStream mCommandStream;
 };
\ No newline at end of file
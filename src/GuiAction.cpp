@@ -277,6 +277,7 @@ public:
     void HandlePerformAction(GuiWidget* targetWidget) override
     {
         targetWidget->mBackgroundColor = mBackgroundColor;
+        targetWidget->InvalidateRender();
     }
     bool HandleDeserialize(cxx::json_node_object actionNode) override
     {
@@ -0,0 +1,222 @@
+#include "pch.h"
+#include "GuiAtlasManager.h"
+#include "Texture2D.h"
+#include "Texture2D_Image.h"
+#include "ConsoleVariable.h"
+#include "Console.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarGui_TexturesAtlas ("gui_texturesAtlas", true, "Pack small gui textures into shared atlas pages to batch widgets quads", ConsoleVar_Gui);
+
+//////////////////////////////////////////////////////////////////////////
+
+GuiAtlasManager gGuiAtlasManager;
+
+bool GuiAtlasManager::Initialize()
+{
+    gConsole.RegisterVariable(&gCvarGui_TexturesAtlas);
+    gConsole.RegisterFunction("stat_guiAtlas", "Print gui atlas pages usage", [](const ConsoleFuncArgs& args)
+        {
+            gGuiAtlasManager.DumpAtlasPages();
+        });
+
+    return true;
+}
+
+void GuiAtlasManager::Deinit()
+{
+    gConsole.UnregisterVariable(&gCvarGui_TexturesAtlas);
+    gConsole.UnregisterFunction("stat_guiAtlas");
+
+    FreeAtlasPages();
+}
+
+const GuiAtlasEntry* GuiAtlasManager::GetAtlasEntry(Texture2D* texture)
+{
+    // animated textures cannot be packed
+    if (texture == nullptr || texture->HasProxyTexture())
+        return nullptr;
+
+    auto entries_iterator = mEntries.find(texture);
+    if (entries_iterator != mEntries.end())
+    {
+        const GuiAtlasEntry& atlasEntry = entries_iterator->second;
+        return atlasEntry.mPageTexture ? &atlasEntry : nullptr;
+    }
+
+    GuiAtlasEntry& atlasEntry = mEntries[texture];
+
+    Texture2D_Image imageData;
+    if (!texture->ReadTextureImage(imageData) || !PackImage(imageData, atlasEntry))
+    {
+        atlasEntry = GuiAtlasEntry();
+        return nullptr;
+    }
+    return &atlasEntry;
+}
+
+bool GuiAtlasManager::GetWhiteTexcoord(Texture2D* pageTexture, glm::vec2& texcoord) const
+{
+    for (const AtlasPage* currPage: mPages)
+    {
+        if (currPage->mTexture == pageTexture)
+        {
+            texcoord = currPage->mWhiteTexcoord;
+            return true;
+        }
+    }
+    return false;
+}
+
+int GuiAtlasManager::GetEntriesCount() const
+{
+    int entriesCount = 0;
+    for (const AtlasPage* currPage: mPages)
+    {
+        entriesCount += currPage->mEntriesCount;
+    }
+    return entriesCount;
+}
+
+void GuiAtlasManager::DumpAtlasPages() const
+{
+    gConsole.LogMessage(eLogMessage_Info, "Gui atlas (%s), pages: %d, textures: %d, not packed: %d", gCvarGui_TexturesAtlas.mValue ? "enabled" : "disabled",
+        GetPagesCount(), GetEntriesCount(), (int) mEntries.size() - GetEntriesCount());
+
+    for (int ipage = 0; ipage < GetPagesCount(); ++ipage)
+    {
+        const AtlasPage* currPage = mPages[ipage];
+        gConsole.LogMessage(eLogMessage_Info, " - page %d: %d textures, %.1f%% used", ipage, currPage->mEntriesCount,
+            (currPage->mUsedPixels * 100.0) / (PageDimensions * PageDimensions));
+    }
+}
+
+GuiAtlasManager::AtlasPage* GuiAtlasManager::AllocatePage()
+{
+    AtlasPage* atlasPage = new AtlasPage;
+    stbrp_init_target(&atlasPage->mPackContext, PageDimensions, PageDimensions, atlasPage->mPackNodes, PageDimensions);
+
+    Texture2D_Image pageImage;
+    Point pageDimensions { PageDimensions, PageDimensions };
+    if (!pageImage.CreateImage(eTextureFormat_RGBA8, pageDimensions, 0, true))
+    {
+        debug_assert(false);
+    }
+    ::memset(pageImage.GetImageDataBuffer(), 0, PageDimensions * PageDimensions * 4);
+
+    // reserve solid white area for untextured rects
+    stbrp_rect whiteRect {};
+    whiteRect.w = WhiteAreaDimensions;
+    whiteRect.h = WhiteAreaDimensions;
+    stbrp_pack_rects(&atlasPage->mPackContext, &whiteRect, 1);
+    debug_assert(whiteRect.was_packed);
+
+    for (int iy = 0; iy < WhiteAreaDimensions; ++iy)
+    {
+        unsigned char* whitePixels = pageImage.GetImageDataBuffer() + ((whiteRect.y + iy) * PageDimensions + whiteRect.x) * 4;
+        ::memset(whitePixels, 0xFF, WhiteAreaDimensions * 4);
+    }
+    atlasPage->mWhiteTexcoord.x = (whiteRect.x + WhiteAreaDimensions * 0.5f) / PageDimensions;
+    atlasPage->mWhiteTexcoord.y = (whiteRect.y + WhiteAreaDimensions * 0.5f) / PageDimensions;
+    atlasPage->mUsedPixels = WhiteAreaDimensions * WhiteAreaDimensions;
+
+    TextureSamplerState samplerState { eTextureFilterMode_Bilinear, eTextureRepeatMode_ClampToEdge };
+
+    atlasPage->mTexture = new Texture2D { cxx::va("gui_atlas_%d", GetPagesCount()) };
+    atlasPage->mTexture->SetPersistent(true);
+    atlasPage->mTexture->SetSamplerState(samplerState);
+    if (!atlasPage->mTexture->CreateTexture(pageImage))
+    {
+        debug_assert(false);
+    }
+
+    mPages.push_back(atlasPage);
+    return atlasPage;
+}
+
+void GuiAtlasManager::FreeAtlasPages()
+{
+    for (AtlasPage* currPage: mPages)
+    {
+        SafeDelete(currPage->mTexture);
+        SafeDelete(currPage);
+    }
+    mPages.clear();
+    mEntries.clear();
+    mUploadBuffer.clear();
+}
+
+bool GuiAtlasManager::PackImage(const Texture2D_Image& imageData, GuiAtlasEntry& atlasEntry)
+{
+    const Point& imageDimensions = imageData.mTextureDesc.mImageDimensions;
+    if (imageData.mTextureDesc.mTextureFormat != eTextureFormat_RGBA8 || imageDimensions.x < 1 || imageDimensions.y < 1 ||
+        imageDimensions.x > MaxEntryDimensions || imageDimensions.y > MaxEntryDimensions)
+    {
+        return false;
+    }
+
+    stbrp_rect packRect {};
+    packRect.w = imageDimensions.x + EntryPadding * 2;
+    packRect.h = imageDimensions.y + EntryPadding * 2;
+
+    // try existing pages first
+    AtlasPage* targetPage = nullptr;
+    for (AtlasPage* currPage: mPages)
+    {
+        if (stbrp_pack_rects(&currPage->mPackContext, &packRect, 1) && packRect.was_packed)
+        {
+            targetPage = currPage;
+            break;
+        }
+    }
+
+    if (targetPage == nullptr)
+    {
+        targetPage = AllocatePage();
+        if (!stbrp_pack_rects(&targetPage->mPackContext, &packRect, 1) || !packRect.was_packed)
+        {
+            debug_assert(false);
+            return false;
+        }
+    }
+
+    Rectangle paddedRect (packRect.x, packRect.y, packRect.w, packRect.h);
+    UploadImage(targetPage, paddedRect, imageData);
+
+    ++targetPage->mEntriesCount;
+    targetPage->mUsedPixels += paddedRect.w * paddedRect.h;
+
+    atlasEntry.mPageTexture = targetPage->mTexture;
+    atlasEntry.mPageRect.Set(paddedRect.x + EntryPadding, paddedRect.y + EntryPadding, imageDimensions.x, imageDimensions.y);
+    return true;
+}
+
+void GuiAtlasManager::UploadImage(AtlasPage* atlasPage, const Rectangle& paddedRect, const Texture2D_Image& imageData)
+{
+    const int BytesPerPixel = 4;
+
+    const Point& imageDimensions = imageData.mTextureDesc.mImageDimensions;
+    const int srcRowLength = imageData.mTextureDesc.mDimensions.x * BytesPerPixel;
+    const unsigned char* srcPixels = imageData.GetImageDataBuffer(0);
+
+    mUploadBuffer.resize(paddedRect.w * paddedRect.h * BytesPerPixel);
+
+    unsigned char* dstPixels = mUploadBuffer.data();
+    for (int iy = 0; iy < paddedRect.h; ++iy)
+    {
+        const int srcy = glm::clamp(iy - EntryPadding, 0, imageDimensions.y - 1);
+        for (int ix = 0; ix < paddedRect.w; ++ix)
+        {
+            const int srcx = glm::clamp(ix - EntryPadding, 0, imageDimensions.x - 1);
+            ::memcpy(dstPixels, srcPixels + srcy * srcRowLength + srcx * BytesPerPixel, BytesPerPixel);
+            dstPixels += BytesPerPixel;
+        }
+    }
+
+    if (!atlasPage->mTexture->UpdateTexture(0, paddedRect, mUploadBuffer.data()))
+    {
+        debug_assert(false);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "3rd_party/stb_rect_pack.h"
+
+// location of packed gui texture within atlas page
+struct GuiAtlasEntry
+{
+public:
+    Texture2D* mPageTexture = nullptr;
+    Rectangle mPageRect; // image area within page, padding is not included
+};
+
+// packs small gui textures into shared atlas pages,
+// so gui renderer can batch quads of different widgets without switching textures
+class GuiAtlasManager: public cxx::noncopyable
+{
+public:
+    static const int PageDimensions = 1024;
+    static const int MaxEntryDimensions = 256; // larger textures are drawn directly
+    static const int EntryPadding = 1; // border pixels are duplicated to avoid bleeding with bilinear filtering
+    static const int WhiteAreaDimensions = 4;
+
+public:
+    // setup atlas manager internal resources
+    bool Initialize();
+    void Deinit();
+
+    // find atlas location of texture or pack it into one of pages, image data is decoded on first request
+    // @param texture: Source gui texture
+    // @returns null if texture cannot be packed, it should be drawn directly
+    const GuiAtlasEntry* GetAtlasEntry(Texture2D* texture);
+
+    // get texture coordinate of white area within atlas page, used to draw solid rects without switching textures
+    // @param pageTexture: Atlas page texture
+    // @param texcoord: Output texture coordinate
+    // @returns false if texture is not atlas page
+    bool GetWhiteTexcoord(Texture2D* pageTexture, glm::vec2& texcoord) const;
+
+    // get number of allocated atlas pages
+    inline int GetPagesCount() const { return (int) mPages.size(); }
+
+    // get number of textures packed into pages
+    int GetEntriesCount() const;
+
+    // print atlas pages usage to console
+    void DumpAtlasPages() const;
+
+private:
+    struct AtlasPage
+    {
+    public:
+        Texture2D* mTexture = nullptr;
+        stbrp_context mPackContext;
+        stbrp_node mPackNodes[PageDimensions];
+        glm::vec2 mWhiteTexcoord;
+        int mEntriesCount = 0;
+        int mUsedPixels = 0;
+    };
+
+    AtlasPage* AllocatePage();
+    void FreeAtlasPages();
+
+    bool PackImage(const Texture2D_Image& imageData, GuiAtlasEntry& atlasEntry);
+
+    // copy image with duplicated borders to atlas page
+    void UploadImage(AtlasPage* atlasPage, const Rectangle& paddedRect, const Texture2D_Image& imageData);
+
+private:
+    std::vector<AtlasPage*> mPages;
+    std::map<Texture2D*, GuiAtlasEntry> mEntries; // empty entry if texture cannot be packed
+    ByteArray mUploadBuffer;
+};
+
+extern GuiAtlasManager gGuiAtlasManager;
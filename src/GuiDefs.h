@@ -150,6 +150,29 @@ public:
         mPoints[3].mPosition.x  = mPoints[2].mPosition.x;
         mPoints[3].mPosition.y  = mPoints[0].mPosition.y;
     }
+    // setup quad vertices with explicit texture coordinates, used for textures packed into atlas
+    inline void SetupVertices(const glm::vec2& texcoordMin, const glm::vec2& texcoordMax, const Rectangle& rcQuad, Color32 color)
+    {
+        // setup quad vertices in specific order
+        mPoints[0].mColor       = color;
+        mPoints[0].mTexcoord    = texcoordMin;
+        mPoints[0].mPosition.x  = rcQuad.x * 1.0f;
+        mPoints[0].mPosition.y  = rcQuad.y * 1.0f;
+        mPoints[1].mColor       = color;
+        mPoints[1].mTexcoord[0] = texcoordMin.x;
+        mPoints[1].mTexcoord[1] = texcoordMax.y;
+        mPoints[1].mPosition.x  = mPoints[0].mPosition.x;
+        mPoints[1].mPosition.y  = (rcQuad.y + rcQuad.h) * 1.0f;
+        mPoints[2].mColor       = color;
+        mPoints[2].mTexcoord    = texcoordMax;
+        mPoints[2].mPosition.x  = (rcQuad.x + rcQuad.w) * 1.0f;
+        mPoints[2].mPosition.y  = mPoints[1].mPosition.y;
+        mPoints[3].mColor       = color;
+        mPoints[3].mTexcoord[0] = texcoordMax.x;
+        mPoints[3].mTexcoord[1] = texcoordMin.y;
+        mPoints[3].mPosition.x  = mPoints[2].mPosition.x;
+        mPoints[3].mPosition.y  = mPoints[0].mPosition.y;
+    }
 public:
     // vertices has specific order:
     // 0 - TOP LEFT
@@ -159,6 +182,69 @@ public:
     Vertex2D mPoints[4];
 };
 
+// recorded gui geometry, vertices are in screen space
+struct GuiDrawList
+{
+public:
+    struct DrawBatch
+    {
+    public:
+        Texture2D* mTexture = nullptr;
+        Rectangle mClipRect; // scissor box
+        int mStartVertex = 0;
+        int mVertexCount = 0;
+    };
+
+public:
+    inline void Clear()
+    {
+        mVertices.clear();
+        mBatches.clear();
+    }
+
+    // reserve vertices at end of list, adjacent vertices with same texture and clip rect share batch
+    // @param texture: Vertices texture
+    // @param clipRect: Vertices scissor box
+    // @param numVerts: Number of vertices to allocate
+    inline Vertex2D* AllocateVertices(Texture2D* texture, const Rectangle& clipRect, int numVerts)
+    {
+        if (mBatches.empty() || mBatches.back().mTexture != texture || mBatches.back().mClipRect != clipRect)
+        {
+            DrawBatch& drawBatch = mBatches.emplace_back();
+            drawBatch.mTexture = texture;
+            drawBatch.mClipRect = clipRect;
+            drawBatch.mStartVertex = (int) mVertices.size();
+        }
+        mBatches.back().mVertexCount += numVerts;
+
+        const size_t startVertex = mVertices.size();
+        mVertices.resize(startVertex + numVerts);
+        return mVertices.data() + startVertex;
+    }
+
+    // copy geometry of other draw list to end of list
+    // @param sourceList: Source geometry
+    // @param clipRect: Scissor box for all source batches
+    inline void AppendDrawList(const GuiDrawList& sourceList, const Rectangle& clipRect)
+    {
+        for (const DrawBatch& sourceBatch: sourceList.mBatches)
+        {
+            Vertex2D* vertices = AllocateVertices(sourceBatch.mTexture, clipRect, sourceBatch.mVertexCount);
+            std::copy_n(sourceList.mVertices.data() + sourceBatch.mStartVertex, sourceBatch.mVertexCount, vertices);
+        }
+    }
+
+    // get texture of last batch or null if list is empty
+    inline Texture2D* GetLastTexture() const
+    {
+        return mBatches.empty() ? nullptr : mBatches.back().mTexture;
+    }
+
+public:
+    std::vector<Vertex2D> mVertices;
+    std::vector<DrawBatch> mBatches;
+};
+
 // creates widget instance of specific class
 class GuiWidgetFactoryInterface
 {
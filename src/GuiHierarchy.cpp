@@ -5,6 +5,9 @@
 #include "TimeManager.h"
 #include "FileSystem.h"
 #include "Console.h"
+#include "GraphicsDevice.h"
+#include "GpuBuffer.h"
+#include "cvars.h"
 
 GuiHierarchy::~GuiHierarchy()
 {
@@ -71,13 +74,57 @@ void GuiHierarchy::Cleanup()
     FreeTemplateWidgets();
 
     SafeDelete(mRootWidget);
+
+    mDrawList.Clear();
+    mPickGrid.Clear();
+    if (mVertexBuffer)
+    {
+        gGraphicsDevice.DestroyBuffer(mVertexBuffer);
+        mVertexBuffer = nullptr;
+    }
 }
 
 void GuiHierarchy::RenderFrame(GuiRenderer& renderContext)
 {
-    if (mRootWidget)
+    if (mRootWidget == nullptr)
+        return;
+
+    if (!gCvarGui_RetainedRender.mValue)
     {
         mRootWidget->RenderFrame(renderContext);
+        return;
+    }
+
+    // rebuild draw list only if some widgets changed since previous frame
+    const Rectangle& screenCliprect = gGraphicsDevice.mScissorBox;
+    if (mRootWidget->mRenderTreeInvalidated || mDrawListCliprect != screenCliprect)
+    {
+        mDrawList.Clear();
+        mRootWidget->CollectDrawList(renderContext, mDrawList, screenCliprect);
+        mRootWidget->mRenderTreeInvalidated = false;
+        mDrawListCliprect = screenCliprect;
+
+        UploadDrawList();
+    }
+
+    renderContext.DrawRecordedList(mDrawList, mVertexBuffer);
+}
+
+void GuiHierarchy::UploadDrawList()
+{
+    if (mDrawList.mVertices.empty())
+        return;
+
+    if (mVertexBuffer == nullptr)
+    {
+        mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices);
+        debug_assert(mVertexBuffer);
+    }
+
+    const int VertexBufferSize = (int) mDrawList.mVertices.size() * Sizeof_Vertex2D;
+    if (!mVertexBuffer->Setup(eBufferUsage_Static, VertexBufferSize, mDrawList.mVertices.data()))
+    {
+        debug_assert(false);
     }
 }
 
@@ -114,13 +161,80 @@ void GuiHierarchy::FitLayoutToScreen(const Point& screenDimensions)
     }
 }
 
-GuiWidget* GuiHierarchy::PickWidget(const Point& screenPosition) const
+GuiWidget* GuiHierarchy::PickWidget(const Point& screenPosition)
 {
-    if (mRootWidget)
+    if (mRootWidget == nullptr)
+        return nullptr;
+
+    if (!gCvarGui_PickGrid.mValue)
     {
         return mRootWidget->PickWidget(screenPosition);
     }
-    return nullptr;
+
+    if (mRootWidget->mPickTreeInvalidated)
+    {
+        mPickGrid.Build(mRootWidget);
+        mRootWidget->mPickTreeInvalidated = false;
+    }
+    return mPickGrid.PickWidget(screenPosition);
+}
+
+void GuiHierarchy::RunPickBenchmark(const Point& screenDimensions, int iterationsCount)
+{
+    if (mRootWidget == nullptr)
+        return;
+
+    const int PointsStep = 4; // pixels
+
+    std::vector<Point> samplePoints;
+    for (int pointy = 0; pointy < screenDimensions.y; pointy += PointsStep)
+    for (int pointx = 0; pointx < screenDimensions.x; pointx += PointsStep)
+    {
+        samplePoints.emplace_back(pointx, pointy);
+    }
+
+    if (samplePoints.empty())
+        return;
+
+    auto timeStart = std::chrono::steady_clock::now();
+    mPickGrid.Build(mRootWidget);
+    mRootWidget->mPickTreeInvalidated = false;
+    std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - timeStart;
+
+    int mismatchesCount = 0;
+    for (const Point& currPoint: samplePoints)
+    {
+        if (mRootWidget->PickWidget(currPoint) != mPickGrid.PickWidget(currPoint))
+        {
+            ++mismatchesCount;
+        }
+    }
+
+    int pickedCount = 0;
+    timeStart = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    {
+        for (const Point& currPoint: samplePoints)
+        {
+            pickedCount += mRootWidget->PickWidget(currPoint) ? 1 : 0;
+        }
+    }
+    std::chrono::duration<double> traversalTime = std::chrono::steady_clock::now() - timeStart;
+
+    timeStart = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    {
+        for (const Point& currPoint: samplePoints)
+        {
+            pickedCount += mPickGrid.PickWidget(currPoint) ? 1 : 0;
+        }
+    }
+    std::chrono::duration<double> gridTime = std::chrono::steady_clock::now() - timeStart;
+
+    const double picksCount = (double) samplePoints.size() * iterationsCount;
+    gConsole.LogMessage(eLogMessage_Info, "   interactive widgets: %d, grid build: %.3f ms, ns/pick traversal: %.1f, grid: %.1f, hits: %d, mismatches: %d",
+        mPickGrid.GetEntriesCount(), buildTime.count() * 1000.0, (traversalTime.count() * 1000000000.0) / picksCount,
+        (gridTime.count() * 1000000000.0) / picksCount, pickedCount / 2, mismatchesCount);
 }
 
 GuiWidget* GuiHierarchy::GetWidgetByPath(const std::string& widgetPath) const
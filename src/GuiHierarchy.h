@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GuiDefs.h"
+#include "GuiPickGrid.h"
 
 class GuiHierarchy: public cxx::noncopyable
 {
@@ -30,9 +31,15 @@ public:
     // handle screen resolution changed during runtime
     void FitLayoutToScreen(const Point& screenDimensions);
 
-    // pick visible and interactive widget at specified screen coordinate
+    // pick visible and interactive widget at specified screen coordinate,
+    // pick grid is rebuilt if layout of some widgets changed
     // @param screenPosition: Screen coordinate
-    GuiWidget* PickWidget(const Point& screenPosition) const;
+    GuiWidget* PickWidget(const Point& screenPosition);
+
+    // measure picking at sampled points through hierarchy traversal and pick grid, results are compared
+    // @param screenDimensions: Sampled area
+    // @param iterationsCount: Number of passes over sampled points
+    void RunPickBenchmark(const Point& screenDimensions, int iterationsCount);
 
     // find widget by specific location within hierarchy
     // @param widgetPath: Path, includes root
@@ -50,6 +57,9 @@ private:
     // destroy template widgets
     void FreeTemplateWidgets();
 
+    // upload collected geometry to vertex buffer
+    void UploadDrawList();
+
     GuiWidget* DeserializeWidgetWithChildren(cxx::json_node_object objectNode);
     GuiWidget* DeserializeTemplateWidget(cxx::json_node_object objectNode);
     void LoadChildrenWidgetProperties(GuiWidget* parentWidget, cxx::json_node_object objectNode);
@@ -60,4 +70,11 @@ private:
 private:
     using GuiTemplateWidgetsMap = std::map<cxx::unique_string, GuiWidget*>;
     GuiTemplateWidgetsMap mTemplateWidgetsClasses;
+
+    // retained geometry of whole hierarchy, rebuilt only when some widgets changed
+    GuiDrawList mDrawList;
+    Rectangle mDrawListCliprect { 0, 0, 0, 0 };
+    GpuBuffer* mVertexBuffer = nullptr;
+
+    GuiPickGrid mPickGrid;
 };
\ No newline at end of file
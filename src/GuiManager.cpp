@@ -11,6 +11,15 @@
 #include "GraphicsDevice.h"
 #include "FileSystem.h"
 #include "GuiScreen.h"
+#include "ConsoleVariable.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarGui_RetainedRender ("gui_retainedRender", true, "Cache widgets geometry between frames and rebuild it only for changed widgets", ConsoleVar_Gui);
+CvarBoolean gCvarGui_PickGrid ("gui_pickGrid", true, "Pick hovered widgets using per screen grid instead of hierarchy traversal", ConsoleVar_Gui);
+
+//////////////////////////////////////////////////////////////////////////
 
 GuiManager gGuiManager;
 
@@ -22,6 +31,15 @@ GuiManager::GuiManager()
 
 bool GuiManager::Initialize()
 {
+    gConsole.RegisterVariable(&gCvarGui_RetainedRender);
+    gConsole.RegisterVariable(&gCvarGui_PickGrid);
+    gConsole.RegisterFunction("bench_guiPick", "Measure widgets picking on shown screens with and without pick grid, args: iterationsCount", [](const ConsoleFuncArgs& args)
+        {
+            int iterationsCount = 10;
+            args.ParseArgument(0, iterationsCount);
+            gGuiManager.RunPickBenchmark(iterationsCount);
+        });
+
     RegisterWidgetsClasses();
     LoadScreenRecords();
     return true;
@@ -29,6 +47,10 @@ bool GuiManager::Initialize()
 
 void GuiManager::Deinit()
 {
+    gConsole.UnregisterVariable(&gCvarGui_RetainedRender);
+    gConsole.UnregisterVariable(&gCvarGui_PickGrid);
+    gConsole.UnregisterFunction("bench_guiPick");
+
     UnregisterWidgetsClasses();
     ClearEventsQueue();
     UnregisterAllEventsHandlers();
@@ -473,3 +495,21 @@ bool GuiManager::GetScreenContentPath(cxx::unique_string screenId, std::string&
     gConsole.LogMessage(eLogMessage_Warning, "Unknown screen id: '%s'", screenId.c_str());
     return false;
 }
+
+void GuiManager::RunPickBenchmark(int iterationsCount)
+{
+    iterationsCount = std::max(iterationsCount, 1);
+
+    gConsole.LogMessage(eLogMessage_Info, "Gui pick benchmark, screen: %dx%d, iterations: %d", 
+        gGraphicsDevice.mScreenResolution.x, gGraphicsDevice.mScreenResolution.y, iterationsCount);
+
+    for (const ScreenElement& currElement: mScreensList)
+    {
+        GuiScreen* currentScreen = currElement.mInstance;
+        if (currentScreen == nullptr || !currentScreen->IsScreenShown())
+            continue;
+
+        gConsole.LogMessage(eLogMessage_Info, " - screen '%s'", currElement.mScreenId.c_str());
+        currentScreen->mHier.RunPickBenchmark(gGraphicsDevice.mScreenResolution, iterationsCount);
+    }
+}
@@ -68,6 +68,10 @@ public:
     // get content location for specific gui screen
     bool GetScreenContentPath(cxx::unique_string screenId, std::string& contentPath);
 
+    // compare widgets picking through hierarchy traversal and pick grid on all shown screens
+    // @param iterationsCount: Number of passes over sampled screen points
+    void RunPickBenchmark(int iterationsCount);
+
 private:
     void RegisterWidgetsClasses();
     void UnregisterWidgetsClasses();
@@ -0,0 +1,168 @@
+#include "pch.h"
+#include "GuiPickGrid.h"
+#include "GuiWidget.h"
+
+void GuiPickGrid::Build(GuiWidget* rootWidget)
+{
+    Clear();
+
+    if (rootWidget == nullptr || !rootWidget->IsVisibleWithParent())
+        return;
+
+    // root widget area does not restrict its children
+    const Point unboundedMin (std::numeric_limits<int>::min());
+    const Point unboundedMax (std::numeric_limits<int>::max());
+    CollectEntries(rootWidget, unboundedMin, unboundedMax);
+
+    SetupCells();
+}
+
+void GuiPickGrid::Clear()
+{
+    mEntries.clear();
+    mCellsFirstEntry.clear();
+    mCellsEntries.clear();
+    mGridOrigin = Point(0, 0);
+    mGridCells = Point(0, 0);
+    mCellDimensions = MinCellDimensions;
+}
+
+GuiWidget* GuiPickGrid::PickWidget(const Point& screenPosition) const
+{
+    if (mCellsEntries.empty())
+        return nullptr;
+
+    const Point cellPosition = (screenPosition - mGridOrigin);
+    if (cellPosition.x < 0 || cellPosition.y < 0)
+        return nullptr;
+
+    const int cellx = cellPosition.x / mCellDimensions;
+    const int celly = cellPosition.y / mCellDimensions;
+    if (cellx >= mGridCells.x || celly >= mGridCells.y)
+        return nullptr;
+
+    const int icell = celly * mGridCells.x + cellx;
+    for (int icellEntry = mCellsFirstEntry[icell]; icellEntry < mCellsFirstEntry[icell + 1]; ++icellEntry)
+    {
+        const PickEntry& currEntry = mEntries[mCellsEntries[icellEntry]];
+        if (screenPosition.x >= currEntry.mMin.x && screenPosition.y >= currEntry.mMin.y &&
+            screenPosition.x < currEntry.mMax.x && screenPosition.y < currEntry.mMax.y)
+        {
+            return currEntry.mWidget;
+        }
+    }
+    return nullptr;
+}
+
+void GuiPickGrid::CollectEntries(GuiWidget* widget, const Point& boundsMin, const Point& boundsMax)
+{
+    // transformations are translations only, so local rect maps to screen space rect,
+    // matches Rectangle::PointWithin bounds
+    const Point screenPosition = widget->LocalToScreen(Point(0, 0));
+    const Point widgetMin = glm::max(boundsMin, screenPosition);
+    const Point widgetMax = glm::min(boundsMax, screenPosition + widget->mSize - Point(1, 1));
+
+    const bool isEmptyArea = (widgetMin.x >= widgetMax.x || widgetMin.y >= widgetMax.y);
+    const bool isRootWidget = (widget->mParent == nullptr);
+
+    if (!widget->mHasDisablePickChildrenAttribute && (!isEmptyArea || isRootWidget))
+    {
+        // process in reversed order
+        for (GuiWidget* currChild = widget->GetLastChild(); currChild;
+            currChild = currChild->mPrevSibling)
+        {
+            if (!currChild->IsVisible())
+                continue;
+
+            if (isRootWidget)
+            {
+                CollectEntries(currChild, boundsMin, boundsMax);
+            }
+            else
+            {
+                CollectEntries(currChild, widgetMin, widgetMax);
+            }
+        }
+    }
+
+    if (widget->mHasInteractiveAttribute && !isEmptyArea)
+    {
+        PickEntry& pickEntry = mEntries.emplace_back();
+        pickEntry.mWidget = widget;
+        pickEntry.mMin = widgetMin;
+        pickEntry.mMax = widgetMax;
+    }
+}
+
+void GuiPickGrid::SetupCells()
+{
+    if (mEntries.empty())
+        return;
+
+    Point gridMin = mEntries[0].mMin;
+    Point gridMax = mEntries[0].mMax;
+    for (const PickEntry& currEntry: mEntries)
+    {
+        gridMin = glm::min(gridMin, currEntry.mMin);
+        gridMax = glm::max(gridMax, currEntry.mMax);
+    }
+
+    // compute cells count using 64 bits so huge widgets do not overflow
+    const long long gridSizex = (long long) gridMax.x - gridMin.x;
+    const long long gridSizey = (long long) gridMax.y - gridMin.y;
+    long long cellsx = 0;
+    long long cellsy = 0;
+    for (mCellDimensions = MinCellDimensions;; mCellDimensions *= 2)
+    {
+        cellsx = (gridSizex + mCellDimensions - 1) / mCellDimensions;
+        cellsy = (gridSizey + mCellDimensions - 1) / mCellDimensions;
+        if (cellsx * cellsy <= MaxCellsCount)
+            break;
+    }
+
+    mGridOrigin = gridMin;
+    mGridCells = Point((int) cellsx, (int) cellsy);
+
+    const int cellsCount = mGridCells.x * mGridCells.y;
+
+    // count entries per cell, then fill ranges in picking order
+    mCellsFirstEntry.assign(cellsCount + 1, 0);
+    for (int ipass = 0; ipass < 2; ++ipass)
+    {
+        for (int ientry = 0, numEntries = (int) mEntries.size(); ientry < numEntries; ++ientry)
+        {
+            const PickEntry& currEntry = mEntries[ientry];
+            const Point cellMin = (currEntry.mMin - mGridOrigin) / mCellDimensions;
+            const Point cellMax = (currEntry.mMax - mGridOrigin - Point(1, 1)) / mCellDimensions;
+            for (int celly = cellMin.y; celly <= cellMax.y; ++celly)
+            for (int cellx = cellMin.x; cellx <= cellMax.x; ++cellx)
+            {
+                const int icell = celly * mGridCells.x + cellx;
+                if (ipass == 0)
+                {
+                    ++mCellsFirstEntry[icell + 1];
+                }
+                else
+                {
+                    mCellsEntries[mCellsFirstEntry[icell]++] = ientry;
+                }
+            }
+        }
+
+        if (ipass == 0)
+        {
+            for (int icell = 0; icell < cellsCount; ++icell)
+            {
+                mCellsFirstEntry[icell + 1] += mCellsFirstEntry[icell];
+            }
+            mCellsEntries.resize(mCellsFirstEntry[cellsCount]);
+        }
+    }
+
+    // cells ranges were shifted while filling, restore them
+    for (int icell = cellsCount; icell > 0; --icell)
+    {
+        mCellsFirstEntry[icell] = mCellsFirstEntry[icell - 1];
+    }
+    mCellsFirstEntry[0] = 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "GuiDefs.h"
+
+// accelerates picking widgets at screen coordinate,
+// interactive widgets are flattened in picking order and distributed between uniform grid cells
+class GuiPickGrid: public cxx::noncopyable
+{
+public:
+    static const int MinCellDimensions = 32; // pixels
+    static const int MaxCellsCount = 4096; // cells grow if widgets occupy larger area
+
+public:
+    // collect interactive widgets of hierarchy and distribute them between cells
+    // @param rootWidget: Hierarchy root widget
+    void Build(GuiWidget* rootWidget);
+    void Clear();
+
+    // pick visible and interactive widget at specified screen coordinate,
+    // result is same as picking from root widget when grid was built
+    // @param screenPosition: Screen coordinate
+    GuiWidget* PickWidget(const Point& screenPosition) const;
+
+    // get number of widgets which can be picked
+    inline int GetEntriesCount() const { return (int) mEntries.size(); }
+
+private:
+    struct PickEntry
+    {
+    public:
+        GuiWidget* mWidget = nullptr;
+        Point mMin; // screen space
+        Point mMax; // exclusive
+    };
+
+    // add interactive widget and its children in same order as they are tested on picking
+    // @param widget: Visible widget
+    // @param boundsMin, boundsMax: Area of parent widgets, children cannot be picked outside of it
+    void CollectEntries(GuiWidget* widget, const Point& boundsMin, const Point& boundsMax);
+
+    void SetupCells();
+
+private:
+    std::vector<PickEntry> mEntries; // sorted in picking order
+    std::vector<int> mCellsFirstEntry; // cells count plus one
+    std::vector<int> mCellsEntries; // entries indices of all cells, ascending within cell
+    Point mGridOrigin;
+    Point mGridCells;
+    int mCellDimensions = MinCellDimensions;
+};
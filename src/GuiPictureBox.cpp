@@ -3,6 +3,8 @@
 #include "GuiRenderer.h"
 #include "Texture2D.h"
 #include "TexturesManager.h"
+#include "GuiAtlasManager.h"
+#include "cvars.h"
 
 // widget class factory
 static GuiWidgetFactory<GuiPictureBox> _PictureBoxWidgetsFactory;
@@ -24,6 +26,9 @@ GuiPictureBox::GuiPictureBox(GuiPictureBox* copyWidget)
     , mSizeMode(copyWidget->mSizeMode)
     , mTexture(copyWidget->mTexture)
     , mQuadsCache(copyWidget->mQuadsCache)
+    , mQuadsTexture(copyWidget->mQuadsTexture)
+    , mAtlasEntry(copyWidget->mAtlasEntry)
+    , mQuadsAtlasEnabled(copyWidget->mQuadsAtlasEnabled)
 {
 }
 
@@ -91,11 +96,20 @@ void GuiPictureBox::HandleRender(GuiRenderer& renderContext)
             return;
     }
 
-    renderContext.DrawQuads(mTexture, 
+    renderContext.DrawQuads(mQuadsTexture, 
         mQuadsCache.data(), 
         mQuadsCache.size());
 }
 
+void GuiPictureBox::HandleUpdate(float deltaTime)
+{
+    // atlas was toggled
+    if (!mQuadsCache.empty() && mQuadsAtlasEnabled != gCvarGui_TexturesAtlas.mValue)
+    {
+        InvalidateCache();
+    }
+}
+
 void GuiPictureBox::HandleSizeChanged(const Point& prevSize)
 {
     InvalidateCache();
@@ -104,12 +118,18 @@ void GuiPictureBox::HandleSizeChanged(const Point& prevSize)
 void GuiPictureBox::InvalidateCache()
 {
     mQuadsCache.clear();
+    InvalidateRender();
 }
 
 void GuiPictureBox::GenerateQuads()
 {
     debug_assert(mTexture);
-    if (!mTexture->IsTextureLoaded())
+
+    // texture packed into atlas is not loaded itself
+    mQuadsAtlasEnabled = gCvarGui_TexturesAtlas.mValue;
+    mAtlasEntry = mQuadsAtlasEnabled ? gGuiAtlasManager.GetAtlasEntry(mTexture) : nullptr;
+    mQuadsTexture = mAtlasEntry ? mAtlasEntry->mPageTexture : mTexture;
+    if (mAtlasEntry == nullptr && !mTexture->IsTextureLoaded())
     {
         mTexture->LoadTexture();
     }
@@ -120,7 +140,8 @@ void GuiPictureBox::GenerateQuads()
 
     Color32 verticesColor = mTintColor;
 
-    const Point& imageSize = mTexture->mTextureDesc.mImageDimensions;
+    const Point imageSize = mAtlasEntry ? Point(mAtlasEntry->mPageRect.w, mAtlasEntry->mPageRect.h) : 
+        mTexture->mTextureDesc.mImageDimensions;
     debug_assert(imageSize.x > 0 && imageSize.y > 0);
 
     if (mSizeMode == eGuiSizeMode_Scale || mSizeMode == eGuiSizeMode_Keep || 
@@ -155,7 +176,7 @@ void GuiPictureBox::GenerateQuads()
         mQuadsCache.emplace_back();
 
         GuiQuadStruct& quad = mQuadsCache.back();
-        quad.SetupVertices(mTexture, rcDestination, verticesColor);
+        SetupQuadVertices(quad, Rectangle(0, 0, imageSize.x, imageSize.y), rcDestination, verticesColor);
     }
     else if (mSizeMode == eGuiSizeMode_TileHorizontal || mSizeMode == eGuiSizeMode_TileVertical || mSizeMode == eGuiSizeMode_Tile)
     {
@@ -206,7 +227,7 @@ void GuiPictureBox::GenerateQuads()
                     CurrentTilePixels_X, 
                     CurrentTilePixels_Y
                 };
-                mQuadsCache[currentY * NumTiles_X + currentX].SetupVertices(mTexture, rcSrc, rcDest, verticesColor);
+                SetupQuadVertices(mQuadsCache[currentY * NumTiles_X + currentX], rcSrc, rcDest, verticesColor);
             }
         }
         else if (mSizeMode == eGuiSizeMode_TileHorizontal)
@@ -223,7 +244,7 @@ void GuiPictureBox::GenerateQuads()
                     currentTile * TileSize_X, 0, 
                     isExtraTile ? ExtraTileSize_X : TileSize_X, TileSize_Y
                 };
-                mQuadsCache[currentTile].SetupVertices(mTexture, rcSrc, rcDest, verticesColor);
+                SetupQuadVertices(mQuadsCache[currentTile], rcSrc, rcDest, verticesColor);
             }
         }
         else if (mSizeMode == eGuiSizeMode_TileVertical)
@@ -240,7 +261,7 @@ void GuiPictureBox::GenerateQuads()
                     0, currentTile * TileSize_Y, 
                     TileSize_X, isExtraTile ? ExtraTileSize_Y : TileSize_Y
                 };
-                mQuadsCache[currentTile].SetupVertices(mTexture, rcSrc, rcDest, verticesColor);
+                SetupQuadVertices(mQuadsCache[currentTile], rcSrc, rcDest, verticesColor);
             }
         } // if
     }
@@ -248,4 +269,20 @@ void GuiPictureBox::GenerateQuads()
     {
         debug_assert(false);
     }
-}
\ No newline at end of file
+}
+
+void GuiPictureBox::SetupQuadVertices(GuiQuadStruct& quad, const Rectangle& rcSrc, const Rectangle& rcQuad, Color32 color) const
+{
+    if (mAtlasEntry == nullptr)
+    {
+        quad.SetupVertices(mTexture, rcSrc, rcQuad, color);
+        return;
+    }
+
+    const float invPageDims = 1.0f / GuiAtlasManager::PageDimensions;
+    const Rectangle& rcPage = mAtlasEntry->mPageRect;
+
+    glm::vec2 texcoordMin ((rcPage.x + rcSrc.x) * invPageDims, (rcPage.y + rcSrc.y) * invPageDims);
+    glm::vec2 texcoordMax ((rcPage.x + rcSrc.x + rcSrc.w) * invPageDims, (rcPage.y + rcSrc.y + rcSrc.h) * invPageDims);
+    quad.SetupVertices(texcoordMin, texcoordMax, rcQuad, color);
+}
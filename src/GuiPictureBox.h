@@ -2,6 +2,8 @@
 
 #include "GuiWidget.h"
 
+struct GuiAtlasEntry;
+
 // picture box widget
 class GuiPictureBox: public GuiWidget
 {
@@ -33,12 +35,19 @@ protected:
     void InvalidateCache();
     void GenerateQuads();
 
+    // setup quad texture coordinates within source texture or atlas page
+    void SetupQuadVertices(GuiQuadStruct& quad, const Rectangle& rcSrc, const Rectangle& rcQuad, Color32 color) const;
+
     // override GuiWidget
     void HandleLoadProperties(cxx::json_node_object documentNode) override;
     void HandleRender(GuiRenderer& renderContext) override;
+    void HandleUpdate(float deltaTime) override;
     void HandleSizeChanged(const Point& prevSize) override;
     GuiPictureBox* CreateClone() override;
 
 protected:
     std::vector<GuiQuadStruct> mQuadsCache;
+    Texture2D* mQuadsTexture = nullptr; // source texture or atlas page
+    const GuiAtlasEntry* mAtlasEntry = nullptr;
+    bool mQuadsAtlasEnabled = false;
 };
\ No newline at end of file
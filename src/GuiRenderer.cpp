@@ -6,17 +6,7 @@
 #include "GpuBuffer.h"
 #include "Texture2D.h"
 #include "TexturesManager.h"
-
-#define ALLOCATE_VERTICES(numVerts, ptr) \
-    { \
-        debug_assert((numVerts) < MaxBatchVertices); \
-        if (MaxBatchVertices < (mBatchVertexCount + (numVerts))) \
-        { \
-            FlushPendingDrawCalls(); \
-        } \
-        (ptr) = (mBatchVertices + mBatchVertexCount); \
-        mBatchVertexCount += (numVerts); \
-    }
+#include "GuiAtlasManager.h"
 
 bool GuiRenderer::Initialize()
 {
@@ -84,6 +74,12 @@ void GuiRenderer::RenderFrameEnd()
     gGraphicsDevice.SetScissorRect(screenRect);
 }
 
+void GuiRenderer::CompleteFrameStats()
+{
+    mPrevFrameStats = mFrameStats;
+    mFrameStats = FrameStats();
+}
+
 void GuiRenderer::SetCurrentTransform(glm::mat4* matrix)
 {
     mCurrentTransform = matrix;
@@ -91,27 +87,37 @@ void GuiRenderer::SetCurrentTransform(glm::mat4* matrix)
 
 void GuiRenderer::FillRect(const Rectangle& rect, Color32 fillColor)
 {
-    SetCurrentBatchTexture(gTexturesManager.mWhiteTexture);
+    // use white area of current atlas page to keep batch
+    Texture2D* texture = mRecordDrawList ? mRecordDrawList->GetLastTexture() : mCurrentTexture;
+
+    glm::vec2 whiteTexcoord (0.0f, 0.0f);
+    if (!gGuiAtlasManager.GetWhiteTexcoord(texture, whiteTexcoord))
+    {
+        texture = gTexturesManager.mWhiteTexture;
+    }
 
-    Vertex2D* vertices = nullptr;
-    ALLOCATE_VERTICES(6, vertices);
+    Vertex2D* vertices = AllocateVertices(texture, 6);
 
     vertices[0].mColor = fillColor;
+    vertices[0].mTexcoord = whiteTexcoord;
     vertices[0].mPosition.x = rect.x * 1.0f;
     vertices[0].mPosition.y = rect.y * 1.0f;
     vertices[1].mColor = fillColor;
+    vertices[1].mTexcoord = whiteTexcoord;
     vertices[1].mPosition.x = vertices[0].mPosition.x;
     vertices[1].mPosition.y = (rect.y + rect.h) * 1.0f;
     vertices[2].mColor = fillColor;
+    vertices[2].mTexcoord = whiteTexcoord;
     vertices[2].mPosition.x = (rect.x + rect.w) * 1.0f;
     vertices[2].mPosition.y = vertices[1].mPosition.y;
     vertices[3] = vertices[0];
     vertices[4] = vertices[2];
     vertices[5].mColor = fillColor;
+    vertices[5].mTexcoord = whiteTexcoord;
     vertices[5].mPosition.x = vertices[2].mPosition.x;
     vertices[5].mPosition.y = vertices[0].mPosition.y;
 
-    TransformVertices(vertices);
+    TransformVertices(vertices, 6);
 }
 
 void GuiRenderer::DrawRect(const Rectangle& rect, Color32 lineColor, int lineWidth)
@@ -147,11 +153,8 @@ void GuiRenderer::DrawQuads(Texture2D* texture, const GuiQuadStruct* quads, int
         return;
     }
 
-    SetCurrentBatchTexture(texture);
-
-    Vertex2D* vertices = nullptr;
-    ALLOCATE_VERTICES(6 * quadsCount, vertices);
-
+    Vertex2D* vertices = AllocateVertices(texture, 6 * quadsCount);
+
     // push all quad vertices to vertex cache
     for (int iquad = 0; iquad < quadsCount; ++iquad)
     {
@@ -162,7 +165,83 @@ void GuiRenderer::DrawQuads(Texture2D* texture, const GuiQuadStruct* quads, int
         vertices[iquad * 6 + 4] = quads[iquad].mPoints[2];
         vertices[iquad * 6 + 5] = quads[iquad].mPoints[3];
     }
-    TransformVertices(vertices);
+    TransformVertices(vertices, 6 * quadsCount);
+}
+
+void GuiRenderer::SetRecordDrawList(GuiDrawList* drawList)
+{
+    if (drawList)
+    {
+        ++mFrameStats.mWidgetsRecorded;
+    }
+    mRecordDrawList = drawList;
+}
+
+void GuiRenderer::DrawRecordedList(const GuiDrawList& drawList, GpuBuffer* vertexBuffer)
+{
+    if (drawList.mBatches.empty())
+        return;
+
+    debug_assert(vertexBuffer);
+    FlushPendingDrawCalls();
+
+    Rectangle prevCliprect = gGraphicsDevice.mScissorBox;
+
+    gGraphicsDevice.BindIndexBuffer(nullptr);
+    gGraphicsDevice.BindVertexBuffer(vertexBuffer, Vertex2D_Format::Get());
+
+    Texture2D* prevTexture = nullptr;
+    for (const GuiDrawList::DrawBatch& currBatch: drawList.mBatches)
+    {
+        if (currBatch.mClipRect != gGraphicsDevice.mScissorBox)
+        {
+            gGraphicsDevice.SetScissorRect(currBatch.mClipRect);
+        }
+
+        if (prevTexture && prevTexture != currBatch.mTexture)
+        {
+            ++mFrameStats.mTextureSwitches;
+        }
+        prevTexture = currBatch.mTexture;
+
+        // textures are activated each frame so animated and evicted ones are handled as usual
+        if (currBatch.mTexture)
+        {
+            currBatch.mTexture->ActivateTexture(eTextureUnit_0);
+        }
+
+        gGraphicsDevice.RenderPrimitives(ePrimitiveType_Triangles, currBatch.mStartVertex, currBatch.mVertexCount);
+        ++mFrameStats.mDrawCalls;
+        mFrameStats.mQuadsDrawn += currBatch.mVertexCount / 6;
+    }
+
+    if (prevCliprect != gGraphicsDevice.mScissorBox)
+    {
+        gGraphicsDevice.SetScissorRect(prevCliprect);
+    }
+    // texture unit state is changed
+    mCurrentTexture = nullptr;
+}
+
+Vertex2D* GuiRenderer::AllocateVertices(Texture2D* texture, int numVerts)
+{
+    if (mRecordDrawList)
+    {
+        // recorded clip rect is not used, it is specified when geometry is collected
+        return mRecordDrawList->AllocateVertices(texture, Rectangle(0, 0, 0, 0), numVerts);
+    }
+
+    SetCurrentBatchTexture(texture);
+
+    debug_assert(numVerts < MaxBatchVertices);
+    if (MaxBatchVertices < (mBatchVertexCount + numVerts))
+    {
+        FlushPendingDrawCalls();
+    }
+    Vertex2D* vertices = (mBatchVertices + mBatchVertexCount);
+    mBatchVertexCount += numVerts;
+    mFrameStats.mQuadsDrawn += numVerts / 6;
+    return vertices;
 }
 
 void GuiRenderer::FlushPendingDrawCalls()
@@ -193,6 +272,7 @@ void GuiRenderer::FlushPendingDrawCalls()
     gGraphicsDevice.BindIndexBuffer(nullptr);
     gGraphicsDevice.BindVertexBuffer(mVertexBuffer, Vertex2D_Format::Get());
     gGraphicsDevice.RenderPrimitives(ePrimitiveType_Triangles, 0, mBatchVertexCount);
+    ++mFrameStats.mDrawCalls;
 
     mBatchVertexCount = 0;
 }
@@ -201,6 +281,10 @@ void GuiRenderer::SetCurrentBatchTexture(Texture2D* newTexutre)
 {
     if (mCurrentTexture != newTexutre)
     {
+        if (mBatchVertexCount > 0)
+        {
+            ++mFrameStats.mTextureSwitches;
+        }
         FlushPendingDrawCalls();
         mCurrentTexture = newTexutre;
     }
@@ -211,12 +295,12 @@ void GuiRenderer::SetCurrentBatchTexture(Texture2D* newTexutre)
     }
 }
 
-void GuiRenderer::TransformVertices(Vertex2D* vertices)
+void GuiRenderer::TransformVertices(Vertex2D* vertices, int numVerts)
 {
     if (mCurrentTransform == nullptr || vertices == nullptr)
         return;
 
-    Vertex2D* vertices_end = mBatchVertices + mBatchVertexCount;
+    Vertex2D* vertices_end = vertices + numVerts;
     for (; vertices != vertices_end; ++vertices)
     {
         vertices->mPosition = glm::vec2(*mCurrentTransform * glm::vec4(vertices->mPosition, 0.0f, 1.0f));
@@ -240,15 +324,21 @@ void GuiRenderer::TransformClipRect(Rectangle& rectangle) const
     }
 }
 
-bool GuiRenderer::EnterChildClipArea(const Rectangle& rcLocal)
+bool GuiRenderer::ComputeChildClipArea(const Rectangle& rcLocal, const Rectangle& currentCliprect, Rectangle& childCliprect) const
 {
     Rectangle newCliprect = rcLocal;
     TransformClipRect(newCliprect);
 
+    childCliprect = newCliprect.GetIntersection(currentCliprect);
+    return childCliprect.h > 0 && childCliprect.w > 0;
+}
+
+bool GuiRenderer::EnterChildClipArea(const Rectangle& rcLocal)
+{
     Rectangle currentCliprect = gGraphicsDevice.mScissorBox;
 
-    newCliprect = newCliprect.GetIntersection(currentCliprect);
-    if (newCliprect.h < 1 || newCliprect.w < 1)
+    Rectangle newCliprect;
+    if (!ComputeChildClipArea(rcLocal, currentCliprect, newCliprect))
     {
         return false;
     }
@@ -5,6 +5,20 @@
 
 class GuiRenderer: public cxx::noncopyable
 {
+public:
+    // per frame rendering statistics
+    struct FrameStats
+    {
+    public:
+        int mDrawCalls = 0;
+        int mTextureSwitches = 0; // batches flushed because of texture change
+        int mQuadsDrawn = 0; // textured quads and filled rects
+        int mWidgetsRecorded = 0; // widgets which geometry was rebuilt for retained rendering
+    };
+
+    // readonly
+    FrameStats mPrevFrameStats;
+
 public:
     // setup gui renderer internal resources
     // @returns false on error
@@ -19,6 +33,9 @@ public:
     // it should be called at end of gui rendering
     void RenderFrameEnd();
 
+    // store statistics of current frame and start counting again, called once per frame after all gui is rendered
+    void CompleteFrameStats();
+
     // set transformation matrix for drawing gui elements
     // @param matrix: Transformation matrix, null for reset current
     void SetCurrentTransform(glm::mat4* matrix);
@@ -27,6 +44,23 @@ public:
     bool EnterChildClipArea(const Rectangle& rcLocal);
     void LeaveChildClipArea();
 
+    // compute clip rect of local area of current transformation within specified clip rect
+    // @param rcLocal: Local area
+    // @param currentCliprect: Parent clip rect, scissor box coordinates
+    // @param childCliprect: Output clip rect
+    // @returns false if area is being cut off entirely
+    bool ComputeChildClipArea(const Rectangle& rcLocal, const Rectangle& currentCliprect, Rectangle& childCliprect) const;
+
+    // redirect drawing operations to draw list instead of batching them for current frame,
+    // used to cache widgets geometry for retained rendering
+    // @param drawList: Target draw list, null to stop recording
+    void SetRecordDrawList(GuiDrawList* drawList);
+
+    // draw geometry recorded earlier, pending drawing operations are flushed first
+    // @param drawList: Recorded geometry
+    // @param vertexBuffer: Buffer containing draw list vertices
+    void DrawRecordedList(const GuiDrawList& drawList, GpuBuffer* vertexBuffer);
+
     // draw without textures
     void FillRect(const Rectangle& rect, Color32 fillColor);
     void DrawRect(const Rectangle& rect, Color32 lineColor, int lineWidth = 1);
@@ -45,7 +79,10 @@ private:
     void FlushPendingDrawCalls();
 
     void SetCurrentBatchTexture(Texture2D* newTexutre);
-    void TransformVertices(Vertex2D* vertices);
+    void TransformVertices(Vertex2D* vertices, int numVerts);
+
+    // allocate vertices within current batch or recorded draw list
+    Vertex2D* AllocateVertices(Texture2D* texture, int numVerts);
     void TransformClipRect(Rectangle& rectangle) const;
 
 private:
@@ -56,6 +93,8 @@ private:
     glm::mat4* mCurrentTransform = nullptr;
     std::vector<Rectangle> mClipRectsStack;
     GpuBuffer* mVertexBuffer = nullptr;
+    FrameStats mFrameStats;
+    GuiDrawList* mRecordDrawList = nullptr;
     // current batch data
     Texture2D* mCurrentTexture = nullptr;
     int mBatchVertexCount = 0;
@@ -206,6 +206,8 @@ void GuiWidget::LoadProperties(cxx::json_node_object documentNode)
     cxx::json_get_attribute(documentNode, "draw_borders", mHasDrawBordersAttribute);
 
     HandleLoadProperties(documentNode);
+    InvalidateRender();
+    InvalidatePickTree();
 }
 
 GuiWidget* GuiWidget::GetLastChild() const
@@ -271,6 +273,59 @@ void GuiWidget::RenderFrame(GuiRenderer& renderContext)
             return;
     }
 
+    RenderContent(renderContext);
+
+    for (GuiWidget* currChild = mFirstChild; currChild; 
+        currChild = currChild->mNextSibling)
+    {
+        currChild->RenderFrame(renderContext);
+    }
+
+    if (isClipChildren)
+    {
+        renderContext.LeaveChildClipArea();
+    }
+}
+
+void GuiWidget::CollectDrawList(GuiRenderer& renderContext, GuiDrawList& drawList, const Rectangle& clipRect)
+{
+    ComputeTransform();
+
+    if (!IsVisibleWithParent())
+        return;
+
+    renderContext.SetCurrentTransform(&mTransform);
+
+    Rectangle currentCliprect = clipRect;
+    if (mClipChildren)
+    {
+        Rectangle rcLocal = GetLocalRect();
+        if (!renderContext.ComputeChildClipArea(rcLocal, clipRect, currentCliprect))
+            return;
+    }
+
+    if (mRenderInvalidated)
+    {
+        mRenderCache.Clear();
+
+        renderContext.SetRecordDrawList(&mRenderCache);
+        RenderContent(renderContext);
+        renderContext.SetRecordDrawList(nullptr);
+
+        mRenderInvalidated = false;
+    }
+
+    drawList.AppendDrawList(mRenderCache, currentCliprect);
+
+    for (GuiWidget* currChild = mFirstChild; currChild; 
+        currChild = currChild->mNextSibling)
+    {
+        currChild->CollectDrawList(renderContext, drawList, currentCliprect);
+    }
+}
+
+void GuiWidget::RenderContent(GuiRenderer& renderContext)
+{
     if (mHasDrawBackgroundAttribute || mHasDrawBordersAttribute)
     {
         Rectangle rcLocal = GetLocalRect();
@@ -285,17 +340,6 @@ void GuiWidget::RenderFrame(GuiRenderer& renderContext)
     }
 
     HandleRender(renderContext);
-
-    for (GuiWidget* currChild = mFirstChild; currChild; 
-        currChild = currChild->mNextSibling)
-    {
-        currChild->RenderFrame(renderContext);
-    }
-
-    if (isClipChildren)
-    {
-        renderContext.LeaveChildClipArea();
-    }
 }
 
 void GuiWidget::UpdateFrame(float deltaTime)
@@ -442,6 +486,8 @@ bool GuiWidget::AttachChild(GuiWidget* widget)
 
     widget->mParent = this;
     widget->InvalidateTransform();
+    widget->InvalidateRender();
+    InvalidatePickTree();
     widget->SetupAnchorsOffsets();
     widget->ParentSizeChanged(mSize, mSize);
     UpdateLayout();
@@ -458,6 +504,8 @@ bool GuiWidget::DetachChild(GuiWidget* widget)
     }
 
     widget->SetDetached();
+    InvalidateRenderTree();
+    InvalidatePickTree();
 
     UpdateLayout();
     HandleChildDetached(widget);
@@ -734,7 +782,11 @@ bool GuiWidget::IsEnabledWithParent() const
 
 void GuiWidget::SetClipChildren(bool isEnabled)
 {
+    if (mClipChildren == isEnabled)
+        return;
+
     mClipChildren = isEnabled;
+    InvalidateRenderTree();
 }
 
 void GuiWidget::SetMinSize(const Point& minSize)
@@ -749,12 +801,20 @@ void GuiWidget::SetMaxSize(const Point& maxSize)
 
 void GuiWidget::SetDrawBackground(bool isEnabled)
 {
+    if (mHasDrawBackgroundAttribute == isEnabled)
+        return;
+
     mHasDrawBackgroundAttribute = isEnabled;
+    InvalidateRender();
 }
 
 void GuiWidget::SetDrawBorders(bool isEnabled)
 {
+    if (mHasDrawBordersAttribute == isEnabled)
+        return;
+
     mHasDrawBordersAttribute = isEnabled;
+    InvalidateRender();
 }
 
 void GuiWidget::SetVisible(bool isVisible)
@@ -839,6 +899,9 @@ void GuiWidget::InvalidateTransform()
         return;
 
     mTransformInvalidated = true;
+    InvalidateRender(); // geometry is cached in screen space
+    InvalidatePickTree();
+
     for (GuiWidget* currChild = mFirstChild; currChild; 
         currChild = currChild->mNextSibling)
     {
@@ -846,6 +909,32 @@ void GuiWidget::InvalidateTransform()
     }
 }
 
+void GuiWidget::InvalidateRender()
+{
+    mRenderInvalidated = true;
+    InvalidateRenderTree();
+}
+
+void GuiWidget::InvalidateRenderTree()
+{
+    GuiWidget* rootWidget = this;
+    while (rootWidget->mParent)
+    {
+        rootWidget = rootWidget->mParent;
+    }
+    rootWidget->mRenderTreeInvalidated = true;
+}
+
+void GuiWidget::InvalidatePickTree()
+{
+    GuiWidget* rootWidget = this;
+    while (rootWidget->mParent)
+    {
+        rootWidget = rootWidget->mParent;
+    }
+    rootWidget->mPickTreeInvalidated = true;
+}
+
 void GuiWidget::ParentPositionChanged(const Point& prevPosition)
 {
     InvalidateTransform();
@@ -982,6 +1071,8 @@ void GuiWidget::SizeChanged(const Point& prevSize, bool setAnchors)
         mOrigin = ComputeOriginPixels();
         InvalidateTransform();
     }
+    InvalidateRender();
+    InvalidatePickTree();
 
     for (GuiWidget* currChild = mFirstChild; currChild; 
         currChild = currChild->mNextSibling)
@@ -1009,6 +1100,8 @@ void GuiWidget::ShownStateChanged()
         GuiEvent eventData(this, GuiEventId_OnShow);
         DispatchEvent(eventData);
     }
+    InvalidateRenderTree();
+    InvalidatePickTree();
 
     for (GuiWidget* currChild = mFirstChild; currChild; 
         currChild = currChild->mNextSibling)
@@ -1031,6 +1124,7 @@ void GuiWidget::EnableStateChanged()
         GuiEvent eventData(this, GuiEventId_OnEnable);
         DispatchEvent(eventData);
     }
+    InvalidateRender();
 
     for (GuiWidget* currChild = mFirstChild; currChild; 
         currChild = currChild->mNextSibling)
@@ -1053,6 +1147,7 @@ void GuiWidget::HoveredStateChanged()
         GuiEvent eventData = GuiEvent::MouseLeaveEvent(this, gInputsManager.mCursorPosition);
         DispatchEvent(eventData);
     }
+    InvalidateRender();
 
     HandleHoveredStateChanged();
 }
@@ -1071,6 +1166,7 @@ void GuiWidget::PressedStateChanged()
 
         mPressMouseButton = eMouseButton_null;
     }
+    InvalidateRender();
 
     HandlePressedStateChanged();
 }
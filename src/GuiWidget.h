@@ -12,6 +12,7 @@ class GuiWidget: public cxx::handled_object<GuiWidget>
     friend class GuiAction;
     friend class GuiLayout;
     friend class GuiScreen;
+    friend class GuiPickGrid;
 
 public:
     
@@ -44,6 +45,12 @@ public:
     // render widget and all children
     // @param renderContext: Gui render context
     void RenderFrame(GuiRenderer& renderContext);
+
+    // collect cached geometry of widget and all visible children, geometry of invalidated widgets is rebuilt
+    // @param renderContext: Gui render context
+    // @param drawList: Output draw list
+    // @param clipRect: Parent clip rect, scissor box coordinates
+    void CollectDrawList(GuiRenderer& renderContext, GuiDrawList& drawList, const Rectangle& clipRect);
 
     // process widget logic and all children
     // @param deltaTime: Time passed since previous update
@@ -184,6 +191,9 @@ public:
     void ComputeTransform();
     void InvalidateTransform();
 
+    // force rebuild cached geometry, should be called after colors changed
+    void InvalidateRender();
+
     // clone widget with or without its chindren
     GuiWidget* Clone();
     GuiWidget* CloneDeep();
@@ -230,6 +240,15 @@ protected:
     void SetDetached();
     void SetupAnchorsOffsets();
 
+    // draw background, borders and widget content
+    void RenderContent(GuiRenderer& renderContext);
+
+    // notify root widget that retained draw list should be rebuilt
+    void InvalidateRenderTree();
+
+    // notify root widget that pick grid should be rebuilt
+    void InvalidatePickTree();
+
     // mouse capture
     void GetMouseCapture();
     void ReleaseMouseCapture();
@@ -305,6 +324,8 @@ protected:
 
     glm::mat4 mTransform; // current transformations matrix, screen space
 
+    GuiDrawList mRenderCache; // widget geometry in screen space, children are not included
+
     // attributes
     bool mHasInteractiveAttribute = false; // widget receiving mouse inputs and can be pressed or hovered
     bool mHasDisablePickChildrenAttribute = false; // cannot pick child widgets
@@ -317,6 +338,9 @@ protected:
 
     // state flags
     bool mTransformInvalidated = true; // transformations matrix dirty
+    bool mRenderInvalidated = true; // cached geometry dirty
+    bool mRenderTreeInvalidated = true; // geometry or visibility of some widgets within hierarchy changed, root widget only
+    bool mPickTreeInvalidated = true; // layout or visibility of some widgets within hierarchy changed, root widget only
     bool mHovered = false;
     bool mPressed = false;
 
@@ -9,6 +9,8 @@
 #include "TimeManager.h"
 #include "ToolsUIManager.h"
 #include "GraphicsDevice.h"
+#include "randomizer.h"
+#include "Console.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -19,6 +21,9 @@
 #define MESH_VIEW_CAMERA_FAR        100.0f
 #define MESH_VIEW_CAMERA_FOVY       60.0f
 
+#define MESH_VIEW_STRESS_MODELS_SPACING     1.0f
+#define MESH_VIEW_STRESS_MODELS_PHASES      16
+
 //////////////////////////////////////////////////////////////////////////
 
 void MeshViewGamestate::HandleGamestateEnter()
@@ -46,6 +51,8 @@ void MeshViewGamestate::HandleGamestateEnter()
 
 void MeshViewGamestate::HandleGamestateLeave()
 {
+    ClearStressScene();
+
     gRenderScene.SetCameraController(nullptr);
     if (mModelObject)
     {
@@ -84,3 +91,71 @@ void MeshViewGamestate::HandleScreenResolutionChanged()
 {
     gRenderScene.mCamera.SetPerspective(gGraphicsDevice.GetScreenResolutionAspect(), MESH_VIEW_CAMERA_FOVY, MESH_VIEW_CAMERA_NEAR, MESH_VIEW_CAMERA_FAR);
 }
+
+void MeshViewGamestate::SetupStressScene(int modelsCount, const std::string& modelName)
+{
+    ClearStressScene();
+
+    ModelAsset* modelAsset = gModelsManager.LoadModelAsset(modelName);
+    if (modelAsset == nullptr)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot load model asset '%s'", modelName.c_str());
+        return;
+    }
+
+    if (mModelObject)
+    {
+        mModelObject->SetActive(false);
+    }
+
+    // place models on square grid around origin
+    const int GridSize = (int) std::ceil(std::sqrt((float) modelsCount));
+    const float GridOffset = (GridSize - 1) * MESH_VIEW_STRESS_MODELS_SPACING * 0.5f;
+
+    cxx::randomizer random;
+    mStressSceneModels.reserve(modelsCount);
+    for (int imodel = 0; imodel < modelsCount; ++imodel)
+    {
+        RenderableModel* modelObject = new RenderableModel;
+        modelObject->SetModelAsset(modelAsset);
+        modelObject->SetPosition(glm::vec3(
+            (imodel % GridSize) * MESH_VIEW_STRESS_MODELS_SPACING - GridOffset, 0.0f,
+            (imodel / GridSize) * MESH_VIEW_STRESS_MODELS_SPACING - GridOffset));
+        // limited number of animation phases, models in same phase share frames
+        if (modelObject->StartAnimation(24.0f, true))
+        {
+            int animationPhase = random.generate_int(MESH_VIEW_STRESS_MODELS_PHASES);
+            modelObject->AdvanceAnimation(modelObject->mAnimState.mAnimationEndTime * animationPhase / MESH_VIEW_STRESS_MODELS_PHASES);
+        }
+        mStressSceneModels.push_back(modelObject);
+    }
+
+    mOrbitCameraController.SetParams(MESH_VIEW_CAMERA_YAW_DEG, MESH_VIEW_CAMERA_PITCH_DEG, 
+        std::max(MESH_VIEW_CAMERA_DISTANCE, GridOffset * 1.5f));
+    mOrbitCameraController.ResetOrientation();
+
+    gGameMain.mFpsWindow.SetWindowShown(true);
+    gConsole.LogMessage(eLogMessage_Info, "Stress scene: %d models of '%s'", modelsCount, modelName.c_str());
+}
+
+void MeshViewGamestate::ClearStressScene()
+{
+    if (mStressSceneModels.empty())
+        return;
+
+    for (RenderableModel* modelObject: mStressSceneModels)
+    {
+        modelObject->DestroyObject();
+    }
+    mStressSceneModels.clear();
+
+    if (mModelObject)
+    {
+        mModelObject->SetActive(true);
+    }
+
+    mOrbitCameraController.SetParams(MESH_VIEW_CAMERA_YAW_DEG, MESH_VIEW_CAMERA_PITCH_DEG, MESH_VIEW_CAMERA_DISTANCE);
+    mOrbitCameraController.ResetOrientation();
+
+    gGameMain.mFpsWindow.SetWindowShown(false);
+}
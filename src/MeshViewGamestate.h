@@ -30,8 +30,15 @@ public:
 
     void HandleScreenResolutionChanged() override;
 
+    // spawn grid of animating models with different animation phases, previous ones get destroyed
+    // @param modelsCount: Number of models
+    // @param modelName: Model asset name
+    void SetupStressScene(int modelsCount, const std::string& modelName);
+    void ClearStressScene();
+
 private:
     OrbitCameraController mOrbitCameraController;
     RenderableModel* mModelObject = nullptr;
+    std::vector<RenderableModel*> mStressSceneModels;
     ToolsUIMeshViewWindow mMeshViewWindow;
 };
@@ -154,11 +154,17 @@ inline GLenum GetAttributeDataTypeGL(eVertexAttributeFormat attributeFormat)
 {
     switch (attributeFormat)
     {
+        case eVertexAttributeFormat_1F: return GL_FLOAT;
         case eVertexAttributeFormat_2F: return GL_FLOAT;
         case eVertexAttributeFormat_3F: return GL_FLOAT;
+        case eVertexAttributeFormat_4F: return GL_FLOAT;
         case eVertexAttributeFormat_4UB: return GL_UNSIGNED_BYTE;
         case eVertexAttributeFormat_1US: return GL_UNSIGNED_SHORT;
         case eVertexAttributeFormat_2US: return GL_UNSIGNED_SHORT;
+        case eVertexAttributeFormat_2S: return GL_SHORT;
+        case eVertexAttributeFormat_4S: return GL_SHORT;
+        case eVertexAttributeFormat_2HF: return GL_HALF_FLOAT;
+        case eVertexAttributeFormat_4HF: return GL_HALF_FLOAT;
     }
     debug_assert(false);
     return GL_UNSIGNED_BYTE;
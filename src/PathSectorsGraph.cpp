@@ -0,0 +1,574 @@
+#include "pch.h"
+#include "PathSectorsGraph.h"
+#include "GameWorld.h"
+#include "TerrainTile.h"
+#include "Console.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+const int PathEntranceSplitLength = 6; // long entrances get node at each end
+
+const float PathSectorsDiagonalDistance = 1.41421356f;
+
+//////////////////////////////////////////////////////////////////////////
+
+// get index of tile within sector area
+inline int GetSectorTileIndex(const Rectangle& sectorArea, const Point& tileLocation)
+{
+    return (tileLocation.y - sectorArea.y) * sectorArea.w + (tileLocation.x - sectorArea.x);
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+PathSectorsGraph::~PathSectorsGraph()
+{
+    Clear();
+}
+
+void PathSectorsGraph::Setup(const Point& mapDimensions, const std::vector<float>* tileCosts)
+{
+    Clear();
+
+    debug_assert(tileCosts);
+    mMapDimensions = mapDimensions;
+    mTileCosts = tileCosts;
+
+    mSectorsDimensions.x = (mapDimensions.x + SectorSizeTiles - 1) / SectorSizeTiles;
+    mSectorsDimensions.y = (mapDimensions.y + SectorSizeTiles - 1) / SectorSizeTiles;
+
+    const int sectorsCount = mSectorsDimensions.x * mSectorsDimensions.y;
+    if (sectorsCount == 0)
+        return;
+
+    mSectors.resize(sectorsCount);
+    for (int sectory = 0; sectory < mSectorsDimensions.y; ++sectory)
+    for (int sectorx = 0; sectorx < mSectorsDimensions.x; ++sectorx)
+    {
+        Rectangle& sectorArea = mSectors[sectory * mSectorsDimensions.x + sectorx].mArea;
+        sectorArea.x = sectorx * SectorSizeTiles;
+        sectorArea.y = sectory * SectorSizeTiles;
+        sectorArea.w = std::min(SectorSizeTiles, mapDimensions.x - sectorArea.x);
+        sectorArea.h = std::min(SectorSizeTiles, mapDimensions.y - sectorArea.y);
+    }
+
+    // nodes depend on entrances of neighbour sectors, so scan all borders first
+    for (int isector = 0; isector < sectorsCount; ++isector)
+    {
+        ScanEntrances(isector, eDirection_E);
+        ScanEntrances(isector, eDirection_S);
+    }
+
+    for (int isector = 0; isector < sectorsCount; ++isector)
+    {
+        BuildNodes(isector);
+    }
+
+    const unsigned int allocateStates = std::max(GetNodesCount() * 2, 256);
+    mPather = new micropather::MicroPather(this, allocateStates, eDirection_COUNT, false);
+}
+
+void PathSectorsGraph::Clear()
+{
+    SafeDelete(mPather);
+
+    mSectors.clear();
+    mInvalidatedSectors.clear();
+    mRebuiltSectorsCount = 0;
+    mTileCosts = nullptr;
+    mMapDimensions = Point();
+    mSectorsDimensions = Point();
+}
+
+void PathSectorsGraph::InvalidateTile(const Point& tileLocation)
+{
+    if (mSectors.empty())
+        return;
+
+    const int sectorIndex = GetSectorIndex(tileLocation);
+    if (!mSectors[sectorIndex].mIsInvalidated)
+    {
+        mSectors[sectorIndex].mIsInvalidated = true;
+        mInvalidatedSectors.push_back(sectorIndex);
+    }
+}
+
+void PathSectorsGraph::UpdateSectors()
+{
+    if (mInvalidatedSectors.empty())
+        return;
+
+    // entrances on all borders of changed sectors are affected,
+    // so nodes of neighbour sectors must be rebuilt as well
+    std::vector<int> rebuildSectors;
+    for (int sectorIndex: mInvalidatedSectors)
+    {
+        mSectors[sectorIndex].mIsInvalidated = false;
+
+        const int sectorx = sectorIndex % mSectorsDimensions.x;
+        const int sectory = sectorIndex / mSectorsDimensions.x;
+
+        ScanEntrances(sectorIndex, eDirection_E);
+        ScanEntrances(sectorIndex, eDirection_S);
+        if (sectorx > 0)
+        {
+            ScanEntrances(sectorIndex - 1, eDirection_E);
+        }
+        if (sectory > 0)
+        {
+            ScanEntrances(sectorIndex - mSectorsDimensions.x, eDirection_S);
+        }
+
+        const int affectedSectors[] =
+        {
+            sectorIndex,
+            sectorx > 0 ? sectorIndex - 1 : -1,
+            sectorx < mSectorsDimensions.x - 1 ? sectorIndex + 1 : -1,
+            sectory > 0 ? sectorIndex - mSectorsDimensions.x : -1,
+            sectory < mSectorsDimensions.y - 1 ? sectorIndex + mSectorsDimensions.x : -1,
+        };
+        for (int affectedSector: affectedSectors)
+        {
+            if (affectedSector > -1 && !cxx::contains(rebuildSectors, affectedSector))
+            {
+                rebuildSectors.push_back(affectedSector);
+            }
+        }
+    }
+    mInvalidatedSectors.clear();
+
+    for (int sectorIndex: rebuildSectors)
+    {
+        BuildNodes(sectorIndex);
+    }
+    mRebuiltSectorsCount += (int) rebuildSectors.size();
+
+    // solver keeps states graph between queries
+    mPather->Reset();
+}
+
+bool PathSectorsGraph::FindWaypoints(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputWaypoints, float* outputCost)
+{
+    outputWaypoints.clear();
+    if (outputCost)
+    {
+        *outputCost = 0.0f;
+    }
+
+    if (mPather == nullptr || startTile == nullptr || goalTile == nullptr)
+    {
+        debug_assert(false);
+        return false;
+    }
+
+    UpdateSectors();
+
+    if (GetTileCost(goalTile->mTileLocation.x, goalTile->mTileLocation.y) < 0.0f)
+        return false;
+
+    mQueryStartTile = startTile;
+    mQueryGoalTile = goalTile;
+
+    const PathSector& startSector = mSectors[GetSectorIndex(startTile->mTileLocation)];
+    ComputeDistances(startSector, startTile->mTileLocation, mQueryStartDistances, nullptr);
+
+    // adjacency of start and goal tiles depends on query, drop states cached by previous one
+    mPather->Reset();
+
+    MP_VECTOR<void*> pathStates;
+    float pathCost = 0.0f;
+
+    int solveResult = mPather->Solve(startTile, goalTile, &pathStates, &pathCost);
+    if (solveResult == micropather::MicroPather::SOLVED)
+    {
+        for (unsigned int istate = 1; istate < pathStates.size(); ++istate)
+        {
+            outputWaypoints.push_back(static_cast<TerrainTile*>(pathStates[istate]));
+        }
+        if (outputCost)
+        {
+            *outputCost = pathCost;
+        }
+    }
+    else if (solveResult == micropather::MicroPather::START_END_SAME)
+    {
+        outputWaypoints.push_back(goalTile);
+    }
+
+    mQueryStartTile = nullptr;
+    mQueryGoalTile = nullptr;
+    return !outputWaypoints.empty();
+}
+
+bool PathSectorsGraph::FindLocalPath(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputPath) const
+{
+    debug_assert(startTile && goalTile);
+
+    const Point& startLocation = startTile->mTileLocation;
+    const Point& goalLocation = goalTile->mTileLocation;
+    if (GetTileCost(goalLocation.x, goalLocation.y) < 0.0f)
+        return false;
+
+    const int sectorIndex = GetSectorIndex(startLocation);
+    if (sectorIndex != GetSectorIndex(goalLocation))
+    {
+        // step through entrance
+        if (std::abs(startLocation.x - goalLocation.x) + std::abs(startLocation.y - goalLocation.y) == 1)
+        {
+            outputPath.push_back(goalTile);
+            return true;
+        }
+        return false;
+    }
+
+    const PathSector& sector = mSectors[sectorIndex];
+
+    float distances[SectorMaxTiles];
+    int parents[SectorMaxTiles];
+    ComputeDistances(sector, startLocation, distances, parents);
+
+    const int goalIndex = GetSectorTileIndex(sector.mArea, goalLocation);
+    if (distances[goalIndex] == FLT_MAX)
+        return false;
+
+    // trace back from goal tile
+    const size_t insertPosition = outputPath.size();
+    for (int currIndex = goalIndex; parents[currIndex] > -1; currIndex = parents[currIndex])
+    {
+        const Point tileLocation (sector.mArea.x + currIndex % sector.mArea.w, sector.mArea.y + currIndex / sector.mArea.w);
+        outputPath.push_back(gGameWorld.mMapData.GetMapTile(tileLocation));
+    }
+    std::reverse(outputPath.begin() + insertPosition, outputPath.end());
+    return true;
+}
+
+int PathSectorsGraph::GetNodesCount() const
+{
+    int nodesCount = 0;
+    for (const PathSector& currSector: mSectors)
+    {
+        nodesCount += (int) currSector.mNodes.size();
+    }
+    return nodesCount;
+}
+
+int PathSectorsGraph::GetSectorIndex(const Point& tileLocation) const
+{
+    return (tileLocation.y / SectorSizeTiles) * mSectorsDimensions.x + (tileLocation.x / SectorSizeTiles);
+}
+
+float PathSectorsGraph::GetTileCost(int tilex, int tiley) const
+{
+    return (*mTileCosts)[tiley * mMapDimensions.x + tilex];
+}
+
+void PathSectorsGraph::ScanEntrances(int sectorIndex, eDirection borderDirection)
+{
+    debug_assert(borderDirection == eDirection_E || borderDirection == eDirection_S);
+
+    PathSector& sector = mSectors[sectorIndex];
+    const Rectangle& area = sector.mArea;
+
+    const bool isEastBorder = (borderDirection == eDirection_E);
+
+    std::vector<SectorEntrance>& entrances = isEastBorder ? sector.mEntrancesE : sector.mEntrancesS;
+    entrances.clear();
+
+    // no neighbour sector
+    if (isEastBorder ? (area.x + area.w >= mMapDimensions.x) : (area.y + area.h >= mMapDimensions.y))
+        return;
+
+    const int borderLength = isEastBorder ? area.h : area.w;
+    const Point borderStart = isEastBorder ? Point(area.x + area.w - 1, area.y) : Point(area.x, area.y + area.h - 1);
+    const Point borderStep = isEastBorder ? Point(0, 1) : Point(1, 0);
+    const Point outerOffset = GetDirectionVector(borderDirection);
+
+    auto AddEntrance = [&](int borderPosition)
+    {
+        const Point innerLocation = borderStart + Point(borderStep.x * borderPosition, borderStep.y * borderPosition);
+
+        SectorEntrance sectorEntrance;
+        sectorEntrance.mInnerTile = gGameWorld.mMapData.GetMapTile(innerLocation);
+        sectorEntrance.mOuterTile = gGameWorld.mMapData.GetMapTile(innerLocation + outerOffset);
+        debug_assert(sectorEntrance.mInnerTile && sectorEntrance.mOuterTile);
+        entrances.push_back(sectorEntrance);
+    };
+
+    // find runs of passable tiles pairs
+    int runStart = -1;
+    for (int iborder = 0; iborder <= borderLength; ++iborder)
+    {
+        bool isPassable = false;
+        if (iborder < borderLength)
+        {
+            const Point innerLocation = borderStart + Point(borderStep.x * iborder, borderStep.y * iborder);
+            const Point outerLocation = innerLocation + outerOffset;
+            isPassable = GetTileCost(innerLocation.x, innerLocation.y) >= 0.0f &&
+                GetTileCost(outerLocation.x, outerLocation.y) >= 0.0f;
+        }
+
+        if (isPassable)
+        {
+            if (runStart < 0)
+            {
+                runStart = iborder;
+            }
+            continue;
+        }
+
+        if (runStart < 0)
+            continue;
+
+        const int runLength = iborder - runStart;
+        if (runLength < PathEntranceSplitLength)
+        {
+            AddEntrance(runStart + runLength / 2);
+        }
+        else
+        {
+            AddEntrance(runStart);
+            AddEntrance(iborder - 1);
+        }
+        runStart = -1;
+    }
+}
+
+void PathSectorsGraph::BuildNodes(int sectorIndex)
+{
+    PathSector& sector = mSectors[sectorIndex];
+    sector.mNodes.clear();
+
+    const int sectorx = sectorIndex % mSectorsDimensions.x;
+    const int sectory = sectorIndex / mSectorsDimensions.x;
+
+    // west and north neighbours own entrances on shared borders
+    const PathSector* sectorW = (sectorx > 0) ? &mSectors[sectorIndex - 1] : nullptr;
+    const PathSector* sectorN = (sectory > 0) ? &mSectors[sectorIndex - mSectorsDimensions.x] : nullptr;
+
+    auto AddNode = [&sector](TerrainTile* terrainTile)
+    {
+        for (const SectorNode& currNode: sector.mNodes)
+        {
+            if (currNode.mTile == terrainTile)
+                return;
+        }
+        sector.mNodes.emplace_back();
+        sector.mNodes.back().mTile = terrainTile;
+    };
+
+    for (const SectorEntrance& currEntrance: sector.mEntrancesE) AddNode(currEntrance.mInnerTile);
+    for (const SectorEntrance& currEntrance: sector.mEntrancesS) AddNode(currEntrance.mInnerTile);
+    if (sectorW)
+    {
+        for (const SectorEntrance& currEntrance: sectorW->mEntrancesE) AddNode(currEntrance.mOuterTile);
+    }
+    if (sectorN)
+    {
+        for (const SectorEntrance& currEntrance: sectorN->mEntrancesS) AddNode(currEntrance.mOuterTile);
+    }
+
+    for (SectorNode& currNode: sector.mNodes)
+    {
+        currNode.mEdges.clear();
+        ComputeDistances(sector, currNode.mTile->mTileLocation, currNode.mDistances, nullptr);
+
+        // edges to nodes within sector
+        for (const SectorNode& otherNode: sector.mNodes)
+        {
+            if (&otherNode == &currNode)
+                continue;
+
+            const float distance = currNode.mDistances[GetSectorTileIndex(sector.mArea, otherNode.mTile->mTileLocation)];
+            if (distance == FLT_MAX)
+                continue;
+
+            micropather::StateCost stateCost;
+            stateCost.state = otherNode.mTile;
+            stateCost.cost = distance;
+            currNode.mEdges.push_back(stateCost);
+        }
+
+        // edges through entrances
+        auto AddEntranceEdge = [this, &currNode](TerrainTile* targetTile)
+        {
+            micropather::StateCost stateCost;
+            stateCost.state = targetTile;
+            stateCost.cost = GetTileCost(targetTile->mTileLocation.x, targetTile->mTileLocation.y);
+            currNode.mEdges.push_back(stateCost);
+        };
+
+        for (const SectorEntrance& currEntrance: sector.mEntrancesE)
+        {
+            if (currEntrance.mInnerTile == currNode.mTile) AddEntranceEdge(currEntrance.mOuterTile);
+        }
+        for (const SectorEntrance& currEntrance: sector.mEntrancesS)
+        {
+            if (currEntrance.mInnerTile == currNode.mTile) AddEntranceEdge(currEntrance.mOuterTile);
+        }
+        if (sectorW)
+        {
+            for (const SectorEntrance& currEntrance: sectorW->mEntrancesE)
+            {
+                if (currEntrance.mOuterTile == currNode.mTile) AddEntranceEdge(currEntrance.mInnerTile);
+            }
+        }
+        if (sectorN)
+        {
+            for (const SectorEntrance& currEntrance: sectorN->mEntrancesS)
+            {
+                if (currEntrance.mOuterTile == currNode.mTile) AddEntranceEdge(currEntrance.mInnerTile);
+            }
+        }
+    }
+}
+
+const PathSectorsGraph::SectorNode* PathSectorsGraph::FindNode(const PathSector& sector, const TerrainTile* terrainTile) const
+{
+    for (const SectorNode& currNode: sector.mNodes)
+    {
+        if (currNode.mTile == terrainTile)
+            return &currNode;
+    }
+    return nullptr;
+}
+
+void PathSectorsGraph::ComputeDistances(const PathSector& sector, const Point& originTile, float* distances, int* parents) const
+{
+    const Rectangle& area = sector.mArea;
+    const int tilesCount = area.w * area.h;
+
+    bool visited[SectorMaxTiles];
+    for (int itile = 0; itile < tilesCount; ++itile)
+    {
+        visited[itile] = false;
+        distances[itile] = FLT_MAX;
+        if (parents)
+        {
+            parents[itile] = -1;
+        }
+    }
+    distances[GetSectorTileIndex(area, originTile)] = 0.0f;
+
+    // sector is small, so plain dijkstra without priority queue
+    for (;;)
+    {
+        int currIndex = -1;
+        float currDistance = FLT_MAX;
+        for (int itile = 0; itile < tilesCount; ++itile)
+        {
+            if (!visited[itile] && distances[itile] < currDistance)
+            {
+                currIndex = itile;
+                currDistance = distances[itile];
+            }
+        }
+
+        if (currIndex < 0)
+            break;
+
+        visited[currIndex] = true;
+
+        const Point currLocation (area.x + currIndex % area.w, area.y + currIndex / area.w);
+        for (int idirection = 0; idirection < eDirection_COUNT; ++idirection)
+        {
+            const Point directionVector = GetDirectionVector((eDirection) idirection);
+            const Point neighbourLocation = currLocation + directionVector;
+            if (!area.PointWithin(neighbourLocation))
+                continue;
+
+            const float neighbourCost = GetTileCost(neighbourLocation.x, neighbourLocation.y);
+            if (neighbourCost < 0.0f)
+                continue;
+
+            float distance = 1.0f;
+            // diagonal directions are odd, don't allow to cut corners
+            if (idirection % 2)
+            {
+                if (GetTileCost(currLocation.x + directionVector.x, currLocation.y) < 0.0f ||
+                    GetTileCost(currLocation.x, currLocation.y + directionVector.y) < 0.0f)
+                {
+                    continue;
+                }
+                distance = PathSectorsDiagonalDistance;
+            }
+
+            const int neighbourIndex = GetSectorTileIndex(area, neighbourLocation);
+            const float neighbourDistance = currDistance + distance * neighbourCost;
+            if (neighbourDistance < distances[neighbourIndex])
+            {
+                distances[neighbourIndex] = neighbourDistance;
+                if (parents)
+                {
+                    parents[neighbourIndex] = currIndex;
+                }
+            }
+        }
+    }
+}
+
+float PathSectorsGraph::LeastCostEstimate(void* stateStart, void* stateEnd)
+{
+    const TerrainTile* startTile = static_cast<const TerrainTile*>(stateStart);
+    const TerrainTile* endTile = static_cast<const TerrainTile*>(stateEnd);
+
+    // octile distance, minimal tile cost is 1
+    const int distancex = std::abs(startTile->mTileLocation.x - endTile->mTileLocation.x);
+    const int distancey = std::abs(startTile->mTileLocation.y - endTile->mTileLocation.y);
+    const int straightSteps = std::abs(distancex - distancey);
+    const int diagonalSteps = std::min(distancex, distancey);
+    return straightSteps + diagonalSteps * PathSectorsDiagonalDistance;
+}
+
+void PathSectorsGraph::AdjacentCost(void* state, MP_VECTOR<micropather::StateCost>* adjacent)
+{
+    const TerrainTile* terrainTile = static_cast<const TerrainTile*>(state);
+
+    const int sectorIndex = GetSectorIndex(terrainTile->mTileLocation);
+    const PathSector& sector = mSectors[sectorIndex];
+
+    const float* distances = nullptr;
+    if (const SectorNode* sectorNode = FindNode(sector, terrainTile))
+    {
+        for (const micropather::StateCost& currEdge: sectorNode->mEdges)
+        {
+            adjacent->push_back(currEdge);
+        }
+        distances = sectorNode->mDistances;
+    }
+    else if (terrainTile == mQueryStartTile)
+    {
+        distances = mQueryStartDistances;
+        // start tile connects to reachable entrance nodes of its sector
+        for (const SectorNode& currNode: sector.mNodes)
+        {
+            const float distance = distances[GetSectorTileIndex(sector.mArea, currNode.mTile->mTileLocation)];
+            if (distance == FLT_MAX)
+                continue;
+
+            micropather::StateCost stateCost;
+            stateCost.state = currNode.mTile;
+            stateCost.cost = distance;
+            adjacent->push_back(stateCost);
+        }
+    }
+
+    // goal tile connects to tiles of its sector unless it is entrance node itself
+    if (distances && mQueryGoalTile && mQueryGoalTile != terrainTile &&
+        GetSectorIndex(mQueryGoalTile->mTileLocation) == sectorIndex &&
+        FindNode(sector, mQueryGoalTile) == nullptr)
+    {
+        const float distance = distances[GetSectorTileIndex(sector.mArea, mQueryGoalTile->mTileLocation)];
+        if (distance < FLT_MAX)
+        {
+            micropather::StateCost stateCost;
+            stateCost.state = mQueryGoalTile;
+            stateCost.cost = distance;
+            adjacent->push_back(stateCost);
+        }
+    }
+}
+
+void PathSectorsGraph::PrintStateInfo(void* state)
+{
+    const TerrainTile* terrainTile = static_cast<const TerrainTile*>(state);
+    gConsole.LogMessage(eLogMessage_Debug, "(%d, %d)", terrainTile->mTileLocation.x, terrainTile->mTileLocation.y);
+}
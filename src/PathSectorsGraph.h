@@ -0,0 +1,112 @@
+#pragma once
+
+#include "micropather.h"
+
+// hierarchical abstraction over map tiles for long range path queries,
+// map is partitioned into sectors which are connected through entrance tiles on their borders
+class PathSectorsGraph: public cxx::noncopyable, private micropather::Graph
+{
+public:
+    static const int SectorSizeTiles = 8; // matches terrain mesh chunks
+    static const int SectorMaxTiles = SectorSizeTiles * SectorSizeTiles;
+
+public:
+    ~PathSectorsGraph();
+
+    // build sectors for current map
+    // @param mapDimensions: Map size in tiles
+    // @param tileCosts: Movement cost of entering each map tile, negative if impassable
+    void Setup(const Point& mapDimensions, const std::vector<float>* tileCosts);
+    void Clear();
+
+    // tile movement cost was changed, sector will be rebuilt before next query
+    // @param tileLocation: Changed tile
+    void InvalidateTile(const Point& tileLocation);
+
+    // rebuild invalidated sectors and their neighbours
+    void UpdateSectors();
+
+    // find abstract path through sectors entrances
+    // @param startTile, goalTile: Path end points
+    // @param outputWaypoints: Entrance tiles followed by goal tile, start tile is not included
+    // @param outputCost: Optional approximate path cost
+    // @returns false if there is no path
+    bool FindWaypoints(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputWaypoints, float* outputCost);
+
+    // find tiles path between two tiles within same sector or adjacent tiles on sectors border
+    // @param startTile, goalTile: Path end points
+    // @param outputPath: Tiles will be appended, start tile is not included
+    // @returns false if tiles are not in same sector or there is no path within sector
+    bool FindLocalPath(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputPath) const;
+
+    inline int GetSectorsCount() const { return (int) mSectors.size(); }
+
+    // get total number of entrance nodes in all sectors
+    int GetNodesCount() const;
+
+    // get number of sectors rebuilt since setup
+    inline int GetRebuiltSectorsCount() const { return mRebuiltSectorsCount; }
+
+private:
+    // pair of adjacent passable tiles on border between sectors
+    struct SectorEntrance
+    {
+    public:
+        TerrainTile* mInnerTile = nullptr; // belongs to sector
+        TerrainTile* mOuterTile = nullptr; // belongs to east or south neighbour sector
+    };
+
+    struct SectorNode
+    {
+    public:
+        TerrainTile* mTile = nullptr;
+        std::vector<micropather::StateCost> mEdges; // to nodes within same sector and through entrances
+        float mDistances[SectorMaxTiles]; // cost to reach each tile of sector
+    };
+
+    struct PathSector
+    {
+    public:
+        Rectangle mArea;
+        std::vector<SectorEntrance> mEntrancesE;
+        std::vector<SectorEntrance> mEntrancesS;
+        std::vector<SectorNode> mNodes;
+        bool mIsInvalidated = false;
+    };
+
+    int GetSectorIndex(const Point& tileLocation) const;
+    float GetTileCost(int tilex, int tiley) const;
+
+    // find entrances on east or south border of sector
+    void ScanEntrances(int sectorIndex, eDirection borderDirection);
+
+    // collect entrance nodes and compute costs between them
+    void BuildNodes(int sectorIndex);
+
+    const SectorNode* FindNode(const PathSector& sector, const TerrainTile* terrainTile) const;
+
+    // compute costs from origin tile to all tiles of sector
+    // @param parents: Optional, receives previous tile index within sector for each tile
+    void ComputeDistances(const PathSector& sector, const Point& originTile, float* distances, int* parents) const;
+
+    // override micropather::Graph
+    float LeastCostEstimate(void* stateStart, void* stateEnd) override;
+    void AdjacentCost(void* state, MP_VECTOR<micropather::StateCost>* adjacent) override;
+    void PrintStateInfo(void* state) override;
+
+private:
+    Point mMapDimensions;
+    Point mSectorsDimensions;
+    const std::vector<float>* mTileCosts = nullptr;
+
+    std::vector<PathSector> mSectors;
+    std::vector<int> mInvalidatedSectors;
+    int mRebuiltSectorsCount = 0;
+
+    micropather::MicroPather* mPather = nullptr;
+
+    // current query
+    TerrainTile* mQueryStartTile = nullptr;
+    TerrainTile* mQueryGoalTile = nullptr;
+    float mQueryStartDistances[SectorMaxTiles];
+};
@@ -0,0 +1,744 @@
+#include "pch.h"
+#include "PathfindingManager.h"
+#include "GameWorld.h"
+#include "TerrainTile.h"
+#include "Console.h"
+#include "ConsoleVariable.h"
+#include "TasksManager.h"
+#include "randomizer.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// movement costs
+const float PathCostImpassable = -1.0f;
+const float PathCostFloor = 1.0f;
+const float PathCostWater = 2.0f;
+const float PathCostLava = 10.0f;
+
+const float PathDiagonalDistance = 1.41421356f;
+
+// limits
+const int MaxCachedPaths = 16384;
+
+const int PathfindingBenchmarkQueries = 10000;
+const int PathfindingBenchmarkStarts = 128;
+const int PathfindingBenchmarkGoals = 32;
+const int PathfindingSectorsBenchmarkQueries = 1000;
+
+//////////////////////////////////////////////////////////////////////////
+
+PathfindingManager gPathfindingManager;
+
+bool PathfindingManager::Initialize()
+{
+    gConsole.RegisterFunction("bench_pathfinding", "Run random path queries on loaded map, args: queriesCount", [](const ConsoleFuncArgs& args)
+        {
+            int queriesCount = 0;
+            args.ParseArgument(0, queriesCount);
+            gPathfindingManager.RunPathfindingBenchmark(queriesCount);
+        });
+    gConsole.RegisterFunction("bench_pathfindingSectors", "Compare tiles and sectors paths on long range queries, args: queriesCount", [](const ConsoleFuncArgs& args)
+        {
+            int queriesCount = 0;
+            args.ParseArgument(0, queriesCount);
+            gPathfindingManager.RunSectorsBenchmark(queriesCount);
+        });
+
+    return true;
+}
+
+void PathfindingManager::Deinit()
+{
+    gConsole.UnregisterFunction("bench_pathfinding");
+    gConsole.UnregisterFunction("bench_pathfindingSectors");
+
+    ClearWorld();
+}
+
+void PathfindingManager::EnterWorld()
+{
+    ClearWorld();
+
+    mMapDimensions = gGameWorld.mMapData.mDimensions;
+
+    const int tilesCount = mMapDimensions.x * mMapDimensions.y;
+    if (tilesCount == 0)
+        return;
+
+    mTileCosts.resize(tilesCount);
+    mTileChangedStamps.resize(tilesCount, 0);
+
+    MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(Point(), mMapDimensions);
+    for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile;
+        currMapTile = tilesIterator.NextTile())
+    {
+        mTileCosts[GetTileIndex(currMapTile)] = ComputeTileCost(currMapTile);
+    }
+
+    mSectorsGraph.Setup(mMapDimensions, &mTileCosts);
+
+    // allocate quarter of map states at once
+    const unsigned int allocateStates = std::max(tilesCount / 4, 256);
+    mPather = new micropather::MicroPather(this, allocateStates, eDirection_COUNT, false);
+    mAsyncPather = new micropather::MicroPather(this, allocateStates, eDirection_COUNT, false);
+}
+
+void PathfindingManager::ClearWorld()
+{
+    WaitAsyncPaths();
+
+    SafeDelete(mPather);
+    SafeDelete(mAsyncPather);
+
+    mSectorsGraph.Clear();
+    mPathsCache.clear();
+    mTileCosts.clear();
+    mTileChangedStamps.clear();
+    mChangedTiles.clear();
+    mChangesCounter = 0;
+    mGlobalChangedStamp = 0;
+    mStats = QueriesStats();
+    mMapDimensions = Point();
+}
+
+void PathfindingManager::UpdateFrame()
+{
+    // keep worker thread busy, changes will be applied when batch is complete
+    if (!IsAsyncPathsComplete())
+        return;
+
+    ApplyTileChanges();
+}
+
+bool PathfindingManager::FindPath(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputPath, float* outputCost)
+{
+    outputPath.clear();
+    if (mPather == nullptr)
+        return false;
+
+    ApplyTileChanges();
+
+    PathQuery pathQuery;
+    pathQuery.mStartTile = startTile;
+    pathQuery.mGoalTile = goalTile;
+    SolveQuery(mPather, pathQuery);
+
+    outputPath.swap(pathQuery.mPath);
+    if (outputCost)
+    {
+        *outputCost = pathQuery.mCost;
+    }
+    return pathQuery.mIsFound;
+}
+
+bool PathfindingManager::FindSectorPath(TerrainTile* startTile, TerrainTile* goalTile, SectorPath& outputPath)
+{
+    outputPath = SectorPath();
+    if (mPather == nullptr)
+        return false;
+
+    ApplyTileChanges();
+
+    outputPath.mCurrentTile = startTile;
+    return mSectorsGraph.FindWaypoints(startTile, goalTile, outputPath.mWaypoints, &outputPath.mCost);
+}
+
+bool PathfindingManager::RefineSectorPath(SectorPath& sectorPath, TilesList& outputTiles)
+{
+    if (mPather == nullptr || sectorPath.IsComplete())
+        return false;
+
+    ApplyTileChanges();
+
+    TerrainTile* waypointTile = sectorPath.mWaypoints[sectorPath.mNextWaypoint];
+    if (!mSectorsGraph.FindLocalPath(sectorPath.mCurrentTile, waypointTile, outputTiles))
+    {
+        // terrain was changed since path was found, route around on tiles graph
+        TilesList segmentTiles;
+        if (!FindPath(sectorPath.mCurrentTile, waypointTile, segmentTiles))
+            return false;
+
+        outputTiles.insert(outputTiles.end(), segmentTiles.begin() + 1, segmentTiles.end());
+    }
+
+    sectorPath.mCurrentTile = waypointTile;
+    ++sectorPath.mNextWaypoint;
+    return true;
+}
+
+void PathfindingManager::SolvePathsAsync(PathQueriesList& queries)
+{
+    if (mAsyncPather == nullptr)
+        return;
+
+    WaitAsyncPaths();
+    ApplyTileChanges();
+
+    mAsyncQueries = &queries;
+    mAsyncInProgress = true;
+    gTasksManager.QueueTask([this]()
+        {
+            for (PathQuery& currQuery: *mAsyncQueries)
+            {
+                SolveQuery(mAsyncPather, currQuery);
+            }
+
+            std::lock_guard<std::mutex> lock(mAsyncMutex);
+            mAsyncInProgress = false;
+            mAsyncCompleteCondition.notify_all();
+        });
+}
+
+bool PathfindingManager::IsAsyncPathsComplete()
+{
+    std::lock_guard<std::mutex> lock(mAsyncMutex);
+    return !mAsyncInProgress;
+}
+
+void PathfindingManager::WaitAsyncPaths()
+{
+    std::unique_lock<std::mutex> lock(mAsyncMutex);
+    mAsyncCompleteCondition.wait(lock, [this]()
+        {
+            return !mAsyncInProgress;
+        });
+    mAsyncQueries = nullptr;
+}
+
+void PathfindingManager::InvalidateTile(TerrainTile* terrainTile)
+{
+    debug_assert(terrainTile);
+    if (mTileCosts.empty())
+        return;
+
+    mChangedTiles.push_back(terrainTile);
+}
+
+void PathfindingManager::ClearPathsCache()
+{
+    WaitAsyncPaths();
+
+    mPathsCache.clear();
+}
+
+void PathfindingManager::SolveQuery(micropather::MicroPather* pather, PathQuery& query)
+{
+    query.mPath.clear();
+    query.mCost = 0.0f;
+    query.mIsFound = false;
+
+    if (query.mStartTile == nullptr || query.mGoalTile == nullptr)
+    {
+        debug_assert(false);
+        return;
+    }
+
+    const int startIndex = GetTileIndex(query.mStartTile);
+    const int goalIndex = GetTileIndex(query.mGoalTile);
+    if (mTileCosts[goalIndex] < 0.0f)
+        return;
+
+    const unsigned long long cacheKey = ((unsigned long long) startIndex << 32) | (unsigned int) goalIndex;
+    {
+        std::lock_guard<std::mutex> lock(mPathsCacheMutex);
+        ++mStats.mQueriesCount;
+
+        auto cached_iterator = mPathsCache.find(cacheKey);
+        if (cached_iterator != mPathsCache.end() && IsCachedPathValid(cached_iterator->second))
+        {
+            ++mStats.mCacheHits;
+            query.mPath = cached_iterator->second.mPath;
+            query.mCost = cached_iterator->second.mCost;
+            query.mIsFound = !query.mPath.empty();
+            return;
+        }
+    }
+
+    MP_VECTOR<void*> pathStates;
+    float pathCost = 0.0f;
+
+    int solveResult = pather->Solve(query.mStartTile, query.mGoalTile, &pathStates, &pathCost);
+    if (solveResult == micropather::MicroPather::SOLVED)
+    {
+        query.mPath.resize(pathStates.size());
+        for (unsigned int istate = 0; istate < pathStates.size(); ++istate)
+        {
+            query.mPath[istate] = static_cast<TerrainTile*>(pathStates[istate]);
+        }
+        query.mCost = pathCost;
+    }
+    else if (solveResult == micropather::MicroPather::START_END_SAME)
+    {
+        query.mPath.push_back(query.mStartTile);
+    }
+    query.mIsFound = !query.mPath.empty();
+
+    // unreachable goals are cached as well
+    std::lock_guard<std::mutex> lock(mPathsCacheMutex);
+    if ((int) mPathsCache.size() >= MaxCachedPaths)
+    {
+        mPathsCache.clear();
+    }
+
+    CachedPath& cachedPath = mPathsCache[cacheKey];
+    cachedPath.mPath = query.mPath;
+    cachedPath.mCost = query.mCost;
+    cachedPath.mSolvedStamp = mChangesCounter;
+}
+
+void PathfindingManager::ApplyTileChanges()
+{
+    if (mChangedTiles.empty())
+        return;
+
+    // costs are read by worker thread
+    WaitAsyncPaths();
+
+    bool costsChanged = false;
+    for (TerrainTile* currTile: mChangedTiles)
+    {
+        const int tileIndex = GetTileIndex(currTile);
+        const float prevCost = mTileCosts[tileIndex];
+        const float newCost = ComputeTileCost(currTile);
+        if (prevCost == newCost)
+            continue;
+
+        mTileCosts[tileIndex] = newCost;
+        mSectorsGraph.InvalidateTile(currTile->mTileLocation);
+
+        StampTileChanged(currTile, prevCost, newCost);
+        costsChanged = true;
+    }
+    mChangedTiles.clear();
+
+    // solvers keep states graph between queries
+    if (costsChanged)
+    {
+        mPather->Reset();
+        mAsyncPather->Reset();
+    }
+}
+
+void PathfindingManager::StampTileChanged(const TerrainTile* terrainTile, float prevCost, float newCost)
+{
+    ++mChangesCounter;
+    if (prevCost < 0.0f || (newCost >= 0.0f && newCost < prevCost))
+    {
+        mGlobalChangedStamp = mChangesCounter;
+        return;
+    }
+
+    mTileChangedStamps[GetTileIndex(terrainTile)] = mChangesCounter;
+
+    // diagonal moves cannot cut corners of impassable tile, so paths through neighbours are affected too
+    if (newCost < 0.0f)
+    {
+        for (const TerrainTile* neighbourTile: terrainTile->mNeighbours)
+        {
+            if (neighbourTile)
+            {
+                mTileChangedStamps[GetTileIndex(neighbourTile)] = mChangesCounter;
+            }
+        }
+    }
+}
+
+float PathfindingManager::ComputeTileCost(const TerrainTile* terrainTile) const
+{
+    const TerrainDefinition* terrainDefinition = terrainTile->GetTerrain();
+    debug_assert(terrainDefinition);
+
+    if (terrainDefinition->mIsSolid || terrainDefinition->mIsImpenetrable)
+        return PathCostImpassable;
+
+    if (terrainDefinition->mIsLava)
+        return PathCostLava;
+
+    if (terrainDefinition->mIsWater)
+        return PathCostWater;
+
+    return PathCostFloor;
+}
+
+float PathfindingManager::ComputePathCost(const TilesList& tilesPath) const
+{
+    float pathCost = 0.0f;
+    for (size_t itile = 1; itile < tilesPath.size(); ++itile)
+    {
+        const Point& prevLocation = tilesPath[itile - 1]->mTileLocation;
+        const Point& currLocation = tilesPath[itile]->mTileLocation;
+        const bool isDiagonal = (prevLocation.x != currLocation.x) && (prevLocation.y != currLocation.y);
+        pathCost += (isDiagonal ? PathDiagonalDistance : 1.0f) * mTileCosts[GetTileIndex(tilesPath[itile])];
+    }
+    return pathCost;
+}
+
+int PathfindingManager::GetTileIndex(const TerrainTile* terrainTile) const
+{
+    return terrainTile->mTileLocation.y * mMapDimensions.x + terrainTile->mTileLocation.x;
+}
+
+bool PathfindingManager::IsCachedPathValid(const CachedPath& cachedPath) const
+{
+    if (cachedPath.mSolvedStamp < mGlobalChangedStamp)
+        return false;
+
+    for (const TerrainTile* currTile: cachedPath.mPath)
+    {
+        if (cachedPath.mSolvedStamp < mTileChangedStamps[GetTileIndex(currTile)])
+            return false;
+    }
+    return true;
+}
+
+float PathfindingManager::LeastCostEstimate(void* stateStart, void* stateEnd)
+{
+    const TerrainTile* startTile = static_cast<const TerrainTile*>(stateStart);
+    const TerrainTile* endTile = static_cast<const TerrainTile*>(stateEnd);
+
+    // octile distance
+    const int distancex = std::abs(startTile->mTileLocation.x - endTile->mTileLocation.x);
+    const int distancey = std::abs(startTile->mTileLocation.y - endTile->mTileLocation.y);
+    const int straightSteps = std::abs(distancex - distancey);
+    const int diagonalSteps = std::min(distancex, distancey);
+    return (straightSteps + diagonalSteps * PathDiagonalDistance) * PathCostFloor;
+}
+
+void PathfindingManager::AdjacentCost(void* state, MP_VECTOR<micropather::StateCost>* adjacent)
+{
+    const TerrainTile* terrainTile = static_cast<const TerrainTile*>(state);
+
+    for (int idirection = 0; idirection < eDirection_COUNT; ++idirection)
+    {
+        TerrainTile* neighbourTile = terrainTile->mNeighbours[idirection];
+        if (neighbourTile == nullptr)
+            continue;
+
+        const float neighbourCost = mTileCosts[GetTileIndex(neighbourTile)];
+        if (neighbourCost < 0.0f)
+            continue;
+
+        float distance = 1.0f;
+        // diagonal directions are odd, don't allow to cut corners
+        if (idirection % 2)
+        {
+            const TerrainTile* sideTileA = terrainTile->mNeighbours[idirection - 1];
+            const TerrainTile* sideTileB = terrainTile->mNeighbours[(idirection + 1) % eDirection_COUNT];
+            if (sideTileA == nullptr || mTileCosts[GetTileIndex(sideTileA)] < 0.0f ||
+                sideTileB == nullptr || mTileCosts[GetTileIndex(sideTileB)] < 0.0f)
+            {
+                continue;
+            }
+            distance = PathDiagonalDistance;
+        }
+
+        // cost of entering neighbour tile
+        micropather::StateCost stateCost;
+        stateCost.state = neighbourTile;
+        stateCost.cost = distance * neighbourCost;
+        adjacent->push_back(stateCost);
+    }
+}
+
+void PathfindingManager::PrintStateInfo(void* state)
+{
+    const TerrainTile* terrainTile = static_cast<const TerrainTile*>(state);
+    gConsole.LogMessage(eLogMessage_Debug, "(%d, %d)", terrainTile->mTileLocation.x, terrainTile->mTileLocation.y);
+}
+
+void PathfindingManager::RunPathfindingBenchmark(int queriesCount)
+{
+    if (mPather == nullptr)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Pathfinding benchmark requires loaded map");
+        return;
+    }
+
+    if (queriesCount < 1)
+    {
+        queriesCount = PathfindingBenchmarkQueries;
+    }
+
+    ApplyTileChanges();
+
+    TilesList passableTiles;
+    MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(Point(), mMapDimensions);
+    for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile;
+        currMapTile = tilesIterator.NextTile())
+    {
+        if (mTileCosts[GetTileIndex(currMapTile)] >= 0.0f)
+        {
+            passableTiles.push_back(currMapTile);
+        }
+    }
+
+    if (passableTiles.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Pathfinding benchmark requires passable tiles");
+        return;
+    }
+
+    // creatures tend to walk between same places, so queries use limited sets of start and goal tiles
+    cxx::randomizer randomizer;
+
+    TilesList startTiles (PathfindingBenchmarkStarts);
+    for (TerrainTile*& currTile: startTiles)
+    {
+        currTile = passableTiles[randomizer.generate_int((int) passableTiles.size())];
+    }
+
+    TilesList goalTiles (PathfindingBenchmarkGoals);
+    for (TerrainTile*& currTile: goalTiles)
+    {
+        currTile = passableTiles[randomizer.generate_int((int) passableTiles.size())];
+    }
+
+    PathQueriesList queries (queriesCount);
+    for (PathQuery& currQuery: queries)
+    {
+        currQuery.mStartTile = startTiles[randomizer.generate_int(PathfindingBenchmarkStarts)];
+        currQuery.mGoalTile = goalTiles[randomizer.generate_int(PathfindingBenchmarkGoals)];
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Pathfinding benchmark: %d queries, %d passable tiles",
+        queriesCount, (int) passableTiles.size());
+
+    for (int ipass = 0; ipass < 2; ++ipass)
+    {
+        ClearPathsCache();
+
+        const QueriesStats prevStats = mStats;
+
+        auto timeStart = std::chrono::steady_clock::now();
+        if (ipass == 0)
+        {
+            for (PathQuery& currQuery: queries)
+            {
+                SolveQuery(mPather, currQuery);
+            }
+        }
+        else
+        {
+            SolvePathsAsync(queries);
+            WaitAsyncPaths();
+        }
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+
+        int foundCount = 0;
+        for (const PathQuery& currQuery: queries)
+        {
+            if (currQuery.mIsFound)
+            {
+                ++foundCount;
+            }
+        }
+
+        const int cacheHits = mStats.mCacheHits - prevStats.mCacheHits;
+        gConsole.LogMessage(eLogMessage_Info, "%s: %.0f queries/sec, cache hits: %.1f%%, paths found: %d",
+            ipass > 0 ? "Worker thread" : "Main thread",
+            queriesCount / timeElapsed.count(),
+            cacheHits * 100.0 / queriesCount, foundCount);
+    }
+
+    CheckCornerChangesInvalidation();
+}
+
+void PathfindingManager::CheckCornerChangesInvalidation()
+{
+    // costs are read by worker thread
+    WaitAsyncPaths();
+
+    int checksCount = 0;
+    int staleCount = 0;
+    for (const auto& currEntry: mPathsCache)
+    {
+        const CachedPath& cachedPath = currEntry.second;
+        for (size_t itile = 1; itile < cachedPath.mPath.size(); ++itile)
+        {
+            const Point& prevLocation = cachedPath.mPath[itile - 1]->mTileLocation;
+            const Point& currLocation = cachedPath.mPath[itile]->mTileLocation;
+            if (prevLocation.x == currLocation.x || prevLocation.y == currLocation.y)
+                continue;
+
+            // side tile of diagonal step is not on path itself
+            TerrainTile* sideTile = gGameWorld.mMapData.GetMapTile(Point(currLocation.x, prevLocation.y));
+            if (sideTile == nullptr || !IsCachedPathValid(cachedPath))
+                continue;
+
+            const int sideTileIndex = GetTileIndex(sideTile);
+            const float prevCost = mTileCosts[sideTileIndex];
+            if (prevCost < 0.0f)
+                continue;
+
+            // keep stamps of side tile and its neighbours to restore them
+            unsigned int prevStamps[eDirection_COUNT + 1];
+            prevStamps[eDirection_COUNT] = mTileChangedStamps[sideTileIndex];
+            for (int idirection = 0; idirection < eDirection_COUNT; ++idirection)
+            {
+                const TerrainTile* neighbourTile = sideTile->mNeighbours[idirection];
+                prevStamps[idirection] = neighbourTile ? mTileChangedStamps[GetTileIndex(neighbourTile)] : 0;
+            }
+
+            mTileCosts[sideTileIndex] = PathCostImpassable;
+            StampTileChanged(sideTile, prevCost, PathCostImpassable);
+            ++checksCount;
+            if (IsCachedPathValid(cachedPath))
+            {
+                ++staleCount;
+            }
+
+            // restore without dropping all paths, so other cached paths can be checked
+            mTileCosts[sideTileIndex] = prevCost;
+            mTileChangedStamps[sideTileIndex] = prevStamps[eDirection_COUNT];
+            for (int idirection = 0; idirection < eDirection_COUNT; ++idirection)
+            {
+                if (const TerrainTile* neighbourTile = sideTile->mNeighbours[idirection])
+                {
+                    mTileChangedStamps[GetTileIndex(neighbourTile)] = prevStamps[idirection];
+                }
+            }
+            break;
+        }
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Corner changes check: %d diagonal steps tested, stale paths: %d", checksCount, staleCount);
+}
+
+void PathfindingManager::RunSectorsBenchmark(int queriesCount)
+{
+    if (mPather == nullptr)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Pathfinding benchmark requires loaded map");
+        return;
+    }
+
+    if (queriesCount < 1)
+    {
+        queriesCount = PathfindingSectorsBenchmarkQueries;
+    }
+
+    ApplyTileChanges();
+    mSectorsGraph.UpdateSectors();
+
+    TilesList passableTiles;
+    MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(Point(), mMapDimensions);
+    for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile;
+        currMapTile = tilesIterator.NextTile())
+    {
+        if (mTileCosts[GetTileIndex(currMapTile)] >= 0.0f)
+        {
+            passableTiles.push_back(currMapTile);
+        }
+    }
+
+    if (passableTiles.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Pathfinding benchmark requires passable tiles");
+        return;
+    }
+
+    // hierarchical search pays off on long paths, so pick distant end points
+    const int minDistance = std::max(mMapDimensions.x, mMapDimensions.y) / 2;
+
+    cxx::randomizer randomizer;
+
+    PathQueriesList queries;
+    for (int iattempt = 0; iattempt < queriesCount * 16 && (int) queries.size() < queriesCount; ++iattempt)
+    {
+        TerrainTile* startTile = passableTiles[randomizer.generate_int((int) passableTiles.size())];
+        TerrainTile* goalTile = passableTiles[randomizer.generate_int((int) passableTiles.size())];
+        if (LeastCostEstimate(startTile, goalTile) < minDistance)
+            continue;
+
+        queries.emplace_back();
+        queries.back().mStartTile = startTile;
+        queries.back().mGoalTile = goalTile;
+    }
+
+    if (queries.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Pathfinding benchmark requires distant passable tiles");
+        return;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Sectors pathfinding benchmark: %d queries, %d sectors, %d entrance nodes",
+        (int) queries.size(), mSectorsGraph.GetSectorsCount(), mSectorsGraph.GetNodesCount());
+
+    // tiles paths
+    ClearPathsCache();
+
+    int tilesFound = 0;
+
+    auto timeStart = std::chrono::steady_clock::now();
+    for (PathQuery& currQuery: queries)
+    {
+        SolveQuery(mPather, currQuery);
+    }
+    std::chrono::duration<double> tilesElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    for (const PathQuery& currQuery: queries)
+    {
+        if (currQuery.mIsFound)
+        {
+            ++tilesFound;
+        }
+    }
+    ClearPathsCache();
+
+    // sectors paths, abstract search and then refine all segments
+    std::vector<SectorPath> sectorPaths (queries.size());
+
+    timeStart = std::chrono::steady_clock::now();
+    for (size_t iquery = 0; iquery < queries.size(); ++iquery)
+    {
+        FindSectorPath(queries[iquery].mStartTile, queries[iquery].mGoalTile, sectorPaths[iquery]);
+    }
+    std::chrono::duration<double> abstractElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    double tilesCost = 0.0;
+    double sectorsCost = 0.0;
+    int sectorsFound = 0;
+
+    TilesList refinedTiles;
+    timeStart = std::chrono::steady_clock::now();
+    for (size_t iquery = 0; iquery < queries.size(); ++iquery)
+    {
+        SectorPath& sectorPath = sectorPaths[iquery];
+        if (sectorPath.mWaypoints.empty())
+            continue;
+
+        refinedTiles.clear();
+        refinedTiles.push_back(sectorPath.mCurrentTile);
+        while (RefineSectorPath(sectorPath, refinedTiles))
+        {
+        }
+
+        // compare only paths found by both methods
+        if (sectorPath.IsComplete() && queries[iquery].mIsFound)
+        {
+            tilesCost += queries[iquery].mCost;
+            sectorsCost += ComputePathCost(refinedTiles);
+            ++sectorsFound;
+        }
+    }
+    std::chrono::duration<double> refineElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    // rebuild time of single sector after terrain change
+    TerrainTile* changedTile = passableTiles[randomizer.generate_int((int) passableTiles.size())];
+    const int prevRebuiltSectors = mSectorsGraph.GetRebuiltSectorsCount();
+
+    timeStart = std::chrono::steady_clock::now();
+    mSectorsGraph.InvalidateTile(changedTile->mTileLocation);
+    mSectorsGraph.UpdateSectors();
+    std::chrono::duration<double> updateElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    const double queriesCountd = (double) queries.size();
+    gConsole.LogMessage(eLogMessage_Info, "Tiles paths: %.0f queries/sec, paths found: %d",
+        queriesCountd / tilesElapsed.count(), tilesFound);
+    gConsole.LogMessage(eLogMessage_Info, "Sectors paths: %.0f queries/sec abstract, %.0f queries/sec refined, paths found: %d",
+        queriesCountd / abstractElapsed.count(), queriesCountd / (abstractElapsed + refineElapsed).count(), sectorsFound);
+    gConsole.LogMessage(eLogMessage_Info, "Sectors paths cost overhead: %.1f%%",
+        (sectorsFound > 0 && tilesCost > 0.0) ? (sectorsCost / tilesCost - 1.0) * 100.0 : 0.0);
+    gConsole.LogMessage(eLogMessage_Info, "Sector update: %d sectors in %.3f ms",
+        mSectorsGraph.GetRebuiltSectorsCount() - prevRebuiltSectors, updateElapsed.count() * 1000.0);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "micropather.h"
+#include "PathSectorsGraph.h"
+
+// single path request and its result
+struct PathQuery
+{
+public:
+    TerrainTile* mStartTile = nullptr;
+    TerrainTile* mGoalTile = nullptr;
+
+    // result
+    TilesList mPath; // from start to goal tile inclusive, empty if not found
+    float mCost = 0.0f;
+    bool mIsFound = false;
+};
+
+using PathQueriesList = std::vector<PathQuery>;
+
+// long range path through sectors entrances, refined to tiles segment by segment
+struct SectorPath
+{
+public:
+    TilesList mWaypoints; // entrance tiles followed by goal tile
+    TerrainTile* mCurrentTile = nullptr; // last refined tile
+    int mNextWaypoint = 0;
+    float mCost = 0.0f; // approximate
+
+    // test whether all waypoints are refined
+    inline bool IsComplete() const { return mNextWaypoint >= (int) mWaypoints.size(); }
+};
+
+// finds paths on game map tiles for creatures and imps
+class PathfindingManager: public cxx::noncopyable, private micropather::Graph
+{
+public:
+    // queries statistics, accumulated since last world enter
+    struct QueriesStats
+    {
+    public:
+        int mQueriesCount = 0;
+        int mCacheHits = 0;
+    };
+
+    // readonly
+    QueriesStats mStats;
+
+public:
+    // one time initialization/shutdown routine
+    bool Initialize();
+    void Deinit();
+
+    void EnterWorld();
+    void ClearWorld();
+
+    // process single frame logic
+    void UpdateFrame();
+
+    // find path between tiles immediately on calling thread
+    // @param startTile, goalTile: Path end points
+    // @param outputPath: Tiles from start to goal inclusive
+    // @param outputCost: Optional path cost
+    // @returns false if there is no path
+    bool FindPath(TerrainTile* startTile, TerrainTile* goalTile, TilesList& outputPath, float* outputCost = nullptr);
+
+    // find abstract path through map sectors, much cheaper than tiles path for long distances
+    // @param startTile, goalTile: Path end points
+    // @param outputPath: Sector path, tiles are not resolved until refined
+    // @returns false if there is no path
+    bool FindSectorPath(TerrainTile* startTile, TerrainTile* goalTile, SectorPath& outputPath);
+
+    // resolve tiles to next waypoint of sector path
+    // @param sectorPath: Path to refine
+    // @param outputTiles: Tiles will be appended, current tile is not included
+    // @returns false if path is complete or next waypoint became unreachable
+    bool RefineSectorPath(SectorPath& sectorPath, TilesList& outputTiles);
+
+    // solve batch of queries on worker thread, only one batch can be in progress at once
+    // @param queries: Queries list, must be kept alive until batch is complete
+    void SolvePathsAsync(PathQueriesList& queries);
+
+    // test whether last queries batch is complete
+    bool IsAsyncPathsComplete();
+
+    // block calling thread until last queries batch is complete
+    void WaitAsyncPaths();
+
+    // tile passability or movement cost might be changed, cached paths will be refreshed
+    // @param terrainTile: Changed tile
+    void InvalidateTile(TerrainTile* terrainTile);
+
+    // drop all cached paths
+    void ClearPathsCache();
+
+    // run random queries on loaded map and print queries/sec and cache hit rate
+    // @param queriesCount: Number of queries, 0 means default
+    void RunPathfindingBenchmark(int queriesCount);
+
+    // run random long range queries and compare tiles and sectors paths
+    // @param queriesCount: Number of queries, 0 means default
+    void RunSectorsBenchmark(int queriesCount);
+
+private:
+    // cached result of solved query
+    struct CachedPath
+    {
+    public:
+        TilesList mPath;
+        float mCost = 0.0f;
+        unsigned int mSolvedStamp = 0; // changes counter value at time of solve
+    };
+
+    void SolveQuery(micropather::MicroPather* pather, PathQuery& query);
+
+    // recompute movement costs for invalidated tiles
+    void ApplyTileChanges();
+
+    // update stamps of tiles affected by cost change of specific tile
+    void StampTileChanged(const TerrainTile* terrainTile, float prevCost, float newCost);
+
+    // make side tiles of cached diagonal steps impassable one by one and test that paths are dropped,
+    // costs and stamps are restored afterwards
+    void CheckCornerChangesInvalidation();
+
+    // get movement cost for specific tile, negative if impassable
+    float ComputeTileCost(const TerrainTile* terrainTile) const;
+
+    // get total movement cost of tiles path
+    float ComputePathCost(const TilesList& tilesPath) const;
+
+    int GetTileIndex(const TerrainTile* terrainTile) const;
+
+    // test whether none of path tiles was changed since path was solved
+    bool IsCachedPathValid(const CachedPath& cachedPath) const;
+
+    // override micropather::Graph
+    float LeastCostEstimate(void* stateStart, void* stateEnd) override;
+    void AdjacentCost(void* state, MP_VECTOR<micropather::StateCost>* adjacent) override;
+    void PrintStateInfo(void* state) override;
+
+private:
+    Point mMapDimensions;
+
+    std::vector<float> mTileCosts;
+    std::vector<unsigned int> mTileChangedStamps;
+    TilesList mChangedTiles;
+
+    // stamps used to validate cached paths:
+    // tile becomes more expensive - only paths through this tile are dropped,
+    // tile becomes impassable - paths through this tile or diagonally past its corners are dropped,
+    // tile becomes cheaper - any path could be improved so all paths are dropped
+    unsigned int mChangesCounter = 0;
+    unsigned int mGlobalChangedStamp = 0;
+
+    PathSectorsGraph mSectorsGraph;
+
+    std::unordered_map<unsigned long long, CachedPath> mPathsCache;
+    std::mutex mPathsCacheMutex;
+
+    // separate solver instances for main and worker threads
+    micropather::MicroPather* mPather = nullptr;
+    micropather::MicroPather* mAsyncPather = nullptr;
+
+    PathQueriesList* mAsyncQueries = nullptr;
+    std::mutex mAsyncMutex;
+    std::condition_variable mAsyncCompleteCondition;
+    bool mAsyncInProgress = false;
+};
+
+extern PathfindingManager gPathfindingManager;
@@ -24,6 +24,16 @@ public:
     eRenderPass mCurrentPass;
 };
 
+// gpu geometry buffers statistics of renderer
+struct RenderGeometryStats
+{
+public:
+    int mMeshesCount = 0; // meshes with allocated buffers
+    long long mVertexBytes = 0; // currently allocated
+    long long mIndexBytes = 0; // currently allocated
+    long long mUploadedBytes = 0; // accumulated since startup
+};
+
 // anim model cached render data, it is managed by AnimModelsRenderer
 class ModelAssetRenderdata
 {
@@ -37,12 +47,16 @@ public:
         mIndexBuffer = nullptr;
         mSubsets.clear();
         mSubsetMaterials.clear();
+        mDequantizeMatrix = glm::mat4(1.0f);
+        mIndicesType = eIndicesType_i32;
+        mCompactVertices = false;
     }
 public:
     struct SubsetLOD
     {
     public:
         int mIndexDataOffset = 0;
+        int mTriangleCount = 0;
     };
     struct Subset
     {
@@ -56,4 +70,8 @@ public:
     std::vector<MeshMaterial> mSubsetMaterials;
     GpuBuffer* mVertexBuffer = nullptr;
     GpuBuffer* mIndexBuffer = nullptr;
+    // compact vertices positions are quantized within bounds of all animation frames
+    glm::mat4 mDequantizeMatrix = glm::mat4(1.0f);
+    eIndicesType mIndicesType = eIndicesType_i32;
+    bool mCompactVertices = false;
 };
@@ -20,7 +20,14 @@ CvarBoolean gCvarRender_DebugDrawEnabled ("r_debugDraw", true, "Enable debug dra
 CvarBoolean gCvarRender_EnableAnimBlendFrames("r_animBlendFrames", true, "Smooth animations", ConsoleVar_Renderer);
 CvarBoolean gCVarRender_DrawWaterAndLava("r_drawWaterLava", true, "Draw water and lava", ConsoleVar_Renderer);
 CvarBoolean gCVarRender_DrawTerrain("r_drawTerrain", true, "Draw terrain", ConsoleVar_Renderer);
+CvarBoolean gCvarRender_TerrainPartialUpdates("r_terrainPartialUpdates", true, "Reupload only changed tiles instead of rebuilding whole terrain mesh", ConsoleVar_Renderer);
+CvarBoolean gCvarRender_CompactVertices("r_compactVertices", false, "Store terrain, water/lava and models geometry with quantized vertices and 16 bit indices", ConsoleVar_Renderer);
+CvarBoolean gCvarRender_TerrainTexturesArray("r_terrainTexturesArray", true, "Pack terrain textures into texture array and draw each terrain mesh with single call", ConsoleVar_Renderer);
 CvarBoolean gCVarRender_DrawModels("r_drawModels", true, "Draw models", ConsoleVar_Renderer);
+CvarBoolean gCvarRender_InstancedModels("r_instancedModels", true, "Draw opaque parts of models with hardware instancing", ConsoleVar_Renderer);
+CvarBoolean gCvarRender_ModelsAutoLOD("r_modelsAutoLOD", true, "Select models level of details by projected size", ConsoleVar_Renderer);
+CvarFloat gCvarRender_ModelsLODScreenSize("r_modelsLODScreenSize", 0.25f, "Projected model size relative to screen height to switch to next level of details, halves for each next level", ConsoleVar_Renderer);
+CvarFloat gCvarRender_ModelsLODHysteresis("r_modelsLODHysteresis", 0.15f, "Relative band around level of details thresholds which prevents flickering", ConsoleVar_Renderer);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -49,8 +56,27 @@ bool RenderManager::Initialize()
     gConsole.RegisterVariable(&gCvarRender_DebugDrawEnabled);
     gConsole.RegisterVariable(&gCvarRender_EnableAnimBlendFrames);
     gConsole.RegisterVariable(&gCVarRender_DrawTerrain);
+    gConsole.RegisterVariable(&gCvarRender_TerrainPartialUpdates);
+    gConsole.RegisterVariable(&gCvarRender_TerrainTexturesArray);
+    gConsole.RegisterVariable(&gCvarRender_CompactVertices);
     gConsole.RegisterVariable(&gCVarRender_DrawWaterAndLava);
     gConsole.RegisterVariable(&gCVarRender_DrawModels);
+    gConsole.RegisterVariable(&gCvarRender_InstancedModels);
+    gConsole.RegisterVariable(&gCvarRender_ModelsAutoLOD);
+    gConsole.RegisterVariable(&gCvarRender_ModelsLODScreenSize);
+    gConsole.RegisterVariable(&gCvarRender_ModelsLODHysteresis);
+
+    gConsole.RegisterFunction("dump_geometryMemory", "Print gpu memory used by terrain, water/lava and models geometry", [](const ConsoleFuncArgs& args)
+        {
+            gRenderManager.PrintGeometryMemoryStats();
+        });
+
+    gConsole.RegisterFunction("bench_compactVertices", "Compare frame time and uploads with regular and compact vertices, args: framesCount", [](const ConsoleFuncArgs& args)
+        {
+            int framesCount = 0;
+            args.ParseArgument(0, framesCount);
+            gRenderManager.StartVertexFormatsBenchmark(framesCount);
+        });
 
     return true;
 }
@@ -60,8 +86,18 @@ void RenderManager::Deinit()
     gConsole.UnregisterVariable(&gCvarRender_DebugDrawEnabled);
     gConsole.UnregisterVariable(&gCvarRender_EnableAnimBlendFrames);
     gConsole.UnregisterVariable(&gCVarRender_DrawTerrain);
+    gConsole.UnregisterVariable(&gCvarRender_TerrainPartialUpdates);
+    gConsole.UnregisterVariable(&gCvarRender_TerrainTexturesArray);
+    gConsole.UnregisterVariable(&gCvarRender_CompactVertices);
     gConsole.UnregisterVariable(&gCVarRender_DrawWaterAndLava);
     gConsole.UnregisterVariable(&gCVarRender_DrawModels);
+    gConsole.UnregisterVariable(&gCvarRender_InstancedModels);
+    gConsole.UnregisterVariable(&gCvarRender_ModelsAutoLOD);
+    gConsole.UnregisterVariable(&gCvarRender_ModelsLODScreenSize);
+    gConsole.UnregisterVariable(&gCvarRender_ModelsLODHysteresis);
+    gConsole.UnregisterFunction("dump_geometryMemory");
+    gConsole.UnregisterFunction("bench_compactVertices");
+    mVertexFormatsBenchmark = VertexFormatsBenchmark();
 
     mGuiRenderer.Deinit();
     mWaterLavaMeshRenderer.Deinit();
@@ -73,12 +109,6 @@ void RenderManager::Deinit()
 
     mLoadedRenderProgramsList.clear();
 }
-
-void RenderManager::RegisterObjectForRendering(SceneObject* object)
-{
-    debug_assert(object);
-    object->RegisterForRendering(mSceneRenderList);
-}
 
 void RenderManager::RenderFrame()
 {
@@ -89,6 +119,8 @@ void RenderManager::RenderFrame()
 
     gGraphicsDevice.ClearScreen();
 
+    UpdateVertexFormatsBenchmark();
+
     gTerrainManager.PreRenderScene();
     
     // draw objects
@@ -108,6 +140,7 @@ void RenderManager::RenderFrame()
     mGuiRenderer.RenderFrameBegin();
     gGuiManager.RenderFrame(mGuiRenderer);
     mGuiRenderer.RenderFrameEnd();
+    mGuiRenderer.CompleteFrameStats();
 
     // draw debug ui
     mGuiRenderer.RenderFrameBegin();
@@ -142,24 +175,132 @@ void RenderManager::HandleScreenResolutionChanged()
     }
 }
 
+void RenderManager::PrintGeometryMemoryStats()
+{
+    const struct
+    {
+        const char* mName;
+        const RenderGeometryStats& mStats;
+    }
+    renderersStats[] = 
+    {
+        {"Terrain", mTerrainMeshRenderer.mGeometryStats},
+        {"Water/lava", mWaterLavaMeshRenderer.mGeometryStats},
+        {"Models", mAnimatingModelsRenderer.mGeometryStats},
+    };
+
+    gConsole.LogMessage(eLogMessage_Info, "Geometry memory (%s vertices):", gCvarRender_CompactVertices.mValue ? "compact" : "regular");
+    for (const auto& currStats: renderersStats)
+    {
+        const RenderGeometryStats& stats = currStats.mStats;
+        const long long totalBytes = stats.mVertexBytes + stats.mIndexBytes;
+        gConsole.LogMessage(eLogMessage_Info, "  %s: %d meshes, vertices %.1f KB, indices %.1f KB, %.1f KB per mesh", 
+            currStats.mName, stats.mMeshesCount, 
+            stats.mVertexBytes / 1024.0, 
+            stats.mIndexBytes / 1024.0, 
+            stats.mMeshesCount > 0 ? (totalBytes / 1024.0 / stats.mMeshesCount) : 0.0);
+    }
+}
+
+void RenderManager::StartVertexFormatsBenchmark(int framesCount)
+{
+    const int DefaultFramesCount = 300;
+
+    if (mVertexFormatsBenchmark.mFramesCount > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Vertex formats benchmark is already running");
+        return;
+    }
+
+    mVertexFormatsBenchmark = VertexFormatsBenchmark();
+    mVertexFormatsBenchmark.mFramesCount = (framesCount > 0) ? framesCount : DefaultFramesCount;
+    mVertexFormatsBenchmark.mInitialCompactVertices = gCvarRender_CompactVertices.mValue;
+
+    gConsole.LogMessage(eLogMessage_Info, "Vertex formats benchmark: %d frames per format", mVertexFormatsBenchmark.mFramesCount);
+}
+
+void RenderManager::UpdateVertexFormatsBenchmark()
+{
+    VertexFormatsBenchmark& benchmark = mVertexFormatsBenchmark;
+    if (benchmark.mFramesCount == 0)
+        return;
+
+    // measure previous frame
+    const auto timeNow = std::chrono::steady_clock::now();
+    if (benchmark.mFrame > 0)
+    {
+        const double frameSeconds = std::chrono::duration<double>(timeNow - benchmark.mFrameStart).count();
+        if (benchmark.mFrame == 1)
+        {
+            benchmark.mRebuildFrameSeconds = frameSeconds;
+        }
+        else
+        {
+            benchmark.mFramesSeconds += frameSeconds;
+        }
+    }
+    benchmark.mFrameStart = timeNow;
+
+    if (benchmark.mFrame == benchmark.mFramesCount + 1)
+    {
+        const double uploadedBytes = (double) (GetGeometryUploadedBytes() - benchmark.mStartUploadedBytes);
+        gConsole.LogMessage(eLogMessage_Info, "%s vertices: rebuild frame %.2f ms, frame %.3f ms, uploaded %.1f KB", 
+            gCvarRender_CompactVertices.mValue ? "Compact" : "Regular", 
+            benchmark.mRebuildFrameSeconds * 1000.0, 
+            benchmark.mFramesSeconds * 1000.0 / benchmark.mFramesCount, 
+            uploadedBytes / 1024.0);
+        PrintGeometryMemoryStats();
+
+        benchmark.mFrame = 0;
+        if (++benchmark.mPass == 2)
+        {
+            benchmark = VertexFormatsBenchmark();
+            return;
+        }
+    }
+
+    if (benchmark.mFrame == 0)
+    {
+        // switching format makes renderers rebuild geometry during current frame,
+        // second pass restores initial format
+        const bool compactVertices = (benchmark.mPass == 0) ? !benchmark.mInitialCompactVertices : benchmark.mInitialCompactVertices;
+        gCvarRender_CompactVertices.SetValue(compactVertices);
+
+        benchmark.mStartUploadedBytes = GetGeometryUploadedBytes();
+        benchmark.mRebuildFrameSeconds = 0.0;
+        benchmark.mFramesSeconds = 0.0;
+    }
+    ++benchmark.mFrame;
+}
+
+long long RenderManager::GetGeometryUploadedBytes() const
+{
+    return mTerrainMeshRenderer.mGeometryStats.mUploadedBytes + 
+        mWaterLavaMeshRenderer.mGeometryStats.mUploadedBytes + 
+        mAnimatingModelsRenderer.mGeometryStats.mUploadedBytes;
+}
+
 void RenderManager::DrawScene()
 {
     SceneRenderContext renderContext;
 
-    gRenderScene.CollectObjectsForRendering();
+    gRenderScene.CollectObjectsForRendering(mSceneRenderList);
 
-    mSceneRenderList.SortOpaque();
-    mSceneRenderList.SortTranslucent();
+    mAnimatingModelsRenderer.RenderFrameBegin();
+    mTerrainMeshRenderer.RenderFrameBegin();
+
+    mSceneRenderList.SortObjects();
 
     for (eRenderPass currRenderPass : {eRenderPass_Opaque, eRenderPass_Translucent})
     {
         const auto& currentList = mSceneRenderList.mObjectsForRenderPass[currRenderPass];
-        for (int icurrentComponent = 0; icurrentComponent < currentList.mElementsCount; ++icurrentComponent)
+        for (SceneObject* currentObject: currentList.mElements)
         {
-            SceneObject* currentObject = currentList.mElements[icurrentComponent];
             renderContext.mCurrentPass = currRenderPass;
             currentObject->RenderFrame(renderContext);
         }
+        renderContext.mCurrentPass = currRenderPass;
+        mAnimatingModelsRenderer.RenderInstancedBatches(renderContext);
     }
 
     mSceneRenderList.Clear();
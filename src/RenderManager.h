@@ -27,9 +27,6 @@ public:
     bool Initialize();
     void Deinit();
 
-    // register object for rendering on current render frame
-    void RegisterObjectForRendering(SceneObject* object);
-
     // render game frame routine
     void RenderFrame();
 
@@ -41,9 +38,38 @@ public:
 
     void HandleScreenResolutionChanged();
 
+    // print gpu memory used by terrain, water/lava and models geometry
+    void PrintGeometryMemoryStats();
+
+    // get game ui rendering statistics of previous frame
+    inline const GuiRenderer::FrameStats& GetGuiFrameStats() const { return mGuiRenderer.mPrevFrameStats; }
+
+    // measure frame time and geometry uploads with regular and compact vertices over subsequent frames
+    // @param framesCount: Number of frames per vertex format, 0 means default
+    void StartVertexFormatsBenchmark(int framesCount);
+
 private:
+    // vertex formats benchmark state
+    struct VertexFormatsBenchmark
+    {
+    public:
+        int mFramesCount = 0; // zero if benchmark is not running
+        int mPass = 0;
+        int mFrame = 0; // within current pass, first frame rebuilds geometry
+        bool mInitialCompactVertices = false;
+        long long mStartUploadedBytes = 0;
+        double mRebuildFrameSeconds = 0.0;
+        double mFramesSeconds = 0.0;
+        std::chrono::steady_clock::time_point mFrameStart;
+    };
+
     void DrawScene();
 
+    void UpdateVertexFormatsBenchmark();
+
+    // get total geometry uploaded by scene renderers
+    long long GetGeometryUploadedBytes() const;
+
     void HandleRenderProgramLoad(RenderProgram* renderProgram);
     void HandleRenderProgramFree(RenderProgram* renderProgram);
 
@@ -55,6 +81,7 @@ private:
     SceneRenderList mSceneRenderList;
     RenderProgram* mActiveRenderProgram = nullptr;
     std::vector<RenderProgram*> mLoadedRenderProgramsList;
+    VertexFormatsBenchmark mVertexFormatsBenchmark;
 };
 
 extern RenderManager gRenderManager;
\ No newline at end of file
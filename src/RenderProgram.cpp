@@ -94,15 +94,11 @@ bool RenderProgram::IsProgramActive() const
 void RenderProgram::ActivateProgram()
 {
     bool isInited = IsProgramLoaded();
-    if (!isInited || mGpuProgram->IsProgramBound()) // program should be not active
+    if (!isInited)
         return;
 
-    // set active render program
-    debug_assert(gRenderManager.mActiveRenderProgram != this);
-    if (gRenderManager.mActiveRenderProgram)
-    {
-        gRenderManager.mActiveRenderProgram->DeactivateProgram();
-    }
+    // set active render program, previous program is not unbound explicitly
+    // so device switches directly between them and skips redundant binds
     gRenderManager.mActiveRenderProgram = this;
 
     gGraphicsDevice.BindRenderProgram(mGpuProgram);
@@ -9,11 +9,34 @@
 #include "SceneRenderList.h"
 #include "TexturesManager.h"
 #include "RenderManager.h"
+#include "randomizer.h"
+#include "TasksManager.h"
 
 //////////////////////////////////////////////////////////////////////////
 
 // cvars
 CvarBoolean gCvarScene_DebugDrawAabb ( "dbg_drawSceneAabb", true, "Draw scene aabb debug data", ConsoleVar_Debug | ConsoleVar_Scene );
+CvarInteger gCvarScene_CollectThreads ( "r_sceneCollectThreads", 0, "Max threads used to collect visible objects, 0 means all available", ConsoleVar_Scene );
+
+//////////////////////////////////////////////////////////////////////////
+
+const int SceneTreeBenchmarkObjects = 10000;
+const int SceneTreeBenchmarkFrames = 60;
+const int SceneTreeBenchmarkQueries = 100; // per query type per frame
+const float SceneTreeBenchmarkArea = 128.0f;
+const float SceneTreeBenchmarkSpeed = 2.0f; // max units per second
+const float SceneTreeBenchmarkFrameDelta = 1.0f / 30.0f;
+
+const int CullingBenchmarkObjects = 50000;
+const int CullingBenchmarkFrames = 120;
+const float CullingBenchmarkArea = 256.0f;
+const float CullingBenchmarkCameraStep = 0.5f; // degrees per frame
+
+const int RenderListBenchmarkObjects = 20000;
+const int RenderListBenchmarkIterations = 50;
+const float RenderListBenchmarkArea = 64.0f;
+
+const int CollectSubtreesPerThread = 4; // more subtrees than threads for better load balancing
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -24,6 +47,31 @@ RenderScene gRenderScene;
 bool RenderScene::Initialize()
 {
     gConsole.RegisterVariable(&gCvarScene_DebugDrawAabb);
+    gConsole.RegisterVariable(&gCvarScene_CollectThreads);
+    gConsole.RegisterFunction("bench_sceneTree", "Move and query temporary scene objects, args: objectsCount framesCount", [](const ConsoleFuncArgs& args)
+        {
+            int objectsCount = 0;
+            int framesCount = 0;
+            args.ParseArgument(0, objectsCount);
+            args.ParseArgument(1, framesCount);
+            gRenderScene.RunSceneTreeBenchmark(objectsCount, framesCount);
+        });
+    gConsole.RegisterFunction("bench_culling", "Cull temporary objects with rotating camera, args: objectsCount framesCount", [](const ConsoleFuncArgs& args)
+        {
+            int objectsCount = 0;
+            int framesCount = 0;
+            args.ParseArgument(0, objectsCount);
+            args.ParseArgument(1, framesCount);
+            gRenderScene.RunCullingBenchmark(objectsCount, framesCount);
+        });
+    gConsole.RegisterFunction("bench_renderList", "Collect and sort temporary visible objects on 1..N threads, args: objectsCount iterationsCount", [](const ConsoleFuncArgs& args)
+        {
+            int objectsCount = 0;
+            int iterationsCount = 0;
+            args.ParseArgument(0, objectsCount);
+            args.ParseArgument(1, iterationsCount);
+            gRenderScene.RunRenderListBenchmark(objectsCount, iterationsCount);
+        });
     return true;
 }
 
@@ -32,6 +80,10 @@ void RenderScene::Deinit()
     mCameraController = nullptr;
 
     gConsole.UnregisterVariable(&gCvarScene_DebugDrawAabb);
+    gConsole.UnregisterVariable(&gCvarScene_CollectThreads);
+    gConsole.UnregisterFunction("bench_sceneTree");
+    gConsole.UnregisterFunction("bench_culling");
+    gConsole.UnregisterFunction("bench_renderList");
 
     DetachObjects();
     mAABBTree.Cleanup();
@@ -63,15 +115,54 @@ void RenderScene::UpdateFrame()
     BuildAABBTree();
 }
 
-void RenderScene::CollectObjectsForRendering()
+void RenderScene::CollectObjectsForRendering(SceneRenderList& renderList)
 {
     mCamera.ComputeMatrices();
-    mAABBTree.QueryObjects(mCamera.mFrustum, [this](SceneObject* sceneObject)
+
+    CollectVisibleObjects(mCamera.mFrustum, mCamera.mPosition, renderList, gCvarScene_CollectThreads.mValue);
+}
+
+void RenderScene::CollectVisibleObjects(const cxx::frustum_t& frustum, const glm::vec3& viewPosition, SceneRenderList& renderList, int threadsCount)
+{
+    if (threadsCount < 1 || threadsCount > gTasksManager.GetMaxThreadsCount())
     {
-        gRenderManager.RegisterObjectForRendering(sceneObject);
-        // update distance to camera 
-        sceneObject->mDistanceToCameraSquared = glm::length2(sceneObject->mPosition - mCamera.mPosition);
-    });
+        threadsCount = gTasksManager.GetMaxThreadsCount();
+    }
+
+    mAABBTree.GetSubtrees(threadsCount * CollectSubtreesPerThread, mCollectSubtrees);
+    if ((int) mCollectThreads.size() < threadsCount)
+    {
+        mCollectThreads.resize(threadsCount);
+    }
+    renderList.SetThreadsCount(threadsCount);
+
+    gTasksManager.ParallelFor((int) mCollectSubtrees.size(), threadsCount, false, [&](int isubtree, int ithread)
+        {
+            CollectThreadData& threadData = mCollectThreads[ithread];
+            threadData.mVisibleObjects.clear();
+            mAABBTree.CullSubtree(mCollectSubtrees[isubtree], frustum, threadData.mVisibleObjects, threadData.mCullingStack);
+
+            for (SceneObject* sceneObject: threadData.mVisibleObjects)
+            {
+                // update distance to camera, it is used in sort key
+                sceneObject->mDistanceToCameraSquared = glm::length2(sceneObject->mPosition - viewPosition);
+                if (sceneObject->IsMeshInvalidated())
+                {
+                    threadData.mInvalidatedObjects.push_back(sceneObject);
+                    continue;
+                }
+                sceneObject->RegisterForRendering(renderList, ithread);
+            }
+        });
+
+    for (CollectThreadData& threadData: mCollectThreads)
+    {
+        for (SceneObject* sceneObject: threadData.mInvalidatedObjects)
+        {
+            sceneObject->RegisterForRendering(renderList);
+        }
+        threadData.mInvalidatedObjects.clear();
+    }
 }
 
 void RenderScene::DebugRenderFrame(DebugRenderer& renderer)
@@ -126,7 +217,8 @@ void RenderScene::ProcessInputEvent(KeyCharEvent& inputEvent)
 void RenderScene::HandleTransformChange(SceneObject* sceneObject)
 {
     debug_assert(sceneObject);
-    cxx::push_back_if_unique(mTransformObjects, sceneObject); // queue for update
+    // object could be queued twice if bounds and then transform gets changed, tree update is cheap for unchanged object
+    mTransformObjects.push_back(sceneObject); // queue for update
 }
 
 void RenderScene::AttachObject(SceneObject* sceneObject)
@@ -209,3 +301,260 @@ void RenderScene::BuildAABBTree()
         mAABBTree.UpdateObject(sceneObject);
     }
 }
+
+void RenderScene::RunSceneTreeBenchmark(int objectsCount, int framesCount)
+{
+    if (objectsCount < 1)
+    {
+        objectsCount = SceneTreeBenchmarkObjects;
+    }
+    if (framesCount < 1)
+    {
+        framesCount = SceneTreeBenchmarkFrames;
+    }
+
+    BuildAABBTree();
+
+    cxx::randomizer randomizer;
+    auto randomPoint = [&randomizer]()
+    {
+        return glm::vec3(randomizer.generate_float() * SceneTreeBenchmarkArea, 0.0f, randomizer.generate_float() * SceneTreeBenchmarkArea);
+    };
+
+    // setup moving objects
+    const cxx::aabbox objectBounds (glm::vec3(-0.25f, 0.0f, -0.25f), glm::vec3(0.25f, 0.5f, 0.25f));
+    std::vector<SceneObject*> objects (objectsCount);
+    std::vector<glm::vec3> velocities (objectsCount);
+    for (int iobject = 0; iobject < objectsCount; ++iobject)
+    {
+        const float angle = glm::radians(randomizer.generate_float() * 360.0f);
+        const float speed = randomizer.generate_float() * SceneTreeBenchmarkSpeed;
+        velocities[iobject] = glm::vec3(glm::cos(angle), 0.0f, glm::sin(angle)) * speed;
+
+        SceneObject* sceneObject = new SceneObject;
+        sceneObject->SetLocalBoundingBox(objectBounds);
+        sceneObject->SetPosition(randomPoint());
+        objects[iobject] = sceneObject;
+    }
+    BuildAABBTree();
+
+    const AABBTree::UpdateStats prevStats = mAABBTree.mStats;
+
+    std::chrono::duration<double> updateElapsed {};
+    std::chrono::duration<double> queriesElapsed {};
+    int queriesResults = 0;
+    auto countResult = [&queriesResults](SceneObject* sceneObject)
+    {
+        ++queriesResults;
+    };
+
+    for (int iframe = 0; iframe < framesCount; ++iframe)
+    {
+        for (int iobject = 0; iobject < objectsCount; ++iobject)
+        {
+            SceneObject* sceneObject = objects[iobject];
+            glm::vec3 position = sceneObject->mPosition + velocities[iobject] * SceneTreeBenchmarkFrameDelta;
+            // bounce off area borders
+            if (position.x < 0.0f || position.x > SceneTreeBenchmarkArea) velocities[iobject].x = -velocities[iobject].x;
+            if (position.z < 0.0f || position.z > SceneTreeBenchmarkArea) velocities[iobject].z = -velocities[iobject].z;
+            sceneObject->SetPosition(glm::clamp(position, glm::vec3(0.0f), glm::vec3(SceneTreeBenchmarkArea)));
+        }
+
+        auto timeStart = std::chrono::steady_clock::now();
+        BuildAABBTree();
+        updateElapsed += std::chrono::steady_clock::now() - timeStart;
+
+        timeStart = std::chrono::steady_clock::now();
+        for (int iquery = 0; iquery < SceneTreeBenchmarkQueries; ++iquery)
+        {
+            const glm::vec3 point = randomPoint();
+            mAABBTree.QueryObjects(cxx::aabbox(point - glm::vec3(4.0f), point + glm::vec3(4.0f)), countResult);
+            mAABBTree.QueryObjects(cxx::bounding_sphere(point, 4.0f), countResult);
+
+            const float angle = glm::radians(randomizer.generate_float() * 360.0f);
+            mAABBTree.QueryObjects(cxx::ray3d(point + glm::vec3(0.0f, 0.25f, 0.0f), glm::vec3(glm::cos(angle), 0.0f, glm::sin(angle))), countResult);
+        }
+        queriesElapsed += std::chrono::steady_clock::now() - timeStart;
+    }
+
+    const int objectsUpdated = mAABBTree.mStats.mObjectsUpdated - prevStats.mObjectsUpdated;
+    const int leavesReinserted = mAABBTree.mStats.mLeavesReinserted - prevStats.mLeavesReinserted;
+    const int rotations = mAABBTree.mStats.mRotations - prevStats.mRotations;
+    const float incrementalCost = mAABBTree.ComputeSAHCost();
+    const int incrementalHeight = mAABBTree.GetTreeHeight();
+
+    auto timeStart = std::chrono::steady_clock::now();
+    mAABBTree.UpdateTree();
+    std::chrono::duration<double> rebuildElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    gConsole.LogMessage(eLogMessage_Info, "Scene tree benchmark: %d moving objects, %d frames, %d objects in tree",
+        objectsCount, framesCount, mAABBTree.GetObjectsCount());
+    gConsole.LogMessage(eLogMessage_Info, "Update: %.3f ms/frame, reinserted leaves: %.1f%%, rotations: %d",
+        updateElapsed.count() * 1000.0 / framesCount,
+        objectsUpdated > 0 ? leavesReinserted * 100.0 / objectsUpdated : 0.0, rotations);
+    gConsole.LogMessage(eLogMessage_Info, "Queries: %.3f us/query, %.1f objects/query",
+        queriesElapsed.count() * 1000000.0 / (framesCount * SceneTreeBenchmarkQueries * 3),
+        queriesResults * 1.0 / (framesCount * SceneTreeBenchmarkQueries * 3));
+    gConsole.LogMessage(eLogMessage_Info, "SAH cost: %.2f (height %d), after full rebuild: %.2f (height %d), rebuild: %.3f ms",
+        incrementalCost, incrementalHeight, mAABBTree.ComputeSAHCost(), mAABBTree.GetTreeHeight(), rebuildElapsed.count() * 1000.0);
+
+    for (SceneObject* sceneObject: objects)
+    {
+        sceneObject->DestroyObject();
+    }
+}
+
+void RenderScene::RunCullingBenchmark(int objectsCount, int framesCount)
+{
+    if (objectsCount < 1)
+    {
+        objectsCount = CullingBenchmarkObjects;
+    }
+    if (framesCount < 1)
+    {
+        framesCount = CullingBenchmarkFrames;
+    }
+
+    BuildAABBTree();
+
+    // setup static objects of different sizes
+    cxx::randomizer randomizer;
+    std::vector<SceneObject*> objects (objectsCount);
+    for (SceneObject*& sceneObject: objects)
+    {
+        const float halfSize = 0.25f + randomizer.generate_float();
+        const glm::vec3 position (randomizer.generate_float() * CullingBenchmarkArea, 0.0f, randomizer.generate_float() * CullingBenchmarkArea);
+
+        sceneObject = new SceneObject;
+        sceneObject->SetLocalBoundingBox(cxx::aabbox(glm::vec3(-halfSize, 0.0f, -halfSize), glm::vec3(halfSize, halfSize * 2.0f, halfSize)));
+        sceneObject->SetPosition(position);
+    }
+    BuildAABBTree();
+
+    // camera rotates around area center
+    const glm::vec3 cameraPosition (CullingBenchmarkArea * 0.5f, 12.0f, CullingBenchmarkArea * 0.5f);
+    const glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    std::vector<cxx::frustum_t> frustums (framesCount);
+    for (int iframe = 0; iframe < framesCount; ++iframe)
+    {
+        const float angle = glm::radians(iframe * CullingBenchmarkCameraStep);
+        const glm::vec3 cameraTarget = cameraPosition + glm::vec3(glm::cos(angle), -0.3f, glm::sin(angle));
+        frustums[iframe].compute_from_viewproj_matrix(projectionMatrix * glm::lookAt(cameraPosition, cameraTarget, glm::vec3(0.0f, 1.0f, 0.0f)));
+    }
+
+    int referenceVisible = 0;
+    auto timeStart = std::chrono::steady_clock::now();
+    for (const cxx::frustum_t& frustum: frustums)
+    {
+        mAABBTree.QueryObjects(frustum, [&referenceVisible](SceneObject* sceneObject)
+            {
+                ++referenceVisible;
+            });
+    }
+    std::chrono::duration<double> referenceElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    std::vector<SceneObject*> visibleObjects;
+    int cullingVisible = 0;
+    AABBTree::CullingStats totalStats;
+    timeStart = std::chrono::steady_clock::now();
+    for (const cxx::frustum_t& frustum: frustums)
+    {
+        AABBTree::CullingStats frameStats;
+        visibleObjects.clear();
+        mAABBTree.CullObjects(frustum, visibleObjects, &frameStats);
+        cullingVisible += (int) visibleObjects.size();
+        totalStats.mNodesVisited += frameStats.mNodesVisited;
+        totalStats.mNodesAccepted += frameStats.mNodesAccepted;
+        totalStats.mCoherentRejects += frameStats.mCoherentRejects;
+    }
+    std::chrono::duration<double> cullingElapsed = std::chrono::steady_clock::now() - timeStart;
+
+    const double objectsTested = 1.0 * framesCount * mAABBTree.GetObjectsCount();
+    gConsole.LogMessage(eLogMessage_Info, "Culling benchmark: %d objects in tree, %d frames, %.1f visible objects/frame",
+        mAABBTree.GetObjectsCount(), framesCount, cullingVisible * 1.0 / framesCount);
+    gConsole.LogMessage(eLogMessage_Info, "Reference: %.2f ns/object, %.3f ms/frame",
+        referenceElapsed.count() * 1000000000.0 / objectsTested, referenceElapsed.count() * 1000.0 / framesCount);
+    gConsole.LogMessage(eLogMessage_Info, "Masked batches: %.2f ns/object, %.3f ms/frame, nodes visited: %.0f/frame, accepted subtrees: %.0f/frame, coherent rejects: %.1f%%",
+        cullingElapsed.count() * 1000000000.0 / objectsTested, cullingElapsed.count() * 1000.0 / framesCount,
+        totalStats.mNodesVisited * 1.0 / framesCount, totalStats.mNodesAccepted * 1.0 / framesCount,
+        totalStats.mNodesVisited > 0 ? totalStats.mCoherentRejects * 100.0 / totalStats.mNodesVisited : 0.0);
+    if (referenceVisible != cullingVisible)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Culling results mismatch: %d reference, %d masked", referenceVisible, cullingVisible);
+    }
+
+    for (SceneObject* sceneObject: objects)
+    {
+        sceneObject->DestroyObject();
+    }
+}
+
+void RenderScene::RunRenderListBenchmark(int objectsCount, int iterationsCount)
+{
+    if (objectsCount < 1)
+    {
+        objectsCount = RenderListBenchmarkObjects;
+    }
+    if (iterationsCount < 1)
+    {
+        iterationsCount = RenderListBenchmarkIterations;
+    }
+
+    BuildAABBTree();
+
+    // setup objects within camera view, every fourth is translucent
+    cxx::randomizer randomizer;
+    std::vector<SceneObject*> objects (objectsCount);
+    for (int iobject = 0; iobject < objectsCount; ++iobject)
+    {
+        const glm::vec3 position (randomizer.generate_float() * RenderListBenchmarkArea, 0.0f, randomizer.generate_float() * RenderListBenchmarkArea);
+
+        SceneObject* sceneObject = new SceneObject;
+        sceneObject->SetLocalBoundingBox(cxx::aabbox(glm::vec3(-0.25f, 0.0f, -0.25f), glm::vec3(0.25f, 0.5f, 0.25f)));
+        sceneObject->SetPosition(position);
+        sceneObject->SetMeshMaterialsCount(1);
+        sceneObject->GetMeshMaterial()->mRenderStates.mIsAlphaBlendEnabled = (iobject % 4) == 3;
+        objects[iobject] = sceneObject;
+    }
+    BuildAABBTree();
+
+    // camera looks down at area center
+    const glm::vec3 cameraPosition (RenderListBenchmarkArea * 0.5f, RenderListBenchmarkArea, RenderListBenchmarkArea * 0.5f);
+    const glm::mat4 viewMatrix = glm::lookAt(cameraPosition, glm::vec3(cameraPosition.x, 0.0f, cameraPosition.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    const glm::mat4 projectionMatrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, RenderListBenchmarkArea * 2.0f);
+    cxx::frustum_t frustum;
+    frustum.compute_from_viewproj_matrix(projectionMatrix * viewMatrix);
+
+    SceneRenderList renderList;
+    // prepare render resources on first pass
+    CollectVisibleObjects(frustum, cameraPosition, renderList, 1);
+
+    gConsole.LogMessage(eLogMessage_Info, "Render list benchmark: %d objects, %d iterations", objectsCount, iterationsCount);
+    for (int ithreads = 1; ithreads <= gTasksManager.GetMaxThreadsCount(); ++ithreads)
+    {
+        std::chrono::duration<double> collectElapsed {};
+        std::chrono::duration<double> sortElapsed {};
+        int visibleCount = 0;
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            renderList.Clear();
+
+            auto timeStart = std::chrono::steady_clock::now();
+            CollectVisibleObjects(frustum, cameraPosition, renderList, ithreads);
+            auto timeCollected = std::chrono::steady_clock::now();
+            renderList.SortObjects();
+            auto timeSorted = std::chrono::steady_clock::now();
+
+            collectElapsed += timeCollected - timeStart;
+            sortElapsed += timeSorted - timeCollected;
+            visibleCount = renderList.GetObjectsCount();
+        }
+        gConsole.LogMessage(eLogMessage_Info, "%d threads: collect %.3f ms, sort %.3f ms, %d visible objects", ithreads, 
+            collectElapsed.count() * 1000.0 / iterationsCount, sortElapsed.count() * 1000.0 / iterationsCount, visibleCount);
+    }
+
+    for (SceneObject* sceneObject: objects)
+    {
+        sceneObject->DestroyObject();
+    }
+}
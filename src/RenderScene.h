@@ -18,8 +18,9 @@ public:
     // process single frame logic
     void UpdateFrame();
 
-    // collect all visible scene objects
-    void CollectObjectsForRendering();
+    // collect all visible scene objects, visibility traversal is split between threads by tree subtrees
+    // @param renderList: Current frame render list
+    void CollectObjectsForRendering(SceneRenderList& renderList);
 
     // process debug draw
     void DebugRenderFrame(DebugRenderer& renderer);
@@ -48,15 +49,45 @@ public:
     // Transformation or local bounds of object gets changed
     void HandleTransformChange(SceneObject* sceneObject);
 
+    // move temporary objects every frame and query them, print tree update and queries cost
+    // @param objectsCount: Number of moving objects, 0 means default
+    // @param framesCount: Number of simulated frames, 0 means default
+    void RunSceneTreeBenchmark(int objectsCount, int framesCount);
+
+    // cull temporary static objects with rotating camera, compare reference and batched culling
+    // @param objectsCount: Number of objects, 0 means default
+    // @param framesCount: Number of simulated frames, 0 means default
+    void RunCullingBenchmark(int objectsCount, int framesCount);
+
+    // collect and sort temporary visible objects with different number of threads
+    // @param objectsCount: Number of visible objects, 0 means default
+    // @param iterationsCount: Number of iterations for each threads count, 0 means default
+    void RunRenderListBenchmark(int objectsCount, int iterationsCount);
+
 private:
+    // per thread visible objects collection data
+    struct CollectThreadData
+    {
+    public:
+        std::vector<SceneObject*> mVisibleObjects;
+        std::vector<SceneObject*> mInvalidatedObjects; // render resources must be prepared on main thread
+        AABBTree::CullingStack mCullingStack;
+    };
+
     void BuildAABBTree();
 
+    // @param threadsCount: Max number of threads, 0 means all available
+    void CollectVisibleObjects(const cxx::frustum_t& frustum, const glm::vec3& viewPosition, SceneRenderList& renderList, int threadsCount);
+
 private:
     AABBTree mAABBTree;
     CameraController* mCameraController = nullptr;
     // objects lists
     std::vector<SceneObject*> mTransformObjects;
     std::vector<SceneObject*> mSceneObjects;
+    // visible objects collection
+    std::vector<AABBTree::TreeNodeIndex> mCollectSubtrees;
+    std::vector<CollectThreadData> mCollectThreads;
 };
 
 extern RenderScene gRenderScene;
\ No newline at end of file
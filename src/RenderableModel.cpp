@@ -243,7 +243,7 @@ void RenderableModel::SetPreferredLOD(int lod)
         return;
 
     mPreferredLOD = lod;
-    // todo
+    // renderer will pick up new level of details on next frame
 }
 
 void RenderableModel::SetAnimationState()
@@ -17,7 +17,8 @@ public:
     std::vector<std::vector<Texture2D*>> mSubmeshTextures; // additional textures
     BlendFramesAnimState mAnimState;
 
-    int mPreferredLOD = 0;
+    int mPreferredLOD = 0; // finest level of details allowed
+    int mCurrentLOD = 0; // level of details selected by renderer for current frame
 
 public:
     RenderableModel();
@@ -52,4 +53,11 @@ public:
 private:
     void SetAnimationState();
     void SetLocalBounds();
+
+private:
+    // copied from shared model asset renderdata
+    glm::mat4 mDequantizeMatrix;
+    eIndicesType mIndicesType = eIndicesType_i32;
+    bool mCompactVertices = false;
+    unsigned int mRenderdataGeneration = 0;
 };
\ No newline at end of file
@@ -37,6 +37,28 @@ void RenderableTerrainMesh::SetTerrainArea(const Rectangle& mapArea)
     sectorBox.mMax.z = sectorBox.mMin.z + (mMapTerrainRect.h * TERRAIN_BLOCK_SIZE);
 
     SetLocalBoundingBox(sectorBox);
+    InvalidateAllTiles();
+}
+
+void RenderableTerrainMesh::InvalidateTileMesh(const TerrainTile* terrainTile)
+{
+    debug_assert(terrainTile);
+    debug_assert(mMapTerrainRect.PointWithin(terrainTile->mTileLocation));
+
+    // whole area rebuild is pending already
+    if (IsMeshInvalidated() && mInvalidatedTiles.empty())
+        return;
+
+    if (!cxx::contains(mInvalidatedTiles, terrainTile))
+    {
+        mInvalidatedTiles.push_back(terrainTile);
+    }
+    InvalidateMesh();
+}
+
+void RenderableTerrainMesh::InvalidateAllTiles()
+{
+    mInvalidatedTiles.clear();
     InvalidateMesh();
 }
 
@@ -54,5 +76,5 @@ void RenderableTerrainMesh::ReleaseRenderResources()
     TerrainMeshRenderer& renderer = gRenderManager.mTerrainMeshRenderer;
     renderer.ReleaseRenderdata(this);
 
-    InvalidateMesh();
+    InvalidateAllTiles();
 }
\ No newline at end of file
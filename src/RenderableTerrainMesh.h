@@ -18,8 +18,73 @@ public:
 
     void SetTerrainArea(const Rectangle& mapArea);
 
+    // tile geometry is changed and must be reuploaded, other tiles of chunk are kept untouched
+    // @param terrainTile: Tile within terrain area
+    void InvalidateTileMesh(const TerrainTile* terrainTile);
+
+    // whole terrain area geometry is changed and must be rebuilt
+    void InvalidateAllTiles();
+
     // override RenderableObject methods
     void PrepareRenderResources() override;
     void ReleaseRenderResources() override;
     void RenderFrame(SceneRenderContext& renderContext) override;
+
+private:
+    // geometry of single material within tile slot
+    struct TilePart
+    {
+    public:
+        int mMaterialIndex = 0; // negative for textures array
+        int mTriangleStart = 0; // within index buffer
+        int mTriangleCount = 0;
+    };
+
+    // range of vertex and index buffers reserved for tile geometry,
+    // indices are relative to slot start vertex
+    struct TileSlot
+    {
+    public:
+        int mVertexStart = 0;
+        int mVertexCapacity = 0;
+        int mTriangleStart = 0;
+        int mTriangleCapacity = 0;
+        std::vector<TilePart> mParts;
+    };
+
+    // geometry ranges of all tiles sharing same material
+    struct MaterialBatch
+    {
+    public:
+        std::vector<unsigned int> mIndexDataOffsets;
+        std::vector<int> mIndicesCounts;
+        std::vector<int> mBaseVertices;
+    };
+
+    std::vector<TileSlot> mTileSlots; // row by row within terrain area
+    std::vector<MaterialBatch> mMaterialBatches; // per mesh material
+    MaterialBatch mTexturesArrayBatch; // all tiles with textures packed into array
+    std::vector<const TerrainTile*> mInvalidatedTiles; // empty if whole area is invalidated
+
+    // range of buffer elements released by relocated tile
+    struct FreeRange
+    {
+    public:
+        int mStart = 0;
+        int mCount = 0;
+    };
+
+    // start of unused space at the end of buffers
+    int mVertexTail = 0;
+    int mTriangleTail = 0;
+
+    // space released by relocated tiles, sorted by start and adjacent ranges are merged
+    std::vector<FreeRange> mFreeVertexRanges;
+    std::vector<FreeRange> mFreeTriangleRanges;
+
+    // compact vertices are quantized within bounds
+    cxx::aabbox mQuantizeBounds;
+    glm::mat4 mDequantizeMatrix;
+    eIndicesType mIndicesType = eIndicesType_i32;
+    bool mCompactVertices = false;
 };
\ No newline at end of file
@@ -39,4 +39,8 @@ public:
     void ReleaseRenderResources() override;
     void RenderFrame(SceneRenderContext& renderContext) override;
     void UpdateFrame(float deltaTime) override;
+
+private:
+    eIndicesType mIndicesType = eIndicesType_i32;
+    bool mCompactVertices = false;
 };
\ No newline at end of file
@@ -3,17 +3,82 @@
 #include "GenericRoom.h"
 #include "TempleRoom.h"
 #include "DungeonHeartRoom.h"
+#include "GameWorld.h"
+#include "GameMap.h"
+#include "TerrainTile.h"
+#include "WallSection.h"
+#include "Console.h"
+#include "cvars.h"
+#include "randomizer.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarGame_RoomsIncrementalUpdate ("g_roomsIncrementalUpdate", true, "Reevaluate room walls and inner tiles only around changed tiles", ConsoleVar_Game);
+
+//////////////////////////////////////////////////////////////////////////
+
+const int RoomEditBenchmarkSize = 20;
+const int RoomEditBenchmarkIterations = 10;
+const int RoomEditTestEdits = 20000;
+
+// setup standalone map where room area is surrounded by two rows of solid tiles
+// @param editMap: Output map
+// @param roomSize: Room area width and height in tiles
+// @param roomTiles: Output tiles of room area
+static void SetupRoomEditMap(GameMap& editMap, int roomSize, TerrainDefinition* solidTerrain, TerrainDefinition* floorTerrain, TilesList& roomTiles)
+{
+    const int borderSize = 2;
+    editMap.Setup(Point(roomSize + borderSize * 2, roomSize + borderSize * 2), 0);
+
+    for (int tiley = 0; tiley < editMap.mDimensions.y; ++tiley)
+    for (int tilex = 0; tilex < editMap.mDimensions.x; ++tilex)
+    {
+        TerrainTile* currTile = editMap.GetMapTile(Point(tilex, tiley));
+        // already invalidated tiles are not added to terrain manager list
+        currTile->mIsMeshInvalidated = true;
+
+        const bool isRoomArea = (tilex >= borderSize && tilex < borderSize + roomSize) &&
+            (tiley >= borderSize && tiley < borderSize + roomSize);
+        currTile->mBaseTerrain = isRoomArea ? floorTerrain : solidTerrain;
+        if (isRoomArea)
+        {
+            roomTiles.push_back(currTile);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
 
 RoomsManager gRoomsManager;
 
 bool RoomsManager::Initialize()
 {
+    gConsole.RegisterVariable(&gCvarGame_RoomsIncrementalUpdate);
+    gConsole.RegisterFunction("bench_roomEdit", "Grow and shrink temporary room tile by tile, map must not be loaded, args: roomSize iterationsCount", [](const ConsoleFuncArgs& args)
+        {
+            int roomSize = 0;
+            int iterationsCount = 0;
+            args.ParseArgument(0, roomSize);
+            args.ParseArgument(1, iterationsCount);
+            gRoomsManager.RunRoomEditBenchmark(roomSize, iterationsCount);
+        });
+    gConsole.RegisterFunction("test_roomEdits", "Compare incremental and full room reevaluation on random tile edits, map must not be loaded, args: roomSize editsCount", [](const ConsoleFuncArgs& args)
+        {
+            int roomSize = 0;
+            int editsCount = 0;
+            args.ParseArgument(0, roomSize);
+            args.ParseArgument(1, editsCount);
+            gRoomsManager.TestRoomEdits(roomSize, editsCount);
+        });
     return true;
 }
 
 void RoomsManager::Deinit()
 {   
-
+    gConsole.UnregisterVariable(&gCvarGame_RoomsIncrementalUpdate);
+    gConsole.UnregisterFunction("bench_roomEdit");
+    gConsole.UnregisterFunction("test_roomEdits");
 }
 
 void RoomsManager::EnterWorld()
@@ -160,3 +225,228 @@ void RoomsManager::DestroyRoomInstance(GenericRoom* roomInstance)
 
     SafeDelete(roomInstance);
 }
+
+void RoomsManager::RunRoomEditBenchmark(int roomSize, int iterationsCount)
+{
+    if (roomSize < 1)
+    {
+        roomSize = RoomEditBenchmarkSize;
+    }
+    if (iterationsCount < 1)
+    {
+        iterationsCount = RoomEditBenchmarkIterations;
+    }
+
+    // tiles invalidation is tracked by terrain and pathfinding of current map
+    if (gGameWorld.mMapData.mDimensions.x > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Room edit benchmark cannot run while map is loaded");
+        return;
+    }
+
+    TerrainDefinition solidTerrain;
+    solidTerrain.mIsSolid = true;
+    solidTerrain.mAllowRoomWalls = true;
+
+    TerrainDefinition floorTerrain;
+
+    RoomDefinition roomDefinition;
+    roomDefinition.mHasWalls = true;
+
+    GameMap benchmarkMap;
+    TilesList roomTiles;
+    SetupRoomEditMap(benchmarkMap, roomSize, &solidTerrain, &floorTerrain, roomTiles);
+
+    struct RoomState
+    {
+    public:
+        int mWallSections = 0;
+        int mWallTiles = 0;
+        int mInnerTiles = 0;
+    };
+
+    const int editsCount = (int) roomTiles.size();
+
+    // results of full reevaluation are used as reference
+    std::vector<RoomState> referenceStates(editsCount * 2);
+
+    const bool prevIncrementalUpdate = gCvarGame_RoomsIncrementalUpdate.mValue;
+
+    double modeMicrosecondsPerEdit[2][2] = {}; // [incremental][grow/shrink]
+    int mismatchesCount = 0;
+    for (int imode = 0; imode < 2; ++imode)
+    {
+        const bool isIncremental = (imode == 1);
+        gCvarGame_RoomsIncrementalUpdate.mValue = isIncremental;
+
+        GenericRoom benchmarkRoom (&roomDefinition, ePlayerID_Keeper1, 0);
+        TilesList editTiles (1);
+
+        std::chrono::duration<double, std::micro> growTime (0.0);
+        std::chrono::duration<double, std::micro> shrinkTime (0.0);
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            for (int iedit = 0; iedit < editsCount * 2; ++iedit)
+            {
+                const bool isGrow = (iedit < editsCount);
+                editTiles[0] = isGrow ? roomTiles[iedit] : roomTiles[editsCount * 2 - iedit - 1];
+
+                auto timeStart = std::chrono::steady_clock::now();
+                if (isGrow)
+                {
+                    benchmarkRoom.EnlargeRoom(editTiles);
+                }
+                else
+                {
+                    benchmarkRoom.ReleaseTiles(editTiles);
+                }
+                auto timeElapsed = std::chrono::steady_clock::now() - timeStart;
+                (isGrow ? growTime : shrinkTime) += timeElapsed;
+
+                if (iteration > 0)
+                    continue;
+
+                RoomState roomState;
+                roomState.mWallSections = (int) benchmarkRoom.mWallSections.size();
+                roomState.mInnerTiles = (int) benchmarkRoom.mInnerTiles.size();
+                for (WallSection* currSection: benchmarkRoom.mWallSections)
+                {
+                    roomState.mWallTiles += (int) currSection->mMapTiles.size();
+                }
+
+                RoomState& referenceState = referenceStates[iedit];
+                if (!isIncremental)
+                {
+                    referenceState = roomState;
+                    continue;
+                }
+
+                if (roomState.mWallSections != referenceState.mWallSections || roomState.mWallTiles != referenceState.mWallTiles ||
+                    roomState.mInnerTiles != referenceState.mInnerTiles)
+                {
+                    ++mismatchesCount;
+                }
+            }
+        }
+        debug_assert(!benchmarkRoom.HasTiles());
+
+        modeMicrosecondsPerEdit[imode][0] = growTime.count() / (editsCount * iterationsCount);
+        modeMicrosecondsPerEdit[imode][1] = shrinkTime.count() / (editsCount * iterationsCount);
+    }
+
+    gCvarGame_RoomsIncrementalUpdate.mValue = prevIncrementalUpdate;
+
+    gConsole.LogMessage(eLogMessage_Info, "Room edit benchmark: %dx%d room, %d iterations", roomSize, roomSize, iterationsCount);
+    gConsole.LogMessage(eLogMessage_Info, " - full: grow %.3f us/edit, shrink %.3f us/edit", 
+        modeMicrosecondsPerEdit[0][0], modeMicrosecondsPerEdit[0][1]);
+    gConsole.LogMessage(eLogMessage_Info, " - incremental: grow %.3f us/edit, shrink %.3f us/edit", 
+        modeMicrosecondsPerEdit[1][0], modeMicrosecondsPerEdit[1][1]);
+    if (mismatchesCount > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, " - incremental results differ from full reevaluation in %d edits", mismatchesCount);
+    }
+}
+
+void RoomsManager::TestRoomEdits(int roomSize, int editsCount)
+{
+    if (roomSize < 1)
+    {
+        roomSize = RoomEditBenchmarkSize;
+    }
+    if (editsCount < 1)
+    {
+        editsCount = RoomEditTestEdits;
+    }
+
+    // tiles invalidation is tracked by terrain and pathfinding of current map
+    if (gGameWorld.mMapData.mDimensions.x > 0)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Room edits test cannot run while map is loaded");
+        return;
+    }
+
+    TerrainDefinition solidTerrain;
+    solidTerrain.mIsSolid = true;
+    solidTerrain.mAllowRoomWalls = true;
+
+    TerrainDefinition floorTerrain;
+
+    RoomDefinition roomDefinition;
+    roomDefinition.mHasWalls = true;
+
+    GameMap testMap;
+    TilesList roomTiles;
+    SetupRoomEditMap(testMap, roomSize, &solidTerrain, &floorTerrain, roomTiles);
+
+    // inner tiles and wall sections described by tile indices, sorted so that order of evaluation does not matter
+    struct RoomLayout
+    {
+    public:
+        std::vector<int> mInnerTiles;
+        std::vector<std::vector<int>> mWallSections; // face id followed by tiles
+    };
+
+    const int mapWidth = testMap.mDimensions.x;
+    auto CaptureLayout = [mapWidth](const GenericRoom& room, RoomLayout& layout)
+    {
+        layout.mInnerTiles.clear();
+        for (const TerrainTile* currTile: room.mInnerTiles)
+        {
+            layout.mInnerTiles.push_back(currTile->mTileLocation.y * mapWidth + currTile->mTileLocation.x);
+        }
+        std::sort(layout.mInnerTiles.begin(), layout.mInnerTiles.end());
+
+        layout.mWallSections.clear();
+        for (const WallSection* currSection: room.mWallSections)
+        {
+            std::vector<int>& sectionTiles = layout.mWallSections.emplace_back();
+            for (const TerrainTile* currTile: currSection->mMapTiles)
+            {
+                sectionTiles.push_back(currTile->mTileLocation.y * mapWidth + currTile->mTileLocation.x);
+            }
+            std::sort(sectionTiles.begin(), sectionTiles.end());
+            sectionTiles.insert(sectionTiles.begin(), currSection->mFaceId);
+        }
+        std::sort(layout.mWallSections.begin(), layout.mWallSections.end());
+    };
+
+    const bool prevIncrementalUpdate = gCvarGame_RoomsIncrementalUpdate.mValue;
+    gCvarGame_RoomsIncrementalUpdate.mValue = true;
+
+    GenericRoom testRoom (&roomDefinition, ePlayerID_Keeper1, 0);
+    TilesList editTiles (1);
+
+    cxx::randomizer randomizer;
+    RoomLayout incrementalLayout;
+    RoomLayout fullLayout;
+    int mismatchesCount = 0;
+    for (int iedit = 0; iedit < editsCount; ++iedit)
+    {
+        editTiles[0] = roomTiles[randomizer.generate_int((int) roomTiles.size())];
+        if (editTiles[0]->mBuiltRoom == &testRoom)
+        {
+            testRoom.ReleaseTiles(editTiles);
+        }
+        else
+        {
+            testRoom.EnlargeRoom(editTiles);
+        }
+        CaptureLayout(testRoom, incrementalLayout);
+
+        // next edit starts from reference state
+        testRoom.ReevaluateInnerSquares();
+        testRoom.ReevaluateWallSections();
+        CaptureLayout(testRoom, fullLayout);
+
+        if (incrementalLayout.mInnerTiles != fullLayout.mInnerTiles || incrementalLayout.mWallSections != fullLayout.mWallSections)
+        {
+            ++mismatchesCount;
+        }
+    }
+    testRoom.ReleaseTiles();
+
+    gCvarGame_RoomsIncrementalUpdate.mValue = prevIncrementalUpdate;
+
+    gConsole.LogMessage(mismatchesCount > 0 ? eLogMessage_Warning : eLogMessage_Info, 
+        "Room edits test: %dx%d room, %d random edits, mismatches with full reevaluation: %d", roomSize, roomSize, editsCount, mismatchesCount);
+}
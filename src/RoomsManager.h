@@ -36,6 +36,18 @@ public:
     // @param roomInstance: Room instance
     void DestroyRoomInstance(GenericRoom* roomInstance);
 
+    // grow and shrink temporary room tile by tile with full and incremental walls reevaluation,
+    // runs on standalone tiles so map must not be loaded
+    // @param roomSize: Room width and height in tiles
+    // @param iterationsCount: Number of grow and shrink cycles
+    void RunRoomEditBenchmark(int roomSize, int iterationsCount);
+
+    // toggle random tiles of temporary room with incremental walls reevaluation and compare
+    // resulting inner tiles and wall sections with full reevaluation after each edit
+    // @param roomSize: Room width and height in tiles
+    // @param editsCount: Number of random edits
+    void TestRoomEdits(int roomSize, int editsCount);
+
 private:
     void DestroyRoomsList();
 
@@ -9,8 +9,7 @@
 #define READ_FSTREAM_DATATYPE(filestream, destination, datatype) \
     { \
         datatype dataBuffer; \
-        long bytesRead = filestream->ReadData(&dataBuffer, sizeof(datatype)); \
-        if (bytesRead != sizeof(datatype)) \
+        if (!filestream->ReadElement(dataBuffer)) \
         { \
             return false; \
         } \
@@ -603,29 +602,30 @@ bool ScenarioLoader::ReadStringId(BinaryInputStream* fileStream)
 
 bool ScenarioLoader::ReadMapData(BinaryInputStream* fileStream)
 {
-    mScenarioData.mMapTiles.resize(mScenarioData.mLevelDimensionX * mScenarioData.mLevelDimensionY);
+    const int tilesCount = mScenarioData.mLevelDimensionX * mScenarioData.mLevelDimensionY;
+    mScenarioData.mMapTiles.resize(tilesCount);
 
-    // read tiles
-    for (int tiley = 0; tiley < mScenarioData.mLevelDimensionY; ++tiley)
-    for (int tilex = 0; tilex < mScenarioData.mLevelDimensionX; ++tilex)
+    // each tile is terrain type, owner, terrain under the bridge and filler byte,
+    // tiles are stored row by row so whole matrix can be read at once
+    const int TileDataLength = 4;
+
+    ByteArray tilesData;
+    if (!fileStream->ReadElements(tilesData, tilesCount * TileDataLength))
+        return false;
+
+    const unsigned char* tileData = tilesData.data();
+    for (int tileIndex = 0; tileIndex < tilesCount; ++tileIndex, tileData += TileDataLength)
     {
-        const int tileIndex = (tiley * mScenarioData.mLevelDimensionX) + tilex;
+        MapTileDefinition& mapTile = mScenarioData.mMapTiles[tileIndex];
 
         // terrain type is not mapped to internal id so it can be red as is
-        READ_FSTREAM_UINT8(fileStream, mScenarioData.mMapTiles[tileIndex].mTerrainType);
+        mapTile.mTerrainType = static_cast<TerrainTypeID>(tileData[0]);
 
-        unsigned char playerID;
-        READ_FSTREAM_UINT8(fileStream, playerID);
-        if (!KwdToENUM(playerID, mScenarioData.mMapTiles[tileIndex].mOwnerIdentifier))
+        if (!KwdToENUM(tileData[1], mapTile.mOwnerIdentifier))
             return false;
 
-        unsigned char bridgeTerrain;
-        READ_FSTREAM_UINT8(fileStream, bridgeTerrain);
-        if (!KwdToENUM(bridgeTerrain, mScenarioData.mMapTiles[tileIndex].mTerrainUnderTheBridge))
+        if (!KwdToENUM(tileData[2], mapTile.mTerrainUnderTheBridge))
             return false;
-
-        unsigned char filler;
-        READ_FSTREAM_UINT8(fileStream, filler);
     }
 
     return true;
@@ -1365,6 +1365,22 @@ bool ScenarioLoader::ReadMapInfo(BinaryInputStream* fileStream)
     return !!fileStream;
 }
 
+bool ScenarioLoader::OpenDataFileInMemory(const std::string& filePath, MemoryInputStream& memoryStream)
+{
+    BinaryInputStream* fileStream = gFileSystem.OpenDataFile(filePath);
+    if (fileStream == nullptr)
+        return false;
+
+    ByteArray fileContent;
+    const bool isSuccess = fileStream->ReadElements(fileContent, fileStream->GetLength());
+    gFileSystem.CloseFileStream(fileStream);
+    if (!isSuccess)
+        return false;
+
+    memoryStream.OpenMemoryStreamFromBuffer(fileContent);
+    return true;
+}
+
 bool ScenarioLoader::ReadDataFile(BinaryInputStream* fileStream, eLevelDataFile dataTypeId)
 {
     KwdFileHeader headerData;
@@ -1593,21 +1609,19 @@ bool ScenarioLoader::LoadScenarioData(const std::string& scenario)
     cxx::path_set_extension(scenarioFileName, ".kwd");
 
     // open file stream
-    BinaryInputStream* fileStream = gFileSystem.OpenDataFile(scenarioFileName);
-    if (fileStream == nullptr)
+    MemoryInputStream fileStream;
+    if (!OpenDataFileInMemory(scenarioFileName, fileStream))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot open scenario file '%s'", scenarioName.c_str());
         return false;
     }
 
-    if (!ReadMapInfo(fileStream))
+    if (!ReadMapInfo(&fileStream))
     {
         gConsole.LogMessage(eLogMessage_Warning, "Error reading scenario data '%s'", scenarioName.c_str());
         return false;
     }
 
-    gFileSystem.CloseFileStream(fileStream);
-
     // override paths
     mPaths.clear();
 
@@ -1631,20 +1645,28 @@ bool ScenarioLoader::LoadScenarioData(const std::string& scenario)
     mPaths.emplace_back(eLevelDataFile::DKLD_THINGS, scenarioName + "Things.kld");
 
     // read data from data files
+    mDataFilesStats.clear();
+
+    MemoryInputStream dataFileStream;
     for (const LevelDataFilePath& pathEntry: mPaths)
     {
-        BinaryInputStream* dataFileStream = gFileSystem.OpenDataFile(pathEntry.mFilePath);
-        if (dataFileStream == nullptr)
+        auto timeStart = std::chrono::steady_clock::now();
+
+        if (!OpenDataFileInMemory(pathEntry.mFilePath, dataFileStream))
         {
             gConsole.LogMessage(eLogMessage_Warning, "Cannot locate scenario data file '%s'", pathEntry.mFilePath.c_str());
             continue;   
         }
-        if (!ReadDataFile(dataFileStream, pathEntry.mId))
+        if (!ReadDataFile(&dataFileStream, pathEntry.mId))
         {
             gConsole.LogMessage(eLogMessage_Warning, "Error reading scenario data file '%s'", pathEntry.mFilePath.c_str());
             return false;
         }    
-        gFileSystem.CloseFileStream(dataFileStream);
+        const long dataFileLength = dataFileStream.GetLength();
+        dataFileStream.CloseMemoryStream();
+
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+        mDataFilesStats.push_back({pathEntry.mFilePath, dataFileLength, timeElapsed.count()});
     }
 
     if (!ScanTerrainTypes())
@@ -5,6 +5,19 @@
 // scenario data loader
 class ScenarioLoader
 {
+public:
+    // load time of single scenario data file
+    struct DataFileStats
+    {
+    public:
+        std::string mFilePath;
+        long mFileLength = 0;
+        double mParseSeconds = 0.0;
+    };
+
+    // readonly
+    std::vector<DataFileStats> mDataFilesStats; // stats of last loaded scenario
+
 public:
     ScenarioLoader(ScenarioData& scenarioData)
         : mScenarioData(scenarioData)
@@ -83,6 +96,8 @@ private:
     bool ReadLevelVariables(BinaryInputStream* fileStream);
     bool ReadMapInfo(BinaryInputStream* fileStream);
     bool ReadDataFile(BinaryInputStream* fileStream, eLevelDataFile dataTypeId);
+    // read whole data file into memory, definitions are decoded from contiguous buffer then
+    bool OpenDataFileInMemory(const std::string& filePath, MemoryInputStream& memoryStream);
     bool ScanTerrainTypes();
     void FixTerrainResources();
 
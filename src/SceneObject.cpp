@@ -213,18 +213,23 @@ void SceneObject::UpdateFrame(float deltaTime)
     // do nothing
 }
 
-void SceneObject::RegisterForRendering(SceneRenderList& renderList)
+void SceneObject::UpdateRenderResources()
 {
-    bool hasOpaqueParts = false;
-    bool hasTransparentParts = false;
-
-    // force regenerate renderdata
     if (IsMeshInvalidated())
     {
         PrepareRenderResources();
 
         mMeshInvalidated = false;
     }
+}
+
+void SceneObject::RegisterForRendering(SceneRenderList& renderList, int threadIndex)
+{
+    bool hasOpaqueParts = false;
+    bool hasTransparentParts = false;
+
+    // force regenerate renderdata
+    UpdateRenderResources();
 
     for (const MeshMaterial& currMaterial: mMeshMaterials)
     {
@@ -240,12 +245,12 @@ void SceneObject::RegisterForRendering(SceneRenderList& renderList)
 
     if (hasOpaqueParts)
     {
-        renderList.RegisterSceneObject(eRenderPass_Opaque, this);
+        renderList.RegisterSceneObject(eRenderPass_Opaque, this, threadIndex);
     }
 
     if (hasTransparentParts)
     {
-        renderList.RegisterSceneObject(eRenderPass_Translucent, this);
+        renderList.RegisterSceneObject(eRenderPass_Translucent, this, threadIndex);
     }
 }
 
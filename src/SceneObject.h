@@ -57,9 +57,14 @@ public:
     // set new parent entity or clear current
     void SetParentEntity(Entity* parentEntity);
 
-    // register itself for rendering on current frame
+    // register itself for rendering on current frame,
+    // could be called from worker thread only if mesh is not invalidated
     // @param renderList: Current frame render list
-    void RegisterForRendering(SceneRenderList& renderList);
+    // @param threadIndex: Render list bucket of calling thread
+    void RegisterForRendering(SceneRenderList& renderList, int threadIndex = 0);
+
+    // regenerate renderdata if mesh is invalidated
+    void UpdateRenderResources();
 
     // setup renderable component mesh materials
     void SetMeshMaterialsCount(int numMaterials);
@@ -2,36 +2,170 @@
 #include "SceneRenderList.h"
 #include "SceneObject.h"
 
-void SceneRenderList::SortOpaque()
+//////////////////////////////////////////////////////////////////////////
+
+const int SortKeyPassShift = 60;
+const int SortKeyProgramShift = 50;
+const int SortKeyProgramBits = 10;
+const int SortKeyTextureShift = 36;
+const int SortKeyTextureBits = 14;
+const int SortKeyVertexBufferShift = 24;
+const int SortKeyVertexBufferBits = 12;
+const int SortKeyOpaqueDistanceBits = 24;
+
+const int RadixSortDigitBits = 8;
+const int RadixSortDigits = 64 / RadixSortDigitBits;
+const int RadixSortBuckets = 1 << RadixSortDigitBits;
+
+//////////////////////////////////////////////////////////////////////////
+
+SceneRenderList::SceneRenderList()
 {
-    ObjectsCollection& renderPassList = mObjectsForRenderPass[eRenderPass_Opaque];
+    SetThreadsCount(1);
+}
 
-    if (renderPassList.mElementsCount > 2)
+void SceneRenderList::SetThreadsCount(int threadsCount)
+{
+    debug_assert(threadsCount > 0);
+    if (threadsCount > (int) mThreadBuckets.size())
     {
-        // dbg
-        for (int iElement = 0; iElement < renderPassList.mElementsCount; ++iElement)
-        {
-            debug_assert(renderPassList.mElements[iElement]->mRenderProgram);
-        }
+        mThreadBuckets.resize(threadsCount);
+    }
+}
 
-        std::sort(renderPassList.mElements, renderPassList.mElements + renderPassList.mElementsCount, 
-            [](const SceneObject* lhs, const SceneObject* rhs)
-        {
-            return lhs->mRenderProgram < rhs->mRenderProgram;
-        });
+void SceneRenderList::Clear()
+{
+    for (std::vector<SortEntry>& currBucket: mThreadBuckets)
+    {
+        currBucket.clear();
+    }
+    for (ObjectsCollection& currCollection: mObjectsForRenderPass)
+    {
+        currCollection.mElements.clear();
     }
 }
 
-void SceneRenderList::SortTranslucent()
+int SceneRenderList::GetObjectsCount() const
 {
-    ObjectsCollection& renderPassList = mObjectsForRenderPass[eRenderPass_Translucent];
+    int objectsCount = 0;
+    for (const std::vector<SortEntry>& currBucket: mThreadBuckets)
+    {
+        objectsCount += (int) currBucket.size();
+    }
+    return objectsCount;
+}
+
+void SceneRenderList::SortObjects()
+{
+    mSortEntries.clear();
+    for (const std::vector<SortEntry>& currBucket: mThreadBuckets)
+    {
+        mSortEntries.insert(mSortEntries.end(), currBucket.begin(), currBucket.end());
+    }
+
+    RadixSort(mSortEntries, mTempEntries);
 
-    if (renderPassList.mElementsCount > 2)
+    // split by render pass
+    for (const SortEntry& currEntry: mSortEntries)
     {
-        std::sort(renderPassList.mElements, renderPassList.mElements + renderPassList.mElementsCount, 
-            [](const SceneObject* lhs, const SceneObject* rhs)
+        const int renderPass = (int) (currEntry.mSortKey >> SortKeyPassShift);
+        debug_assert(renderPass < eRenderPass_Count);
+        mObjectsForRenderPass[renderPass].mElements.push_back(currEntry.mSceneObject);
+    }
+}
+
+SceneRenderList::SortKey SceneRenderList::ComputeSortKey(eRenderPass renderPass, const SceneObject* sceneObject)
+{
+    debug_assert(sceneObject);
+
+    // non-negative float bits are ordered same way as float values
+    const float distance = std::max(sceneObject->mDistanceToCameraSquared, 0.0f);
+    unsigned int distanceBits = 0;
+    ::memcpy(&distanceBits, &distance, sizeof(distanceBits));
+
+    SortKey sortKey = ((SortKey) renderPass << SortKeyPassShift);
+    if (renderPass != eRenderPass_Opaque)
+        return sortKey | distanceBits;
+
+    // texture of first opaque part, objects usually have single material per pass
+    const Texture2D* diffuseTexture = nullptr;
+    for (const MeshMaterial& currMaterial: sceneObject->mMeshMaterials)
+    {
+        if (currMaterial.IsTransparent())
+            continue;
+
+        diffuseTexture = currMaterial.mDiffuseTexture;
+        break;
+    }
+
+    // distance only orders objects with same states, so low mantissa bits are dropped
+    sortKey |= GetPointerKeyBits(sceneObject->mRenderProgram, SortKeyProgramBits) << SortKeyProgramShift;
+    sortKey |= GetPointerKeyBits(diffuseTexture, SortKeyTextureBits) << SortKeyTextureShift;
+    sortKey |= GetPointerKeyBits(sceneObject->mVertexBuffer, SortKeyVertexBufferBits) << SortKeyVertexBufferShift;
+    sortKey |= distanceBits >> (32 - SortKeyOpaqueDistanceBits);
+    return sortKey;
+}
+
+SceneRenderList::SortKey SceneRenderList::GetPointerKeyBits(const void* pointer, int bitsCount)
+{
+    debug_assert(bitsCount > 0 && bitsCount < 32);
+    if (pointer == nullptr)
+        return 0;
+
+    // objects are allocated at least 16 bytes aligned, so low bits are skipped
+    unsigned long long pointerBits = ((unsigned long long) pointer) >> 4;
+    pointerBits ^= (pointerBits >> bitsCount) ^ (pointerBits >> (bitsCount * 2));
+    return pointerBits & ((1ULL << bitsCount) - 1);
+}
+
+void SceneRenderList::RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& tempEntries)
+{
+    const int entriesCount = (int) entries.size();
+    if (entriesCount < 2)
+        return;
+
+    tempEntries.resize(entriesCount);
+
+    // build histograms of all digits at once
+    unsigned int histograms[RadixSortDigits][RadixSortBuckets] = {};
+    for (const SortEntry& currEntry: entries)
+    {
+        for (int idigit = 0; idigit < RadixSortDigits; ++idigit)
         {
-            return lhs->mDistanceToCameraSquared < rhs->mDistanceToCameraSquared;
-        });
+            ++histograms[idigit][(currEntry.mSortKey >> (idigit * RadixSortDigitBits)) & (RadixSortBuckets - 1)];
+        }
     }
-}
\ No newline at end of file
+
+    SortEntry* sourceEntries = entries.data();
+    SortEntry* destEntries = tempEntries.data();
+    for (int idigit = 0; idigit < RadixSortDigits; ++idigit)
+    {
+        const int digitShift = idigit * RadixSortDigitBits;
+        unsigned int* histogram = histograms[idigit];
+
+        // all keys have same digit, nothing to reorder
+        if (histogram[(sourceEntries[0].mSortKey >> digitShift) & (RadixSortBuckets - 1)] == (unsigned int) entriesCount)
+            continue;
+
+        unsigned int bucketOffset = 0;
+        for (int ibucket = 0; ibucket < RadixSortBuckets; ++ibucket)
+        {
+            const unsigned int bucketSize = histogram[ibucket];
+            histogram[ibucket] = bucketOffset;
+            bucketOffset += bucketSize;
+        }
+
+        for (int ientry = 0; ientry < entriesCount; ++ientry)
+        {
+            const SortEntry& currEntry = sourceEntries[ientry];
+            destEntries[histogram[(currEntry.mSortKey >> digitShift) & (RadixSortBuckets - 1)]++] = currEntry;
+        }
+        std::swap(sourceEntries, destEntries);
+    }
+
+    // sorted data ended up in scratch storage
+    if (sourceEntries != entries.data())
+    {
+        entries.swap(tempEntries);
+    }
+}
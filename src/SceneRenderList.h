@@ -2,48 +2,77 @@
 
 #include "GameDefs.h"
 
-// list for collecting scene objects which will be rendered on current frame
+// list for collecting scene objects which will be rendered on current frame,
+// objects could be registered concurrently from multiple threads, each thread has its own bucket
 class SceneRenderList
 {
-private:
-    static const int MaxElements = 8192;
+public:
+    // sort key layout, most significant bits first:
+    // opaque - render pass 4 bits, render program 10 bits, diffuse texture 14 bits, vertex buffer 12 bits, distance to camera 24 bits
+    // translucent - render pass 4 bits, 28 unused bits, distance to camera 32 bits
+    using SortKey = unsigned long long;
+
+    // collected object with its sort key
+    struct SortEntry
+    {
+    public:
+        SortKey mSortKey;
+        SceneObject* mSceneObject;
+    };
 
 public:
-    SceneRenderList() = default;
+    SceneRenderList();
+
+    // setup buckets for concurrent registration, must not be called while objects are collected
+    // @param threadsCount: Number of threads that will register objects
+    void SetThreadsCount(int threadsCount);
 
-    inline void RegisterSceneObject(eRenderPass renderPass, SceneObject* sceneObject)
+    // add object to list, distance to camera must be updated at this point
+    // @param renderPass: Render pass
+    // @param sceneObject: Object
+    // @param threadIndex: Calling thread index in range [0, threadsCount)
+    inline void RegisterSceneObject(eRenderPass renderPass, SceneObject* sceneObject, int threadIndex = 0)
     {
         debug_assert(sceneObject);
+        debug_assert(threadIndex < (int) mThreadBuckets.size());
 
-        ObjectsCollection& renderPassList = mObjectsForRenderPass[renderPass];
-        if (renderPassList.mElementsCount < MaxElements)
-        {
-            renderPassList.mElements[renderPassList.mElementsCount++] = sceneObject;
-        }        
+        mThreadBuckets[threadIndex].push_back({ComputeSortKey(renderPass, sceneObject), sceneObject});
     }
 
     // discard all previously collected objects
-    inline void Clear()
-    {
-        for (int icurr = 0; icurr < eRenderPass_Count; ++icurr)
-        {
-            mObjectsForRenderPass[icurr].mElementsCount = 0;
-        }
-    }
+    void Clear();
+
+    // merge objects collected by all threads and sort them by keys,
+    // opaque objects are grouped by render program, texture and vertex buffer, translucent objects are ordered by distance to camera
+    void SortObjects();
+
+    // get collected objects count in all buckets
+    int GetObjectsCount() const;
 
-    // sort opaque objects by render program
-    void SortOpaque();
+    // compute object key within render pass
+    // @param renderPass: Render pass
+    // @param sceneObject: Object
+    static SortKey ComputeSortKey(eRenderPass renderPass, const SceneObject* sceneObject);
 
-    // sort translucent object by distance to camera
-    void SortTranslucent();
+    // fold pointer value into specified number of bits
+    static SortKey GetPointerKeyBits(const void* pointer, int bitsCount);
+
+    // sort entries by key, least significant digit first radix sort
+    // @param entries: Entries to sort
+    // @param tempEntries: Scratch storage
+    static void RadixSort(std::vector<SortEntry>& entries, std::vector<SortEntry>& tempEntries);
 
 public:
-    // registered objects lists
+    // sorted objects lists
     struct ObjectsCollection
     {
-        int mElementsCount = 0;
-        SceneObject* mElements[MaxElements];
+        std::vector<SceneObject*> mElements;
     };
 
     ObjectsCollection mObjectsForRenderPass[eRenderPass_Count];
+
+private:
+    std::vector<std::vector<SortEntry>> mThreadBuckets;
+    std::vector<SortEntry> mSortEntries;
+    std::vector<SortEntry> mTempEntries;
 };
@@ -30,6 +30,7 @@ void TerrainRenderProgram::HandleProgramLoad()
     //mGpuProgram->BindAttribute(eVertexAttribute_Normal0, "in_normal");
     mGpuProgram->BindAttribute(eVertexAttribute_Texcoord0, "in_texcoord");
     mGpuProgram->BindAttribute(eVertexAttribute_TerrainTilePosition, "in_tile_coord");
+    mGpuProgram->BindAttribute(eVertexAttribute_TerrainTextureLayer, "in_texture_layer");
 }
 
 void TerrainRenderProgram::HandleProgramFree()
@@ -114,6 +115,29 @@ void MorphAnimRenderProgram::HandleProgramFree()
 
 //////////////////////////////////////////////////////////////////////////
 
+MorphAnimInstancedRenderProgram::MorphAnimInstancedRenderProgram(): RenderProgram("shaders/anim_blend_frames_instanced.glsl")
+{
+}
+
+void MorphAnimInstancedRenderProgram::HandleProgramLoad()
+{
+    // configure input layout
+    mGpuProgram->BindAttribute(eVertexAttribute_Position0, "in_pos_frame0");
+    mGpuProgram->BindAttribute(eVertexAttribute_Position1, "in_pos_frame1");
+    mGpuProgram->BindAttribute(eVertexAttribute_Texcoord0, "in_texcoord");
+    mGpuProgram->BindAttribute(eVertexAttribute_InstanceTransform0, "in_instance_transform0");
+    mGpuProgram->BindAttribute(eVertexAttribute_InstanceTransform1, "in_instance_transform1");
+    mGpuProgram->BindAttribute(eVertexAttribute_InstanceTransform2, "in_instance_transform2");
+    mGpuProgram->BindAttribute(eVertexAttribute_InstanceTransform3, "in_instance_transform3");
+    mGpuProgram->BindAttribute(eVertexAttribute_InstanceMixFrames, "in_instance_mix_frames");
+}
+
+void MorphAnimInstancedRenderProgram::HandleProgramFree()
+{
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 GuiRenderProgram::GuiRenderProgram(): RenderProgram("shaders/gui.glsl")
 {
 }
@@ -78,6 +78,19 @@ private:
 
 //////////////////////////////////////////////////////////////////////////
 
+// blend frames animation shader, model transformation and mix frames are per instance attributes
+class MorphAnimInstancedRenderProgram: public RenderProgram
+{
+public:
+    MorphAnimInstancedRenderProgram();
+
+private:
+    void HandleProgramLoad() override;
+    void HandleProgramFree() override;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
 // render program intended for gui draw
 class GuiRenderProgram: public RenderProgram
 {
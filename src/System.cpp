@@ -13,11 +13,34 @@
 #include "GameMain.h"
 #include "ModelAssetsManager.h"
 #include "GuiManager.h"
-
-#include "GLFW/glfw3.h"
+#include "GuiAtlasManager.h"
+#include "TasksManager.h"
+#include "RenderScene.h"
+#include "GameWorld.h"
+#include "TopDownCameraController.h"
+#include "UniqueStringsBenchmark.h"
 
 System gSystem;
 
+//////////////////////////////////////////////////////////////////////////
+
+const int HeadlessDefaultFramesCount = 600;
+const double HeadlessFrameDelta = 1.0 / 30.0;
+const float HeadlessCameraOrbitSeconds = 20.0f;
+const float HeadlessCameraOrbitRadius = 0.35f; // fraction of map size
+const float HeadlessCameraPitch = -53.0f;
+const float HeadlessCameraDistance = 8.0f;
+const char* HeadlessStatsFileName = "headless_frames.csv";
+
+// get monotonic time in seconds, works without window
+static double GetMonotonicTime()
+{
+    std::chrono::duration<double> timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+    return timeSinceEpoch.count();
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 void System::Initialize(int argc, char *argv[])
 {
     if (!gConsole.Initialize())
@@ -28,6 +51,12 @@ void System::Initialize(int argc, char *argv[])
     gConsole.LogMessage(eLogMessage_Info, GAME_TITLE);
     gConsole.LogMessage(eLogMessage_Info, "System initialize");
 
+    if (!gTasksManager.Initialize())
+    {
+        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize tasks manager");
+        Terminate();
+    }
+
     if (!gFileSystem.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize filesystem");
@@ -39,6 +68,11 @@ void System::Initialize(int argc, char *argv[])
         debug_assert(false);
     }
 
+    if (!mStartupParams.mLogFileName.empty() && !gConsole.SetLogFile(mStartupParams.mLogFileName))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot open log file '%s'", mStartupParams.mLogFileName.c_str());
+    }
+
     LoadSettings();
 
     if (!gFileSystem.SetupDungeonKeeperGamePaths())
@@ -59,6 +93,12 @@ void System::Initialize(int argc, char *argv[])
         Terminate();
     }
 
+    if (!gUniqueStringsBenchmark.Initialize())
+    {
+        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize unique strings benchmark");
+        Terminate();
+    }
+
     if (!gInputsManager.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Error, "Cannot initialize inputs manager");
@@ -97,6 +137,12 @@ void System::Initialize(int argc, char *argv[])
         Terminate();
     }
 
+    if (!gGuiAtlasManager.Initialize())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize ui atlas manager");
+        Terminate();
+    }
+
     if (!gGuiManager.Initialize())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize ui manager");
@@ -110,7 +156,7 @@ void System::Initialize(int argc, char *argv[])
         Terminate();
     }
 
-    mStartSystemTime = ::glfwGetTime();
+    mStartSystemTime = GetMonotonicTime();
     debug_assert(mStartSystemTime > 0.0);
 
     // hide console window initially
@@ -125,6 +171,7 @@ void System::Deinit()
 
     gGameMain.Deinit();
     gGuiManager.Deinit();
+    gGuiAtlasManager.Deinit();
     gModelsManager.Deinit();
     gTexturesManager.Deinit();
     gToolsUIManager.Deinit();
@@ -132,8 +179,10 @@ void System::Deinit()
     gTimeManager.Deinit();
     gGraphicsDevice.Deinit();
     gInputsManager.Deinit();
+    gUniqueStringsBenchmark.Deinit();
     gEngineTexturesProvider.Deinit();
     gFileSystem.Deinit();
+    gTasksManager.Deinit();
     gConsole.Deinit();
 }
 
@@ -142,11 +191,17 @@ void System::Execute()
     const double MinFPS = 20.0;
     const double MaxFrameDelta = (1.0 / MinFPS);
 
+    if (mStartupParams.mHeadless)
+    {
+        ExecuteHeadless(mStartupParams.mBenchmarkFrames > 0 ? mStartupParams.mBenchmarkFrames : HeadlessDefaultFramesCount);
+        return;
+    }
+
     // main loop
-    double previousFrameTime = ::glfwGetTime();
+    double previousFrameTime = GetMonotonicTime();
     for (; !mQuitRequested; )
     {
-        double currentFrameTime = ::glfwGetTime();
+        double currentFrameTime = GetMonotonicTime();
         double currentFrameDelta = currentFrameTime - previousFrameTime;
 
         if (currentFrameDelta > MaxFrameDelta)
@@ -154,24 +209,119 @@ void System::Execute()
             currentFrameDelta = MaxFrameDelta;
         }
 
-        gTimeManager.UpdateFrame(currentFrameDelta);
-        gGraphicsDevice.ProcessInputEvents();
-
+        UpdateFrame(currentFrameDelta);
         if (mQuitRequested)
             break;
 
-        // update frame
-        gTexturesManager.UpdateFrame();
-        gGameMain.UpdateFrame();
-        gToolsUIManager.UpdateFrame();
-        gGuiManager.UpdateFrame();
-
         // render frame
         gRenderManager.RenderFrame();
         previousFrameTime = currentFrameTime;
     }
 }
 
+void System::UpdateFrame(double frameDelta)
+{
+    gTimeManager.UpdateFrame(frameDelta);
+    gGraphicsDevice.ProcessInputEvents();
+
+    if (mQuitRequested)
+        return;
+
+    // update frame
+    gTexturesManager.UpdateFrame();
+    gGameMain.UpdateFrame();
+    gToolsUIManager.UpdateFrame();
+    gGuiManager.UpdateFrame();
+}
+
+void System::ExecuteHeadless(int framesCount)
+{
+    debug_assert(framesCount > 0);
+    debug_assert(gGraphicsDevice.IsNullBackend());
+
+    gConsole.LogMessage(eLogMessage_Info, "Headless run (%d frames)", framesCount);
+
+    // scripted camera circles around map center
+    glm::vec3 mapCenter;
+    float orbitRadius = HeadlessCameraDistance;
+    const Point& mapDimensions = gGameWorld.mMapData.mDimensions;
+    if (mapDimensions.x > 0 && mapDimensions.y > 0)
+    {
+        mapCenter.x = mapDimensions.x * TERRAIN_BLOCK_SIZE * 0.5f;
+        mapCenter.z = mapDimensions.y * TERRAIN_BLOCK_SIZE * 0.5f;
+        orbitRadius = std::min(mapDimensions.x, mapDimensions.y) * TERRAIN_BLOCK_SIZE * HeadlessCameraOrbitRadius;
+    }
+
+    TopDownCameraController cameraController;
+    gRenderScene.SetCameraController(&cameraController);
+
+    GraphicsCommandStream& commandStream = gGraphicsDevice.GetCommandStream();
+
+    std::string framesStats = "frame,update_ms,render_ms,draw_calls,instances,state_changes,state_changes_skipped,bytes_transferred,gui_draw_calls";
+    for (int icommand = 0; icommand < eGraphicsCommand_COUNT; ++icommand)
+    {
+        framesStats += ",";
+        framesStats += cxx::enum_to_string((eGraphicsCommand) icommand);
+    }
+    framesStats += "\n";
+
+    double totalUpdateTime = 0.0;
+    double totalRenderTime = 0.0;
+    double maxFrameTime = 0.0;
+    long long totalDrawCalls = 0;
+    long long totalGuiDrawCalls = 0;
+
+    for (int iframe = 0; iframe < framesCount && !mQuitRequested; ++iframe)
+    {
+        const double timeStart = GetMonotonicTime();
+        UpdateFrame(HeadlessFrameDelta);
+
+        // camera is placed after controllers update, so game does not override it
+        const float orbitAngle = glm::radians(360.0f * (float) (iframe * HeadlessFrameDelta) / HeadlessCameraOrbitSeconds);
+        cameraController.Set3rdPersonParams(glm::degrees(orbitAngle), HeadlessCameraPitch, HeadlessCameraDistance);
+        cameraController.SetFocusPoint(mapCenter + glm::vec3(glm::cos(orbitAngle), 0.0f, glm::sin(orbitAngle)) * orbitRadius);
+
+        const double timeUpdated = GetMonotonicTime();
+        commandStream.Clear();
+        gRenderManager.RenderFrame();
+        const double timeRendered = GetMonotonicTime();
+
+        const double updateTime = (timeUpdated - timeStart) * 1000.0;
+        const double renderTime = (timeRendered - timeUpdated) * 1000.0;
+        totalUpdateTime += updateTime;
+        totalRenderTime += renderTime;
+        maxFrameTime = std::max(maxFrameTime, updateTime + renderTime);
+
+        // device statistics are complete after present
+        const GraphicsDeviceStats& deviceStats = gGraphicsDevice.mPrevFrameStats;
+        totalDrawCalls += deviceStats.mDrawCalls;
+
+        const GuiRenderer::FrameStats& guiStats = gRenderManager.GetGuiFrameStats();
+        totalGuiDrawCalls += guiStats.mDrawCalls;
+
+        framesStats += cxx::va("%d,%.3f,%.3f,%d,%d,%d,%d,%u,%d", iframe, updateTime, renderTime, deviceStats.mDrawCalls, deviceStats.mInstancesDrawn,
+            deviceStats.mStateChanges, deviceStats.mStateChangesSkipped, commandStream.mBytesTransferred, guiStats.mDrawCalls);
+        for (int icommand = 0; icommand < eGraphicsCommand_COUNT; ++icommand)
+        {
+            framesStats += cxx::va(",%d", commandStream.mCommandsCount[icommand]);
+        }
+        framesStats += "\n";
+    }
+
+    gRenderScene.SetCameraController(nullptr);
+
+    gConsole.LogMessage(eLogMessage_Info, "Headless run complete: update %.3f ms, render %.3f ms, max frame %.3f ms, draw calls %.1f, gui draw calls %.1f (average per frame)",
+        totalUpdateTime / framesCount, totalRenderTime / framesCount, maxFrameTime, (double) totalDrawCalls / framesCount, (double) totalGuiDrawCalls / framesCount);
+    gConsole.LogMessage(eLogMessage_Info, "Last frame commands:");
+    commandStream.DumpCommands(false);
+
+    if (!gFileSystem.WriteTextFile(HeadlessStatsFileName, framesStats))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write headless frames stats to '%s'", HeadlessStatsFileName);
+    }
+    mQuitRequested = true;
+}
+
 void System::Terminate()
 {
     Deinit(); // leave gracefully
@@ -186,7 +336,7 @@ void System::QuitRequest()
 
 double System::GetSysTime() const
 {
-    double currentTime = ::glfwGetTime();
+    double currentTime = GetMonotonicTime();
     return currentTime - mStartSystemTime;
 }
 
@@ -35,6 +35,15 @@ private:
     void SaveSettings();
     void LoadSettings();
 
+    // process single frame logic, without rendering
+    // @param frameDelta: Time since last frame
+    void UpdateFrame(double frameDelta);
+
+    // run fixed number of frames with null graphics device while camera flies around map,
+    // per frame cpu timings and recorded commands counters are dumped to csv file
+    // @param framesCount: Number of frames
+    void ExecuteHeadless(int framesCount);
+
 private:
     double mStartSystemTime = 0.0;
     bool mQuitRequested = false;
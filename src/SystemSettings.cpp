@@ -72,6 +72,30 @@ bool SystemStartupParams::ParseStartupParams(int argc, char *argv[])
             continue;
         }
 
+        if (cxx_stricmp(argv[iarg], "-headless") == 0)
+        {
+            mHeadless = true;
+
+            iarg += 1;
+            continue;
+        }
+
+        if (cxx_stricmp(argv[iarg], "-benchframes") == 0 && (argc > iarg + 1))
+        {
+            mBenchmarkFrames = std::max(0, ::atoi(argv[iarg + 1]));
+
+            iarg += 2;
+            continue;
+        }
+
+        if (cxx_stricmp(argv[iarg], "-logfile") == 0 && (argc > iarg + 1))
+        {
+            mLogFileName.assign(argv[iarg + 1]);
+
+            iarg += 2;
+            continue;
+        }
+
         ++iarg;
     }
 
@@ -83,4 +107,7 @@ void SystemStartupParams::Clear()
     mCustomConfigFileName.clear();
     mDungeonKeeperGamePath.clear();
     mStartupMapName.clear();
+    mHeadless = false;
+    mBenchmarkFrames = 0;
+    mLogFileName.clear();
 }
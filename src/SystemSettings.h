@@ -33,6 +33,15 @@ public:
     // custom map name to load
     std::string mStartupMapName;
 
+    // run without window using null graphics device backend
+    bool mHeadless = false;
+
+    // number of frames for headless render benchmark, 0 to use default of 600 frames
+    int mBenchmarkFrames = 0;
+
+    // write log messages to file
+    std::string mLogFileName;
+
 public:
     SystemStartupParams() = default;
 
@@ -0,0 +1,208 @@
+#include "pch.h"
+#include "TasksManager.h"
+#include "Console.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+const int MaxWorkerThreads = 16;
+
+//////////////////////////////////////////////////////////////////////////
+
+TasksManager gTasksManager;
+
+bool TasksManager::Initialize()
+{
+    debug_assert(mWorkerThreads.empty());
+
+    int workersCount = (int) std::thread::hardware_concurrency() - 1; // main thread excluded
+    workersCount = glm::clamp(workersCount, 1, MaxWorkerThreads);
+
+    mShutdownRequested = false;
+    for (int iworker = 0; iworker < workersCount; ++iworker)
+    {
+        mWorkerThreads.emplace_back(&TasksManager::WorkerThreadProc, this);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Worker threads count: %d", workersCount);
+    return true;
+}
+
+void TasksManager::Deinit()
+{
+    // workers finish all queued tasks before exit, so batches being waited on are completed
+    {
+        std::lock_guard<std::mutex> lock(mTasksMutex);
+        mShutdownRequested = true;
+    }
+    mTasksCondition.notify_all();
+
+    for (std::thread& currThread: mWorkerThreads)
+    {
+        currThread.join();
+    }
+    mWorkerThreads.clear();
+    debug_assert(mTasksQueue.empty());
+}
+
+void TasksManager::QueueTask(TaskProc taskProc)
+{
+    debug_assert(taskProc);
+
+    // no workers, execute immediately
+    if (mWorkerThreads.empty())
+    {
+        taskProc();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mTasksMutex);
+        QueuedTask& queuedTask = mTasksQueue.emplace_back();
+        queuedTask.mTaskProc = std::move(taskProc);
+    }
+    mTasksCondition.notify_one();
+}
+
+void TasksManager::QueueTask(TaskGroup& taskGroup, TaskProc taskProc)
+{
+    debug_assert(taskProc);
+
+    // no workers, execute immediately
+    if (mWorkerThreads.empty())
+    {
+        taskProc();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mTasksMutex);
+        QueuedTask& queuedTask = mTasksQueue.emplace_back();
+        queuedTask.mTaskProc = std::move(taskProc);
+        queuedTask.mTaskGroup = &taskGroup;
+        ++taskGroup.mTasksPending;
+    }
+    mTasksCondition.notify_one();
+}
+
+void TasksManager::WaitTasks(TaskGroup& taskGroup)
+{
+    std::unique_lock<std::mutex> lock(mTasksMutex);
+    while (taskGroup.mTasksPending > 0)
+    {
+        // help with own tasks which are not picked by workers yet
+        auto task_iterator = std::find_if(mTasksQueue.begin(), mTasksQueue.end(), [&taskGroup](const QueuedTask& queuedTask)
+            {
+                return queuedTask.mTaskGroup == &taskGroup;
+            });
+
+        if (task_iterator == mTasksQueue.end())
+        {
+            mTasksCompleteCondition.wait(lock);
+            continue;
+        }
+
+        TaskProc taskProc = std::move(task_iterator->mTaskProc);
+        mTasksQueue.erase(task_iterator);
+
+        lock.unlock();
+        taskProc();
+        lock.lock();
+
+        CompleteTask(&taskGroup);
+    }
+}
+
+void TasksManager::CompleteTask(TaskGroup* taskGroup)
+{
+    if (taskGroup == nullptr)
+        return;
+
+    debug_assert(taskGroup->mTasksPending > 0);
+    if (--taskGroup->mTasksPending == 0)
+    {
+        mTasksCompleteCondition.notify_all();
+    }
+}
+
+void TasksManager::ParallelFor(int tasksCount, int threadsCount, bool staticSchedule, const ParallelForProc& proc)
+{
+    if (tasksCount < 1)
+        return;
+
+    if (threadsCount < 1 || threadsCount > GetMaxThreadsCount())
+    {
+        threadsCount = GetMaxThreadsCount();
+    }
+    threadsCount = std::min(threadsCount, tasksCount);
+
+    // run on calling thread
+    if (threadsCount == 1)
+    {
+        for (int itask = 0; itask < tasksCount; ++itask)
+        {
+            proc(itask, 0);
+        }
+        return;
+    }
+
+    std::atomic<int> nextTaskIndex (0);
+
+    auto threadProc = [&](int threadIndex)
+    {
+        if (staticSchedule)
+        {
+            const int taskFirst = (tasksCount * threadIndex) / threadsCount;
+            const int taskLast = (tasksCount * (threadIndex + 1)) / threadsCount;
+            for (int itask = taskFirst; itask < taskLast; ++itask)
+            {
+                proc(itask, threadIndex);
+            }
+            return;
+        }
+
+        for (int itask = nextTaskIndex++; itask < tasksCount; itask = nextTaskIndex++)
+        {
+            proc(itask, threadIndex);
+        }
+    };
+
+    TaskGroup taskGroup;
+    for (int ithread = 1; ithread < threadsCount; ++ithread)
+    {
+        QueueTask(taskGroup, [&threadProc, ithread]()
+            {
+                threadProc(ithread);
+            });
+    }
+
+    // calling thread also participates, then runs thread ranges not picked by busy workers
+    threadProc(0);
+    WaitTasks(taskGroup);
+}
+
+void TasksManager::WorkerThreadProc()
+{
+    for (;;)
+    {
+        QueuedTask queuedTask;
+        {
+            std::unique_lock<std::mutex> lock(mTasksMutex);
+            mTasksCondition.wait(lock, [this]()
+                {
+                    return mShutdownRequested || !mTasksQueue.empty();
+                });
+
+            // queued tasks are not dropped on shutdown
+            if (mTasksQueue.empty())
+                break;
+
+            queuedTask = std::move(mTasksQueue.front());
+            mTasksQueue.pop_front();
+        }
+
+        queuedTask.mTaskProc();
+
+        std::lock_guard<std::mutex> lock(mTasksMutex);
+        CompleteTask(queuedTask.mTaskGroup);
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// background tasks manager, distributes work between pool of worker threads
+class TasksManager: public cxx::noncopyable
+{
+public:
+    using TaskProc = std::function<void()>;
+    using ParallelForProc = std::function<void(int taskIndex, int threadIndex)>;
+
+    // counts pending tasks queued as single batch, so owner waits only for its own tasks
+    class TaskGroup: public cxx::noncopyable
+    {
+        friend class TasksManager;
+
+    public:
+        ~TaskGroup()
+        {
+            debug_assert(mTasksPending == 0);
+        }
+
+    private:
+        int mTasksPending = 0; // protected by tasks mutex
+    };
+
+public:
+    // setup worker threads, returns false on error
+    bool Initialize();
+    void Deinit();
+
+    // get number of worker threads, calling thread is not included
+    inline int GetWorkersCount() const { return (int) mWorkerThreads.size(); }
+
+    // get max number of threads that can participate in parallel processing, calling thread is included
+    inline int GetMaxThreadsCount() const { return GetWorkersCount() + 1; }
+
+    // queue task for asynchronous execution on worker thread
+    // @param taskGroup: Batch which task belongs to, optional
+    // @param taskProc: Task function
+    void QueueTask(TaskProc taskProc);
+    void QueueTask(TaskGroup& taskGroup, TaskProc taskProc);
+
+    // block calling thread until all tasks of batch are complete,
+    // tasks of batch which are not started yet are executed on calling thread, so it is safe to wait on worker thread
+    // @param taskGroup: Batch of tasks
+    void WaitTasks(TaskGroup& taskGroup);
+
+    // process tasks in range [0, tasksCount) on worker threads and calling thread, blocks until all complete
+    // @param tasksCount: Number of tasks
+    // @param threadsCount: Max number of threads including calling thread, 0 means all available
+    // @param staticSchedule: Each thread gets fixed contiguous range of tasks instead of dynamic distribution,
+    //                        so specific task is always processed by same thread
+    // @param proc: Task function, receives task index and thread index in range [0, threadsCount)
+    void ParallelFor(int tasksCount, int threadsCount, bool staticSchedule, const ParallelForProc& proc);
+
+private:
+    struct QueuedTask
+    {
+    public:
+        TaskProc mTaskProc;
+        TaskGroup* mTaskGroup = nullptr;
+    };
+
+    void WorkerThreadProc();
+
+    // decrement pending tasks of batch, tasks mutex must be locked
+    void CompleteTask(TaskGroup* taskGroup);
+
+private:
+    std::vector<std::thread> mWorkerThreads;
+    std::deque<QueuedTask> mTasksQueue;
+    std::mutex mTasksMutex;
+    std::condition_variable mTasksCondition;
+    std::condition_variable mTasksCompleteCondition;
+    bool mShutdownRequested = false;
+};
+
+extern TasksManager gTasksManager;
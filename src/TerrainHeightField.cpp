@@ -1,6 +1,32 @@
 #include "pch.h"
 #include "TerrainHeightField.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define HEIGHTFIELD_SSE2
+#endif
+
+#ifdef HEIGHTFIELD_SSE2
+
+// sse2 helpers
+inline __m128i sse2_floor_epi32(__m128 value)
+{
+    __m128i truncated = _mm_cvttps_epi32(value);
+    // subtract 1 where truncation rounded negative values up
+    __m128 roundedUp = _mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), value);
+    return _mm_add_epi32(truncated, _mm_castps_si128(roundedUp));
+}
+
+inline __m128i sse2_clamp_epi32(__m128i value, __m128i minValue, __m128i maxValue)
+{
+    __m128i lessMask = _mm_cmplt_epi32(value, minValue);
+    value = _mm_or_si128(_mm_and_si128(lessMask, minValue), _mm_andnot_si128(lessMask, value));
+    __m128i greaterMask = _mm_cmpgt_epi32(value, maxValue);
+    return _mm_or_si128(_mm_and_si128(greaterMask, maxValue), _mm_andnot_si128(greaterMask, value));
+}
+
+#endif // HEIGHTFIELD_SSE2
+
 void TerrainHeightField::InitHeightField(const Point& dimensions)
 {
     mDimensions = dimensions;
@@ -42,20 +68,18 @@ void TerrainHeightField::UpdateHeights(TerrainTile* terrainTile)
         const float MaxHeight = TERRAIN_BLOCK_HEIGHT + TERRAIN_FLOOR_LEVEL;
         const float MinHeight = 0.0f;
 
-        const float stepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
+        int cellOffset = (terrainTile->mTileLocation.y * mDimensions.x) + (terrainTile->mTileLocation.x);
+        HeightFieldCell& cell = mHeightCells[cellOffset];
+        memset(&cell, 0, sizeof(HeightFieldCell));
+
+        // choose max height
+        ComputeTerrainHeights(terrainTile->mFaces[eTileFace_Ceiling], blockCoordinate, cell);
+        ComputeTerrainHeights(terrainTile->mFaces[eTileFace_Floor], blockCoordinate, cell);
+
         for (int iy = 0; iy < SubdividePointsCount; ++iy)
         for (int ix = 0; ix < SubdividePointsCount; ++ix)
         {
-            cxx::ray3d ray;
-            ray.mDirection = -SceneAxisY;
-            ray.mOrigin[0] = blockCoordinate.x + (ix * stepLength);
-            ray.mOrigin[1] = MaxHeight + 1.0f;
-            ray.mOrigin[2] = blockCoordinate.z + (iy * stepLength);
-            float h0 = ComputeTerrainHeight(terrainTile->mFaces[eTileFace_Ceiling], ray);
-            float h1 = ComputeTerrainHeight(terrainTile->mFaces[eTileFace_Floor], ray);
-            float height = glm::clamp((h0 > h1) ? h0 : h1, MinHeight, MaxHeight); // choose max height
-            int cellOffset = (terrainTile->mTileLocation.y * mDimensions.x) + (terrainTile->mTileLocation.x);
-            mHeightCells[cellOffset].mPoints[ix][iy] = height;
+            cell.mPoints[ix][iy] = glm::clamp(cell.mPoints[ix][iy], MinHeight, MaxHeight);
         }
     }
 }
@@ -69,63 +93,184 @@ void TerrainHeightField::ClearHeights()
 
 float TerrainHeightField::GetTerrainHeight(const glm::vec3& coordinate) const
 {
-    const float StepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
-    const float MaxHeight = TERRAIN_BLOCK_HEIGHT + TERRAIN_FLOOR_LEVEL;
+    if (!IsInitialized())
+        return 0.0f;
 
-    if (IsInitialized())
+    float coordx;
+    float coordz;
+    const HeightFieldCell& cell = GetHeightCell(coordinate, coordx, coordz);
+
+    //  0,0        1,0
+    //    A ------ B
+    //    |     // |
+    //    |   //   |
+    //    | //     |
+    //    C ------ D
+    //  0,1        1,1
+
+    const float gridx = coordx * (SubdivideCount / TERRAIN_BLOCK_SIZE);
+    const float gridz = coordz * (SubdivideCount / TERRAIN_BLOCK_SIZE);
+    const int quadx = std::min((int) gridx, SubdivideCount - 1);
+    const int quadz = std::min((int) gridz, SubdivideCount - 1);
+    const float fracx = gridx - quadx;
+    const float fracz = gridz - quadz;
+
+    const float hA = cell.mPoints[quadx + 0][quadz + 0];
+    const float hB = cell.mPoints[quadx + 1][quadz + 0];
+    const float hC = cell.mPoints[quadx + 0][quadz + 1];
+    const float hD = cell.mPoints[quadx + 1][quadz + 1];
+
+    // upper triangle
+    if (fracx + fracz <= 1.0f)
     {
-        glm::vec3 coordinateWithinTile;
-        GetCoordinateWithinTerrainBlock(coordinate, coordinateWithinTile);
+        return hA + (hB - hA) * fracx + (hC - hA) * fracz;
+    }
+    // lower triangle
+    return hD + (hC - hD) * (1.0f - fracx) + (hB - hD) * (1.0f - fracz);
+}
 
-        Point tileLocation;
-        GetTerrainBlockLocation(coordinate, tileLocation);
+void TerrainHeightField::GetTerrainHeights(const glm::vec3* coordinates, float* heights, int count) const
+{
+    debug_assert(coordinates);
+    debug_assert(heights);
 
-        tileLocation.x = glm::clamp(tileLocation.x, 0, mDimensions.x - 1);
-        tileLocation.y = glm::clamp(tileLocation.y, 0, mDimensions.y - 1);
+    if (!IsInitialized())
+    {
+        std::fill(heights, heights + count, 0.0f);
+        return;
+    }
 
-        const HeightFieldCell& cell = mHeightCells[tileLocation.y * mDimensions.x + tileLocation.x];
+    int icoordinate = 0;
 
-        // todo: optimize this!
+#ifdef HEIGHTFIELD_SSE2
+    const float* heightPoints = &mHeightCells[0].mPoints[0][0];
 
-        //  0,0        1,0
-        //    A ------ B
-        //    |     // |
-        //    |   //   |
-        //    | //     |
-        //    C ------ D
-        //  0,1        1,1
+    const __m128 halfBlockSize = _mm_set1_ps(TERRAIN_BLOCK_HALF_SIZE);
+    const __m128 invBlockSize = _mm_set1_ps(1.0f / TERRAIN_BLOCK_SIZE);
+    const __m128 gridScale = _mm_set1_ps(SubdivideCount * 1.0f);
+    const __m128 oneValue = _mm_set1_ps(1.0f);
+    const __m128i zeroIndex = _mm_setzero_si128();
+    const __m128i maxTileX = _mm_set1_epi32(mDimensions.x - 1);
+    const __m128i maxTileY = _mm_set1_epi32(mDimensions.y - 1);
+    const __m128i maxQuad = _mm_set1_epi32(SubdivideCount - 1);
 
-        cxx::ray3d ray;
-        ray.mOrigin.x = coordinateWithinTile.x;
-        ray.mOrigin.y = MaxHeight + 1.0f;
-        ray.mOrigin.z = coordinateWithinTile.z;
-        ray.mDirection = -SceneAxisY;
+    alignas(16) int tilex[4];
+    alignas(16) int tiley[4];
+    alignas(16) int quadx[4];
+    alignas(16) int quadz[4];
+    alignas(16) float hA[4];
+    alignas(16) float hB[4];
+    alignas(16) float hC[4];
+    alignas(16) float hD[4];
 
-        glm::vec3 output;
-        for (int cell_y = 0; cell_y < SubdivideCount; ++cell_y)
-        for (int cell_x = 0; cell_x < SubdivideCount; ++cell_x)
-        {
-            glm::vec3 pA ((cell_x + 0) * StepLength, cell.mPoints[cell_x + 0][cell_y + 0], (cell_y + 0) * StepLength);
-            glm::vec3 pB ((cell_x + 1) * StepLength, cell.mPoints[cell_x + 1][cell_y + 0], (cell_y + 0) * StepLength);
-            glm::vec3 pC ((cell_x + 0) * StepLength, cell.mPoints[cell_x + 0][cell_y + 1], (cell_y + 1) * StepLength);
-            glm::vec3 pD ((cell_x + 1) * StepLength, cell.mPoints[cell_x + 1][cell_y + 1], (cell_y + 1) * StepLength);
+    for (; icoordinate + 4 <= count; icoordinate += 4)
+    {
+        const glm::vec3* source = coordinates + icoordinate;
+        __m128 coordx = _mm_add_ps(_mm_setr_ps(source[0].x, source[1].x, source[2].x, source[3].x), halfBlockSize);
+        __m128 coordz = _mm_add_ps(_mm_setr_ps(source[0].z, source[1].z, source[2].z, source[3].z), halfBlockSize);
+        coordx = _mm_mul_ps(coordx, invBlockSize);
+        coordz = _mm_mul_ps(coordz, invBlockSize);
 
-            // upper triangle
-            if (cxx::intersects(ray, pA, pC, pB, output))
-            {
-                return output.y;
-            }
-            // lower triangle
-            if (cxx::intersects(ray, pC, pD, pB, output))
-            {
-                return output.y;
-            }
+        // tile location and coordinate within tile
+        __m128i floorx = sse2_floor_epi32(coordx);
+        __m128i floorz = sse2_floor_epi32(coordz);
+        __m128 gridx = _mm_mul_ps(_mm_sub_ps(coordx, _mm_cvtepi32_ps(floorx)), gridScale);
+        __m128 gridz = _mm_mul_ps(_mm_sub_ps(coordz, _mm_cvtepi32_ps(floorz)), gridScale);
+        _mm_store_si128((__m128i*) tilex, sse2_clamp_epi32(floorx, zeroIndex, maxTileX));
+        _mm_store_si128((__m128i*) tiley, sse2_clamp_epi32(floorz, zeroIndex, maxTileY));
+
+        // quad within tile and coordinate within quad
+        __m128i quadIndexx = sse2_clamp_epi32(_mm_cvttps_epi32(gridx), zeroIndex, maxQuad);
+        __m128i quadIndexz = sse2_clamp_epi32(_mm_cvttps_epi32(gridz), zeroIndex, maxQuad);
+        __m128 fracx = _mm_sub_ps(gridx, _mm_cvtepi32_ps(quadIndexx));
+        __m128 fracz = _mm_sub_ps(gridz, _mm_cvtepi32_ps(quadIndexz));
+        _mm_store_si128((__m128i*) quadx, quadIndexx);
+        _mm_store_si128((__m128i*) quadz, quadIndexz);
+
+        // fetch quad corners
+        for (int ilane = 0; ilane < 4; ++ilane)
+        {
+            const int cellIndex = tiley[ilane] * mDimensions.x + tilex[ilane];
+            const float* points = heightPoints + cellIndex * (SubdividePointsCount * SubdividePointsCount);
+            const int pointA = quadx[ilane] * SubdividePointsCount + quadz[ilane];
+            hA[ilane] = points[pointA];
+            hB[ilane] = points[pointA + SubdividePointsCount];
+            hC[ilane] = points[pointA + 1];
+            hD[ilane] = points[pointA + SubdividePointsCount + 1];
         }
-        return TERRAIN_FLOOR_LEVEL;
+
+        const __m128 heightA = _mm_load_ps(hA);
+        const __m128 heightB = _mm_load_ps(hB);
+        const __m128 heightC = _mm_load_ps(hC);
+        const __m128 heightD = _mm_load_ps(hD);
+
+        // upper triangle
+        __m128 upperHeight = _mm_add_ps(heightA, _mm_add_ps(
+            _mm_mul_ps(_mm_sub_ps(heightB, heightA), fracx), 
+            _mm_mul_ps(_mm_sub_ps(heightC, heightA), fracz)));
+        // lower triangle
+        __m128 lowerHeight = _mm_add_ps(heightD, _mm_add_ps(
+            _mm_mul_ps(_mm_sub_ps(heightC, heightD), _mm_sub_ps(oneValue, fracx)), 
+            _mm_mul_ps(_mm_sub_ps(heightB, heightD), _mm_sub_ps(oneValue, fracz))));
+
+        __m128 upperMask = _mm_cmple_ps(_mm_add_ps(fracx, fracz), oneValue);
+        __m128 result = _mm_or_ps(_mm_and_ps(upperMask, upperHeight), _mm_andnot_ps(upperMask, lowerHeight));
+        _mm_storeu_ps(heights + icoordinate, result);
+    }
+#endif // HEIGHTFIELD_SSE2
+
+    // process remaining coordinates
+    for (; icoordinate < count; ++icoordinate)
+    {
+        heights[icoordinate] = GetTerrainHeight(coordinates[icoordinate]);
+    }
+}
+
+float TerrainHeightField::GetTerrainHeightRaycast(const glm::vec3& coordinate) const
+{
+    if (IsInitialized())
+    {
+        float coordx;
+        float coordz;
+        const HeightFieldCell& cell = GetHeightCell(coordinate, coordx, coordz);
+        return GetCellHeightRaycast(cell, coordx, coordz);
     }
     return 0.0f;
 }
 
+float TerrainHeightField::GetTerrainHeightReference(const glm::vec3& coordinate, TerrainTile* terrainTile) const
+{
+    if (IsInitialized() && terrainTile)
+    {
+        glm::vec3 coordinateWithinTile;
+        GetCoordinateWithinTerrainBlock(coordinate, coordinateWithinTile);
+
+        HeightFieldCell referenceCell;
+        ComputeHeightCellRaycast(terrainTile, referenceCell);
+        return GetCellHeightRaycast(referenceCell, coordinateWithinTile.x, coordinateWithinTile.z);
+    }
+    return 0.0f;
+}
+
+float TerrainHeightField::GetHeightCellError(TerrainTile* terrainTile) const
+{
+    if (!IsInitialized() || terrainTile == nullptr)
+        return 0.0f;
+
+    HeightFieldCell referenceCell;
+    ComputeHeightCellRaycast(terrainTile, referenceCell);
+
+    const HeightFieldCell& cell = mHeightCells[terrainTile->mTileLocation.y * mDimensions.x + terrainTile->mTileLocation.x];
+
+    float maxError = 0.0f;
+    for (int iy = 0; iy < SubdividePointsCount; ++iy)
+    for (int ix = 0; ix < SubdividePointsCount; ++ix)
+    {
+        maxError = std::max(maxError, fabs(cell.mPoints[ix][iy] - referenceCell.mPoints[ix][iy]));
+    }
+    return maxError;
+}
+
 void TerrainHeightField::GenerateDebugMesh(Vertex3D_TriMesh& outputMesh) const
 {
     const float StepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
@@ -174,9 +319,73 @@ void TerrainHeightField::GenerateDebugMesh(Vertex3D_TriMesh& outputMesh) const
     }
 }
 
-float TerrainHeightField::ComputeTerrainHeight(const TileFaceData& sourceData, const cxx::ray3d& processRay) const
+float TerrainHeightField::GetCellHeightRaycast(const HeightFieldCell& cell, float coordx, float coordz) const
+{
+    const float StepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
+    const float MaxHeight = TERRAIN_BLOCK_HEIGHT + TERRAIN_FLOOR_LEVEL;
+
+    //  0,0        1,0
+    //    A ------ B
+    //    |     // |
+    //    |   //   |
+    //    | //     |
+    //    C ------ D
+    //  0,1        1,1
+
+    cxx::ray3d ray;
+    ray.mOrigin.x = coordx;
+    ray.mOrigin.y = MaxHeight + 1.0f;
+    ray.mOrigin.z = coordz;
+    ray.mDirection = -SceneAxisY;
+
+    glm::vec3 output;
+    for (int cell_y = 0; cell_y < SubdivideCount; ++cell_y)
+    for (int cell_x = 0; cell_x < SubdivideCount; ++cell_x)
+    {
+        glm::vec3 pA ((cell_x + 0) * StepLength, cell.mPoints[cell_x + 0][cell_y + 0], (cell_y + 0) * StepLength);
+        glm::vec3 pB ((cell_x + 1) * StepLength, cell.mPoints[cell_x + 1][cell_y + 0], (cell_y + 0) * StepLength);
+        glm::vec3 pC ((cell_x + 0) * StepLength, cell.mPoints[cell_x + 0][cell_y + 1], (cell_y + 1) * StepLength);
+        glm::vec3 pD ((cell_x + 1) * StepLength, cell.mPoints[cell_x + 1][cell_y + 1], (cell_y + 1) * StepLength);
+
+        // upper triangle
+        if (cxx::intersects(ray, pA, pC, pB, output))
+        {
+            return output.y;
+        }
+        // lower triangle
+        if (cxx::intersects(ray, pC, pD, pB, output))
+        {
+            return output.y;
+        }
+    }
+    return TERRAIN_FLOOR_LEVEL;
+}
+
+void TerrainHeightField::ComputeHeightCellRaycast(TerrainTile* terrainTile, HeightFieldCell& outputCell) const
+{
+    glm::vec3 blockCoordinate;
+    GetTerrainBlockCoordinate(terrainTile->mTileLocation, blockCoordinate);
+
+    const float MaxHeight = TERRAIN_BLOCK_HEIGHT + TERRAIN_FLOOR_LEVEL;
+    const float MinHeight = 0.0f;
+
+    const float stepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
+    for (int iy = 0; iy < SubdividePointsCount; ++iy)
+    for (int ix = 0; ix < SubdividePointsCount; ++ix)
+    {
+        cxx::ray3d ray;
+        ray.mDirection = -SceneAxisY;
+        ray.mOrigin[0] = blockCoordinate.x + (ix * stepLength);
+        ray.mOrigin[1] = MaxHeight + 1.0f;
+        ray.mOrigin[2] = blockCoordinate.z + (iy * stepLength);
+        float h0 = ComputeTerrainHeightRaycast(terrainTile->mFaces[eTileFace_Ceiling], ray);
+        float h1 = ComputeTerrainHeightRaycast(terrainTile->mFaces[eTileFace_Floor], ray);
+        outputCell.mPoints[ix][iy] = glm::clamp((h0 > h1) ? h0 : h1, MinHeight, MaxHeight); // choose max height
+    }
+}
+
+float TerrainHeightField::ComputeTerrainHeightRaycast(const TileFaceData& sourceData, const cxx::ray3d& processRay) const
 {
-    debug_assert(IsInitialized());
     glm::vec3 outPoint;
 
     float height = 0.0f;
@@ -198,4 +407,81 @@ float TerrainHeightField::ComputeTerrainHeight(const TileFaceData& sourceData, c
         }
     } // for
     return height;
+}
+
+void TerrainHeightField::ComputeTerrainHeights(const TileFaceData& sourceData, const glm::vec3& blockCoordinate, HeightFieldCell& outputCell) const
+{
+    debug_assert(IsInitialized());
+
+    const float StepLength = TERRAIN_BLOCK_SIZE / (SubdivideCount * 1.0f);
+    const float InvStepLength = 1.0f / StepLength;
+
+    // project each triangle onto sample points grid and test only points within its bounds,
+    // it is equivalent to casting vertical ray through each sample point
+    for (const TileMesh& currentPiece: sourceData.mMeshArray)
+    {
+        for (const glm::ivec3& currentTriangle: currentPiece.mTriangles)
+        { 
+            const glm::vec3& p0 = currentPiece.mVertices[currentTriangle[0]].mPosition;
+            const glm::vec3& p1 = currentPiece.mVertices[currentTriangle[1]].mPosition;
+            const glm::vec3& p2 = currentPiece.mVertices[currentTriangle[2]].mPosition;
+
+            const float edge1x = p1.x - p0.x;
+            const float edge1z = p1.z - p0.z;
+            const float edge2x = p2.x - p0.x;
+            const float edge2z = p2.z - p0.z;
+            const float det = edge1x * edge2z - edge2x * edge1z;
+            if (det > -FLT_EPSILON && det < FLT_EPSILON)
+                continue; // triangle is parallel to vertical ray
+
+            // sample points covered by triangle bounds
+            const float minx = (std::min(p0.x, std::min(p1.x, p2.x)) - blockCoordinate.x) * InvStepLength;
+            const float maxx = (std::max(p0.x, std::max(p1.x, p2.x)) - blockCoordinate.x) * InvStepLength;
+            const float minz = (std::min(p0.z, std::min(p1.z, p2.z)) - blockCoordinate.z) * InvStepLength;
+            const float maxz = (std::max(p0.z, std::max(p1.z, p2.z)) - blockCoordinate.z) * InvStepLength;
+            const int pointxStart = std::max((int) std::ceil(minx - 0.001f), 0);
+            const int pointxEnd = std::min((int) std::floor(maxx + 0.001f), SubdividePointsCount - 1);
+            const int pointzStart = std::max((int) std::ceil(minz - 0.001f), 0);
+            const int pointzEnd = std::min((int) std::floor(maxz + 0.001f), SubdividePointsCount - 1);
+
+            const float invDet = 1.0f / det;
+            for (int pointz = pointzStart; pointz <= pointzEnd; ++pointz)
+            for (int pointx = pointxStart; pointx <= pointxEnd; ++pointx)
+            {
+                const float deltax = blockCoordinate.x + (pointx * StepLength) - p0.x;
+                const float deltaz = blockCoordinate.z + (pointz * StepLength) - p0.z;
+                const float u = (deltax * edge2z - edge2x * deltaz) * invDet;
+                if (u < 0.0f || u > 1.0f)
+                    continue;
+
+                const float v = (edge1x * deltaz - deltax * edge1z) * invDet;
+                if (v < 0.0f || u + v > 1.0f)
+                    continue;
+
+                const float height = p0.y + (p1.y - p0.y) * u + (p2.y - p0.y) * v;
+                if (height > outputCell.mPoints[pointx][pointz])
+                {
+                    outputCell.mPoints[pointx][pointz] = height;
+                }
+            }
+        }
+    } // for
+}
+
+const TerrainHeightField::HeightFieldCell& TerrainHeightField::GetHeightCell(const glm::vec3& coordinate, float& coordx, float& coordz) const
+{
+    debug_assert(IsInitialized());
+
+    glm::vec3 coordinateWithinTile;
+    GetCoordinateWithinTerrainBlock(coordinate, coordinateWithinTile);
+
+    Point tileLocation;
+    GetTerrainBlockLocation(coordinate, tileLocation);
+
+    tileLocation.x = glm::clamp(tileLocation.x, 0, mDimensions.x - 1);
+    tileLocation.y = glm::clamp(tileLocation.y, 0, mDimensions.y - 1);
+
+    coordx = coordinateWithinTile.x;
+    coordz = coordinateWithinTile.z;
+    return mHeightCells[tileLocation.y * mDimensions.x + tileLocation.x];
 }
\ No newline at end of file
@@ -33,13 +33,31 @@ public:
         return GetTerrainHeight(coordinate);
     }
 
+    // get terrain heights for batch of coordinates, processes 4 coordinates at once where SSE2 is available
+    // @param coordinates: Points in world space, 'y' component is ignored
+    // @param heights: Output heights
+    // @param count: Number of coordinates
+    void GetTerrainHeights(const glm::vec3* coordinates, float* heights, int count) const;
+
+    // get terrain height at specific coordinate by casting ray against height cell triangles
+    // it is much slower than GetTerrainHeight, for validation purposes only
+    // @param coordinate: Point in world space, 'y' component is ignored
+    float GetTerrainHeightRaycast(const glm::vec3& coordinate) const;
+
+    // get terrain height at specific coordinate the way it was computed before triangles projection:
+    // cell points are found by casting vertical ray per point against tile faces, then ray is cast against cell triangles,
+    // it does not use stored heights, for validation purposes only
+    // @param coordinate: Point in world space, 'y' component is ignored
+    // @param terrainTile: Tile at coordinate
+    float GetTerrainHeightReference(const glm::vec3& coordinate, TerrainTile* terrainTile) const;
+
+    // get max difference between stored cell points of tile and points found by casting vertical ray per point
+    // @param terrainTile: Target tile
+    float GetHeightCellError(TerrainTile* terrainTile) const;
+
     // for debug purposes
     void GenerateDebugMesh(Vertex3D_TriMesh& outputMesh) const;
 
-private:
-    // internal computations
-    float ComputeTerrainHeight(const TileFaceData& sourceData, const cxx::ray3d& processRay) const;
-
 private:
     static const int SubdivideCount = 2;
     static const int SubdividePointsCount = SubdivideCount * 2 - 1;
@@ -48,6 +66,16 @@ private:
         // x/y
         float mPoints[SubdividePointsCount][SubdividePointsCount];
     };
+
+    // internal computations
+    void ComputeTerrainHeights(const TileFaceData& sourceData, const glm::vec3& blockCoordinate, HeightFieldCell& outputCell) const;
+    const HeightFieldCell& GetHeightCell(const glm::vec3& coordinate, float& coordx, float& coordz) const;
+
+    // reference computations, per point raycast
+    float GetCellHeightRaycast(const HeightFieldCell& cell, float coordx, float coordz) const;
+    void ComputeHeightCellRaycast(TerrainTile* terrainTile, HeightFieldCell& outputCell) const;
+    float ComputeTerrainHeightRaycast(const TileFaceData& sourceData, const cxx::ray3d& processRay) const;
+
     std::vector<HeightFieldCell> mHeightCells;
     Point mDimensions; // num tiles w x h
 };
\ No newline at end of file
@@ -12,15 +12,30 @@
 #include "Texture2D.h"
 #include "RenderableProcMesh.h"
 #include "cvars.h"
+#include "TasksManager.h"
+#include "randomizer.h"
+#include "RenderManager.h"
+#include "PathfindingManager.h"
 
 //////////////////////////////////////////////////////////////////////////
 
 // cvars
 CvarBoolean gCVarRender_DrawTerrainHeightFieldMesh ("r_drawTerrainHeightField", false, "Enable draw terrain height field mesh", ConsoleVar_Debug | ConsoleVar_Renderer);
+CvarInteger gCvarGame_TerrainBuildThreads ("g_terrainBuildThreads", 0, "Max threads used to build terrain mesh, 0 means all available", ConsoleVar_Game);
+CvarBoolean gCvarGame_TerrainBuildDeterministic ("g_terrainBuildDeterministic", false, "Assign terrain tiles to build threads in fixed order", ConsoleVar_Game | ConsoleVar_Debug);
 
 //////////////////////////////////////////////////////////////////////////
 
 const int TerrainMeshSizeTiles = 8; // 8x8 tiles per terrain mesh
+
+const int TerrainMeshBenchmarkIterations = 4;
+
+const int TerrainEditsDefaultIterations = 50;
+const int TerrainEditsAreaSize = 3; // 3x3 tiles room
+
+const int TerrainHeightsDefaultQueries = 1000000;
+
+const float TerrainHeightsValidationEpsilon = 0.0001f;
                                     
 const Color32 TILE_TAGGED_COLOR = Color32::MakeRGBA(64, 64, 255, 0); // color constants
 
@@ -44,12 +59,71 @@ bool TerrainManager::Initialize()
             }
         });
 
+    gCvarRender_TerrainTexturesArray.SetValueChangedCallback([](CVarBase* cvar)
+        {
+            // texture layers are stored within vertices
+            for (RenderableTerrainMesh* currTerrainMesh: gTerrainManager.mTerrainMeshArray)
+            {
+                currTerrainMesh->InvalidateAllTiles();
+            }
+        });
+
+    gCvarRender_CompactVertices.SetValueChangedCallback([](CVarBase* cvar)
+        {
+            // models renderer switches vertex format by itself
+            for (RenderableTerrainMesh* currTerrainMesh: gTerrainManager.mTerrainMeshArray)
+            {
+                currTerrainMesh->InvalidateAllTiles();
+            }
+            for (RenderableWaterLavaMesh* currWaterLavaMesh: gTerrainManager.mWaterLavaMeshArray)
+            {
+                currWaterLavaMesh->InvalidateMesh();
+            }
+        });
+
+    gConsole.RegisterVariable(&gCvarGame_TerrainBuildThreads);
+    gConsole.RegisterVariable(&gCvarGame_TerrainBuildDeterministic);
+
+    gConsole.RegisterFunction("bench_terrainMesh", "Rebuild full terrain mesh with 1..N threads, args: maxThreads", [](const ConsoleFuncArgs& args)
+        {
+            int maxThreads = 0;
+            args.ParseArgument(0, maxThreads);
+            gTerrainManager.RunTerrainMeshBenchmark(maxThreads);
+        });
+
+    gConsole.RegisterFunction("bench_terrainEdits", "Measure terrain mesh uploads on room construct/sell, args: iterations", [](const ConsoleFuncArgs& args)
+        {
+            int iterations = 0;
+            args.ParseArgument(0, iterations);
+            gTerrainManager.RunTerrainEditsBenchmark(iterations);
+        });
+
+    gConsole.RegisterFunction("bench_terrainHeights", "Measure terrain height queries performance, args: queriesCount", [](const ConsoleFuncArgs& args)
+        {
+            int queriesCount = 0;
+            args.ParseArgument(0, queriesCount);
+            gTerrainManager.RunHeightFieldBenchmark(queriesCount);
+        });
+
+    gConsole.RegisterFunction("test_terrainHeights", "Compare terrain height queries and height cells against per point raycast, args: queriesCount", [](const ConsoleFuncArgs& args)
+        {
+            int queriesCount = 0;
+            args.ParseArgument(0, queriesCount);
+            gTerrainManager.ValidateHeightField(queriesCount);
+        });
+
     return true;
 }
 
 void TerrainManager::Deinit()
 {
     gConsole.UnregisterVariable(&gCVarRender_DrawTerrainHeightFieldMesh);
+    gConsole.UnregisterVariable(&gCvarGame_TerrainBuildThreads);
+    gConsole.UnregisterVariable(&gCvarGame_TerrainBuildDeterministic);
+    gConsole.UnregisterFunction("bench_terrainMesh");
+    gConsole.UnregisterFunction("bench_terrainEdits");
+    gConsole.UnregisterFunction("bench_terrainHeights");
+    gConsole.UnregisterFunction("test_terrainHeights");
     FreeHighhlightTilesTexture();
 }
 
@@ -79,6 +153,7 @@ void TerrainManager::ClearWorld()
     FreeTerrainMeshList();
 
     mMeshInvalidatedTiles.clear();
+    mTilesMeshStaging.clear();
     mHighlightTiles.clear();
 
     mHeightField.Cleanup();
@@ -151,16 +226,17 @@ void TerrainManager::UpdateTerrainMesh()
 
     std::set<GenericRoom*> invalidateRooms;
 
-    // build terrain tiles and collect invalidated rooms
+    // collect invalidated rooms
     for (TerrainTile* currentTile: mMeshInvalidatedTiles)
     {
         if (currentTile->mBuiltRoom)
         {
             invalidateRooms.insert(currentTile->mBuiltRoom);
         }
-        // force rebuild mesh
-        gGameWorld.mDungeonBuilder.BuildTerrainMesh(currentTile);
     }
+
+    // force rebuild terrain tiles
+    BuildTilesMesh(mMeshInvalidatedTiles, gCvarGame_TerrainBuildThreads.mValue);
 
     // ask rooms rebuild themselves
     for (GenericRoom* currentRoom: invalidateRooms)
@@ -184,10 +260,10 @@ void TerrainManager::UpdateTerrainMesh()
     {
         currentTile->mIsMeshInvalidated = false;
 
-        // invalidate terrain mesh chunk
+        // invalidate tile within terrain mesh chunk
         RenderableTerrainMesh* terrainMesh = GetObjectTerrainFromTile(currentTile->mTileLocation);
         debug_assert(terrainMesh);
-        terrainMesh->InvalidateMesh();
+        terrainMesh->InvalidateTileMesh(currentTile);
     }
 
     // update heightfield
@@ -203,6 +279,12 @@ void TerrainManager::UpdateTerrainMesh()
 
 void TerrainManager::InvalidateTileMesh(TerrainTile* terrainTile)
 {
+    // terrain type or owner changed
+    if (terrainTile)
+    {
+        gPathfindingManager.InvalidateTile(terrainTile);
+    }
+
     if (terrainTile && !terrainTile->mIsMeshInvalidated)
     {
         if (cxx::contains(mMeshInvalidatedTiles, terrainTile))
@@ -239,13 +321,18 @@ void TerrainManager::ClearInvalidatedTiles()
 
 void TerrainManager::BuildFullTerrainMesh()
 {
-    // build terrain tiles
+    TilesList mapTiles;
+    mapTiles.reserve(gGameWorld.mMapData.mDimensions.x * gGameWorld.mMapData.mDimensions.y);
+
     MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(Point(), gGameWorld.mMapData.mDimensions);
     for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile; 
         currMapTile = tilesIterator.NextTile())
     {
-        gGameWorld.mDungeonBuilder.BuildTerrainMesh(currMapTile);
+        mapTiles.push_back(currMapTile);
     }
+
+    // build terrain tiles
+    BuildTilesMesh(mapTiles, gCvarGame_TerrainBuildThreads.mValue);
 
     // ask rooms to build its tiles
     for (GenericRoom* currentRoom: gRoomsManager.mRoomsList)
@@ -255,17 +342,355 @@ void TerrainManager::BuildFullTerrainMesh()
 
     ClearInvalidatedTiles();
 
+    // decode all terrain textures at once rather than one by one on first use
+    std::set<Texture2D*> terrainTextures;
+    for (TerrainTile* currTile: mapTiles)
+    {
+        for (const TileFaceData& tileFace: currTile->mFaces)
+        {
+            for (const TileMesh& currTileMesh: tileFace.mMeshArray)
+            {
+                if (currTileMesh.mMaterial.mDiffuseTexture)
+                {
+                    terrainTextures.insert(currTileMesh.mMaterial.mDiffuseTexture);
+                }
+            }
+        }
+    }
+    gRenderManager.mTerrainMeshRenderer.PrepareTexturesArray({terrainTextures.begin(), terrainTextures.end()});
+
     // update heightfield
-    tilesIterator.Reset();
+    mHeightField.UpdateHeights(mapTiles);
+
+    UpdateHeightFieldDebugMesh();
+}
+
+void TerrainManager::BuildTilesMesh(const TilesList& terrainTiles, int threadsCount)
+{
+    const int tilesCount = (int) terrainTiles.size();
+    if (tilesCount > (int) mTilesMeshStaging.size())
+    {
+        mTilesMeshStaging.resize(tilesCount);
+    }
+
+    // construct geometry, tiles are not modified until commit so workers can read neighbours safely
+    DungeonBuilder& dungeonBuilder = gGameWorld.mDungeonBuilder;
+    gTasksManager.ParallelFor(tilesCount, threadsCount, gCvarGame_TerrainBuildDeterministic.mValue, 
+        [&dungeonBuilder, &terrainTiles, this](int taskIndex, int threadIndex)
+        {
+            dungeonBuilder.BuildTerrainMesh(terrainTiles[taskIndex], mTilesMeshStaging[taskIndex]);
+        });
+
+    // commit on main thread in source order
+    for (int itile = 0; itile < tilesCount; ++itile)
+    {
+        dungeonBuilder.CommitTerrainMesh(terrainTiles[itile], mTilesMeshStaging[itile]);
+        mTilesMeshStaging[itile].Clear();
+    }
+}
+
+void TerrainManager::RunTerrainMeshBenchmark(int maxThreads)
+{
+    if (mTerrainMeshArray.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Terrain benchmark requires loaded map");
+        return;
+    }
+
+    if (maxThreads < 1 || maxThreads > gTasksManager.GetMaxThreadsCount())
+    {
+        maxThreads = gTasksManager.GetMaxThreadsCount();
+    }
+
+    TilesList mapTiles;
+    MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(Point(), gGameWorld.mMapData.mDimensions);
     for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile; 
         currMapTile = tilesIterator.NextTile())
     {
-        mHeightField.UpdateHeights(currMapTile);
+        mapTiles.push_back(currMapTile);
     }
 
+    gConsole.LogMessage(eLogMessage_Info, "Terrain mesh benchmark: %dx%d tiles, %d iterations", 
+        gGameWorld.mMapData.mDimensions.x, gGameWorld.mMapData.mDimensions.y, TerrainMeshBenchmarkIterations);
+
+    // warm up models and textures cache
+    BuildTilesMesh(mapTiles, maxThreads);
+
+    double singleThreadSeconds = 0.0;
+    for (int ithreads = 1; ithreads <= maxThreads; ++ithreads)
+    {
+        auto timeStart = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < TerrainMeshBenchmarkIterations; ++iteration)
+        {
+            BuildTilesMesh(mapTiles, ithreads);
+        }
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+
+        double seconds = timeElapsed.count();
+        if (ithreads == 1)
+        {
+            singleThreadSeconds = seconds;
+        }
+
+        double tilesPerSecond = (mapTiles.size() * TerrainMeshBenchmarkIterations) / seconds;
+        gConsole.LogMessage(eLogMessage_Info, "Threads: %d, tiles/sec: %.0f, speedup: %.2fx", 
+            ithreads, tilesPerSecond, singleThreadSeconds / seconds);
+    }
+
+    // restore rooms geometry
+    for (GenericRoom* currentRoom: gRoomsManager.mRoomsList)
+    {
+        currentRoom->BuildTilesMesh();
+    }
+
+    ClearInvalidatedTiles();
+
+    for (RenderableTerrainMesh* currTerrainMesh: mTerrainMeshArray)
+    {
+        currTerrainMesh->InvalidateAllTiles();
+    }
+
+    mHeightField.UpdateHeights(mapTiles);
     UpdateHeightFieldDebugMesh();
 }
 
+void TerrainManager::RunTerrainEditsBenchmark(int iterations)
+{
+    if (mTerrainMeshArray.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Terrain edits benchmark requires loaded map");
+        return;
+    }
+
+    if (iterations < 1)
+    {
+        iterations = TerrainEditsDefaultIterations;
+    }
+
+    RoomDefinition* roomDefinition = nullptr;
+    for (RoomDefinition& currDefinition: gGameWorld.mScenarioData.mRoomDefs)
+    {
+        if (currDefinition.mBuildable && currDefinition.mPlaceableOnLand)
+        {
+            roomDefinition = &currDefinition;
+            break;
+        }
+    }
+
+    // find free area within player territory
+    const ePlayerID playerID = ePlayerID_Keeper1;
+    const Point& mapDimensions = gGameWorld.mMapData.mDimensions;
+
+    bool areaFound = false;
+    Rectangle editArea;
+    for (int tiley = 0; roomDefinition && !areaFound && tiley <= mapDimensions.y - TerrainEditsAreaSize; ++tiley)
+    for (int tilex = 0; !areaFound && tilex <= mapDimensions.x - TerrainEditsAreaSize; ++tilex)
+    {
+        editArea = Rectangle(tilex, tiley, TerrainEditsAreaSize, TerrainEditsAreaSize);
+        areaFound = true;
+
+        MapTilesIterator tilesIterator = gGameWorld.mMapData.IterateTiles(editArea);
+        for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile && areaFound; 
+            currMapTile = tilesIterator.NextTile())
+        {
+            areaFound = gGameWorld.CanPlaceRoomOnLocation(currMapTile, playerID, roomDefinition);
+        }
+    }
+
+    if (!areaFound)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Terrain edits benchmark requires free %dx%d claimed area", 
+            TerrainEditsAreaSize, TerrainEditsAreaSize);
+        return;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Terrain edits benchmark: room '%s' at (%d, %d), %d iterations", 
+        roomDefinition->mRoomName.c_str(), editArea.x, editArea.y, iterations);
+
+    // make sure that pending changes are uploaded
+    UpdateTerrainMesh();
+    for (RenderableTerrainMesh* currTerrainMesh: mTerrainMeshArray)
+    {
+        currTerrainMesh->UpdateRenderResources();
+    }
+
+    const TerrainMeshRenderer::UploadStats& uploadStats = gRenderManager.mTerrainMeshRenderer.mUploadStats;
+    const bool partialUpdates = gCvarRender_TerrainPartialUpdates.mValue;
+    for (int ipass = 0; ipass < 2; ++ipass)
+    {
+        gCvarRender_TerrainPartialUpdates.SetValue(ipass > 0);
+
+        const long long prevUploadedBytes = uploadStats.mUploadedBytes;
+        double buildSeconds = 0.0;
+        double uploadSeconds = 0.0;
+        for (int iteration = 0; iteration < iterations; ++iteration)
+        {
+            for (int iedit = 0; iedit < 2; ++iedit)
+            {
+                if (iedit == 0)
+                {
+                    gGameWorld.ConstructRoom(playerID, roomDefinition, editArea);
+                }
+                else
+                {
+                    gGameWorld.SellRooms(playerID, editArea);
+                }
+
+                auto timeStart = std::chrono::steady_clock::now();
+                UpdateTerrainMesh();
+                auto timeBuilt = std::chrono::steady_clock::now();
+                for (RenderableTerrainMesh* currTerrainMesh: mTerrainMeshArray)
+                {
+                    currTerrainMesh->UpdateRenderResources();
+                }
+                auto timeUploaded = std::chrono::steady_clock::now();
+
+                buildSeconds += std::chrono::duration<double>(timeBuilt - timeStart).count();
+                uploadSeconds += std::chrono::duration<double>(timeUploaded - timeBuilt).count();
+            }
+        }
+
+        const int editsCount = iterations * 2;
+        const double uploadedBytes = (double) (uploadStats.mUploadedBytes - prevUploadedBytes);
+        gConsole.LogMessage(eLogMessage_Info, "%s: %.1f KB/edit, build %.3f ms/edit, upload %.3f ms/edit", 
+            ipass > 0 ? "Partial updates" : "Full rebuilds", 
+            uploadedBytes / editsCount / 1024.0, 
+            buildSeconds * 1000.0 / editsCount, 
+            uploadSeconds * 1000.0 / editsCount);
+    }
+
+    gCvarRender_TerrainPartialUpdates.SetValue(partialUpdates);
+}
+
+void TerrainManager::GenerateHeightFieldQueries(std::vector<glm::vec3>& coordinates, int queriesCount) const
+{
+    const Point& mapDimensions = gGameWorld.mMapData.mDimensions;
+
+    cxx::randomizer randomizer;
+    coordinates.resize(queriesCount);
+    for (glm::vec3& currCoordinate: coordinates)
+    {
+        currCoordinate.x = (randomizer.generate_float() * mapDimensions.x - TERRAIN_BLOCK_HALF_SIZE) * TERRAIN_BLOCK_SIZE;
+        currCoordinate.y = 0.0f;
+        currCoordinate.z = (randomizer.generate_float() * mapDimensions.y - TERRAIN_BLOCK_HALF_SIZE) * TERRAIN_BLOCK_SIZE;
+    }
+}
+
+void TerrainManager::RunHeightFieldBenchmark(int queriesCount)
+{
+    if (mTerrainMeshArray.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Heights benchmark requires loaded map");
+        return;
+    }
+
+    if (queriesCount < 1)
+    {
+        queriesCount = TerrainHeightsDefaultQueries;
+    }
+
+    std::vector<glm::vec3> coordinates;
+    std::vector<float> heights(queriesCount);
+    GenerateHeightFieldQueries(coordinates, queriesCount);
+
+    auto MeasureQueries = [queriesCount](const std::function<void()>& proc)
+    {
+        auto timeStart = std::chrono::steady_clock::now();
+        proc();
+        std::chrono::duration<double, std::nano> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+        return timeElapsed.count() / queriesCount;
+    };
+
+    double raycastNs = MeasureQueries([&]()
+        {
+            for (int iquery = 0; iquery < queriesCount; ++iquery)
+            {
+                heights[iquery] = mHeightField.GetTerrainHeightRaycast(coordinates[iquery]);
+            }
+        });
+
+    double lookupNs = MeasureQueries([&]()
+        {
+            for (int iquery = 0; iquery < queriesCount; ++iquery)
+            {
+                heights[iquery] = mHeightField.GetTerrainHeight(coordinates[iquery]);
+            }
+        });
+
+    double batchNs = MeasureQueries([&]()
+        {
+            mHeightField.GetTerrainHeights(coordinates.data(), heights.data(), queriesCount);
+        });
+
+    gConsole.LogMessage(eLogMessage_Info, "Terrain heights benchmark: %d queries", queriesCount);
+    gConsole.LogMessage(eLogMessage_Info, "Raycast: %.2f ns/query, lookup: %.2f ns/query, batch: %.2f ns/query", 
+        raycastNs, lookupNs, batchNs);
+}
+
+void TerrainManager::ValidateHeightField(int queriesCount)
+{
+    if (mTerrainMeshArray.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Heights validation requires loaded map");
+        return;
+    }
+
+    if (queriesCount < 1)
+    {
+        queriesCount = TerrainHeightsDefaultQueries;
+    }
+
+    std::vector<glm::vec3> coordinates;
+    std::vector<float> batchHeights(queriesCount);
+    GenerateHeightFieldQueries(coordinates, queriesCount);
+
+    mHeightField.GetTerrainHeights(coordinates.data(), batchHeights.data(), queriesCount);
+
+    GameMap& gameMap = gGameWorld.mMapData;
+
+    // queries are compared against old path, which casts ray per cell point against tile faces
+    // and then casts ray against cell triangles
+    float maxLookupError = 0.0f;
+    float maxBatchError = 0.0f;
+    int mismatchCount = 0;
+    for (int iquery = 0; iquery < queriesCount; ++iquery)
+    {
+        Point tileLocation;
+        GetTerrainBlockLocation(coordinates[iquery], tileLocation);
+        tileLocation.x = glm::clamp(tileLocation.x, 0, gameMap.mDimensions.x - 1);
+        tileLocation.y = glm::clamp(tileLocation.y, 0, gameMap.mDimensions.y - 1);
+
+        float referenceHeight = mHeightField.GetTerrainHeightReference(coordinates[iquery], gameMap.GetMapTile(tileLocation));
+        float lookupError = fabs(mHeightField.GetTerrainHeight(coordinates[iquery]) - referenceHeight);
+        float batchError = fabs(batchHeights[iquery] - referenceHeight);
+        if (lookupError > TerrainHeightsValidationEpsilon || batchError > TerrainHeightsValidationEpsilon)
+        {
+            ++mismatchCount;
+        }
+        maxLookupError = std::max(maxLookupError, lookupError);
+        maxBatchError = std::max(maxBatchError, batchError);
+    }
+
+    // cell points computed by triangles projection
+    float maxCellError = 0.0f;
+    int cellMismatchCount = 0;
+    MapTilesIterator tilesIterator = gameMap.IterateTiles(Point(), gameMap.mDimensions);
+    for (TerrainTile* currMapTile = tilesIterator.NextTile(); currMapTile; 
+        currMapTile = tilesIterator.NextTile())
+    {
+        float cellError = mHeightField.GetHeightCellError(currMapTile);
+        if (cellError > TerrainHeightsValidationEpsilon)
+        {
+            ++cellMismatchCount;
+        }
+        maxCellError = std::max(maxCellError, cellError);
+    }
+
+    gConsole.LogMessage((mismatchCount || cellMismatchCount) ? eLogMessage_Warning : eLogMessage_Info, 
+        "Terrain heights validation: %d queries, max error lookup: %f, batch: %f, mismatches: %d, max cell error: %f, cell mismatches: %d", 
+        queriesCount, maxLookupError, maxBatchError, mismatchCount, maxCellError, cellMismatchCount);
+}
+
 void TerrainManager::InitWaterLavaMeshList()
 {
     GameMap& gameMap = gGameWorld.mMapData;
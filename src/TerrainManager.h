@@ -26,6 +26,23 @@ public:
     void UpdateTerrainMesh();
     void BuildFullTerrainMesh();
 
+    // rebuild full terrain mesh several times using 1..N threads and print tiles/sec stats
+    // @param maxThreads: Max threads count, 0 means all available
+    void RunTerrainMeshBenchmark(int maxThreads);
+
+    // repeatedly construct and sell room within player territory and print uploaded bytes and ms per edit
+    // for both full terrain mesh rebuilds and partial tiles updates
+    // @param iterations: Number of construct/sell cycles, 0 means default
+    void RunTerrainEditsBenchmark(int iterations);
+
+    // measure raycast, lookup and batch terrain height queries and print ns/query stats
+    // @param queriesCount: Number of random queries, 0 means default
+    void RunHeightFieldBenchmark(int queriesCount);
+
+    // compare lookup and batch terrain height queries against raycast and print max error
+    // @param queriesCount: Number of random queries, 0 means default
+    void ValidateHeightField(int queriesCount);
+
     // tile mesh is invalidated and will be regenerated
     void InvalidateTileMesh(TerrainTile* terrainTile);
     void InvalidateTileNeighboursMesh(TerrainTile* terrainTile);
@@ -35,6 +52,14 @@ public:
     void HighhlightTile(TerrainTile* terrainTile, bool isHighlighted);
 
 private:
+    // construct tile meshes on worker threads and commit results on main thread
+    // @param terrainTiles: Tiles to rebuild
+    // @param threadsCount: Max number of threads, 0 means all available
+    void BuildTilesMesh(const TilesList& terrainTiles, int threadsCount);
+
+    // generate random coordinates within map bounds for height queries
+    void GenerateHeightFieldQueries(std::vector<glm::vec3>& coordinates, int queriesCount) const;
+
     void InitTerrainMeshList();
     void FreeTerrainMeshList();
     
@@ -64,6 +89,7 @@ private:
     RenderableProcMesh* mHeightFieldDebugMesh = nullptr;
 
     TilesList mMeshInvalidatedTiles;
+    std::vector<TileMeshStaging> mTilesMeshStaging;
     TilesList mHighlightTiles;
 
     Texture2D_Image mHighlightTilesImage;
@@ -9,53 +9,19 @@
 #include "GpuBuffer.h"
 #include "TerrainManager.h"
 #include "Texture2D.h"
+#include "Texture2D_Image.h"
+#include "GpuTextureArray2D.h"
+#include "EngineTexturesProvider.h"
 
 // limits
 const int MaxTerrainMeshBufferSize = 1024 * 1024 * 2;
 
-//////////////////////////////////////////////////////////////////////////
-
-struct PieceBucket
-{
-public:
-    std::deque<const TileMesh*> mTileMeshArray;
+const int TerrainTileReserveDivisor = 2; // tile slot reserves half of its size to grow in place
+const int TerrainTailReserveDivisor = 4; // buffers reserve quarter of size for relocated tiles
 
-    int mVertexCount = 0;
-    int mTriangleCount = 0;
-};
+const int MaxTerrainTextureLayers = 256;
 
-typedef std::map<MeshMaterial, PieceBucket> PieceBucketMap;
-struct PieceBucketContainer
-{
-public:
-    PieceBucketMap mPieceBucketMap;
-
-    int mVertexCount = 0;
-    int mTrianglesCount = 0;
-};
-
-// Process mesh
-template<typename TMeshPiecesContainer>
-inline void SplitMeshPieces(const TMeshPiecesContainer& meshPieces, PieceBucketContainer& bucketContainer)
-{
-    for (const TileMesh& currTileMesh: meshPieces)
-    {
-        const int TriangleCount = (int) currTileMesh.mTriangles.size();
-        const int VertexCount = (int) currTileMesh.mVertices.size();
-        debug_assert(currTileMesh.mMaterial.mDiffuseTexture);
-        if (!currTileMesh.mMaterial.mDiffuseTexture)
-        {
-            continue;
-        }
-        // allocate new bucket or request by material
-        PieceBucket& pieceBucket = bucketContainer.mPieceBucketMap[currTileMesh.mMaterial];
-        pieceBucket.mVertexCount += VertexCount;
-        pieceBucket.mTriangleCount += TriangleCount;
-        bucketContainer.mVertexCount += VertexCount;
-        bucketContainer.mTrianglesCount += TriangleCount;
-        pieceBucket.mTileMeshArray.emplace_back(&currTileMesh);
-    }
-}
+const float TerrainQuantizeMargin = TERRAIN_BLOCK_SIZE; // geometry might slightly exceed terrain area bounds
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -71,6 +37,96 @@ bool TerrainMeshRenderer::Initialize()
 void TerrainMeshRenderer::Deinit()
 {
     mTerrainRenderProgram.FreeProgram();
+
+    if (mTexturesArray)
+    {
+        gGraphicsDevice.DestroyTexture(mTexturesArray);
+        mTexturesArray = nullptr;
+    }
+    mTextureLayers.clear();
+    mTextureLayersCount = 0;
+}
+
+void TerrainMeshRenderer::RenderFrameBegin()
+{
+    mPrevFrameStats = mFrameStats;
+    mFrameStats = FrameStats();
+}
+
+void TerrainMeshRenderer::PrepareTexturesArray(const std::vector<Texture2D*>& terrainTextures)
+{
+    std::vector<Texture2D*> newTextures;
+    std::vector<std::string> newTexturesNames;
+    for (Texture2D* currTexture: terrainTextures)
+    {
+        if (mTextureLayers.find(currTexture) != mTextureLayers.end() || cxx::contains(newTextures, currTexture))
+            continue;
+
+        // animating textures are not supported
+        if (currTexture->HasProxyTexture() || !gEngineTexturesProvider.ContainsTexture(currTexture->mTextureName))
+        {
+            mTextureLayers[currTexture] = TerrainNoTextureLayer;
+            continue;
+        }
+        newTextures.push_back(currTexture);
+        newTexturesNames.push_back(currTexture->mTextureName);
+    }
+
+    if (newTextures.empty())
+        return;
+
+    std::vector<Texture2D_Image> texturesData;
+    gEngineTexturesProvider.ExtractTextures(newTexturesNames, texturesData);
+
+    // layers size is taken from first texture
+    if (mTexturesArray == nullptr)
+    {
+        for (const Texture2D_Image& currImage: texturesData)
+        {
+            if (currImage.IsNull() || currImage.mTextureDesc.mTextureFormat != eTextureFormat_RGBA8)
+                continue;
+
+            const int layersCount = std::min(MaxTerrainTextureLayers, gGraphicsDevice.mCaps.mMaxArrayTextureLayers);
+            mTexturesArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_RGBA8, currImage.mTextureDesc.mDimensions, layersCount, nullptr);
+            debug_assert(mTexturesArray);
+            break;
+        }
+
+        if (mTexturesArray == nullptr)
+        {
+            for (Texture2D* currTexture: newTextures)
+            {
+                mTextureLayers[currTexture] = TerrainNoTextureLayer;
+            }
+            return;
+        }
+    }
+
+    const Point& layerDimensions = mTexturesArray->mSize;
+    for (size_t itexture = 0; itexture < newTextures.size(); ++itexture)
+    {
+        const Texture2D_Image& currImage = texturesData[itexture];
+
+        unsigned short textureLayer = TerrainNoTextureLayer;
+        if (!currImage.IsNull() && currImage.mTextureDesc.mTextureFormat == eTextureFormat_RGBA8 && 
+            mTextureLayersCount < mTexturesArray->mLayersCount)
+        {
+            // larger textures might provide mipmap of matching size
+            for (int imipmap = 0; imipmap < currImage.mTextureDesc.mMipmapsCount + 1; ++imipmap)
+            {
+                const Point mipmapDimensions (currImage.mTextureDesc.mDimensions.x >> imipmap, currImage.mTextureDesc.mDimensions.y >> imipmap);
+                if (mipmapDimensions != layerDimensions)
+                    continue;
+
+                if (mTexturesArray->Upload(mTextureLayersCount, 1, currImage.GetImageDataBuffer(imipmap)))
+                {
+                    textureLayer = (unsigned short) mTextureLayersCount++;
+                }
+                break;
+            }
+        }
+        mTextureLayers[newTextures[itexture]] = textureLayer;
+    }
 }
 
 void TerrainMeshRenderer::Render(SceneRenderContext& renderContext, RenderableTerrainMesh* component)
@@ -79,14 +135,14 @@ void TerrainMeshRenderer::Render(SceneRenderContext& renderContext, RenderableTe
         return;
 
     debug_assert(component);
-    if (component->mDrawParts.empty())
+    if (component->mMaterialBatches.empty() && component->mTexturesArrayBatch.mIndicesCounts.empty())
     {
         debug_assert(false);
         return;
     }
 
     mTerrainRenderProgram.SetViewProjectionMatrix(gRenderScene.mCamera.mViewProjectionMatrix);
-    mTerrainRenderProgram.SetModelMatrix(SceneIdentyMatrix);
+    mTerrainRenderProgram.SetModelMatrix(component->mCompactVertices ? component->mDequantizeMatrix : SceneIdentyMatrix);
     mTerrainRenderProgram.ActivateProgram();
 
     // bind additional highlight tiles texture
@@ -97,16 +153,39 @@ void TerrainMeshRenderer::Render(SceneRenderContext& renderContext, RenderableTe
 
     // bind indices
     gGraphicsDevice.BindIndexBuffer(component->mIndexBuffer);
-    gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_Terrain_Format::Get());
+    if (component->mCompactVertices)
+    {
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_TerrainCompact_Format::Get());
+    }
+    else
+    {
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_Terrain_Format::Get());
+    }
+
+    ++mFrameStats.mMeshesDrawn;
 
-    for (RenderableTerrainMesh::DrawPart& currBatch: component->mDrawParts)
+    // textures array contains opaque textures only
+    const RenderableTerrainMesh::MaterialBatch& arrayBatch = component->mTexturesArrayBatch;
+    if (renderContext.mCurrentPass == eRenderPass_Opaque && !arrayBatch.mIndicesCounts.empty())
     {
-        if (currBatch.mVertexCount == 0)
-        {
-            debug_assert(false);
+        mTexturesArrayMaterial.ActivateMaterial();
+        gGraphicsDevice.BindTexture(eTextureUnit_2, mTexturesArray);
+        gGraphicsDevice.RenderIndexedPrimitivesMulti(ePrimitiveType_Triangles, component->mIndicesType,
+            arrayBatch.mIndexDataOffsets.data(), 
+            arrayBatch.mIndicesCounts.data(), 
+            arrayBatch.mBaseVertices.data(), (int) arrayBatch.mIndicesCounts.size());
+        ++mFrameStats.mMaterialSwitches;
+        ++mFrameStats.mDrawCalls;
+    }
+
+    const int NumBatches = (int) component->mMaterialBatches.size();
+    for (int imaterial = 0; imaterial < NumBatches; ++imaterial)
+    {
+        const RenderableTerrainMesh::MaterialBatch& currBatch = component->mMaterialBatches[imaterial];
+        if (currBatch.mIndicesCounts.empty())
             continue;
-        }
-        MeshMaterial* currMaterial = component->GetMeshMaterial(currBatch.mMaterialIndex);
+
+        MeshMaterial* currMaterial = component->GetMeshMaterial(imaterial);
         if (currMaterial == nullptr)
         {
             debug_assert(false);
@@ -120,9 +199,13 @@ void TerrainMeshRenderer::Render(SceneRenderContext& renderContext, RenderableTe
             continue;
 
         currMaterial->ActivateMaterial();
-        gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32,
-            currBatch.mIndexDataOffset, 
-            currBatch.mTriangleCount * 3);
+        // all tiles sharing material are drawn at once
+        gGraphicsDevice.RenderIndexedPrimitivesMulti(ePrimitiveType_Triangles, component->mIndicesType,
+            currBatch.mIndexDataOffsets.data(), 
+            currBatch.mIndicesCounts.data(), 
+            currBatch.mBaseVertices.data(), (int) currBatch.mIndicesCounts.size());
+        ++mFrameStats.mMaterialSwitches;
+        ++mFrameStats.mDrawCalls;
     }
 }
 
@@ -132,15 +215,25 @@ void TerrainMeshRenderer::ReleaseRenderdata(RenderableTerrainMesh* component)
     component->mRenderProgram = nullptr;
     if (component->mVertexBuffer)
     {
+        mGeometryStats.mVertexBytes -= component->mVertexBuffer->mBufferCapacity;
+        --mGeometryStats.mMeshesCount;
         gGraphicsDevice.DestroyBuffer(component->mVertexBuffer);
         component->mVertexBuffer = nullptr;
     }
 
     if (component->mIndexBuffer)
     {
+        mGeometryStats.mIndexBytes -= component->mIndexBuffer->mBufferCapacity;
         gGraphicsDevice.DestroyBuffer(component->mIndexBuffer);
         component->mIndexBuffer = nullptr;
     }
+    component->mTileSlots.clear();
+    component->mMaterialBatches.clear();
+    component->mTexturesArrayBatch = RenderableTerrainMesh::MaterialBatch();
+    component->mVertexTail = 0;
+    component->mTriangleTail = 0;
+    component->mFreeVertexRanges.clear();
+    component->mFreeTriangleRanges.clear();
     component->InvalidateMesh();
     component->ClearMeshMaterials();
 }
@@ -148,6 +241,18 @@ void TerrainMeshRenderer::ReleaseRenderdata(RenderableTerrainMesh* component)
 void TerrainMeshRenderer::PrepareRenderdata(RenderableTerrainMesh* component)
 {
     debug_assert(component);
+
+    // try to reupload changed tiles only
+    if (gCvarRender_TerrainPartialUpdates.mValue && !component->mInvalidatedTiles.empty() && 
+        component->mCompactVertices == gCvarRender_CompactVertices.mValue)
+    {
+        if (UpdateTilesRenderdata(component))
+        {
+            component->mInvalidatedTiles.clear();
+            return;
+        }
+    }
+    component->mInvalidatedTiles.clear();
 
     const Rectangle& rcMapTerrain = component->mMapTerrainRect;
     if (rcMapTerrain.w < 1 || rcMapTerrain.h < 1)
@@ -158,47 +263,97 @@ void TerrainMeshRenderer::PrepareRenderdata(RenderableTerrainMesh* component)
 
     component->ClearMeshMaterials();
     component->ClearDrawParts();
+    component->mMaterialBatches.clear();
+    component->mTileSlots.clear();
+    component->mTileSlots.resize(rcMapTerrain.w * rcMapTerrain.h);
 
     GameMap& gamemap = gGameWorld.mMapData;
-    
-    // prepare data for batching
-    PieceBucketContainer pieceBucketContainer;
 
-    for (int tiley = rcMapTerrain.y; tiley < (rcMapTerrain.y + rcMapTerrain.h); ++tiley)
-    for (int tilex = rcMapTerrain.x; tilex < (rcMapTerrain.x + rcMapTerrain.w); ++tilex)
+    // compute geometry size for each tile
+    int totalVertices = 0;
+    int totalTriangles = 0;
+    int maxTileVertices = 0;
+    for (int tiley = 0; tiley < rcMapTerrain.h; ++tiley)
+    for (int tilex = 0; tilex < rcMapTerrain.w; ++tilex)
     {
-        const Point tileLocation (tilex, tiley);
+        const Point tileLocation (rcMapTerrain.x + tilex, rcMapTerrain.y + tiley);
         const TerrainTile* currTile = gamemap.GetMapTile(tileLocation);
-
         if (currTile == nullptr)
         {
             debug_assert(false);
             continue;
         }
 
-        for (const TileFaceData& tileFace: currTile->mFaces)
+        RenderableTerrainMesh::TileSlot& tileSlot = component->mTileSlots[tiley * rcMapTerrain.w + tilex];
+        CollectTileMeshes(component, currTile, tileSlot.mVertexCapacity, tileSlot.mTriangleCapacity);
+        totalVertices += tileSlot.mVertexCapacity;
+        totalTriangles += tileSlot.mTriangleCapacity;
+        maxTileVertices = std::max(maxTileVertices, tileSlot.mVertexCapacity);
+    }
+
+    // choose vertex format, positions are quantized within mesh bounds extended with margin
+    component->mCompactVertices = gCvarRender_CompactVertices.mValue;
+    component->mIndicesType = eIndicesType_i32;
+    if (component->mCompactVertices)
+    {
+        const glm::vec3 margin (TerrainQuantizeMargin);
+        component->mQuantizeBounds = cxx::aabbox(component->mBounds.mMin - margin, component->mBounds.mMax + margin);
+        component->mDequantizeMatrix = GetDequantizeMatrix(component->mQuantizeBounds);
+
+        // indices are relative to tile slot start
+        const int MaxTileVertices = 0xFFFF;
+        if (maxTileVertices + maxTileVertices / TerrainTileReserveDivisor <= MaxTileVertices)
         {
-            SplitMeshPieces(tileFace.mMeshArray, pieceBucketContainer);
+            component->mIndicesType = eIndicesType_i16;
         }
     }
 
     // allocate buffers
 
-    int actualVBufferLength = pieceBucketContainer.mVertexCount * Sizeof_Vertex3D_Terrain;
-    int actualIBufferLength = pieceBucketContainer.mTrianglesCount * sizeof(glm::ivec3);
+    const int vertexSize = GetVertexSize(component);
+    const int triangleSize = GetTriangleSize(component);
+    const int MaxVertices = MaxTerrainMeshBufferSize / vertexSize;
+    const int MaxTriangles = MaxTerrainMeshBufferSize / triangleSize;
 
-    if (actualVBufferLength == 0 || actualIBufferLength == 0)
+    if (totalVertices == 0 || totalTriangles == 0)
     {
         debug_assert(false);
         return;
     }
 
-    if (actualVBufferLength > MaxTerrainMeshBufferSize || actualIBufferLength > MaxTerrainMeshBufferSize)
+    if (totalVertices > MaxVertices || totalTriangles > MaxTriangles)
     {
         debug_assert(false);
         return;
     }
 
+    // reserve space within tile slots when it fits
+    const bool reserveTileSlots = 
+        (totalVertices + totalVertices / TerrainTileReserveDivisor) <= MaxVertices &&
+        (totalTriangles + totalTriangles / TerrainTileReserveDivisor) <= MaxTriangles;
+
+    int startVertex = 0;
+    int startTriangle = 0;
+    for (RenderableTerrainMesh::TileSlot& tileSlot: component->mTileSlots)
+    {
+        if (reserveTileSlots)
+        {
+            tileSlot.mVertexCapacity += tileSlot.mVertexCapacity / TerrainTileReserveDivisor;
+            tileSlot.mTriangleCapacity += tileSlot.mTriangleCapacity / TerrainTileReserveDivisor;
+        }
+        tileSlot.mVertexStart = startVertex;
+        tileSlot.mTriangleStart = startTriangle;
+        startVertex += tileSlot.mVertexCapacity;
+        startTriangle += tileSlot.mTriangleCapacity;
+    }
+    component->mVertexTail = startVertex;
+    component->mTriangleTail = startTriangle;
+    component->mFreeVertexRanges.clear();
+    component->mFreeTriangleRanges.clear();
+
+    const int vertexCapacity = std::min(startVertex + startVertex / TerrainTailReserveDivisor, MaxVertices);
+    const int triangleCapacity = std::min(startTriangle + startTriangle / TerrainTailReserveDivisor, MaxTriangles);
+
     // allocate vertex buffer object
     if (component->mVertexBuffer == nullptr)
     {
@@ -208,6 +363,7 @@ void TerrainMeshRenderer::PrepareRenderdata(RenderableTerrainMesh* component)
             debug_assert(false);
             return;
         }
+        ++mGeometryStats.mMeshesCount;
     }
 
     // allocate index buffer object
@@ -225,64 +381,60 @@ void TerrainMeshRenderer::PrepareRenderdata(RenderableTerrainMesh* component)
     GpuBuffer* indexBuffer = component->mIndexBuffer;
 
     // setup buffers
-    if (!vertexBuffer->Setup(eBufferUsage_Static, actualVBufferLength, nullptr) ||
-        !indexBuffer->Setup(eBufferUsage_Static, actualIBufferLength, nullptr))
+    mGeometryStats.mVertexBytes -= vertexBuffer->mBufferCapacity;
+    mGeometryStats.mIndexBytes -= indexBuffer->mBufferCapacity;
+    if (!vertexBuffer->Setup(eBufferUsage_Dynamic, vertexCapacity * vertexSize, nullptr) ||
+        !indexBuffer->Setup(eBufferUsage_Dynamic, triangleCapacity * triangleSize, nullptr))
     {
         debug_assert(false);
+        component->mTileSlots.clear();
         return;
     }
-
-    int numPieces = (int) pieceBucketContainer.mPieceBucketMap.size();
-    debug_assert(numPieces > 0);
-    component->SetDrawPartsCount(numPieces);
-    component->SetMeshMaterialsCount(numPieces);
+    mGeometryStats.mVertexBytes += vertexBuffer->mBufferCapacity;
+    mGeometryStats.mIndexBytes += indexBuffer->mBufferCapacity;
 
     // compile geometries
-    Vertex3D_Terrain* vbufferPtr = vertexBuffer->LockData<Vertex3D_Terrain>(BufferAccess_UnsynchronizedWrite, 0, actualVBufferLength);
+    const unsigned int usedVBufferLength = startVertex * vertexSize;
+    const unsigned int usedIBufferLength = startTriangle * triangleSize;
+
+    unsigned char* vbufferPtr = vertexBuffer->LockData<unsigned char>(BufferAccess_UnsynchronizedWrite, 0, usedVBufferLength);
     debug_assert(vbufferPtr);
 
-    glm::ivec3* ibufferPtr = indexBuffer->LockData<glm::ivec3>(BufferAccess_UnsynchronizedWrite, 0, actualIBufferLength);
+    unsigned char* ibufferPtr = indexBuffer->LockData<unsigned char>(BufferAccess_UnsynchronizedWrite, 0, usedIBufferLength);
     debug_assert(ibufferPtr);
 
-    unsigned int imaterial = 0;
-    unsigned int startVertex = 0;
-    unsigned int startTriangle = 0;
-
-    for (const auto& ebucket : pieceBucketContainer.mPieceBucketMap)
+    if (vbufferPtr && ibufferPtr)
     {
-        component->SetMeshMaterial(imaterial, ebucket.first);
+        for (int tiley = 0; tiley < rcMapTerrain.h; ++tiley)
+        for (int tilex = 0; tilex < rcMapTerrain.w; ++tilex)
+        {
+            const Point tileLocation (rcMapTerrain.x + tilex, rcMapTerrain.y + tiley);
+            const TerrainTile* currTile = gamemap.GetMapTile(tileLocation);
+            if (currTile == nullptr)
+                continue;
 
-        RenderableTerrainMesh::DrawPart& drawCall = component->mDrawParts[imaterial];
-        drawCall.mMaterialIndex = imaterial;
-        drawCall.mTriangleCount = ebucket.second.mTriangleCount;
-        drawCall.mVertexCount = ebucket.second.mVertexCount;
-        drawCall.mIndexDataOffset = startTriangle * sizeof(glm::ivec3);
-        drawCall.mVertexDataOffset = startVertex * Sizeof_Vertex3D_Terrain;
+            RenderableTerrainMesh::TileSlot& tileSlot = component->mTileSlots[tiley * rcMapTerrain.w + tilex];
 
-        // copy geometry data
-        unsigned int vertexoffset = 0;
-        for (const TileMesh* currTileMesh: ebucket.second.mTileMeshArray)
-        {
-            // copy vertices
-            const unsigned int groupNumVertices = currTileMesh->mVertices.size();
-            ::memcpy(vbufferPtr, currTileMesh->mVertices.data(), groupNumVertices * Sizeof_Vertex3D_Terrain);
-            // copy triangles
-            const unsigned int groupNumTriangles = currTileMesh->mTriangles.size();
-            for (unsigned int itriangle = 0; itriangle < groupNumTriangles; ++itriangle)
+            int tileVertices = 0;
+            int tileTriangles = 0;
+            CollectTileMeshes(component, currTile, tileVertices, tileTriangles);
+
+            unsigned char* tileVertexData = vbufferPtr + tileSlot.mVertexStart * vertexSize;
+            unsigned char* tileTriangleData = ibufferPtr + tileSlot.mTriangleStart * triangleSize;
+            if (component->mCompactVertices)
             {
-                const glm::ivec3& srcTriangle = currTileMesh->mTriangles[itriangle];               
-                ibufferPtr[itriangle].x = srcTriangle.x + vertexoffset + startVertex;
-                ibufferPtr[itriangle].y = srcTriangle.y + vertexoffset + startVertex;
-                ibufferPtr[itriangle].z = srcTriangle.z + vertexoffset + startVertex;
+                mVerticesStaging.resize(tileVertices);
+                mTrianglesStaging.resize(tileTriangles);
+                WriteTileGeometry(tileSlot, mVerticesStaging.data(), mTrianglesStaging.data());
+                EncodeTileGeometry(component, tileVertices, tileTriangles, tileVertexData, tileTriangleData);
+            }
+            else
+            {
+                WriteTileGeometry(tileSlot, 
+                    reinterpret_cast<Vertex3D_Terrain*>(tileVertexData), 
+                    reinterpret_cast<glm::ivec3*>(tileTriangleData));
             }
-            vertexoffset += groupNumVertices;
-            ibufferPtr += groupNumTriangles;
-            vbufferPtr += groupNumVertices;
         }
-
-        startTriangle += drawCall.mTriangleCount;
-        startVertex += drawCall.mVertexCount;
-        ++imaterial;
     }
 
     if (!indexBuffer->Unlock())
@@ -295,5 +447,367 @@ void TerrainMeshRenderer::PrepareRenderdata(RenderableTerrainMesh* component)
         debug_assert(false);
     }
 
+    UpdateMaterialBatches(component);
+
+    mUploadStats.mUploadedBytes += usedVBufferLength + usedIBufferLength;
+    ++mUploadStats.mMeshesRebuilt;
+    mGeometryStats.mUploadedBytes += usedVBufferLength + usedIBufferLength;
+
     component->mRenderProgram = &mTerrainRenderProgram;
+}
+
+bool TerrainMeshRenderer::UpdateTilesRenderdata(RenderableTerrainMesh* component)
+{
+    GpuBuffer* vertexBuffer = component->mVertexBuffer;
+    GpuBuffer* indexBuffer = component->mIndexBuffer;
+    if (component->mTileSlots.empty() || vertexBuffer == nullptr || indexBuffer == nullptr)
+        return false;
+
+    const Rectangle& rcMapTerrain = component->mMapTerrainRect;
+
+    const int vertexSize = GetVertexSize(component);
+    const int triangleSize = GetTriangleSize(component);
+    const int MaxVertices = vertexBuffer->mBufferCapacity / vertexSize;
+    const int MaxTriangles = indexBuffer->mBufferCapacity / triangleSize;
+
+    for (const TerrainTile* currTile: component->mInvalidatedTiles)
+    {
+        if (!rcMapTerrain.PointWithin(currTile->mTileLocation))
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        const int tileIndex = (currTile->mTileLocation.y - rcMapTerrain.y) * rcMapTerrain.w + 
+            (currTile->mTileLocation.x - rcMapTerrain.x);
+        RenderableTerrainMesh::TileSlot& tileSlot = component->mTileSlots[tileIndex];
+
+        int tileVertices = 0;
+        int tileTriangles = 0;
+        CollectTileMeshes(component, currTile, tileVertices, tileTriangles);
+
+        // 16 bit indices are relative to tile slot start
+        if (component->mIndicesType == eIndicesType_i16 && tileVertices > 0xFFFF)
+            return false;
+
+        // move tile to free space if it doesn't fit its slot anymore, old slot space is released for other tiles,
+        // whole mesh is rebuilt if there is no space left
+        if (tileVertices > tileSlot.mVertexCapacity)
+        {
+            ReleaseBufferRange(component->mFreeVertexRanges, component->mVertexTail, tileSlot.mVertexStart, tileSlot.mVertexCapacity);
+
+            int vertexCapacity = tileVertices + tileVertices / TerrainTileReserveDivisor;
+            if (!AllocateBufferRange(component->mFreeVertexRanges, component->mVertexTail, MaxVertices, vertexCapacity, tileSlot.mVertexStart))
+            {
+                vertexCapacity = tileVertices;
+                if (!AllocateBufferRange(component->mFreeVertexRanges, component->mVertexTail, MaxVertices, vertexCapacity, tileSlot.mVertexStart))
+                    return false;
+            }
+            tileSlot.mVertexCapacity = vertexCapacity;
+        }
+
+        if (tileTriangles > tileSlot.mTriangleCapacity)
+        {
+            ReleaseBufferRange(component->mFreeTriangleRanges, component->mTriangleTail, tileSlot.mTriangleStart, tileSlot.mTriangleCapacity);
+
+            int triangleCapacity = tileTriangles + tileTriangles / TerrainTileReserveDivisor;
+            if (!AllocateBufferRange(component->mFreeTriangleRanges, component->mTriangleTail, MaxTriangles, triangleCapacity, tileSlot.mTriangleStart))
+            {
+                triangleCapacity = tileTriangles;
+                if (!AllocateBufferRange(component->mFreeTriangleRanges, component->mTriangleTail, MaxTriangles, triangleCapacity, tileSlot.mTriangleStart))
+                    return false;
+            }
+            tileSlot.mTriangleCapacity = triangleCapacity;
+        }
+
+        mVerticesStaging.resize(tileVertices);
+        mTrianglesStaging.resize(tileTriangles);
+        WriteTileGeometry(tileSlot, mVerticesStaging.data(), mTrianglesStaging.data());
+
+        const unsigned int verticesLength = tileVertices * vertexSize;
+        const unsigned int trianglesLength = tileTriangles * triangleSize;
+
+        const void* verticesData = mVerticesStaging.data();
+        const void* trianglesData = mTrianglesStaging.data();
+        if (component->mCompactVertices)
+        {
+            mEncodedVerticesStaging.resize(verticesLength);
+            mEncodedTrianglesStaging.resize(trianglesLength);
+            EncodeTileGeometry(component, tileVertices, tileTriangles, mEncodedVerticesStaging.data(), mEncodedTrianglesStaging.data());
+            verticesData = mEncodedVerticesStaging.data();
+            trianglesData = mEncodedTrianglesStaging.data();
+        }
+
+        if (verticesLength > 0 && 
+            !vertexBuffer->SubData(tileSlot.mVertexStart * vertexSize, verticesLength, verticesData))
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        if (trianglesLength > 0 && 
+            !indexBuffer->SubData(tileSlot.mTriangleStart * triangleSize, trianglesLength, trianglesData))
+        {
+            debug_assert(false);
+            return false;
+        }
+
+        mUploadStats.mUploadedBytes += verticesLength + trianglesLength;
+        ++mUploadStats.mTilesUpdated;
+        mGeometryStats.mUploadedBytes += verticesLength + trianglesLength;
+    }
+
+    UpdateMaterialBatches(component);
+    return true;
+}
+
+bool TerrainMeshRenderer::AllocateBufferRange(std::vector<RenderableTerrainMesh::FreeRange>& freeRanges, int& tail, int maxCount, int count, int& start) const
+{
+    // first fit
+    for (auto range_iterator = freeRanges.begin(); range_iterator != freeRanges.end(); ++range_iterator)
+    {
+        if (range_iterator->mCount < count)
+            continue;
+
+        start = range_iterator->mStart;
+        range_iterator->mStart += count;
+        range_iterator->mCount -= count;
+        if (range_iterator->mCount == 0)
+        {
+            freeRanges.erase(range_iterator);
+        }
+        return true;
+    }
+
+    if (tail + count > maxCount)
+        return false;
+
+    start = tail;
+    tail += count;
+    return true;
+}
+
+void TerrainMeshRenderer::ReleaseBufferRange(std::vector<RenderableTerrainMesh::FreeRange>& freeRanges, int& tail, int start, int count) const
+{
+    if (count == 0)
+        return;
+
+    auto range_iterator = std::lower_bound(freeRanges.begin(), freeRanges.end(), start, 
+        [](const RenderableTerrainMesh::FreeRange& lhs, int rhs)
+        {
+            return lhs.mStart < rhs;
+        });
+
+    RenderableTerrainMesh::FreeRange releasedRange;
+    releasedRange.mStart = start;
+    releasedRange.mCount = count;
+    range_iterator = freeRanges.insert(range_iterator, releasedRange);
+
+    // merge with next and previous ranges
+    auto next_iterator = range_iterator + 1;
+    if (next_iterator != freeRanges.end() && range_iterator->mStart + range_iterator->mCount == next_iterator->mStart)
+    {
+        range_iterator->mCount += next_iterator->mCount;
+        freeRanges.erase(next_iterator);
+    }
+    if (range_iterator != freeRanges.begin())
+    {
+        auto prev_iterator = range_iterator - 1;
+        if (prev_iterator->mStart + prev_iterator->mCount == range_iterator->mStart)
+        {
+            prev_iterator->mCount += range_iterator->mCount;
+            freeRanges.erase(range_iterator);
+        }
+    }
+
+    // last range adjoining unused space returns to tail
+    if (freeRanges.back().mStart + freeRanges.back().mCount == tail)
+    {
+        tail = freeRanges.back().mStart;
+        freeRanges.pop_back();
+    }
+}
+
+void TerrainMeshRenderer::CollectTileMeshes(RenderableTerrainMesh* component, const TerrainTile* terrainTile, int& vertexCount, int& triangleCount)
+{
+    mTileMeshes.clear();
+    vertexCount = 0;
+    triangleCount = 0;
+
+    for (const TileFaceData& tileFace: terrainTile->mFaces)
+    {
+        for (const TileMesh& currTileMesh: tileFace.mMeshArray)
+        {
+            debug_assert(currTileMesh.mMaterial.mDiffuseTexture);
+            if (!currTileMesh.mMaterial.mDiffuseTexture)
+            {
+                continue;
+            }
+            TileMeshEntry tileMeshEntry;
+            tileMeshEntry.mTextureLayer = GetTextureLayer(currTileMesh.mMaterial);
+            tileMeshEntry.mMaterialIndex = (tileMeshEntry.mTextureLayer == TerrainNoTextureLayer) ? 
+                GetMaterialIndex(component, currTileMesh.mMaterial) : -1;
+            tileMeshEntry.mTileMesh = &currTileMesh;
+            mTileMeshes.push_back(tileMeshEntry);
+
+            vertexCount += (int) currTileMesh.mVertices.size();
+            triangleCount += (int) currTileMesh.mTriangles.size();
+        }
+    }
+
+    std::stable_sort(mTileMeshes.begin(), mTileMeshes.end(), [](const TileMeshEntry& lhs, const TileMeshEntry& rhs)
+        {
+            return lhs.mMaterialIndex < rhs.mMaterialIndex;
+        });
+}
+
+void TerrainMeshRenderer::WriteTileGeometry(RenderableTerrainMesh::TileSlot& tileSlot, Vertex3D_Terrain* vertices, glm::ivec3* triangles) const
+{
+    tileSlot.mParts.clear();
+
+    int vertexOffset = 0;
+    int triangleOffset = 0;
+    for (const TileMeshEntry& currEntry: mTileMeshes)
+    {
+        const TileMesh* currTileMesh = currEntry.mTileMesh;
+        // start new part on material change
+        if (tileSlot.mParts.empty() || tileSlot.mParts.back().mMaterialIndex != currEntry.mMaterialIndex)
+        {
+            RenderableTerrainMesh::TilePart& tilePart = tileSlot.mParts.emplace_back();
+            tilePart.mMaterialIndex = currEntry.mMaterialIndex;
+            tilePart.mTriangleStart = tileSlot.mTriangleStart + triangleOffset;
+        }
+
+        // copy vertices
+        const int groupNumVertices = (int) currTileMesh->mVertices.size();
+        ::memcpy(vertices + vertexOffset, currTileMesh->mVertices.data(), groupNumVertices * Sizeof_Vertex3D_Terrain);
+        for (int ivertex = 0; ivertex < groupNumVertices; ++ivertex)
+        {
+            vertices[vertexOffset + ivertex].mTextureLayer = currEntry.mTextureLayer;
+        }
+        // copy triangles, indices are relative to slot start
+        const int groupNumTriangles = (int) currTileMesh->mTriangles.size();
+        for (int itriangle = 0; itriangle < groupNumTriangles; ++itriangle)
+        {
+            triangles[triangleOffset + itriangle] = currTileMesh->mTriangles[itriangle] + vertexOffset;
+        }
+        tileSlot.mParts.back().mTriangleCount += groupNumTriangles;
+        vertexOffset += groupNumVertices;
+        triangleOffset += groupNumTriangles;
+    }
+}
+
+void TerrainMeshRenderer::EncodeTileGeometry(const RenderableTerrainMesh* component, int vertexCount, int triangleCount, 
+    unsigned char* vertices, unsigned char* triangles) const
+{
+    debug_assert(component->mCompactVertices);
+    debug_assert(vertexCount <= (int) mVerticesStaging.size() && triangleCount <= (int) mTrianglesStaging.size());
+
+    Vertex3D_TerrainCompact* compactVertices = reinterpret_cast<Vertex3D_TerrainCompact*>(vertices);
+    for (int ivertex = 0; ivertex < vertexCount; ++ivertex)
+    {
+        const Vertex3D_Terrain& sourceVertex = mVerticesStaging[ivertex];
+        Vertex3D_TerrainCompact& compactVertex = compactVertices[ivertex];
+        PackPositionSnorm16(sourceVertex.mPosition, component->mQuantizeBounds, compactVertex.mPosition);
+        compactVertex.mPosition[3] = PackSnorm16(1.0f);
+        compactVertex.mTexcoord[0] = PackHalfFloat(sourceVertex.mTexcoord.x);
+        compactVertex.mTexcoord[1] = PackHalfFloat(sourceVertex.mTexcoord.y);
+        compactVertex.mTileCoord[0] = sourceVertex.mTileCoord[0];
+        compactVertex.mTileCoord[1] = sourceVertex.mTileCoord[1];
+        compactVertex.mTextureLayer = sourceVertex.mTextureLayer;
+        compactVertex.mPadding = 0;
+    }
+
+    if (component->mIndicesType == eIndicesType_i32)
+    {
+        ::memcpy(triangles, mTrianglesStaging.data(), triangleCount * sizeof(glm::ivec3));
+        return;
+    }
+
+    unsigned short* indices = reinterpret_cast<unsigned short*>(triangles);
+    for (int itriangle = 0; itriangle < triangleCount; ++itriangle)
+    {
+        const glm::ivec3& sourceTriangle = mTrianglesStaging[itriangle];
+        indices[itriangle * 3 + 0] = (unsigned short) sourceTriangle.x;
+        indices[itriangle * 3 + 1] = (unsigned short) sourceTriangle.y;
+        indices[itriangle * 3 + 2] = (unsigned short) sourceTriangle.z;
+    }
+}
+
+int TerrainMeshRenderer::GetVertexSize(const RenderableTerrainMesh* component) const
+{
+    return component->mCompactVertices ? Sizeof_Vertex3D_TerrainCompact : Sizeof_Vertex3D_Terrain;
+}
+
+int TerrainMeshRenderer::GetTriangleSize(const RenderableTerrainMesh* component) const
+{
+    return GetIndexSizeBytes(component->mIndicesType) * 3;
+}
+
+int TerrainMeshRenderer::GetMaterialIndex(RenderableTerrainMesh* component, const MeshMaterial& meshMaterial) const
+{
+    const int NumMaterials = component->GetMaterialsCount();
+    for (int imaterial = 0; imaterial < NumMaterials; ++imaterial)
+    {
+        if (*component->GetMeshMaterial(imaterial) == meshMaterial)
+            return imaterial;
+    }
+    component->SetMeshMaterialsCount(NumMaterials + 1);
+    component->SetMeshMaterial(NumMaterials, meshMaterial);
+    return NumMaterials;
+}
+
+unsigned short TerrainMeshRenderer::GetTextureLayer(const MeshMaterial& meshMaterial)
+{
+    if (!gCvarRender_TerrainTexturesArray.mValue || meshMaterial.IsTransparent())
+        return TerrainNoTextureLayer;
+
+    // only diffuse texture is used by terrain program
+    if (meshMaterial.mRenderStates != mTexturesArrayMaterial.mRenderStates || 
+        meshMaterial.mMaterialColor != mTexturesArrayMaterial.mMaterialColor)
+    {
+        return TerrainNoTextureLayer;
+    }
+
+    auto layer_iterator = mTextureLayers.find(meshMaterial.mDiffuseTexture);
+    if (layer_iterator == mTextureLayers.end())
+    {
+        // texture appeared after map load
+        PrepareTexturesArray({meshMaterial.mDiffuseTexture});
+        layer_iterator = mTextureLayers.find(meshMaterial.mDiffuseTexture);
+        if (layer_iterator == mTextureLayers.end())
+            return TerrainNoTextureLayer;
+    }
+    return layer_iterator->second;
+}
+
+void TerrainMeshRenderer::UpdateMaterialBatches(RenderableTerrainMesh* component) const
+{
+    const int triangleSize = GetTriangleSize(component);
+
+    component->mMaterialBatches.resize(component->GetMaterialsCount());
+    for (RenderableTerrainMesh::MaterialBatch& currBatch: component->mMaterialBatches)
+    {
+        currBatch.mIndexDataOffsets.clear();
+        currBatch.mIndicesCounts.clear();
+        currBatch.mBaseVertices.clear();
+    }
+    component->mTexturesArrayBatch.mIndexDataOffsets.clear();
+    component->mTexturesArrayBatch.mIndicesCounts.clear();
+    component->mTexturesArrayBatch.mBaseVertices.clear();
+
+    for (const RenderableTerrainMesh::TileSlot& currTileSlot: component->mTileSlots)
+    {
+        for (const RenderableTerrainMesh::TilePart& currPart: currTileSlot.mParts)
+        {
+            if (currPart.mTriangleCount == 0)
+                continue;
+
+            RenderableTerrainMesh::MaterialBatch& currBatch = (currPart.mMaterialIndex < 0) ? 
+                component->mTexturesArrayBatch : component->mMaterialBatches[currPart.mMaterialIndex];
+            currBatch.mIndexDataOffsets.push_back(currPart.mTriangleStart * triangleSize);
+            currBatch.mIndicesCounts.push_back(currPart.mTriangleCount * 3);
+            currBatch.mBaseVertices.push_back(currTileSlot.mVertexStart);
+        }
+    }
 }
\ No newline at end of file
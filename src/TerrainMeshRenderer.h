@@ -1,12 +1,37 @@
 #pragma once
 
 #include "Shaders.h"
+#include "RenderableTerrainMesh.h"
 
 // terrain visualization manager
 class TerrainMeshRenderer: public cxx::noncopyable
 {
     friend class RenderableTerrainMesh;
 
+public:
+    // geometry uploads statistics, accumulated since startup
+    struct UploadStats
+    {
+    public:
+        long long mUploadedBytes = 0;
+        int mTilesUpdated = 0; // tiles reuploaded in place
+        int mMeshesRebuilt = 0; // terrain meshes rebuilt entirely
+    };
+
+    // per frame rendering statistics
+    struct FrameStats
+    {
+    public:
+        int mMeshesDrawn = 0;
+        int mDrawCalls = 0;
+        int mMaterialSwitches = 0;
+    };
+
+    // readonly
+    UploadStats mUploadStats;
+    FrameStats mPrevFrameStats;
+    RenderGeometryStats mGeometryStats;
+
 public:
 
     // setup renderer internal resources
@@ -18,11 +43,75 @@ public:
     // @param component: Renderable component
     void Render(SceneRenderContext& renderContext, RenderableTerrainMesh* component);
 
+    // reset frame statistics
+    void RenderFrameBegin();
+
+    // decode terrain textures and pack them into layers of textures array,
+    // textures that were not packed will be drawn with separate materials
+    // @param terrainTextures: Diffuse textures used by terrain tiles
+    void PrepareTexturesArray(const std::vector<Texture2D*>& terrainTextures);
+
 private:
     // setup renderable component mesh renderdata
     void PrepareRenderdata(RenderableTerrainMesh* component);
     void ReleaseRenderdata(RenderableTerrainMesh* component);
 
+    // reupload invalidated tiles geometry only
+    // @returns false if whole mesh must be rebuilt
+    bool UpdateTilesRenderdata(RenderableTerrainMesh* component);
+
+    // collect tile meshes grouped by material into staging list
+    void CollectTileMeshes(RenderableTerrainMesh* component, const TerrainTile* terrainTile, int& vertexCount, int& triangleCount);
+    void WriteTileGeometry(RenderableTerrainMesh::TileSlot& tileSlot, Vertex3D_Terrain* vertices, glm::ivec3* triangles) const;
+
+    // convert staging tile geometry to compact vertices and 16 bit indices if enabled for component
+    void EncodeTileGeometry(const RenderableTerrainMesh* component, int vertexCount, int triangleCount, 
+        unsigned char* vertices, unsigned char* triangles) const;
+
+    // get size of vertex and triangle within component buffers, in bytes
+    int GetVertexSize(const RenderableTerrainMesh* component) const;
+    int GetTriangleSize(const RenderableTerrainMesh* component) const;
+
+    // get index of mesh material or add new one
+    int GetMaterialIndex(RenderableTerrainMesh* component, const MeshMaterial& meshMaterial) const;
+
+    // get layer of diffuse texture within textures array
+    // @returns TerrainNoTextureLayer if material cannot be drawn with textures array
+    unsigned short GetTextureLayer(const MeshMaterial& meshMaterial);
+
+    void UpdateMaterialBatches(RenderableTerrainMesh* component) const;
+
+    // reserve range of buffer elements for relocated tile, released ranges are reused before tail space
+    // @param freeRanges: Released ranges
+    // @param tail: Start of unused space at the end of buffer
+    // @param maxCount: Buffer capacity in elements
+    // @param count: Number of elements to reserve
+    // @param start: Output range start
+    bool AllocateBufferRange(std::vector<RenderableTerrainMesh::FreeRange>& freeRanges, int& tail, int maxCount, int count, int& start) const;
+    void ReleaseBufferRange(std::vector<RenderableTerrainMesh::FreeRange>& freeRanges, int& tail, int start, int count) const;
+
 private:
+    struct TileMeshEntry
+    {
+    public:
+        int mMaterialIndex = 0; // negative for textures array
+        unsigned short mTextureLayer = TerrainNoTextureLayer;
+        const TileMesh* mTileMesh = nullptr;
+    };
+
     TerrainRenderProgram mTerrainRenderProgram;
+    FrameStats mFrameStats;
+
+    // terrain textures packed into single array, layer per texture
+    GpuTextureArray2D* mTexturesArray = nullptr;
+    MeshMaterial mTexturesArrayMaterial;
+    std::map<Texture2D*, unsigned short> mTextureLayers; // including textures that cannot be packed
+    int mTextureLayersCount = 0;
+
+    // staging data
+    std::vector<TileMeshEntry> mTileMeshes;
+    std::vector<Vertex3D_Terrain> mVerticesStaging;
+    std::vector<glm::ivec3> mTrianglesStaging;
+    std::vector<unsigned char> mEncodedVerticesStaging;
+    std::vector<unsigned char> mEncodedTrianglesStaging;
 };
\ No newline at end of file
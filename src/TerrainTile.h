@@ -25,6 +25,21 @@ public:
     std::vector<Vertex3D_Terrain> mVertices;
 };
 
+// tile faces geometry constructed apart from tile, allows to build tile mesh on worker thread
+struct TileMeshStaging
+{
+public:
+    void Clear()
+    {
+        for (std::vector<TileMesh>& currFace: mFaces)
+        {
+            currFace.clear();
+        }
+    }
+public:
+    std::vector<TileMesh> mFaces[eTileFace_COUNT];
+};
+
 // tile face data
 struct TileFaceData 
 {
@@ -6,6 +6,7 @@
 #include "EngineTexturesProvider.h"
 #include "Console.h"
 #include "Texture2DAnimation.h"
+#include "TexturesManager.h"
 
 Texture2D::Texture2D(const std::string& textureName)
     : mTextureName(textureName)
@@ -33,6 +34,7 @@ void Texture2D::DestroyTextureObject()
     // clear loading flags
     mPersistent = false;
     mLoadedFromFile = false;
+    mDroppedMipmaps = 0;
 }
 
 void Texture2D::SetSamplerState(const TextureSamplerState& samplerState)
@@ -56,6 +58,20 @@ bool Texture2D::ActivateTexture(eTextureUnit textureUnit)
         return mProxyTexture->ActivateTexture(textureUnit);
     }
 
+    mLastUsedFrame = gTexturesManager.GetFrameIndex();
+
+    if (!IsTextureLoaded() && gTexturesManager.RequestTextureStreaming(this))
+    {
+        // bind placeholder until image data is decoded and uploaded
+        return gTexturesManager.mMissingTexture->ActivateTexture(textureUnit);
+    }
+
+    // texture is used again, restore full resolution once it is decoded
+    if (mDroppedMipmaps > 0)
+    {
+        gTexturesManager.RequestTextureRestore(this);
+    }
+
     if (!LoadTexture()) // try to load
     {
         debug_assert(false);
@@ -80,7 +96,7 @@ bool Texture2D::LoadTexture()
     Texture2D_Image imageData;
     if (gEngineTexturesProvider.ContainsTexture(mTextureName))
     {
-        if (!gEngineTexturesProvider.ExtractTexture(mTextureName, imageData))
+        if (!ReadTextureImage(imageData))
         {
             gConsole.LogMessage(eLogMessage_Debug, "Fail to load texture '%s'", mTextureName.c_str());
             debug_assert(false);
@@ -91,23 +107,48 @@ bool Texture2D::LoadTexture()
         // todo: load textures from wad
         debug_assert(false);
     }
-    
+    return LoadTexture(imageData);
+}
+
+bool Texture2D::ReadTextureImage(Texture2D_Image& imageData) const
+{
+    if (!gEngineTexturesProvider.ExtractTexture(mTextureName, imageData))
+        return false;
+
+    // force pot dims
+    if (!imageData.IsPowerOfTwo())
+    {
+        imageData.ResizeToPowerOfTwo();
+    }
+    return true;
+}
+
+bool Texture2D::LoadTexture(const Texture2D_Image& imageData)
+{
+    if (mProxyTexture)
+    {
+        debug_assert(false);
+        return false;
+    }
+
     if (imageData.IsNull()) // create dummy texture
     {
+        Texture2D_Image dummyImageData;
         Point dummyTextureDims { 64, 64 };
-        imageData.CreateImage(eTextureFormat_RGBA8, dummyTextureDims, 0, false);
-        imageData.FillWithCheckerBoard();
-        if (!CreateTexture(imageData))
+        dummyImageData.CreateImage(eTextureFormat_RGBA8, dummyTextureDims, 0, false);
+        dummyImageData.FillWithCheckerBoard();
+        if (!CreateTexture(dummyImageData))
         {
             debug_assert(false);
         }
         return false;
     }
 
-    // force pot dims
+    // npot textures must be converted to pot manually
     if (!imageData.IsPowerOfTwo())
     {
-        imageData.ResizeToPowerOfTwo();
+        debug_assert(false);
+        return false;
     }
 
     mLoadedFromFile = true;
@@ -118,6 +159,10 @@ bool Texture2D::LoadTexture()
         debug_assert(mGpuTextureObject);
     }
 
+    // previous content could be dummy or reduced image
+    mGpuTextureObject->FreeTextureObject();
+    mDroppedMipmaps = 0;
+
     if (!mGpuTextureObject->InitTextureObject(mTextureDesc, imageData.GetImageDataBuffer()))
     {
         debug_assert(false);
@@ -287,6 +332,56 @@ bool Texture2D::CreateTexture(const Texture2D_Desc& sourceDesc, const void* text
     return true;
 }
 
+bool Texture2D::DropMipmaps(const Texture2D_Image& imageData, int droppedMipmaps)
+{
+    if (mProxyTexture || !mLoadedFromFile || !IsTextureLoaded() || imageData.IsNull() || droppedMipmaps < 1)
+        return false;
+
+    const int firstMipmap = droppedMipmaps;
+    if (firstMipmap > imageData.mTextureDesc.mMipmapsCount)
+        return false;
+
+    // describe reduced image, uv range remains same
+    Texture2D_Desc textureDesc = imageData.mTextureDesc;
+    textureDesc.mDimensions.x = GetTextureMipmapDims(textureDesc.mDimensions.x, firstMipmap);
+    textureDesc.mDimensions.y = GetTextureMipmapDims(textureDesc.mDimensions.y, firstMipmap);
+    textureDesc.mImageDimensions.x = GetTextureMipmapDims(textureDesc.mImageDimensions.x, firstMipmap);
+    textureDesc.mImageDimensions.y = GetTextureMipmapDims(textureDesc.mImageDimensions.y, firstMipmap);
+    textureDesc.mMipmapsCount -= firstMipmap;
+
+    mGpuTextureObject->FreeTextureObject();
+    if (!mGpuTextureObject->InitTextureObject(textureDesc, imageData.GetImageDataBuffer(firstMipmap)))
+    {
+        debug_assert(false);
+    }
+
+    for (int imipmap = 1; imipmap < textureDesc.mMipmapsCount + 1; ++imipmap)
+    {
+        if (!mGpuTextureObject->TexSubImage(imipmap, imageData.GetImageDataBuffer(firstMipmap + imipmap)))
+        {
+            debug_assert(false);
+        }
+    }
+
+    mGpuTextureObject->SetSamplerState(mSamplerState);
+    mTextureDesc = textureDesc;
+    mDroppedMipmaps = firstMipmap;
+    return true;
+}
+
+unsigned int Texture2D::GetGpuMemorySize() const
+{
+    if (mProxyTexture || mGpuTextureObject == nullptr)
+        return 0;
+
+    unsigned int dataLength = 0;
+    for (int imipmap = 0; imipmap < mTextureDesc.mMipmapsCount + 1; ++imipmap)
+    {
+        dataLength += GetTextureDataSize(mTextureDesc.mTextureFormat, mTextureDesc.mDimensions, imipmap);
+    }
+    return dataLength;
+}
+
 void Texture2D::SetProxyTexture(Texture2D* texture)
 {
     DestroyTextureObject();
@@ -19,6 +19,16 @@ public:
     // load texture data from file mTextureName and upload it to gpu
     // @returns false on error
     bool LoadTexture();
+
+    // upload previously decoded image data to gpu, dummy texture will be created if image is null
+    // @param imageData: Image data decoded with ReadTextureImage
+    // @returns false on error
+    bool LoadTexture(const Texture2D_Image& imageData);
+
+    // decode texture data of file mTextureName without touching gpu, safe to call from worker thread
+    // @param imageData: Output image with pot dimensions
+    // @returns false on error
+    bool ReadTextureImage(Texture2D_Image& imageData) const;
     void FreeTexture();
 
     // create texture from source image and upload it to gpu
@@ -33,12 +43,18 @@ public:
 
     void SetProxyTexture(Texture2D* proxyTexture);
 
+    // recreate texture without largest mipmap levels to reduce gpu memory usage
+    // @param imageData: Full image data decoded with ReadTextureImage
+    // @param droppedMipmaps: Number of largest levels to skip
+    // @returns false if texture was not loaded from file or has not enough mipmaps
+    bool DropMipmaps(const Texture2D_Image& imageData, int droppedMipmaps);
+
     // set texture filtering and repeating modes
     // @param samplerState: Sampler state params
     void SetSamplerState(const TextureSamplerState& samplerState);
 
     // bind texture to specific texture unit
-    // will load texture if it not loaded yet
+    // will load texture if it not loaded yet or bind placeholder while it is streaming
     // @param textureUnit: Texture unit identifier
     // @returns false on error
     bool ActivateTexture(eTextureUnit textureUnit);
@@ -56,6 +72,15 @@ public:
 
     bool HasProxyTexture() const;
 
+    // get number of bytes occupied by texture data in gpu memory, proxy texture does not occupy memory
+    unsigned int GetGpuMemorySize() const;
+
+    // get frame index when texture was bound last time
+    inline unsigned int GetLastUsedFrame() const { return mLastUsedFrame; }
+
+    // get number of largest mipmap levels dropped to save memory
+    inline int GetDroppedMipmapsCount() const { return mDroppedMipmaps; }
+
 private:
     // internals
     void DestroyTextureObject();
@@ -63,6 +88,8 @@ private:
 private:
     bool mLoadedFromFile = false; // image was loaded from image file so it can be reloaded
     bool mPersistent = false; // once it was loaded keep alive forever
+    int mDroppedMipmaps = 0;
+    unsigned int mLastUsedFrame = 0;
 
     TextureSamplerState mSamplerState;
     GpuTexture2D* mGpuTextureObject = nullptr;
@@ -4,6 +4,17 @@
 #include "Texture2D_Image.h"
 #include "Texture2DAnimation.h"
 #include "TimeManager.h"
+#include "TasksManager.h"
+#include "EngineTexturesProvider.h"
+#include "ConsoleVariable.h"
+#include "Console.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// cvars
+CvarBoolean gCvarRender_TexturesStreaming ("r_texturesStreaming", true, "Decode textures on worker threads and draw placeholder until they are uploaded", ConsoleVar_Renderer);
+CvarInteger gCvarRender_TexturesMemoryBudget ("r_texturesMemoryBudget", 512, "Max megabytes of gpu memory occupied by textures before least recently used ones are reduced or unloaded, 0 means unlimited", ConsoleVar_Renderer);
+CvarInteger gCvarRender_TexturesUploadBudget ("r_texturesUploadBudget", 4096, "Max kilobytes of streamed textures data uploaded to gpu per frame, at least one texture is uploaded", ConsoleVar_Renderer);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -13,12 +24,29 @@ static const int WaterAnimationFramesCount = 32;
 static const float LavaAnimationSpeed = 1.0f;
 static const int LavaAnimationFramesCount = 1;
 
+// leave workers free for per-frame parallel jobs
+static const int MaxDecodeTasksInProgress = 2;
+
+// textures used within this number of frames are never evicted
+static const unsigned int EvictionMinUnusedFrames = 300;
+// mipmaps dropping decodes image again on worker thread, limit work per frame
+static const int MaxMipmapsDropsPerFrame = 4;
+static const int MinDroppedMipmapDims = 32;
+
 //////////////////////////////////////////////////////////////////////////
 
 TexturesManager gTexturesManager;
 
 bool TexturesManager::Initialize()
 {
+    gConsole.RegisterVariable(&gCvarRender_TexturesStreaming);
+    gConsole.RegisterVariable(&gCvarRender_TexturesUploadBudget);
+    gConsole.RegisterVariable(&gCvarRender_TexturesMemoryBudget);
+    gConsole.RegisterFunction("stat_texturesStreaming", "Print textures streaming counters", [](const ConsoleFuncArgs& args)
+        {
+            gTexturesManager.DumpStreamingStats();
+        });
+
     InitStandardTextures();
 
     return true;
@@ -26,6 +54,17 @@ bool TexturesManager::Initialize()
 
 void TexturesManager::Deinit()
 {
+    gConsole.UnregisterVariable(&gCvarRender_TexturesStreaming);
+    gConsole.UnregisterVariable(&gCvarRender_TexturesUploadBudget);
+    gConsole.UnregisterVariable(&gCvarRender_TexturesMemoryBudget);
+    gConsole.UnregisterFunction("stat_texturesStreaming");
+
+    CancelTexturesStreaming();
+    mStreamingStats = TextureStreamingStats();
+    mResidencyStats = TextureResidencyStats();
+    mEvictionCandidates.clear();
+    mFrameIndex = 0;
+
     FreeStandardTextures();
     FreeTextures();
 
@@ -41,6 +80,277 @@ void TexturesManager::UpdateFrame()
     {
         currAnimation->AdvanceAnimation(deltaTime);
     }
+
+    ProcessTexturesStreaming();
+    ProcessTexturesResidency();
+
+    ++mFrameIndex;
+}
+
+bool TexturesManager::RequestTextureStreaming(Texture2D* texture)
+{
+    debug_assert(texture);
+    if (!gCvarRender_TexturesStreaming.mValue)
+        return false;
+
+    if (mStreamingTextures.find(texture) != mStreamingTextures.end())
+        return true;
+
+    // missing textures are replaced with dummy immediately
+    if (!gEngineTexturesProvider.ContainsTexture(texture->mTextureName))
+        return false;
+
+    QueueTextureDecode(texture, 0);
+    return true;
+}
+
+void TexturesManager::RequestTextureRestore(Texture2D* texture)
+{
+    debug_assert(texture);
+    if (mStreamingTextures.find(texture) != mStreamingTextures.end())
+        return;
+
+    QueueTextureDecode(texture, 0);
+}
+
+void TexturesManager::QueueTextureDecode(Texture2D* texture, int droppedMipmaps)
+{
+    debug_assert(mStreamingTextures.find(texture) == mStreamingTextures.end());
+
+    TextureStreamingRequest* request = new TextureStreamingRequest;
+    request->mTexture = texture;
+    request->mDroppedMipmaps = droppedMipmaps;
+
+    mStreamingTextures.insert(texture);
+    mDecodeQueue.push_back(request);
+    mStreamingStats.mQueueDepth = (int) mStreamingTextures.size();
+}
+
+void TexturesManager::CancelTexturesStreaming()
+{
+    gTasksManager.WaitTasks(mDecodeTasks);
+    mDecodeTasksInProgress = 0;
+
+    for (TextureStreamingRequest* currRequest: mDecodedRequests)
+    {
+        delete currRequest;
+    }
+    mDecodedRequests.clear();
+
+    for (TextureStreamingRequest* currRequest: mUploadQueue)
+    {
+        delete currRequest;
+    }
+    mUploadQueue.clear();
+
+    for (TextureStreamingRequest* currRequest: mDecodeQueue)
+    {
+        delete currRequest;
+    }
+    mDecodeQueue.clear();
+    mStreamingTextures.clear();
+    mStreamingStats.mQueueDepth = 0;
+}
+
+void TexturesManager::ProcessTexturesStreaming()
+{
+    mStreamingStats.mUploadBytesFrame = 0;
+    if (mStreamingTextures.empty())
+        return;
+
+    // collect decoded textures
+    {
+        std::lock_guard<std::mutex> lock(mDecodedRequestsMutex);
+        for (TextureStreamingRequest* currRequest: mDecodedRequests)
+        {
+            mUploadQueue.push_back(currRequest);
+        }
+        mDecodeTasksInProgress -= (int) mDecodedRequests.size();
+        mDecodedRequests.clear();
+    }
+
+    // start decode tasks
+    while (!mDecodeQueue.empty() && mDecodeTasksInProgress < MaxDecodeTasksInProgress)
+    {
+        TextureStreamingRequest* request = mDecodeQueue.front();
+        mDecodeQueue.pop_front();
+
+        ++mDecodeTasksInProgress;
+        gTasksManager.QueueTask(mDecodeTasks, [this, request]()
+            {
+                auto timeStart = std::chrono::steady_clock::now();
+                if (!request->mTexture->ReadTextureImage(request->mImageData))
+                {
+                    request->mImageData.Clear();
+                }
+                std::chrono::duration<double, std::milli> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+                request->mDecodeMilliseconds = timeElapsed.count();
+
+                std::lock_guard<std::mutex> lock(mDecodedRequestsMutex);
+                mDecodedRequests.push_back(request);
+            });
+    }
+
+    // upload within frame budget
+    const unsigned int uploadBudget = (unsigned int) std::max(gCvarRender_TexturesUploadBudget.mValue, 0) * 1024;
+    while (!mUploadQueue.empty())
+    {
+        TextureStreamingRequest* request = mUploadQueue.front();
+
+        unsigned int dataLength = 0;
+        if (!request->mImageData.IsNull())
+        {
+            for (int imipmap = request->mDroppedMipmaps; imipmap < request->mImageData.mTextureDesc.mMipmapsCount + 1; ++imipmap)
+            {
+                dataLength += request->mImageData.GetImageDataSize(imipmap);
+            }
+        }
+
+        if (mStreamingStats.mUploadBytesFrame > 0 && mStreamingStats.mUploadBytesFrame + dataLength > uploadBudget)
+            break;
+
+        mUploadQueue.pop_front();
+
+        Texture2D* texture = request->mTexture;
+        if (request->mDroppedMipmaps > 0)
+        {
+            // texture might be unloaded while it was decoding
+            if (texture->IsTextureLoaded() && texture->DropMipmaps(request->mImageData, request->mDroppedMipmaps))
+            {
+                ++mResidencyStats.mMipmapsDroppedCount;
+                mStreamingStats.mUploadBytesFrame += dataLength;
+                mStreamingStats.mUploadBytesTotal += dataLength;
+            }
+        }
+        // texture might be loaded immediately or replaced with proxy while it was streaming
+        else if ((!texture->IsTextureLoaded() || texture->GetDroppedMipmapsCount() > 0) && !texture->HasProxyTexture())
+        {
+            if (request->mImageData.IsNull())
+            {
+                gConsole.LogMessage(eLogMessage_Debug, "Fail to load texture '%s'", texture->mTextureName.c_str());
+            }
+            texture->LoadTexture(request->mImageData);
+            mStreamingStats.mUploadBytesFrame += dataLength;
+            mStreamingStats.mUploadBytesTotal += dataLength;
+            ++mStreamingStats.mUploadedCount;
+        }
+
+        ++mStreamingStats.mDecodedCount;
+        mStreamingStats.mDecodeMilliseconds += request->mDecodeMilliseconds;
+        mStreamingStats.mDecodeMillisecondsMax = std::max(mStreamingStats.mDecodeMillisecondsMax, request->mDecodeMilliseconds);
+
+        mStreamingTextures.erase(texture);
+        delete request;
+    }
+
+    mStreamingStats.mUploadBytesFrameMax = std::max(mStreamingStats.mUploadBytesFrameMax, mStreamingStats.mUploadBytesFrame);
+    mStreamingStats.mQueueDepth = (int) mStreamingTextures.size();
+}
+
+void TexturesManager::ProcessTexturesResidency()
+{
+    mResidencyStats.mResidentCount = 0;
+    mResidencyStats.mResidentBytes = 0;
+    mEvictionCandidates.clear();
+
+    for (const auto& curr: mTextures2DMap)
+    {
+        Texture2D* texture = curr.second;
+        if (!texture->IsTextureLoaded() || texture->HasProxyTexture())
+            continue;
+
+        ++mResidencyStats.mResidentCount;
+        mResidencyStats.mResidentBytes += texture->GetGpuMemorySize();
+
+        if (texture->IsPersistent() || (mFrameIndex - texture->GetLastUsedFrame()) < EvictionMinUnusedFrames)
+            continue;
+
+        if (mStreamingTextures.find(texture) != mStreamingTextures.end())
+            continue;
+
+        mEvictionCandidates.push_back(texture);
+    }
+
+    const unsigned long long memoryBudget = (unsigned long long) std::max(gCvarRender_TexturesMemoryBudget.mValue, 0) * 1024 * 1024;
+    if (memoryBudget == 0 || mResidencyStats.mResidentBytes <= memoryBudget)
+        return;
+
+    // least recently used first
+    std::sort(mEvictionCandidates.begin(), mEvictionCandidates.end(), [](const Texture2D* lhs, const Texture2D* rhs)
+        {
+            return lhs->GetLastUsedFrame() < rhs->GetLastUsedFrame();
+        });
+
+    // reduce textures resolution before unloading them completely
+    int mipmapsDrops = 0;
+    for (Texture2D* texture: mEvictionCandidates)
+    {
+        if (mResidencyStats.mResidentBytes <= memoryBudget || mipmapsDrops == MaxMipmapsDropsPerFrame)
+            break;
+
+        const Point& dimensions = texture->mTextureDesc.mDimensions;
+        if (texture->GetDroppedMipmapsCount() > 0 || texture->mTextureDesc.mMipmapsCount < 1 ||
+            std::min(dimensions.x, dimensions.y) < MinDroppedMipmapDims * 2)
+        {
+            continue;
+        }
+
+        if (!texture->IsLoadedFromFile())
+            continue;
+
+        // texture keeps full resolution until reduced image is decoded, count memory as already released
+        QueueTextureDecode(texture, 1);
+        ++mipmapsDrops;
+        mResidencyStats.mResidentBytes -= GetTextureDataSize(texture->mTextureDesc.mTextureFormat, dimensions, 0);
+    }
+
+    // wait for next frame if there are more textures to reduce
+    if (mipmapsDrops == MaxMipmapsDropsPerFrame)
+        return;
+
+    for (Texture2D* texture: mEvictionCandidates)
+    {
+        if (mResidencyStats.mResidentBytes <= memoryBudget)
+            break;
+
+        // being reduced
+        if (mStreamingTextures.find(texture) != mStreamingTextures.end())
+            continue;
+
+        const unsigned int sizeBefore = texture->GetGpuMemorySize();
+        texture->FreeTexture();
+        ++mResidencyStats.mEvictedCount;
+        --mResidencyStats.mResidentCount;
+        mResidencyStats.mResidentBytes -= sizeBefore;
+    }
+}
+
+void TexturesManager::GetResidentTextures(std::vector<Texture2D*>& outputTextures) const
+{
+    outputTextures.clear();
+    for (const auto& curr: mTextures2DMap)
+    {
+        if (curr.second->IsTextureLoaded() && !curr.second->HasProxyTexture())
+        {
+            outputTextures.push_back(curr.second);
+        }
+    }
+}
+
+void TexturesManager::DumpStreamingStats() const
+{
+    double averageDecodeMilliseconds = 0.0;
+    if (mStreamingStats.mDecodedCount > 0)
+    {
+        averageDecodeMilliseconds = mStreamingStats.mDecodeMilliseconds / mStreamingStats.mDecodedCount;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Textures streaming (%s):", gCvarRender_TexturesStreaming.mValue ? "enabled" : "disabled");
+    gConsole.LogMessage(eLogMessage_Info, " - queue depth: %d (%d decoding)", mStreamingStats.mQueueDepth, mDecodeTasksInProgress);
+    gConsole.LogMessage(eLogMessage_Info, " - decoded: %d, avg %.3f ms, max %.3f ms", mStreamingStats.mDecodedCount,
+        averageDecodeMilliseconds, mStreamingStats.mDecodeMillisecondsMax);
+    gConsole.LogMessage(eLogMessage_Info, " - uploaded: %d, %llu bytes total, last frame %u bytes, max %u bytes per frame", mStreamingStats.mUploadedCount,
+        mStreamingStats.mUploadBytesTotal, mStreamingStats.mUploadBytesFrame, mStreamingStats.mUploadBytesFrameMax);
 }
 
 Texture2D* TexturesManager::FindTexture2D(const std::string& textureName) const
@@ -96,6 +406,8 @@ void TexturesManager::ReloadAllTextures()
 
 void TexturesManager::PurgeLoadedTextures()
 {
+    CancelTexturesStreaming();
+
     for (auto& curr: mTextures2DMap)
     {
         if (curr.second->IsPersistent() || !curr.second->IsTextureLoaded())
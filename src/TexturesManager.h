@@ -1,6 +1,32 @@
 #pragma once
 
 #include "Texture2DAnimation.h"
+#include "Texture2D_Image.h"
+#include "TasksManager.h"
+
+// textures streaming counters
+struct TextureStreamingStats
+{
+public:
+    int mQueueDepth = 0; // textures waiting for decode or upload
+    int mDecodedCount = 0;
+    int mUploadedCount = 0;
+    double mDecodeMilliseconds = 0.0; // total time spent in decode tasks
+    double mDecodeMillisecondsMax = 0.0;
+    unsigned int mUploadBytesFrame = 0; // bytes uploaded during last frame
+    unsigned int mUploadBytesFrameMax = 0;
+    unsigned long long mUploadBytesTotal = 0;
+};
+
+// textures gpu memory counters
+struct TextureResidencyStats
+{
+public:
+    int mResidentCount = 0; // loaded textures excluding proxies
+    unsigned long long mResidentBytes = 0;
+    int mEvictedCount = 0;
+    int mMipmapsDroppedCount = 0;
+};
 
 // textures manager class
 class TexturesManager: public cxx::noncopyable
@@ -20,14 +46,40 @@ public:
     Texture2D* mEngineTestCross = nullptr;
     Texture2D* mEngineTestLight = nullptr;
 
+    // readonly
+    TextureStreamingStats mStreamingStats;
+    TextureResidencyStats mResidencyStats;
+
 public:
     // setup manager internal resources, returns false on error
     bool Initialize();
     void Deinit();
 
-    // process animating textures
+    // process animating textures and upload streamed textures
     void UpdateFrame();
 
+    // enqueue texture data decoding on worker threads, it will be uploaded to gpu within one of next frames
+    // @param texture: Texture which is not loaded yet
+    // @returns false if streaming is disabled or texture cannot be streamed, it should be loaded immediately
+    bool RequestTextureStreaming(Texture2D* texture);
+
+    // enqueue decoding of full resolution image for texture with dropped mipmaps, it will be restored within one of next frames
+    // @param texture: Reduced texture
+    void RequestTextureRestore(Texture2D* texture);
+
+    // wait for pending decode tasks and drop all streaming requests
+    void CancelTexturesStreaming();
+
+    // print streaming counters to console
+    void DumpStreamingStats() const;
+
+    // get list of textures currently occupying gpu memory
+    // @param outputTextures: Output list
+    void GetResidentTextures(std::vector<Texture2D*>& outputTextures) const;
+
+    // get current frame index, used to track textures usage
+    inline unsigned int GetFrameIndex() const { return mFrameIndex; }
+
     // reload unloaded textures to gpu memory
     void ReloadAllTextures();
 
@@ -60,7 +112,27 @@ private:
 
     void InitWaterLavaTextureAnimations();
 
+    // start decode tasks and upload decoded textures within frame budget
+    void ProcessTexturesStreaming();
+
+    // reduce or unload least recently used textures if gpu memory budget is exceeded
+    void ProcessTexturesResidency();
+
+    // enqueue texture data decoding, decoded image is applied to texture on upload
+    // @param texture: Texture
+    // @param droppedMipmaps: Number of largest mipmap levels skipped on upload
+    void QueueTextureDecode(Texture2D* texture, int droppedMipmaps);
+
 private:
+    // texture which is being decoded or waiting for upload
+    struct TextureStreamingRequest
+    {
+    public:
+        Texture2D* mTexture = nullptr;
+        Texture2D_Image mImageData;
+        int mDroppedMipmaps = 0; // reduce texture instead of full upload
+        double mDecodeMilliseconds = 0.0;
+    };
     using Textures2DMap = std::map<std::string, Texture2D*, cxx::icase_less>;
     Textures2DMap mTextures2DMap;
 
@@ -68,6 +140,19 @@ private:
 
     Texture2DAnimation mWaterTextureAnimation;
     Texture2DAnimation mLavaTextureAnimation;
+
+    // streaming
+    std::set<Texture2D*> mStreamingTextures; // all requested textures
+    std::deque<TextureStreamingRequest*> mDecodeQueue; // waiting for decode task
+    std::deque<TextureStreamingRequest*> mUploadQueue; // decoded, waiting for upload
+    std::vector<TextureStreamingRequest*> mDecodedRequests; // shared with decode tasks
+    std::mutex mDecodedRequestsMutex;
+    TasksManager::TaskGroup mDecodeTasks;
+    int mDecodeTasksInProgress = 0;
+
+    // residency
+    std::vector<Texture2D*> mEvictionCandidates;
+    unsigned int mFrameIndex = 0;
 };
 
 extern TexturesManager gTexturesManager;
\ No newline at end of file
@@ -40,6 +40,8 @@ void ToolsUIConsoleWindow::DoUI(ImGuiIO& imguiContext)
         ImGuiWindowFlags_HorizontalScrollbar | ImGuiWindowFlags_NoBackground);
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4,1));
 
+    // lines are appended by console writer thread
+    std::unique_lock<std::mutex> logLinesLock(gConsole.mLogLinesMutex);
     for (const Console::LineStruct& currentLine: gConsole.mLogLines)
     {
         const char* item = currentLine.mMessageString.c_str();
@@ -66,6 +68,7 @@ void ToolsUIConsoleWindow::DoUI(ImGuiIO& imguiContext)
             ImGui::PopStyleColor();
         }
     }
+    logLinesLock.unlock();
 
     if (mScrollToBottom || (mAutoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()))
     {
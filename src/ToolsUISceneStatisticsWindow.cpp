@@ -4,6 +4,10 @@
 #include "GameMain.h"
 #include "TerrainTile.h"
 #include "TerrainManager.h"
+#include "GraphicsDevice.h"
+#include "RenderManager.h"
+#include "GuiAtlasManager.h"
+#include "cvars.h"
 
 ToolsUISceneStatisticsWindow::ToolsUISceneStatisticsWindow()
 {
@@ -23,6 +27,38 @@ void ToolsUISceneStatisticsWindow::DoUI(ImGuiIO& imguiContext)
 
     ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Frame Time: %.3f ms (%.1f FPS)", 1000.0f / imguiContext.Framerate, imguiContext.Framerate);
 
+    const GraphicsDeviceStats& frameStats = gGraphicsDevice.mPrevFrameStats;
+    ImGui::Text("Draw calls: %d (%d instances), State changes: %d (%d skipped)", frameStats.mDrawCalls, frameStats.mInstancesDrawn, 
+        frameStats.mStateChanges, frameStats.mStateChangesSkipped);
+
+    // models level of details
+    const AnimModelsRenderer::FrameStats& modelsStats = gRenderManager.mAnimatingModelsRenderer.mPrevFrameStats;
+    for (int icurrentLOD = 0; icurrentLOD < AnimModelsRenderer::MaxStatsLODs; ++icurrentLOD)
+    {
+        if (modelsStats.mModelsCount[icurrentLOD] == 0)
+            continue;
+
+        ImGui::Text("Models LOD %d: %d (%d triangles)", icurrentLOD, 
+            modelsStats.mModelsCount[icurrentLOD], modelsStats.mTrianglesCount[icurrentLOD]);
+    }
+
+    // terrain draw calls
+    const TerrainMeshRenderer::FrameStats& terrainFrameStats = gRenderManager.mTerrainMeshRenderer.mPrevFrameStats;
+    ImGui::Text("Terrain: %d meshes, %d draw calls, %d material switches%s", terrainFrameStats.mMeshesDrawn, 
+        terrainFrameStats.mDrawCalls, terrainFrameStats.mMaterialSwitches, gCvarRender_TerrainTexturesArray.mValue ? " (textures array)" : "");
+
+    // terrain geometry uploads
+    const TerrainMeshRenderer::UploadStats& terrainStats = gRenderManager.mTerrainMeshRenderer.mUploadStats;
+    ImGui::Text("Terrain uploads: %.1f KB (%d tiles updated, %d meshes rebuilt)", terrainStats.mUploadedBytes / 1024.0, 
+        terrainStats.mTilesUpdated, terrainStats.mMeshesRebuilt);
+
+    // game ui batches
+    const GuiRenderer::FrameStats& guiFrameStats = gRenderManager.GetGuiFrameStats();
+    ImGui::Text("Gui: %d draw calls, %d texture switches, %d quads (atlas: %d pages, %d textures%s)", guiFrameStats.mDrawCalls,
+        guiFrameStats.mTextureSwitches, guiFrameStats.mQuadsDrawn, gGuiAtlasManager.GetPagesCount(), gGuiAtlasManager.GetEntriesCount(),
+        gCvarGui_TexturesAtlas.mValue ? "" : ", disabled");
+    ImGui::Text("Gui widgets rebuilt: %d%s", guiFrameStats.mWidgetsRecorded, gCvarGui_RetainedRender.mValue ? "" : " (retained render disabled)");
+
     // show hovered tile info
     if (gGameMain.IsGameplayGamestate())
     {
@@ -0,0 +1,75 @@
+#include "pch.h"
+#include "3rd_party/imgui.h"
+#include "ToolsUITexturesWindow.h"
+#include "TexturesManager.h"
+#include "Texture2D.h"
+
+ToolsUITexturesWindow::ToolsUITexturesWindow()
+{
+}
+
+void ToolsUITexturesWindow::DoUI(ImGuiIO& imguiContext)
+{
+    const ImVec2 distance { 10.0f, 10.0f };
+    const ImVec2 initialSize { 560.0f, 400.0f };
+    const ImVec2 initialPos { distance.x, imguiContext.DisplaySize.y - initialSize.y - distance.y };
+
+    ImGui::SetNextWindowBgAlpha(0.5f);
+    ImGui::SetNextWindowSize(initialSize, ImGuiCond_Once);
+    ImGui::SetNextWindowPos(initialPos, ImGuiCond_Once);
+
+    if (!ImGui::Begin("Textures", &mWindowShown))
+    {
+        ImGui::End();
+        return;
+    }
+
+    const TextureResidencyStats& residencyStats = gTexturesManager.mResidencyStats;
+    const TextureStreamingStats& streamingStats = gTexturesManager.mStreamingStats;
+    ImGui::Text("Resident: %d textures, %.2f MB", residencyStats.mResidentCount, residencyStats.mResidentBytes / (1024.0 * 1024.0));
+    ImGui::Text("Evicted: %d, mipmaps dropped: %d", residencyStats.mEvictedCount, residencyStats.mMipmapsDroppedCount);
+    ImGui::Text("Streaming queue: %d, uploaded last frame: %.1f KB", streamingStats.mQueueDepth, streamingStats.mUploadBytesFrame / 1024.0);
+    ImGui::Separator();
+
+    // largest first
+    gTexturesManager.GetResidentTextures(mResidentTextures);
+    std::sort(mResidentTextures.begin(), mResidentTextures.end(), [](const Texture2D* lhs, const Texture2D* rhs)
+        {
+            return lhs->GetGpuMemorySize() > rhs->GetGpuMemorySize();
+        });
+
+    const unsigned int currentFrame = gTexturesManager.GetFrameIndex();
+
+    ImGui::Columns(5, "resident_textures");
+    ImGui::Text("Name"); ImGui::NextColumn();
+    ImGui::Text("Size"); ImGui::NextColumn();
+    ImGui::Text("Mipmaps"); ImGui::NextColumn();
+    ImGui::Text("Bytes"); ImGui::NextColumn();
+    ImGui::Text("Unused frames"); ImGui::NextColumn();
+    ImGui::Separator();
+
+    for (const Texture2D* currTexture: mResidentTextures)
+    {
+        const Texture2D_Desc& textureDesc = currTexture->mTextureDesc;
+        ImGui::Text("%s%s", currTexture->mTextureName.c_str(), currTexture->IsPersistent() ? " (persistent)" : "");
+        ImGui::NextColumn();
+        ImGui::Text("%dx%d", textureDesc.mDimensions.x, textureDesc.mDimensions.y);
+        ImGui::NextColumn();
+        if (currTexture->GetDroppedMipmapsCount() > 0)
+        {
+            ImGui::Text("%d (-%d)", textureDesc.mMipmapsCount, currTexture->GetDroppedMipmapsCount());
+        }
+        else
+        {
+            ImGui::Text("%d", textureDesc.mMipmapsCount);
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%u", currTexture->GetGpuMemorySize());
+        ImGui::NextColumn();
+        ImGui::Text("%u", currentFrame - currTexture->GetLastUsedFrame());
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+
+    ImGui::End();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ToolsUIWindow.h"
+
+// resident textures window
+class ToolsUITexturesWindow: public ToolsUIWindow
+{
+public:
+    ToolsUITexturesWindow();
+
+private:
+    // overrides ToolsUIWindow
+    void DoUI(ImGuiIO& imguiContext) override;
+
+private:
+    std::vector<Texture2D*> mResidentTextures;
+};
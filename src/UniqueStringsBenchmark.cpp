@@ -0,0 +1,200 @@
+#include "pch.h"
+#include "UniqueStringsBenchmark.h"
+#include "EngineTexturesProvider.h"
+#include "TasksManager.h"
+#include "Console.h"
+#include "ConsoleVariable.h"
+#include "FileSystem.h"
+#include "FileSystemArchive.h"
+
+//////////////////////////////////////////////////////////////////////////
+
+// unique strings table as it was before sharding, used to compare names lookup cost
+class LegacyUniqueStringsTable
+{
+public:
+    struct StringHolder
+    {
+    public:
+        std::string mString;
+        unsigned int mReferenceCounter = 0;
+    };
+
+    StringHolder* Acquire(const char* stringContent)
+    {
+        std::string stringContentTemp(stringContent);
+
+        StringHolder& holder = mStringsTable[stringContentTemp];
+        if (holder.mReferenceCounter == 0)
+        {
+            holder.mString.swap(stringContentTemp);
+        }
+        ++holder.mReferenceCounter;
+        return &holder;
+    }
+
+    void Release(StringHolder* holder)
+    {
+        if (--holder->mReferenceCounter > 0)
+            return;
+
+        auto map_iterator = mStringsTable.find(holder->mString);
+        debug_assert(map_iterator != mStringsTable.end());
+        mStringsTable.erase(map_iterator);
+    }
+
+private:
+    std::map<std::string, StringHolder> mStringsTable;
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+UniqueStringsBenchmark gUniqueStringsBenchmark;
+
+bool UniqueStringsBenchmark::Initialize()
+{
+    gConsole.RegisterFunction("bench_uniqueStrings", "Intern engine texture and model names with legacy and sharded strings tables, args: iterationsCount maxThreads", [](const ConsoleFuncArgs& args)
+        {
+            int iterationsCount = 100;
+            int maxThreads = 0;
+            args.ParseArgument(0, iterationsCount);
+            args.ParseArgument(1, maxThreads);
+            gUniqueStringsBenchmark.RunBenchmark(iterationsCount, maxThreads);
+        });
+
+    return true;
+}
+
+void UniqueStringsBenchmark::Deinit()
+{
+    gConsole.UnregisterFunction("bench_uniqueStrings");
+}
+
+void UniqueStringsBenchmark::RunBenchmark(int iterationsCount, int maxThreads)
+{
+    std::vector<std::string> names;
+    gEngineTexturesProvider.GetTexturesNames(names);
+    const int texturesNamesCount = (int) names.size();
+
+    for (const FileSystemArchive* currArchive: gFileSystem.mResourceArchives)
+    {
+        for (const auto& currEntry: currArchive->mEtriesMap)
+        {
+            std::string entryName = currEntry.first;
+            cxx::str_to_lower(entryName);
+            if (cxx::ends_with(entryName, ".kmf"))
+            {
+                names.push_back(currEntry.first);
+            }
+        }
+    }
+
+    if (names.empty())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Unique strings benchmark requires engine textures and mounted resource archives");
+        return;
+    }
+
+    iterationsCount = std::max(iterationsCount, 1);
+    if (maxThreads < 1 || maxThreads > gTasksManager.GetMaxThreadsCount())
+    {
+        maxThreads = gTasksManager.GetMaxThreadsCount();
+    }
+
+    // case-insensitive lookups use names in different case
+    std::vector<std::string> upperCaseNames = names;
+    for (std::string& currName: upperCaseNames)
+    {
+        cxx::str_to_upper(currName);
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Unique strings benchmark, texture names: %d, model names: %d, iterations: %d",
+        texturesNamesCount, (int) names.size() - texturesNamesCount, iterationsCount);
+
+    auto printPassResult = [&names, iterationsCount](const char* passName, int threadsCount, const std::chrono::steady_clock::time_point& timeStart)
+    {
+        std::chrono::duration<double> timeElapsed = std::chrono::steady_clock::now() - timeStart;
+
+        const double lookupsCount = (double) names.size() * iterationsCount;
+        const double seconds = std::max(timeElapsed.count(), 0.000001);
+        gConsole.LogMessage(eLogMessage_Info, " - %s, threads: %d, lookups/sec: %.0f, ns/lookup: %.1f", passName, threadsCount,
+            lookupsCount / seconds, (seconds * 1000000000.0) / lookupsCount);
+    };
+
+    // all names are interned before passes, so each lookup hits existing entry
+    {
+        LegacyUniqueStringsTable legacyTable;
+        std::vector<LegacyUniqueStringsTable::StringHolder*> legacyStrings;
+        for (const std::string& currName: names)
+        {
+            legacyStrings.push_back(legacyTable.Acquire(currName.c_str()));
+        }
+
+        auto timeStart = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            for (const std::string& currName: names)
+            {
+                legacyTable.Release(legacyTable.Acquire(currName.c_str()));
+            }
+        }
+        printPassResult("legacy", 1, timeStart);
+
+        timeStart = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterationsCount; ++iteration)
+        {
+            for (const std::string& currName: upperCaseNames)
+            {
+                std::string foldedName = currName;
+                cxx::str_to_lower(foldedName);
+                legacyTable.Release(legacyTable.Acquire(foldedName.c_str()));
+            }
+        }
+        printPassResult("legacy ignore case", 1, timeStart);
+
+        for (LegacyUniqueStringsTable::StringHolder* currString: legacyStrings)
+        {
+            legacyTable.Release(currString);
+        }
+    }
+
+    std::vector<cxx::unique_string> uniqueStrings;
+    for (const std::string& currName: names)
+    {
+        uniqueStrings.emplace_back(currName);
+        uniqueStrings.push_back(cxx::unique_string::from_icase(currName));
+    }
+
+    auto timeStart = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    {
+        for (const std::string& currName: names)
+        {
+            cxx::unique_string uniqueName(currName);
+        }
+    }
+    printPassResult("sharded", 1, timeStart);
+
+    timeStart = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterationsCount; ++iteration)
+    {
+        for (const std::string& currName: upperCaseNames)
+        {
+            cxx::unique_string uniqueName = cxx::unique_string::from_icase(currName);
+        }
+    }
+    printPassResult("sharded ignore case", 1, timeStart);
+
+    // legacy table is not thread-safe, so only sharded one is measured concurrently
+    timeStart = std::chrono::steady_clock::now();
+    gTasksManager.ParallelFor(iterationsCount, maxThreads, false, [&names](int taskIndex, int threadIndex)
+        {
+            for (const std::string& currName: names)
+            {
+                cxx::unique_string uniqueName(currName);
+            }
+        });
+    printPassResult("sharded", maxThreads, timeStart);
+
+    gConsole.LogMessage(eLogMessage_Info, " - interned strings: %d", cxx::unique_string::get_strings_count());
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// compares lookup cost of legacy and sharded unique strings tables on engine texture and model names
+class UniqueStringsBenchmark: public cxx::noncopyable
+{
+public:
+    // register benchmark console command
+    bool Initialize();
+    void Deinit();
+
+    // intern engine texture and model names with legacy and sharded unique strings tables and print lookup timings
+    // @param iterationsCount: Number of passes over names list
+    // @param maxThreads: Max number of threads for concurrent pass, 0 means all available
+    void RunBenchmark(int iterationsCount, int maxThreads);
+};
+
+extern UniqueStringsBenchmark gUniqueStringsBenchmark;
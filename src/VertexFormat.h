@@ -46,8 +46,29 @@ public:
     SingleAttribute mAttributes[eVertexAttribute_COUNT];
     unsigned int mDataStride = 0; // common to all attributes
     unsigned int mBaseOffset = 0; // additional offset in bytes within source vertex buffer, affects on all attribues
+    unsigned int mInstanceDivisor = 0; // non zero for per instance attributes streams, number of instances per element
 };
 
+inline bool operator == (const VertexFormat::SingleAttribute& lhs, const VertexFormat::SingleAttribute& rhs)
+{
+    return lhs.mFormat == rhs.mFormat &&
+        lhs.mDataOffset == rhs.mDataOffset &&
+        lhs.mNormalized == rhs.mNormalized;
+}
+
+inline bool operator == (const VertexFormat& lhs, const VertexFormat& rhs)
+{
+    if (lhs.mDataStride != rhs.mDataStride || lhs.mBaseOffset != rhs.mBaseOffset || lhs.mInstanceDivisor != rhs.mInstanceDivisor)
+        return false;
+
+    for (int iattribute = 0; iattribute < eVertexAttribute_COUNT; ++iattribute)
+    {
+        if (!(lhs.mAttributes[iattribute] == rhs.mAttributes[iattribute]))
+            return false;
+    }
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 // standard engine vertex definition
@@ -160,6 +181,37 @@ public:
         this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_2F, offsetof(TVertexType, mTexcoord));
         this->SetAttribute(eVertexAttribute_Normal0, eVertexAttributeFormat_3F, offsetof(TVertexType, mNormal));
         this->SetAttribute(eVertexAttribute_TerrainTilePosition, eVertexAttributeFormat_2US, offsetof(TVertexType, mTileCoord));
+        this->SetAttribute(eVertexAttribute_TerrainTextureLayer, eVertexAttributeFormat_1US, offsetof(TVertexType, mTextureLayer));
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// compact terrain vertex definition, positions must be restored with dequantize model matrix
+struct Vertex3D_TerrainCompact_Format: public VertexFormat
+{
+public:
+    Vertex3D_TerrainCompact_Format()
+    {
+        Setup();
+    }
+    // get definition instance
+    static const Vertex3D_TerrainCompact_Format& Get() 
+    { 
+        static const Vertex3D_TerrainCompact_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = Vertex3D_TerrainCompact;
+    // initialize definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_Vertex3D_TerrainCompact;
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4S, offsetof(TVertexType, mPosition));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_2HF, offsetof(TVertexType, mTexcoord));
+        this->SetAttribute(eVertexAttribute_TerrainTilePosition, eVertexAttributeFormat_2US, offsetof(TVertexType, mTileCoord));
+        this->SetAttribute(eVertexAttribute_TerrainTextureLayer, eVertexAttributeFormat_1US, offsetof(TVertexType, mTextureLayer));
+
+        this->SetAttributeNormalized(eVertexAttribute_Position0, true);
     }
 };
 
@@ -191,6 +243,32 @@ public:
 
 //////////////////////////////////////////////////////////////////////////
 
+// compact water or lava vertex definition
+struct Vertex3D_WaterLavaCompact_Format: public VertexFormat
+{
+public:
+    Vertex3D_WaterLavaCompact_Format()
+    {
+        Setup();
+    }
+    // get definition instance
+    static const Vertex3D_WaterLavaCompact_Format& Get() 
+    { 
+        static const Vertex3D_WaterLavaCompact_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = Vertex3D_WaterLavaCompact;
+    // initialize definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_Vertex3D_WaterLavaCompact;
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4HF, offsetof(TVertexType, mPosition));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_2HF, offsetof(TVertexType, mTexcoord));
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
 // morph/keyframe animation vertex definition
 // no color data stored!
 struct Vertex3D_Anim_Format: public VertexFormat
@@ -241,4 +319,85 @@ public:
             (numVertsPerFrame * Sizeof_Position * numFrames) + 
             (numVertsPerFrame * Sizeof_Normal * frame1));
     }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// compact morph/keyframe animation vertex definition, attributes layout is same as Vertex3D_Anim_Format:
+// positions are snorm16 within model bounds and must be restored with dequantize model matrix,
+// normals are octahedral encoded snorm16
+struct Vertex3D_AnimCompact_Format: public VertexFormat
+{
+public:
+    Vertex3D_AnimCompact_Format()
+    {
+        this->mDataStride = 0;
+    }
+
+    enum 
+    { 
+        Sizeof_Texcoord = sizeof(glm::vec2),
+        Sizeof_Position = sizeof(short) * 4,
+        Sizeof_Normal = sizeof(short) * 2,
+    };
+
+    inline void Setup(int dataOffset, int numVertsPerFrame, int numFrames, int frame0, int frame1)
+    {
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_2F, dataOffset);
+
+        // frame 0
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_4S,
+            (dataOffset + numVertsPerFrame * Sizeof_Texcoord) + 
+            (numVertsPerFrame * Sizeof_Position * frame0));
+
+        this->SetAttribute(eVertexAttribute_Normal0, eVertexAttributeFormat_2S, 
+            (dataOffset + numVertsPerFrame * Sizeof_Texcoord) + 
+            (numVertsPerFrame * Sizeof_Position * numFrames) + 
+            (numVertsPerFrame * Sizeof_Normal * frame0));
+
+        // frame 1
+        this->SetAttribute(eVertexAttribute_Position1, eVertexAttributeFormat_4S, 
+            (dataOffset + numVertsPerFrame * Sizeof_Texcoord) + 
+            (numVertsPerFrame * Sizeof_Position * frame1));
+
+        this->SetAttribute(eVertexAttribute_Normal1, eVertexAttributeFormat_2S, 
+            (dataOffset + numVertsPerFrame * Sizeof_Texcoord) + 
+            (numVertsPerFrame * Sizeof_Position * numFrames) + 
+            (numVertsPerFrame * Sizeof_Normal * frame1));
+
+        this->SetAttributeNormalized(eVertexAttribute_Position0, true);
+        this->SetAttributeNormalized(eVertexAttribute_Normal0, true);
+        this->SetAttributeNormalized(eVertexAttribute_Position1, true);
+        this->SetAttributeNormalized(eVertexAttribute_Normal1, true);
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// per instance data of animating model definition
+struct Vertex3D_AnimInstance_Format: public VertexFormat
+{
+public:
+    Vertex3D_AnimInstance_Format()
+    {
+        Setup();
+    }
+    // get definition instance
+    static const Vertex3D_AnimInstance_Format& Get() 
+    { 
+        static const Vertex3D_AnimInstance_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = Vertex3D_AnimInstance;
+    // initialize definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_Vertex3D_AnimInstance;
+        this->mInstanceDivisor = 1;
+        this->SetAttribute(eVertexAttribute_InstanceTransform0, eVertexAttributeFormat_4F, offsetof(TVertexType, mTransformation) + sizeof(glm::vec4) * 0);
+        this->SetAttribute(eVertexAttribute_InstanceTransform1, eVertexAttributeFormat_4F, offsetof(TVertexType, mTransformation) + sizeof(glm::vec4) * 1);
+        this->SetAttribute(eVertexAttribute_InstanceTransform2, eVertexAttributeFormat_4F, offsetof(TVertexType, mTransformation) + sizeof(glm::vec4) * 2);
+        this->SetAttribute(eVertexAttribute_InstanceTransform3, eVertexAttributeFormat_4F, offsetof(TVertexType, mTransformation) + sizeof(glm::vec4) * 3);
+        this->SetAttribute(eVertexAttribute_InstanceMixFrames, eVertexAttributeFormat_1F, offsetof(TVertexType, mMixFrames));
+    }
 };
\ No newline at end of file
@@ -7,8 +7,10 @@
 #include "GraphicsDevice.h"
 #include "GpuBuffer.h"
 #include "TerrainTile.h"
+#include "GameWorld.h"
 
 const int MaxWaterLavaMeshBufferSize = 1024 * 1024 * 2;
+const int MaxCompactWaterLavaMapSize = 1024;
 
 bool WaterLavaMeshRenderer::Initialize()
 {
@@ -43,7 +45,14 @@ void WaterLavaMeshRenderer::Render(SceneRenderContext& renderContext, Renderable
 
     // bind indices
     gGraphicsDevice.BindIndexBuffer(component->mIndexBuffer);
-    gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_WaterLava_Format::Get());
+    if (component->mCompactVertices)
+    {
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_WaterLavaCompact_Format::Get());
+    }
+    else
+    {
+        gGraphicsDevice.BindVertexBuffer(component->mVertexBuffer, Vertex3D_WaterLava_Format::Get());
+    }
 
     for (RenderableWaterLavaMesh::DrawPart& currPart: component->mDrawParts)
     {
@@ -61,7 +70,7 @@ void WaterLavaMeshRenderer::Render(SceneRenderContext& renderContext, Renderable
         currMaterial->ActivateMaterial();
         if (currPart.mTriangleCount)
         {
-            gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, eIndicesType_i32, 0, currPart.mTriangleCount * 3);
+            gGraphicsDevice.RenderIndexedPrimitives(ePrimitiveType_Triangles, component->mIndicesType, 0, currPart.mTriangleCount * 3);
         }
         else
         {
@@ -88,8 +97,15 @@ void WaterLavaMeshRenderer::PrepareRenderdata(RenderableWaterLavaMesh* component
     component->SetDrawPartsCount(1);
     component->SetDrawPart(0, 0, 0, 0, vertexCount, triangleCount);
 
-    int actualVBufferLength = vertexCount * Sizeof_Vertex3D_WaterLava;
-    int actualIBufferLength = triangleCount * sizeof(glm::ivec3);
+    // half floats keep tile corners and centers exactly within 1024 units
+    const Point& mapDimensions = gGameWorld.mMapData.mDimensions;
+    component->mCompactVertices = gCvarRender_CompactVertices.mValue && 
+        mapDimensions.x <= MaxCompactWaterLavaMapSize && mapDimensions.y <= MaxCompactWaterLavaMapSize;
+    component->mIndicesType = (component->mCompactVertices && vertexCount <= 0xFFFF) ? eIndicesType_i16 : eIndicesType_i32;
+
+    const int vertexSize = component->mCompactVertices ? Sizeof_Vertex3D_WaterLavaCompact : Sizeof_Vertex3D_WaterLava;
+    int actualVBufferLength = vertexCount * vertexSize;
+    int actualIBufferLength = triangleCount * 3 * GetIndexSizeBytes(component->mIndicesType);
     if (actualVBufferLength > MaxWaterLavaMeshBufferSize || actualIBufferLength > MaxWaterLavaMeshBufferSize)
     {
         debug_assert(false);
@@ -105,6 +121,7 @@ void WaterLavaMeshRenderer::PrepareRenderdata(RenderableWaterLavaMesh* component
             debug_assert(false);
             return;
         }
+        ++mGeometryStats.mMeshesCount;
     }
 
     // allocate index buffer object
@@ -122,19 +139,31 @@ void WaterLavaMeshRenderer::PrepareRenderdata(RenderableWaterLavaMesh* component
     GpuBuffer* indexBuffer = component->mIndexBuffer;
 
     // setup buffers
+    mGeometryStats.mVertexBytes -= vertexBuffer->mBufferCapacity;
+    mGeometryStats.mIndexBytes -= indexBuffer->mBufferCapacity;
     if (!vertexBuffer->Setup(eBufferUsage_Static, actualVBufferLength, nullptr) ||
         !indexBuffer->Setup(eBufferUsage_Static, actualIBufferLength, nullptr))
     {
         debug_assert(false);
         return;
     }
+    mGeometryStats.mVertexBytes += vertexBuffer->mBufferCapacity;
+    mGeometryStats.mIndexBytes += indexBuffer->mBufferCapacity;
+    mGeometryStats.mUploadedBytes += actualVBufferLength + actualIBufferLength;
 
-    Vertex3D_WaterLava* vbufferPtr = vertexBuffer->LockData<Vertex3D_WaterLava>(BufferAccess_UnsynchronizedWrite, 0, actualVBufferLength);
+    unsigned char* vbufferPtr = vertexBuffer->LockData<unsigned char>(BufferAccess_UnsynchronizedWrite, 0, actualVBufferLength);
     debug_assert(vbufferPtr);
 
-    glm::ivec3* ibufferPtr = indexBuffer->LockData<glm::ivec3>(BufferAccess_UnsynchronizedWrite, 0, actualIBufferLength);
+    unsigned char* ibufferPtr = indexBuffer->LockData<unsigned char>(BufferAccess_UnsynchronizedWrite, 0, actualIBufferLength);
     debug_assert(ibufferPtr);
 
+    if (vbufferPtr == nullptr || ibufferPtr == nullptr)
+    {
+        indexBuffer->Unlock();
+        vertexBuffer->Unlock();
+        return;
+    }
+
     // upload data
     int vertices_counter = 0;
     for (TerrainTile* currTile: component->mWaterLavaTiles)
@@ -149,10 +178,20 @@ void WaterLavaMeshRenderer::PrepareRenderdata(RenderableWaterLavaMesh* component
 
         for (const glm::ivec3& pointindex : pointindices)
         {
-            ibufferPtr->x = vertices_counter + pointindex.x;
-            ibufferPtr->y = vertices_counter + pointindex.y;
-            ibufferPtr->z = vertices_counter + pointindex.z;
-            ++ibufferPtr;
+            const glm::ivec3 triangle = pointindex + vertices_counter;
+            if (component->mIndicesType == eIndicesType_i16)
+            {
+                unsigned short* indices = reinterpret_cast<unsigned short*>(ibufferPtr);
+                indices[0] = (unsigned short) triangle.x;
+                indices[1] = (unsigned short) triangle.y;
+                indices[2] = (unsigned short) triangle.z;
+                ibufferPtr += 3 * sizeof(unsigned short);
+            }
+            else
+            {
+                ::memcpy(ibufferPtr, &triangle, sizeof(glm::ivec3));
+                ibufferPtr += sizeof(glm::ivec3);
+            }
         }
 
         // setup vertices
@@ -195,9 +234,23 @@ void WaterLavaMeshRenderer::PrepareRenderdata(RenderableWaterLavaMesh* component
         // process vertices
         for (int ipoint = 0; ipoint < NumVerticesPerTile; ++ipoint)
         {
-            vbufferPtr->mPosition = positions[ipoint];
-            vbufferPtr->mTexcoord = texturecoords[ipoint];
-            ++vbufferPtr;
+            if (component->mCompactVertices)
+            {
+                Vertex3D_WaterLavaCompact* vertex = reinterpret_cast<Vertex3D_WaterLavaCompact*>(vbufferPtr);
+                vertex->mPosition[0] = PackHalfFloat(positions[ipoint].x);
+                vertex->mPosition[1] = PackHalfFloat(positions[ipoint].y);
+                vertex->mPosition[2] = PackHalfFloat(positions[ipoint].z);
+                vertex->mPosition[3] = PackHalfFloat(1.0f);
+                vertex->mTexcoord[0] = PackHalfFloat(texturecoords[ipoint].x);
+                vertex->mTexcoord[1] = PackHalfFloat(texturecoords[ipoint].y);
+            }
+            else
+            {
+                Vertex3D_WaterLava* vertex = reinterpret_cast<Vertex3D_WaterLava*>(vbufferPtr);
+                vertex->mPosition = positions[ipoint];
+                vertex->mTexcoord = texturecoords[ipoint];
+            }
+            vbufferPtr += vertexSize;
         }
 
         vertices_counter += NumVerticesPerTile;
@@ -222,12 +275,15 @@ void WaterLavaMeshRenderer::ReleaseRenderdata(RenderableWaterLavaMesh* component
     component->mRenderProgram = nullptr;
     if (component->mVertexBuffer)
     {
+        mGeometryStats.mVertexBytes -= component->mVertexBuffer->mBufferCapacity;
+        --mGeometryStats.mMeshesCount;
         gGraphicsDevice.DestroyBuffer(component->mVertexBuffer);
         component->mVertexBuffer = nullptr;
     }
 
     if (component->mIndexBuffer)
     {
+        mGeometryStats.mIndexBytes -= component->mIndexBuffer->mBufferCapacity;
         gGraphicsDevice.DestroyBuffer(component->mIndexBuffer);
         component->mIndexBuffer = nullptr;
     }
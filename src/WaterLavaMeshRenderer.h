@@ -7,6 +7,10 @@ class WaterLavaMeshRenderer: public cxx::noncopyable
 {
     friend class RenderableWaterLavaMesh;
 
+public:
+    // readonly
+    RenderGeometryStats mGeometryStats;
+
 public:
     // setup renderer internal resources
     bool Initialize();
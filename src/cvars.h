@@ -5,10 +5,25 @@
 // scene cvars
 extern CvarBoolean gCvarScene_DebugDrawAabb;
 
+// gui cvars
+extern CvarBoolean gCvarGui_TexturesAtlas;
+extern CvarBoolean gCvarGui_RetainedRender;
+extern CvarBoolean gCvarGui_PickGrid;
+
+// game cvars
+extern CvarBoolean gCvarGame_RoomsIncrementalUpdate;
+
 // render common cvars
 extern CvarBoolean gCvarRender_DebugDrawEnabled;
 extern CvarBoolean gCvarRender_EnableAnimBlendFrames;
 extern CvarBoolean gCVarRender_DrawWaterAndLava;
 extern CvarBoolean gCVarRender_DrawTerrain;
+extern CvarBoolean gCvarRender_TerrainPartialUpdates;
+extern CvarBoolean gCvarRender_TerrainTexturesArray;
+extern CvarBoolean gCvarRender_CompactVertices;
 extern CvarBoolean gCVarRender_DrawModels;
+extern CvarBoolean gCvarRender_InstancedModels;
+extern CvarBoolean gCvarRender_ModelsAutoLOD;
+extern CvarFloat gCvarRender_ModelsLODScreenSize;
+extern CvarFloat gCvarRender_ModelsLODHysteresis;
 extern CvarBoolean gCVarRender_DrawTerrainHeightFieldMesh;
\ No newline at end of file
@@ -8,6 +8,20 @@ impl_enum_strings(eLogMessage)
     {eLogMessage_Info, "info"},
     {eLogMessage_Warning, "warning"},
     {eLogMessage_Error, "error"},
+};
+
+impl_enum_strings(eGraphicsCommand)
+{
+    {eGraphicsCommand_BindProgram, "bind_program"},
+    {eGraphicsCommand_BindVertexBuffer, "bind_vertex_buffer"},
+    {eGraphicsCommand_BindIndexBuffer, "bind_index_buffer"},
+    {eGraphicsCommand_BindTexture, "bind_texture"},
+    {eGraphicsCommand_SetRenderStates, "set_render_states"},
+    {eGraphicsCommand_SetUniform, "set_uniform"},
+    {eGraphicsCommand_UploadBuffer, "upload_buffer"},
+    {eGraphicsCommand_UploadTexture, "upload_texture"},
+    {eGraphicsCommand_Draw, "draw"},
+    {eGraphicsCommand_ClearScreen, "clear_screen"},
 };
 
 impl_enum_strings(eTextureRepeatMode)
@@ -73,11 +87,17 @@ impl_enum_strings(eTextureUnit)
 
 impl_enum_strings(eVertexAttributeFormat)
 {
+    {eVertexAttributeFormat_1F, "1f"},
     {eVertexAttributeFormat_2F, "2f"},
     {eVertexAttributeFormat_3F, "3f"},
+    {eVertexAttributeFormat_4F, "4f"},
     {eVertexAttributeFormat_4UB, "4ub"},
     {eVertexAttributeFormat_1US, "1us"},
     {eVertexAttributeFormat_2US, "2us"},
+    {eVertexAttributeFormat_2S, "2s"},
+    {eVertexAttributeFormat_4S, "4s"},
+    {eVertexAttributeFormat_2HF, "2hf"},
+    {eVertexAttributeFormat_4HF, "4hf"},
     {eVertexAttributeFormat_Unknown, "unknown"},
 };
 
@@ -92,6 +112,12 @@ impl_enum_strings(eVertexAttribute)
     {eVertexAttribute_Color0, "in_color0"},
     {eVertexAttribute_Color1, "in_color1"},
     {eVertexAttribute_TerrainTilePosition, "terrain_tile_pos"},
+    {eVertexAttribute_TerrainTextureLayer, "terrain_texture_layer"},
+    {eVertexAttribute_InstanceTransform0, "in_instance_transform0"},
+    {eVertexAttribute_InstanceTransform1, "in_instance_transform1"},
+    {eVertexAttribute_InstanceTransform2, "in_instance_transform2"},
+    {eVertexAttribute_InstanceTransform3, "in_instance_transform3"},
+    {eVertexAttribute_InstanceMixFrames, "in_instance_mix_frames"},
 };
 
 impl_enum_strings(eBufferContent)
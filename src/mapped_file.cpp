@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "mapped_file.h"
+
+#if OS_NAME == OS_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+#endif
+
+namespace cxx
+{
+
+bool mapped_file::open(const std::string& filepath)
+{
+    close();
+
+#if OS_NAME == OS_WINDOWS
+    HANDLE fileHandle = ::CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!::GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    HANDLE mappingHandle = ::CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL)
+    {
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    void* mappedData = ::MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (mappedData == NULL)
+    {
+        ::CloseHandle(mappingHandle);
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+
+    mFileHandle = fileHandle;
+    mMappingHandle = mappingHandle;
+    mData = static_cast<const unsigned char*>(mappedData);
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+    if (fileDescriptor == -1)
+        return false;
+
+    struct stat fileStat;
+    if (::fstat(fileDescriptor, &fileStat) == -1 || fileStat.st_size == 0)
+    {
+        ::close(fileDescriptor);
+        return false;
+    }
+
+    void* mappedData = ::mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    // mapping stays valid after descriptor is closed
+    ::close(fileDescriptor);
+
+    if (mappedData == MAP_FAILED)
+        return false;
+
+    mData = static_cast<const unsigned char*>(mappedData);
+    mSize = static_cast<size_t>(fileStat.st_size);
+#endif
+    return true;
+}
+
+void mapped_file::close()
+{
+    if (mData == nullptr)
+        return;
+
+#if OS_NAME == OS_WINDOWS
+    ::UnmapViewOfFile(mData);
+    ::CloseHandle(mMappingHandle);
+    ::CloseHandle(mFileHandle);
+    mMappingHandle = nullptr;
+    mFileHandle = nullptr;
+#else
+    ::munmap(const_cast<unsigned char*>(mData), mSize);
+#endif
+    mData = nullptr;
+    mSize = 0;
+}
+
+} // namespace cxx
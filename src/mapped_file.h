@@ -0,0 +1,42 @@
+#pragma once
+
+namespace cxx
+{
+    // read-only memory mapped file
+    // content could be accessed from multiple threads simultaneously
+    class mapped_file: public noncopyable
+    {
+    public:
+        mapped_file() = default;
+        ~mapped_file()
+        {
+            close();
+        }
+
+        // map entire file to memory for reading
+        // @param filepath: File path
+        // @returns false on error
+        bool open(const std::string& filepath);
+
+        // unmap file content
+        void close();
+
+        // test whether file is mapped
+        inline bool is_open() const { return mData != nullptr; }
+
+        // get pointer to file content or null if file is not mapped
+        inline const unsigned char* data() const { return mData; }
+
+        // get file content size in bytes
+        inline size_t size() const { return mSize; }
+
+    private:
+        const unsigned char* mData = nullptr;
+        size_t mSize = 0;
+#if OS_NAME == OS_WINDOWS
+        void* mFileHandle = nullptr;
+        void* mMappingHandle = nullptr;
+#endif
+    };
+
+} // namespace cxx
@@ -139,6 +139,17 @@ namespace cxx
         return true;
     }
 
+    // test intersection aabbox vs sphere
+    // @param bbox: Bounding box
+    // @param theSphere: Bounding sphere
+    inline bool intersects(const aabbox& bbox, const bounding_sphere& theSphere)
+    {
+        // closest point on box to sphere center
+        const glm::vec3 closestPoint = glm::clamp(theSphere.mOrigin, bbox.mMin, bbox.mMax);
+        const float sqDistance = glm::length2(closestPoint - theSphere.mOrigin);
+        return sqDistance <= (theSphere.mRadius * theSphere.mRadius);
+    }
+
     // test intersection aabox vs ray
     // @param bbox: Bouding box
     // @param ray3d: Ray
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
 #include <set>
@@ -29,6 +30,10 @@
 #include <cctype>
 #include <functional>
 #include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <unordered_map>
 #include <sstream>
 #include <iterator>
@@ -46,6 +51,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/norm.hpp>
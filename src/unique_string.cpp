@@ -4,49 +4,225 @@
 namespace cxx
 {
 
-void unique_string::set_data_internal(const char* string_content)
+// strings are distributed between shards by low bits of hash,
+// each shard is open addressing hash table with linear probing
+class unique_string::strings_table
 {
-    // check whether string isn't null
-    if (string_content == nullptr || *string_content == 0)
+public:
+    static const unsigned int ShardsCountBits = 5;
+    static const unsigned int ShardsCount = (1U << ShardsCountBits);
+    static const unsigned int ShardInitialCapacity = 64; // power of two
+
+    enum
     {
-        reset_data_internal();
-        return;
+        FNV_OFFSET_BASIS = 2166136261U,
+        FNV_PRIME = 16777619U
+    };
+
+    static unsigned int compute_hash(std::string_view string_content)
+    {
+        unsigned int result_value = FNV_OFFSET_BASIS;
+        for (char c: string_content)
+        {
+            result_value ^= (unsigned char) c;
+            result_value *= FNV_PRIME;
+        }
+        return result_value;
+    }
+
+    // find existing or add new string holder and reference it
+    string_holder* acquire(std::string_view string_content, unsigned int string_hash)
+    {
+        table_shard& shard = mShards[string_hash & (ShardsCount - 1)];
+
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+
+        string_holder* holder = shard.find(string_content, string_hash);
+        if (holder == nullptr)
+        {
+            holder = new string_holder;
+            holder->mString.assign(string_content.data(), string_content.length());
+            holder->mHash = string_hash;
+            shard.insert(holder);
+        }
+        holder->mReferenceCounter.fetch_add(1, std::memory_order_relaxed);
+        return holder;
+    }
+
+    // dereference string holder and destroy it if it is not used anymore
+    void release(string_holder* holder)
+    {
+        // last reference is only dropped under shard lock, so acquire cannot see destroyed holder
+        unsigned int references_count = holder->mReferenceCounter.load(std::memory_order_relaxed);
+        while (references_count > 1)
+        {
+            if (holder->mReferenceCounter.compare_exchange_weak(references_count, references_count - 1, std::memory_order_acq_rel))
+                return;
+        }
+
+        table_shard& shard = mShards[holder->mHash & (ShardsCount - 1)];
+
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        if (holder->mReferenceCounter.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            shard.erase(holder);
+            delete holder;
+        }
     }
-    std::string string_content_temp(string_content);
 
-    unique_string_table& strings_table = get_strings_table();
-    string_holder& holder = strings_table[string_content_temp];
-    if (holder.mReferenceCounter == 0) 
+    int get_strings_count()
     {
-        // consume temporary std string
-        holder.mString.swap(string_content_temp);
+        int strings_count = 0;
+        for (table_shard& currShard: mShards)
+        {
+            std::lock_guard<std::mutex> lock(currShard.mMutex);
+            strings_count += currShard.mElementsCount;
+        }
+        return strings_count;
     }
-    set_data_internal(&holder);
+
+private:
+    struct alignas(64) table_shard
+    {
+    public:
+        std::mutex mMutex;
+        std::vector<string_holder*> mSlots;
+        unsigned int mElementsCount = 0;
+
+    public:
+        inline unsigned int get_home_slot(unsigned int string_hash) const
+        {
+            return (string_hash >> ShardsCountBits) & (mSlots.size() - 1);
+        }
+
+        string_holder* find(std::string_view string_content, unsigned int string_hash) const
+        {
+            if (mSlots.empty())
+                return nullptr;
+
+            const unsigned int slots_mask = mSlots.size() - 1;
+            for (unsigned int islot = get_home_slot(string_hash);; islot = (islot + 1) & slots_mask)
+            {
+                string_holder* holder = mSlots[islot];
+                if (holder == nullptr)
+                    return nullptr;
+
+                if (holder->mHash == string_hash && holder->mString.length() == string_content.length() &&
+                    ::memcmp(holder->mString.data(), string_content.data(), string_content.length()) == 0)
+                {
+                    return holder;
+                }
+            }
+        }
+
+        void insert(string_holder* holder)
+        {
+            // keep load factor below 3/4
+            if ((mElementsCount + 1) * 4 > mSlots.size() * 3)
+            {
+                rehash(mSlots.empty() ? ShardInitialCapacity : mSlots.size() * 2);
+            }
+            insert_slot(holder);
+            ++mElementsCount;
+        }
+
+        void erase(string_holder* holder)
+        {
+            const unsigned int slots_mask = mSlots.size() - 1;
+
+            unsigned int islot = get_home_slot(holder->mHash);
+            while (mSlots[islot] != holder)
+            {
+                debug_assert(mSlots[islot]);
+                islot = (islot + 1) & slots_mask;
+            }
+            mSlots[islot] = nullptr;
+            --mElementsCount;
+
+            // shift back following elements of probe sequence so lookups don't stop at hole
+            for (unsigned int inext = (islot + 1) & slots_mask; mSlots[inext]; inext = (inext + 1) & slots_mask)
+            {
+                unsigned int ihome = get_home_slot(mSlots[inext]->mHash);
+                if (((inext - ihome) & slots_mask) >= ((inext - islot) & slots_mask))
+                {
+                    mSlots[islot] = mSlots[inext];
+                    mSlots[inext] = nullptr;
+                    islot = inext;
+                }
+            }
+        }
+
+    private:
+        void insert_slot(string_holder* holder)
+        {
+            const unsigned int slots_mask = mSlots.size() - 1;
+
+            unsigned int islot = get_home_slot(holder->mHash);
+            while (mSlots[islot])
+            {
+                islot = (islot + 1) & slots_mask;
+            }
+            mSlots[islot] = holder;
+        }
+
+        void rehash(unsigned int slots_count)
+        {
+            std::vector<string_holder*> prev_slots(slots_count, nullptr);
+            mSlots.swap(prev_slots);
+            for (string_holder* currHolder: prev_slots)
+            {
+                if (currHolder)
+                {
+                    insert_slot(currHolder);
+                }
+            }
+        }
+    };
+
+private:
+    table_shard mShards[ShardsCount];
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+// table is never destroyed because static unique strings could be released after it
+unique_string::strings_table& unique_string::get_strings_table()
+{
+    static strings_table* stringsTable = new strings_table;
+    return *stringsTable;
 }
 
-void unique_string::set_data_internal(const char* string_begin, const char* string_end)
+//////////////////////////////////////////////////////////////////////////
+
+void unique_string::assign_icase(std::string_view string_content)
 {
-    debug_assert(string_begin);
-    debug_assert(string_end);
-    if (string_begin == string_end || string_begin == nullptr || string_end == nullptr)
+    const int MaxStackContentLength = 256;
+
+    if (string_content.length() > MaxStackContentLength)
     {
-        reset_data_internal();
+        std::string folded_content(string_content);
+        for (char& c: folded_content)
+        {
+            c = ::tolower((unsigned char) c);
+        }
+        set_data_internal(std::string_view(folded_content));
         return;
     }
 
-    std::string string_content_temp(string_begin, string_end);
-
-    unique_string_table& strings_table = get_strings_table();
-    string_holder& holder = strings_table[string_content_temp];
-    if (holder.mReferenceCounter == 0) 
+    char folded_content[MaxStackContentLength];
+    for (size_t ichar = 0; ichar < string_content.length(); ++ichar)
     {
-        // consume temporary std string
-        holder.mString.swap(string_content_temp);
+        folded_content[ichar] = ::tolower((unsigned char) string_content[ichar]);
     }
-    set_data_internal(&holder);
+    set_data_internal(std::string_view(folded_content, string_content.length()));
 }
 
-void unique_string::set_data_internal(const std::string& string_content)
+int unique_string::get_strings_count()
+{
+    return get_strings_table().get_strings_count();
+}
+
+void unique_string::set_data_internal(std::string_view string_content)
 {
     // check whether string isn't null
     if (string_content.empty())
@@ -55,27 +231,13 @@ void unique_string::set_data_internal(const std::string& string_content)
         return;
     }
 
-    unique_string_table& strings_table = get_strings_table();
-    string_holder& holder = strings_table[string_content];
-    if (holder.mReferenceCounter == 0) 
-    {
-        holder.mString = string_content;
-    }
-    set_data_internal(&holder); 
-}
-
-void unique_string::set_data_internal(string_holder* content_holder)
-{
-    if (mStringHolder == content_holder) // same, do nothing
+    const unsigned int string_hash = strings_table::compute_hash(string_content);
+    if (mStringHolder->mHash == string_hash && mStringHolder->mString == string_content) // same, do nothing
         return;
 
+    string_holder* content_holder = get_strings_table().acquire(string_content, string_hash);
     reset_data_internal();
     mStringHolder = content_holder;
-
-    if (mStringHolder != get_null_string_data())
-    {
-        ++mStringHolder->mReferenceCounter;
-    }
 }
 
 void unique_string::reset_data_internal()
@@ -85,20 +247,7 @@ void unique_string::reset_data_internal()
         return;
 
     debug_assert(mStringHolder->mReferenceCounter > 0);
-    if (--mStringHolder->mReferenceCounter == 0)
-    {
-        unique_string_table& strings_table = get_strings_table();
-        auto map_iterator = strings_table.find(mStringHolder->mString);
-        if (map_iterator != strings_table.end())
-        {
-            strings_table.erase(map_iterator);
-        }
-        else
-        {
-            debug_assert(false);
-        }
-    }
-
+    get_strings_table().release(mStringHolder);
     mStringHolder = null_string_data;
 }
 
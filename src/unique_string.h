@@ -3,7 +3,8 @@
 namespace cxx
 {
     // stores unique pointer to immutable string
-    // not thread-safe
+    // thread-safe, strings table is split into shards guarded by separate locks,
+    // lookup of already interned content does not allocate
     class unique_string
     {
     public:
@@ -12,8 +13,15 @@ namespace cxx
 
         // construct unique string copy
         unique_string(const unique_string& string_content)
+            : mStringHolder(string_content.mStringHolder)
         {
-            set_data_internal(string_content.mStringHolder);
+            add_reference_internal(mStringHolder);
+        }
+
+        unique_string(unique_string&& string_content) noexcept
+            : mStringHolder(string_content.mStringHolder)
+        {
+            string_content.mStringHolder = get_null_string_data();
         }
 
         // construct unique string using c content
@@ -24,6 +32,12 @@ namespace cxx
 
         // construct unique string using std string content
         explicit unique_string(const std::string& string_content)
+        {
+            set_data_internal(std::string_view(string_content));
+        }
+
+        // construct unique string using string view content
+        explicit unique_string(std::string_view string_content)
         {
             set_data_internal(string_content);
         }
@@ -33,6 +47,15 @@ namespace cxx
             reset_data_internal();
         }
 
+        // construct unique string from content folded to lower case,
+        // names which differ only in case become same unique string
+        static unique_string from_icase(std::string_view string_content)
+        {
+            unique_string result_string;
+            result_string.assign_icase(string_content);
+            return result_string;
+        }
+
         // set unique string data using c string content
         inline void assign(const char* string_content)
         {
@@ -41,15 +64,31 @@ namespace cxx
 
         // set unique string using std string content
         inline void assign(const std::string& string_content)
+        {
+            set_data_internal(std::string_view(string_content));
+        }
+
+        // set unique string using string view content
+        inline void assign(std::string_view string_content)
         {
             set_data_internal(string_content);
         }
 
         inline void assign(const char* string_begin, const char* string_end)
         {
-            set_data_internal(string_begin, string_end);
+            debug_assert(string_begin);
+            debug_assert(string_end);
+            if (string_begin == nullptr || string_end == nullptr)
+            {
+                reset_data_internal();
+                return;
+            }
+            set_data_internal(std::string_view(string_begin, string_end - string_begin));
         }
 
+        // set unique string using content folded to lower case
+        void assign_icase(std::string_view string_content);
+
         // set null unique string
         inline void clear()
         {
@@ -59,7 +98,22 @@ namespace cxx
         // set unique string copy
         inline unique_string& operator = (const unique_string& string_content)
         {
-            set_data_internal(string_content);
+            if (mStringHolder != string_content.mStringHolder)
+            {
+                add_reference_internal(string_content.mStringHolder);
+                reset_data_internal();
+                mStringHolder = string_content.mStringHolder;
+            }
+            return *this;
+        }
+        inline unique_string& operator = (unique_string&& string_content) noexcept
+        {
+            if (this != &string_content)
+            {
+                reset_data_internal();
+                mStringHolder = string_content.mStringHolder;
+                string_content.mStringHolder = get_null_string_data();
+            }
             return *this;
         }
         // set unique string data using c string content
@@ -70,6 +124,12 @@ namespace cxx
         }
         // set unique string using std string content
         inline unique_string& operator = (const std::string& string_content)
+        {
+            set_data_internal(std::string_view(string_content));
+            return *this;
+        }
+        // set unique string using string view content
+        inline unique_string& operator = (std::string_view string_content)
         {
             set_data_internal(string_content);
             return *this;
@@ -91,6 +151,12 @@ namespace cxx
             return mStringHolder->mString == other_string;
         }
         inline bool operator != (const char* other_string) const { return !(*this == other_string); }
+        // compare unique string content with string view
+        inline bool operator == (std::string_view other_string) const
+        {
+            return mStringHolder->mString == other_string;
+        }
+        inline bool operator != (std::string_view other_string) const { return !(*this == other_string); }
         // getters
         inline operator const char* () const { return mStringHolder->mString.c_str(); }
         inline int length() const
@@ -102,21 +168,33 @@ namespace cxx
             return mStringHolder == get_null_string_data();
         }
         inline const char* c_str() const { return mStringHolder->mString.c_str(); }
+        inline std::string_view view() const { return mStringHolder->mString; }
 
-    private:
-        struct string_holder;
+        // get content hash computed on interning, zero for null string
+        inline unsigned int hash() const { return mStringHolder->mHash; }
 
-        using unique_string_table = std::map<std::string, string_holder>;
-        static unique_string_table& get_strings_table()
+        // hash function for unordered containers
+        struct hashfunc
         {
-            static unique_string_table uniqueStringsTable;
-            return uniqueStringsTable;
-        }
+            inline size_t operator() (const unique_string& input_string) const
+            {
+                return input_string.hash();
+            }
+        };
+
+        // get number of distinct strings currently interned
+        static int get_strings_count();
+
+    private:
+        class strings_table;
+        static strings_table& get_strings_table();
+
         struct string_holder
         {
         public:
             std::string mString; // unique data
-            unsigned int mReferenceCounter = 0;
+            unsigned int mHash = 0;
+            std::atomic<unsigned int> mReferenceCounter {0};
         };
         static string_holder* get_null_string_data()
         {
@@ -126,14 +204,27 @@ namespace cxx
 
     private:
         // set unique string data for c string content
-        void set_data_internal(const char* string_content);
-        void set_data_internal(const char* string_begin, const char* string_end);
+        inline void set_data_internal(const char* string_content)
+        {
+            if (string_content == nullptr)
+            {
+                reset_data_internal();
+                return;
+            }
+            set_data_internal(std::string_view(string_content));
+        }
 
-        // set unique string data for std string content
-        void set_data_internal(const std::string& string_content);
+        // set unique string data for string view content
+        void set_data_internal(std::string_view string_content);
 
-        // set unique string data
-        void set_data_internal(string_holder* content_holder);
+        // increment references counter, holder is already referenced so no lock required
+        static inline void add_reference_internal(string_holder* content_holder)
+        {
+            if (content_holder != get_null_string_data())
+            {
+                content_holder->mReferenceCounter.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
 
         // free unique string data
         void reset_data_internal();